@@ -2,6 +2,7 @@
 #include <Arduino.h>
 #include <DS3231.h>
 #include <EEPROM.h>
+#include "counters.h"
 
 #define MAX_DATA 1439 // максимальное количество минут для установки будильника (23 ч, 59 мин)
 
@@ -40,11 +41,19 @@ private:
 
   void write_eeprom_8(IndexOffset _index, uint8_t _data)
   {
+    if (read_eeprom_8(_index) != _data)
+    {
+      COUNT_ACTIVITY(CNT_EEPROM_WRITE);
+    }
     EEPROM.update(eeprom_index + _index, _data);
   }
 
   void write_eeprom_16(IndexOffset _index, uint16_t _data)
   {
+    if (read_eeprom_16(_index) != _data)
+    {
+      COUNT_ACTIVITY(CNT_EEPROM_WRITE);
+    }
     EEPROM.put(eeprom_index + _index, _data);
   }
 
@@ -75,8 +84,17 @@ public:
   Alarm(uint8_t _led_pin, uint16_t _eeprom_index)
   {
     led_pin = _led_pin;
-    pinMode(led_pin, OUTPUT);
     eeprom_index = _eeprom_index;
+    state = ALARM_OFF;
+  }
+
+  /**
+   * @brief инициализация будильника - проверка настроек в EEPROM и восстановление состояния; вызывается из setup()
+   *
+   */
+  void begin()
+  {
+    pinMode(led_pin, OUTPUT);
     if (read_eeprom_8(ALARM_STATE) > 1)
     {
       write_eeprom_8(ALARM_STATE, 0);
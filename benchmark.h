@@ -0,0 +1,111 @@
+/* Измерение времени выполнения функций отрисовки на самом МК;
+
+   Каждая функция выполняется BENCHMARK_ITERATIONS раз подряд, время выполнения определяется по отметкам времени HAL (halStamp(), аппаратный таймер с шагом 16 мкс, не теряющий времени при запрещенных прерываниях, в отличие от micros()) за вычетом времени пустого цикла. Результат выводится таблицей в формате CSV (имя функции, количество повторов, время одного вызова в мкс * 100 и оно же в тактах МК - пересчитанное по F_CPU, а не измеренное счетчиком тактов), которую удобно сохранять и сравнивать с результатами предыдущих версий:
+
+   kernel,iterations,us_x100,cycles_derived
+   showTime,200,18450,2952
+
+   Строка show - передача данных на экран: перед каждым вызовом show() на экране меняется один столбец или разряд, а для адресных светодиодов сбрасывается ограничение частоты передач, поэтому каждый вызов действительно передает кадр.
+
+   Во время измерения содержимое экрана портится, после измерения оно перерисовывается задачами часов.
+*/
+#pragma once
+#include <Arduino.h>
+#include <DS3231.h> // https://github.com/NorthernWidget/DS3231
+#include "hal.h"
+#if defined(MAX72XX_MATRIX_DISPLAY) || defined(WS2812_MATRIX_DISPLAY)
+#include "matrix_data.h"
+#endif
+
+#define BENCHMARK_ITERATIONS 200 // количество повторов каждой функции
+
+volatile uint8_t benchmark_sink; // приемник результатов, не дающий компилятору выбросить вычисления
+
+#ifdef MAX72XX_MATRIX_DISPLAY
+// попиксельное транспонирование блока 8х8 - для сравнения с transpose8x8()
+void transposeByPixels(const uint8_t *src, uint8_t *dst)
+{
+  for (uint8_t r = 0; r < 8; r++)
+  {
+    uint8_t x = 0;
+    for (uint8_t c = 0; c < 8; c++)
+    {
+      bitWrite(x, c, bitRead(src[c], r));
+    }
+    dst[r] = x;
+  }
+}
+#endif
+
+// выполнение кода code BENCHMARK_ITERATIONS раз и вывод результата; в коде доступен номер повтора _i
+#define BENCHMARK(out, name, code)                                        \
+  {                                                                       \
+    HalStamp _t = halStamp();                                             \
+    for (uint16_t _i = 0; _i < BENCHMARK_ITERATIONS; _i++)                \
+    {                                                                     \
+      code;                                                               \
+    }                                                                     \
+    printBenchmarkResult(out, F(name), halElapsedMicros(_t), empty_time); \
+  }
+
+void printBenchmarkResult(Print &out, const __FlashStringHelper *name, uint32_t time, uint32_t empty_time)
+{
+  time = (time > empty_time) ? time - empty_time : 0;
+  out.print(name);
+  out.print(',');
+  out.print(BENCHMARK_ITERATIONS);
+  out.print(',');
+  out.print(time * 100ul / BENCHMARK_ITERATIONS);
+  out.print(',');
+  out.println(time * (F_CPU / 1000000ul) / BENCHMARK_ITERATIONS);
+}
+
+/**
+ * @brief измерение времени выполнения функций отрисовки и вывод результата
+ *
+ * @param disp экран
+ * @param out поток для вывода, например, Serial
+ */
+template <class T>
+void runRenderBenchmark(T &disp, Print &out)
+{
+  DateTime date(2024, 12, 31, 23, 59, 58);
+  halTimerBegin();
+  HalStamp t = halStamp();
+  for (uint16_t i = 0; i < BENCHMARK_ITERATIONS; i++)
+  {
+    benchmark_sink = i;
+  }
+  uint32_t empty_time = halElapsedMicros(t);
+
+  out.println(F("kernel,iterations,us_x100,cycles_derived"));
+#if defined(MAX72XX_MATRIX_DISPLAY) || defined(WS2812_MATRIX_DISPLAY)
+  // вывод символа шрифта 5х7 через открытую обертку setDispData() над setChar()
+  BENCHMARK(out, "setDispData", disp.setDispData(_i & 0x1F, GLYPH_0 + (_i & 0x07), 5));
+  BENCHMARK(out, "showTime", disp.showTime(_i % 24, _i % 60, _i % 60, true));
+  BENCHMARK(out, "getDayOfWeek", benchmark_sink = getDayOfWeek(_i % 28 + 1, _i % 12 + 1, 2000 + _i));
+#else
+  BENCHMARK(out, "showTime", disp.showTime(_i % 24, _i % 60, true));
+#endif
+#if defined(MAX72XX_MATRIX_DISPLAY) || defined(WS2812_MATRIX_DISPLAY)
+  BENCHMARK(out, "setColumn", disp.setColumn(_i & 0x1F, _i));
+#endif
+#if defined(MAX72XX_MATRIX_DISPLAY)
+  uint8_t block[8] = {0x7E, 0x85, 0x89, 0x91, 0xA1, 0x7E, 0x00, 0x00};
+  uint8_t rows[8];
+  BENCHMARK(out, "transpose8x8", block[0] = _i; transpose8x8(block, rows); benchmark_sink = rows[_i & 0x07]);
+  BENCHMARK(out, "transposeByPixels", block[0] = _i; transposeByPixels(block, rows); benchmark_sink = rows[_i & 0x07]);
+#endif
+  BENCHMARK(out, "showTemp", disp.showTemp((int)(_i % 199) - 99));
+  disp.showDate(date, true);
+  // при бегущей строке каждый вызов формирует строку даты целиком (getDateString()); по окончании вывода даты он запускается заново, как в часах
+  BENCHMARK(out, "showDate", if (disp.showDate(date)) { disp.showDate(date, true); });
+  disp.showDate(date, true);
+#if defined(WS2812_MATRIX_DISPLAY)
+  BENCHMARK(out, "show", disp.setColumn(_i & 0x1F, _i); disp.resetShowLimit(); benchmark_sink = disp.show());
+#elif defined(MAX72XX_MATRIX_DISPLAY)
+  BENCHMARK(out, "show", disp.setColumn(_i & 0x1F, _i); benchmark_sink = disp.show());
+#else
+  BENCHMARK(out, "show", disp.setDispData(_i & 0x03, _i); benchmark_sink = disp.show());
+#endif
+}
@@ -0,0 +1,405 @@
+/* Кнопки с захватом фронтов в прерывании и очередью событий с метками времени;
+
+   Обработчик прерывания по изменению уровня на пинах кнопок вызывает EventButton::capture(), который помещает каждый фронт (номер кнопки, уровень, время в мс) в кольцевой буфер. Буфер рассчитан на одного писателя (прерывание) и одного читателя (главный цикл) и не требует блокировок. Если прерывания не используются (USE_BUTTON_INTERRUPTS не определен), capture() вызывается при каждом опросе кнопок.
+
+   Подавление дребезга и определение кликов выполняются по меткам времени фронтов, а не по моменту опроса кнопки, поэтому задержки главного цикла (например, во время FastLED.show() или обмена по I2C) не влияют на распознавание одиночного и двойного кликов, длинного клика и серии кликов - события лишь выдаются позже.
+
+   Состояния кнопки и режимы длинного клика совпадают с принятыми в библиотеке shButton.
+*/
+#pragma once
+#include <Arduino.h>
+
+// ==== состояния кнопки =============================
+#define BTN_RELEASED 0  // кнопка отпущена
+#define BTN_UP 1        // кнопка только что отпущена
+#define BTN_PRESSED 2   // кнопка нажата
+#define BTN_DOWN 3      // кнопка только что нажата
+#define BTN_DBLCLICK 4  // двойной клик
+#define BTN_ONECLICK 5  // одиночный клик
+#define BTN_LONGCLICK 6 // длинный клик
+
+// ==== режимы длинного клика ========================
+#define LCM_CONTINUED 0   // длинный клик выдается постоянно, пока кнопка нажата
+#define LCM_ONLYONCE 1    // длинный клик выдается один раз
+#define LCM_CLICKSERIES 2 // после длинного клика выдается серия длинных кликов с заданным интервалом
+
+#define BTN_MAX_COUNT 4         // максимальное количество кнопок
+#define BTN_EDGE_QUEUE_SIZE 16  // размер буфера фронтов (степень двойки)
+#define BTN_STATE_QUEUE_SIZE 4  // размер очереди состояний каждой кнопки (степень двойки)
+#define BTN_DEBOUNCE_TIMEOUT 30 // время подавления дребезга по умолчанию, мс
+#define BTN_DBLCLICK_TIMEOUT 300 // интервал двойного клика по умолчанию, мс
+#define BTN_LONGCLICK_TIMEOUT 1000 // время длинного клика по умолчанию, мс
+#define BTN_SERIAL_INTERVAL 200    // интервал серии кликов по умолчанию, мс
+
+/**
+ * @brief фронт на пине кнопки
+ */
+struct ButtonEdge
+{
+  uint8_t index; // номер кнопки
+  bool closed;   // кнопка замкнута
+  uint16_t time; // время фронта, мс (младшие 16 бит millis())
+};
+
+class EventButton
+{
+private:
+  static EventButton *buttons[BTN_MAX_COUNT];
+  static uint8_t button_count;
+  static volatile ButtonEdge edges[BTN_EDGE_QUEUE_SIZE];
+  static volatile uint8_t edge_head;
+  static volatile uint8_t edge_tail;
+  static volatile bool edge_overflow;
+  static uint16_t last_edge_time; // время последнего разобранного фронта
+
+  uint8_t pin;
+  uint8_t index;
+  volatile bool raw_closed = false; // последний уровень на пине, видимый обработчику прерывания
+
+  uint16_t debounce_timeout = BTN_DEBOUNCE_TIMEOUT;
+  uint16_t dblclick_timeout = BTN_DBLCLICK_TIMEOUT;
+  uint16_t longclick_timeout = BTN_LONGCLICK_TIMEOUT;
+  uint16_t serial_interval = BTN_SERIAL_INTERVAL;
+  uint8_t longclick_mode = LCM_CONTINUED;
+  bool virtual_click = false;
+
+  bool edge_closed = false; // уровень после последнего фронта, еще не прошедший подавление дребезга
+  uint16_t edge_time = 0;   // время последнего фронта
+  bool closed = false;      // состояние кнопки после подавления дребезга
+  bool ignore = false;      // игнорировать текущее нажатие до отпускания кнопки
+  bool long_done = false;   // длинный клик для текущего нажатия уже выдан
+  bool dbl_press = false;   // текущее нажатие - второе нажатие двойного клика
+  bool click_wait = false;  // ожидание истечения интервала двойного клика для выдачи одиночного клика
+  uint16_t press_time = 0;
+  uint16_t release_time = 0;
+  uint16_t serial_time = 0; // время выдачи следующего клика серии
+
+  uint8_t states[BTN_STATE_QUEUE_SIZE];
+  uint8_t state_head = 0;
+  uint8_t state_tail = 0;
+  uint8_t last_state = BTN_RELEASED;
+
+  void pushState(uint8_t _state)
+  {
+    uint8_t next = (state_head + 1) & (BTN_STATE_QUEUE_SIZE - 1);
+    if (next != state_tail)
+    {
+      states[state_head] = _state;
+      state_head = next;
+    }
+  }
+
+  void setClosed(bool _closed, uint16_t t)
+  {
+    closed = _closed;
+    if (closed)
+    {
+      if (ignore)
+      {
+        return;
+      }
+      dbl_press = click_wait && (uint16_t)(t - release_time) < dblclick_timeout;
+      click_wait = false;
+      long_done = false;
+      press_time = t;
+      pushState((dbl_press) ? BTN_DBLCLICK : BTN_DOWN);
+    }
+    else
+    {
+      if (ignore)
+      {
+        ignore = false;
+        return;
+      }
+      // длинный клик и клики серии, пришедшиеся на время до отпускания кнопки, выдаются, даже если кнопку в это время не опрашивали
+      checkHold(t);
+      pushState(BTN_UP);
+      if (!long_done && !dbl_press)
+      {
+        if (virtual_click)
+        {
+          click_wait = true;
+          release_time = t;
+        }
+        else
+        {
+          pushState(BTN_ONECLICK);
+        }
+      }
+    }
+  }
+
+  // выдача длинного клика и кликов серии, время которых наступило к моменту t
+  void checkHold(uint16_t t)
+  {
+    if (!long_done)
+    {
+      if ((uint16_t)(t - press_time) < longclick_timeout)
+      {
+        return;
+      }
+      long_done = true;
+      serial_time = press_time + longclick_timeout + serial_interval;
+      pushState(BTN_LONGCLICK);
+      return;
+    }
+    switch (longclick_mode)
+    {
+    case LCM_CONTINUED:
+      pushState(BTN_LONGCLICK);
+      break;
+    case LCM_CLICKSERIES:
+      // время кликов серии отсчитывается от момента нажатия, поэтому задержки опроса не сдвигают серию
+      for (uint8_t i = 0; i < BTN_STATE_QUEUE_SIZE - 1 && (int16_t)(t - serial_time) >= 0; i++)
+      {
+        serial_time += serial_interval;
+        pushState(BTN_LONGCLICK);
+      }
+      break;
+    }
+  }
+
+  // обработка фронта; фронт принимается, только если уровень после него продержался не менее debounce_timeout
+  void onEdge(bool _closed, uint16_t t)
+  {
+    if (edge_closed != closed && (uint16_t)(t - edge_time) >= debounce_timeout)
+    {
+      setClosed(edge_closed, edge_time);
+    }
+    edge_closed = _closed;
+    edge_time = t;
+  }
+
+  // обработка событий, зависящих от времени
+  void process(uint16_t now)
+  {
+    if (edge_closed != closed && (uint16_t)(now - edge_time) >= debounce_timeout)
+    {
+      setClosed(edge_closed, edge_time);
+    }
+    if (closed && !ignore)
+    {
+      checkHold(now);
+    }
+    else if (click_wait && (uint16_t)(now - release_time) >= dblclick_timeout)
+    {
+      click_wait = false;
+      pushState(BTN_ONECLICK);
+    }
+  }
+
+  // разбор буфера фронтов
+  static void update()
+  {
+#ifndef USE_BUTTON_INTERRUPTS
+    capture();
+#endif
+    // флаг читается до разбора буфера: фронты, потерянные позже, будут учтены при следующем вызове
+    bool overflow = edge_overflow;
+    while (edge_tail != edge_head)
+    {
+      uint8_t t = edge_tail;
+      uint8_t i = edges[t].index;
+      if (i < button_count)
+      {
+        buttons[i]->onEdge(edges[t].closed, edges[t].time);
+      }
+      last_edge_time = edges[t].time;
+      edge_tail = (t + 1) & (BTN_EDGE_QUEUE_SIZE - 1);
+    }
+    if (overflow)
+    {
+      // фронты потеряны - синхронизировать состояние кнопок с текущими уровнями на пинах; потерянные фронты произошли после последнего принятого, поэтому используется его время, а не текущее, чтобы не сдвигать подавление дребезга и отсчет длинного клика
+      edge_overflow = false;
+      for (uint8_t i = 0; i < button_count; i++)
+      {
+        EventButton *btn = buttons[i];
+        if (btn->raw_closed != btn->edge_closed)
+        {
+          btn->onEdge(btn->raw_closed, last_edge_time);
+        }
+      }
+    }
+  }
+
+public:
+  /**
+   * @brief конструктор; кнопка замыкает пин на GND, пин подтягивается к VCC внутренним резистором
+   *
+   * @param button_pin пин кнопки
+   */
+  EventButton(uint8_t button_pin)
+  {
+    pin = button_pin;
+    pinMode(pin, INPUT_PULLUP);
+    // кнопки сверх BTN_MAX_COUNT не регистрируются, и их фронты не захватываются
+    index = button_count;
+    if (index < BTN_MAX_COUNT)
+    {
+      buttons[button_count++] = this;
+    }
+  }
+
+  /**
+   * @brief захват фронтов на пинах всех кнопок; вызывается из обработчика прерывания по изменению уровня на пинах
+   *
+   * @return true, если изменился уровень хотя бы на одном пине кнопки; false - прерывание вызвано другим пином той же группы (например, SQW)
+   */
+  static bool capture()
+  {
+    bool result = false;
+    uint16_t t = millis();
+    for (uint8_t i = 0; i < button_count; i++)
+    {
+      EventButton *btn = buttons[i];
+      bool _closed = digitalRead(btn->pin) == LOW;
+      if (_closed != btn->raw_closed)
+      {
+        result = true;
+        btn->raw_closed = _closed;
+        uint8_t next = (edge_head + 1) & (BTN_EDGE_QUEUE_SIZE - 1);
+        if (next == edge_tail)
+        {
+          edge_overflow = true;
+        }
+        else
+        {
+          edges[edge_head].index = i;
+          edges[edge_head].closed = _closed;
+          edges[edge_head].time = t;
+          edge_head = next;
+        }
+      }
+    }
+    return (result);
+  }
+
+  /**
+   * @brief получение текущего состояния кнопки; за один вызов выдается одно событие
+   *
+   * @return uint8_t
+   */
+  uint8_t getButtonState()
+  {
+    update();
+    process(millis());
+    if (state_tail != state_head)
+    {
+      last_state = states[state_tail];
+      state_tail = (state_tail + 1) & (BTN_STATE_QUEUE_SIZE - 1);
+    }
+    else
+    {
+      last_state = (closed) ? BTN_PRESSED : BTN_RELEASED;
+    }
+    return (last_state);
+  }
+
+  /**
+   * @brief получение последнего состояния кнопки, выданного методом getButtonState()
+   *
+   * @return uint8_t
+   */
+  uint8_t getLastState() { return (last_state); }
+
+  /**
+   * @brief получение состояния кнопки после подавления дребезга
+   *
+   * @return true, если кнопка нажата
+   */
+  bool isButtonClosed() { return (closed); }
+
+  /**
+   * @brief получение времени удержания кнопки, отсчитываемого от момента нажатия
+   *
+   * @return время в мс; 0, если кнопка не нажата
+   */
+  uint16_t getHoldTime() { return ((closed) ? (uint16_t)millis() - press_time : 0); }
+
+  /**
+   * @brief получение пина кнопки
+   *
+   * @return uint8_t
+   */
+  uint8_t getPin() { return (pin); }
+
+  /**
+   * @brief проверка, что при последнем состоянии кнопки _state нажата и вторая кнопка
+   *
+   * @param btn вторая кнопка
+   * @param _state состояние текущей кнопки
+   * @return true, если условие выполнено
+   */
+  bool isSecondButtonPressed(EventButton &btn, uint8_t _state = BTN_DOWN)
+  {
+    bool result = (last_state == _state) && btn.isButtonClosed();
+    if (result)
+    {
+      resetButtonState();
+      btn.resetButtonState();
+    }
+    return (result);
+  }
+
+  /**
+   * @brief сброс состояния кнопки; текущее нажатие игнорируется до отпускания кнопки
+   *
+   */
+  void resetButtonState()
+  {
+    state_tail = state_head;
+    click_wait = false;
+    ignore = closed;
+    last_state = (closed) ? BTN_PRESSED : BTN_RELEASED;
+  }
+
+  /**
+   * @brief установка времени подавления дребезга
+   *
+   * @param timeout время, мс
+   */
+  void setTimeoutOfDebounce(uint16_t timeout) { debounce_timeout = timeout; }
+
+  /**
+   * @brief установка интервала двойного клика
+   *
+   * @param timeout время, мс
+   */
+  void setTimeoutOfDblClick(uint16_t timeout) { dblclick_timeout = timeout; }
+
+  /**
+   * @brief установка времени длинного клика
+   *
+   * @param timeout время, мс
+   */
+  void setTimeoutOfLongClick(uint16_t timeout) { longclick_timeout = timeout; }
+
+  /**
+   * @brief установка режима длинного клика
+   *
+   * @param mode режим - LCM_CONTINUED, LCM_ONLYONCE или LCM_CLICKSERIES
+   */
+  void setLongClickMode(uint8_t mode) { longclick_mode = mode; }
+
+  /**
+   * @brief установка интервала серии кликов в режиме LCM_CLICKSERIES
+   *
+   * @param interval интервал, мс
+   */
+  void setIntervalOfSerial(uint16_t interval) { serial_interval = interval; }
+
+  /**
+   * @brief включение виртуального клика - одиночный клик выдается только по истечении интервала двойного клика, если второго нажатия не было
+   *
+   * @param flag включить/выключить
+   */
+  void setVirtualClickOn(bool flag) { virtual_click = flag; }
+};
+
+EventButton *EventButton::buttons[BTN_MAX_COUNT];
+uint8_t EventButton::button_count = 0;
+volatile ButtonEdge EventButton::edges[BTN_EDGE_QUEUE_SIZE];
+volatile uint8_t EventButton::edge_head = 0;
+volatile uint8_t EventButton::edge_tail = 0;
+volatile bool EventButton::edge_overflow = false;
+uint16_t EventButton::last_edge_time = 0;
@@ -0,0 +1,92 @@
+/* Счетчики активности часов;
+
+   Считаются обращения к периферии, которые определяют нагрузку на шины и износ EEPROM: транзакции I2C с модулем DS3231, передачи данных на экран, записи в EEPROM, ноты пищалки и события кнопок. Отчет со значениями счетчиков и их частотой в минуту и в час за время с момента последнего сброса выводится методом printReport().
+
+   Счетчики увеличиваются макросом COUNT_ACTIVITY(id); если макрос USE_ACTIVITY_COUNTERS не определен, макрос пуст и код счетчиков не компилируется.
+*/
+#pragma once
+#include <Arduino.h>
+
+#ifdef USE_ACTIVITY_COUNTERS
+
+enum ActivityCounter : uint8_t // идентификаторы счетчиков
+{
+  CNT_I2C,           // транзакции I2C с DS3231
+  CNT_DISPLAY_SHOW,  // передачи данных на экран
+  CNT_EEPROM_WRITE,  // записи в EEPROM
+  CNT_BUZZER_NOTE,   // ноты пищалки
+  CNT_BUTTON_EVENT,  // события кнопок
+  ACTIVITY_COUNTER_COUNT
+};
+
+class ActivityCounters
+{
+private:
+  uint32_t count[ACTIVITY_COUNTER_COUNT];
+  uint32_t start_time = 0;
+
+public:
+  ActivityCounters() { reset(); }
+
+  /**
+   * @brief увеличение счетчика на единицу
+   *
+   * @param id идентификатор счетчика
+   */
+  void inc(ActivityCounter id) { count[id]++; }
+
+  /**
+   * @brief получение значения счетчика
+   *
+   * @param id идентификатор счетчика
+   * @return uint32_t
+   */
+  uint32_t get(ActivityCounter id) { return (count[id]); }
+
+  /**
+   * @brief сброс счетчиков
+   *
+   */
+  void reset()
+  {
+    for (uint8_t i = 0; i < ACTIVITY_COUNTER_COUNT; i++)
+    {
+      count[i] = 0;
+    }
+    start_time = millis();
+  }
+
+  /**
+   * @brief вывод отчета по счетчикам: значение, частота в минуту и в час; после вывода счетчики сбрасываются
+   *
+   * @param out поток для вывода, например, Serial
+   */
+  void printReport(Print &out)
+  {
+    static const char PROGMEM names[] = "i2c\0show\0eeprom\0note\0button";
+    uint32_t t = millis() - start_time;
+    out.print(F("time, s: "));
+    out.println(t / 1000);
+    out.println(F("name cnt /min /h"));
+    const char *name = names;
+    for (uint8_t i = 0; i < ACTIVITY_COUNTER_COUNT; i++)
+    {
+      out.print((const __FlashStringHelper *)name);
+      name += strlen_P(name) + 1;
+      out.print(' ');
+      out.print(count[i]);
+      out.print(' ');
+      out.print((t > 0) ? (uint32_t)((uint64_t)count[i] * 60000ul / t) : 0);
+      out.print(' ');
+      out.println((t > 0) ? (uint32_t)((uint64_t)count[i] * 3600000ul / t) : 0);
+    }
+    reset();
+  }
+};
+
+ActivityCounters activity;
+
+#define COUNT_ACTIVITY(id) activity.inc(id)
+#else
+#define COUNT_ACTIVITY(id)
+#endif
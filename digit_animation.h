@@ -0,0 +1,203 @@
+/* Анимация смены цифр времени на матричных экранах;
+
+   При смене часов или минут анимируются только изменившиеся цифры. Промежуточные столбцы вычисляются на лету из символов font_digit: при прокрутке (ANIMATION_ROLL) старая цифра уходит вверх, а новая поднимается снизу, при сдвиге (ANIMATION_SLIDE) цифры сдвигаются влево; плавная смена яркости (ANIMATION_FADE) выполняется экраном WS2812, на MAX72xx она заменяется прокруткой.
+
+   Кадры анимации формируются задачей вывода на экран (display_guard), по одному шагу за вызов. Время формирования кадра ограничено ANIMATION_FRAME_BUDGET и проверяется перед выводом каждой цифры: если оно исчерпано, оставшиеся цифры сразу выводятся в конечном виде и анимация завершается, поэтому анимация не задерживает опрос кнопок и RTC.
+
+   Методы:
+
+   void start(digit, from, to) - запуск анимации цифры (0..3) от символа from к символу to;
+   void cancel(digit) - отмена анимации цифры;
+   void stop() - отмена всей анимации;
+   bool isActive() - выполняется ли анимация;
+   bool isDigitActive(digit) - анимируется ли цифра;
+   void next() - переход к следующему шагу анимации;
+   uint8_t getStep() - номер текущего шага (1..ANIMATION_STEPS);
+   uint8_t getColumn(digit, col) - столбец цифры на текущем шаге;
+   void finish(time, snapped) - учет времени формирования кадра; анимация завершается после последнего шага или если цифры были выведены в конечном виде;
+   void printReport(out) - вывод статистики времени формирования кадров;
+*/
+#pragma once
+#include <Arduino.h>
+#include "matrix_data.h"
+
+#define ANIMATION_STEPS 8       // количество шагов анимации; шаги выполняются с интервалом задачи вывода на экран
+#define ANIMATION_DIGIT_WIDTH 6 // ширина цифры, столбцов
+
+class DigitAnimator
+{
+private:
+  uint8_t from[4];
+  uint8_t to[4];
+  uint8_t active = 0; // биты анимируемых цифр
+  uint8_t step = 0;
+  uint16_t max_time = 0; // максимальное время формирования кадра, мкс
+  uint16_t frames = 0;   // количество сформированных кадров
+  uint16_t overruns = 0; // количество кадров, не уложившихся в ANIMATION_FRAME_BUDGET
+
+  uint8_t getGlyphColumn(uint8_t chr, uint8_t col)
+  {
+    return (pgm_read_byte(&font_digit[chr * ANIMATION_DIGIT_WIDTH + col]));
+  }
+
+public:
+  /**
+   * @brief запуск анимации цифры; если другие цифры уже анимируются, анимация всех цифр начинается заново
+   *
+   * @param digit номер цифры, 0..3 слева направо
+   * @param _from символ, который выведен сейчас
+   * @param _to новый символ
+   */
+  void start(uint8_t digit, uint8_t _from, uint8_t _to)
+  {
+    from[digit] = _from;
+    to[digit] = _to;
+    active |= 1 << digit;
+    step = 0;
+  }
+
+  /**
+   * @brief отмена анимации цифры
+   *
+   * @param digit номер цифры
+   */
+  void cancel(uint8_t digit) { active &= ~(1 << digit); }
+
+  /**
+   * @brief отмена всей анимации
+   *
+   */
+  void stop() { active = 0; }
+
+  /**
+   * @brief проверка, выполняется ли анимация
+   *
+   * @return true, если анимируется хотя бы одна цифра
+   */
+  bool isActive() { return (active != 0); }
+
+  /**
+   * @brief проверка, анимируется ли цифра
+   *
+   * @param digit номер цифры
+   * @return true, если анимируется
+   */
+  bool isDigitActive(uint8_t digit) { return (active & (1 << digit)); }
+
+  /**
+   * @brief получение смещения цифры от левого края области 32х8
+   *
+   * @param digit номер цифры
+   * @return uint8_t
+   */
+  uint8_t getDigitOffset(uint8_t digit)
+  {
+    static const uint8_t PROGMEM offset[] = {1, 8, 17, 24};
+
+    return (pgm_read_byte(&offset[digit]));
+  }
+
+  /**
+   * @brief переход к следующему шагу анимации
+   *
+   */
+  void next() { step++; }
+
+  /**
+   * @brief получение номера текущего шага анимации
+   *
+   * @return uint8_t 1..ANIMATION_STEPS
+   */
+  uint8_t getStep() { return (step); }
+
+  /**
+   * @brief получение начального столбца цифры
+   *
+   * @param digit номер цифры
+   * @param col столбец, 0..ANIMATION_DIGIT_WIDTH-1
+   * @return uint8_t
+   */
+  uint8_t getFromColumn(uint8_t digit, uint8_t col) { return (getGlyphColumn(from[digit], col)); }
+
+  /**
+   * @brief получение конечного столбца цифры
+   *
+   * @param digit номер цифры
+   * @param col столбец, 0..ANIMATION_DIGIT_WIDTH-1
+   * @return uint8_t
+   */
+  uint8_t getToColumn(uint8_t digit, uint8_t col) { return (getGlyphColumn(to[digit], col)); }
+
+  /**
+   * @brief получение столбца цифры на текущем шаге анимации
+   *
+   * @param digit номер цифры
+   * @param col столбец, 0..ANIMATION_DIGIT_WIDTH-1
+   * @return uint8_t
+   */
+  uint8_t getColumn(uint8_t digit, uint8_t col)
+  {
+    if (step >= ANIMATION_STEPS)
+    {
+      return (getToColumn(digit, col));
+    }
+#if DIGIT_ANIMATION == ANIMATION_SLIDE
+    // лента из старой цифры, пустого столбца и новой цифры сдвигается влево
+    uint8_t x = col + step * (ANIMATION_DIGIT_WIDTH + 1) / ANIMATION_STEPS;
+    if (x < ANIMATION_DIGIT_WIDTH)
+    {
+      return (getFromColumn(digit, x));
+    }
+    x -= ANIMATION_DIGIT_WIDTH + 1;
+    return ((x < ANIMATION_DIGIT_WIDTH) ? getToColumn(digit, x) : 0x00);
+#else
+    // старшим битом столбца является верхняя строка, поэтому сдвиг влево поднимает изображение
+    uint8_t k = step * 8 / ANIMATION_STEPS;
+    return ((uint8_t)(getFromColumn(digit, col) << k) | (getToColumn(digit, col) >> (8 - k)));
+#endif
+  }
+
+  /**
+   * @brief учет времени формирования кадра; после последнего шага анимация завершается
+   *
+   * @param time время формирования кадра, мкс
+   * @param snapped бюджет кадра был исчерпан, и цифры выведены в конечном виде
+   */
+  void finish(uint32_t time, bool snapped)
+  {
+    if (time > max_time)
+    {
+      max_time = (time < 0xFFFF) ? time : 0xFFFF;
+    }
+    if (frames < 0xFFFF)
+    {
+      frames++;
+    }
+    if ((snapped || time > ANIMATION_FRAME_BUDGET) && overruns < 0xFFFF)
+    {
+      overruns++;
+    }
+    if (snapped || step >= ANIMATION_STEPS)
+    {
+      active = 0;
+    }
+  }
+
+  /**
+   * @brief вывод статистики времени формирования кадров анимации; после вывода статистика сбрасывается
+   *
+   * @param out поток для вывода, например, Serial
+   */
+  void printReport(Print &out)
+  {
+    out.print(F("anim frames: "));
+    out.println(frames);
+    out.print(F("anim max, us: "));
+    out.println(max_time);
+    out.print(F("anim overruns: "));
+    out.println(overruns);
+    frames = 0;
+    max_time = 0;
+    overruns = 0;
+  }
+};
@@ -4,6 +4,9 @@
 #include <avr/pgmspace.h>
 #include <DS3231.h>        // https://github.com/NorthernWidget/DS3231
 #include <shMAX72xxMini.h> // https://github.com/VAleSh-Soft/shMAX72xxMini
+#ifdef USE_DIGIT_ANIMATION
+#include "digit_animation.h"
+#endif
 
 // ==== класс для 7-сегментного индикатора MAX72xx ===
 
@@ -79,8 +82,9 @@ public:
   /**
    * @brief отрисовка на экране содержимого его буфера
    *
+   * @return true, если данные были переданы на экран
    */
-  void show()
+  bool show()
   {
     bool flag = false;
     static uint8_t _data[4] = {0x00, 0x00, 0x00, 0x00};
@@ -101,6 +105,7 @@ public:
       }
       setSegments(data);
     }
+    return (flag);
   }
 
   /**
@@ -215,7 +220,7 @@ public:
     data[0] = 0b00011111;
     if (toSensor)
     {
-      data[1] = (toMin) ? encodeDigit(0) : encodeDigit(1);
+      data[1] = (toMin) ? this->encodeDigit(0) : this->encodeDigit(1);
     }
     else
     {
@@ -224,8 +229,8 @@ public:
     data[1] |= 0x80; // для показа двоеточия установить старший бит во второй цифре
     if (!blink)
     {
-      data[2] = encodeDigit(br / 10);
-      data[3] = encodeDigit(br % 10);
+      data[2] = this->encodeDigit(br / 10);
+      data[3] = this->encodeDigit(br % 10);
     }
   }
 
@@ -241,38 +246,183 @@ public:
   }
 };
 
-// ==== класс для матрицы 8х8х4 MAX72xx ==============
+// ==== класс для матрицы из модулей 8х8 MAX72xx ===
 
-template <uint8_t cs_pin>
-class DisplayMAX72xxMatrix : public shMAX72xxMini<cs_pin, 4>
+// флаги преобразования блока 8х8 при переводе столбцов изображения в строки регистров MAX72xx
+enum MatrixOrientation : uint8_t
+{
+  MATRIX_TRANSPOSE = 0x01,    // транспонировать блок
+  MATRIX_REVERSE_SRC = 0x02,  // обратный порядок столбцов изображения (отражение по горизонтали)
+  MATRIX_REVERSE_ROWS = 0x04, // обратный порядок строк результата
+  MATRIX_REVERSE_BITS = 0x08  // обратный порядок битов в строках результата
+};
+
+/**
+ * @brief матрица из модулей 8х8 MAX72xx, соединенных в цепочку построчно: сначала модули верхнего ряда слева направо, затем следующего ряда и т.д.
+ *
+ * @tparam cs_pin пин CS
+ * @tparam col_count ширина экрана в пикселях, кратна 8, не меньше 32
+ * @tparam row_count высота экрана в пикселях, кратна 8
+ */
+template <uint8_t cs_pin, uint8_t col_count = 32, uint8_t row_count = 8>
+class DisplayMAX72xxMatrix : public shMAX72xxMini<cs_pin, (col_count / 8) * (row_count / 8)>
 {
 private:
+  static_assert(col_count >= 32 && col_count <= 128 && col_count % 8 == 0, "matrix width must be a multiple of 8 in the range 32..128");
+  static_assert(row_count >= 8 && row_count <= 32 && row_count % 8 == 0, "matrix height must be a multiple of 8 in the range 8..32");
+
+  typedef shMAX72xxMini<cs_pin, (col_count / 8) * (row_count / 8)> Driver;
+
+  static const uint8_t BANDS = row_count / 8;                // количество рядов модулей
+  static const uint8_t DEVICES = (col_count / 8) * BANDS;    // количество модулей
+  static const uint8_t LAYOUT_OFFSET = (col_count - 32) / 2; // смещение области 32х8, в которой строится изображение, от левого края экрана
+  static const uint8_t TEXT_ROW = (row_count - 8) / 2;       // верхняя строка области 32х8
+  static const uint8_t TEXT_BAND = TEXT_ROW / 8;             // ряд модулей, в котором начинается область 32х8
+  static const uint8_t TEXT_SHIFT = TEXT_ROW % 8;            // сдвиг области 32х8 внутри ряда модулей
+  static const uint16_t TICKER_LENGTH = 168 + col_count;     // длина строки бегущей строки, столбцов
+
+  // изображение хранится по столбцам, как его формируют шрифты, по 8 строк на каждый ряд модулей; в строки регистров MAX72xx оно переводится при выводе на экран, один раз на каждый измененный модуль; библиотека при этом остается в направлении по умолчанию, в котором setRow() записывает байт в регистр без преобразований
+  uint8_t columns[BANDS][col_count];
+  uint8_t dirty[(DEVICES + 7) / 8];       // биты модулей, столбцы которых изменились после последней передачи
+  uint8_t orientation = MATRIX_TRANSPOSE; // флаги MatrixOrientation для заданного поворота и отражения
+  uint8_t direction = 0;
+  bool flip = false;
+  MatrixLayers layers;
+  uint8_t lang = LANG_DEFAULT; // язык вывода, номер языкового пакета
+#ifdef USE_DIGIT_ANIMATION
+  DigitAnimator animator;
+#endif
+
+  void writeBand(uint8_t band, uint8_t col, uint8_t data, uint8_t mask)
+  {
+    data = (columns[band][col] & ~mask) | (data & mask);
+    if (columns[band][col] != data)
+    {
+      columns[band][col] = data;
+      uint8_t dev = band * (col_count / 8) + (col >> 3);
+      dirty[dev >> 3] |= 1 << (dev & 0x07);
+    }
+  }
+
+  // запись столбца области 32х8; старший бит - верхняя строка
+  void writeColumn(uint8_t col, uint8_t data)
+  {
+    if (col < col_count)
+    {
+      if (TEXT_SHIFT == 0)
+      {
+        writeBand(TEXT_BAND, col, data, 0xFF);
+      }
+      else
+      {
+        writeBand(TEXT_BAND, col, data >> TEXT_SHIFT, 0xFF >> TEXT_SHIFT);
+        writeBand(TEXT_BAND + 1, col, data << (8 - TEXT_SHIFT), 0xFF << (8 - TEXT_SHIFT));
+      }
+    }
+  }
+
+  void clearFrame()
+  {
+    for (uint8_t b = 0; b < BANDS; b++)
+    {
+      for (uint8_t i = 0; i < col_count; i++)
+      {
+        writeBand(b, i, 0x00, 0xFF);
+      }
+    }
+  }
+
+  void clearColumns(uint8_t col, uint8_t count)
+  {
+    for (uint8_t i = 0; i < count; i++)
+    {
+      writeColumn(col + i, 0x00);
+    }
+  }
+
+  void setDirty()
+  {
+    memset(dirty, 0xFF, sizeof(dirty));
+  }
+
+  void updateOrientation()
+  {
+    // повороты на 0, 90, 180 и 270 градусов
+    static const uint8_t PROGMEM orient[] = {
+        MATRIX_TRANSPOSE,
+        MATRIX_REVERSE_BITS,
+        MATRIX_TRANSPOSE | MATRIX_REVERSE_SRC | MATRIX_REVERSE_ROWS,
+        MATRIX_REVERSE_ROWS};
+
+    orientation = pgm_read_byte(&orient[direction]);
+    if (flip)
+    {
+      orientation ^= MATRIX_REVERSE_SRC;
+    }
+    setDirty();
+  }
+
+  // перевод столбцов модуля в строки регистров и запись их в буфер библиотеки
+  void renderDevice(uint8_t dev)
+  {
+    uint8_t src[8];
+    uint8_t rows[8];
+    uint8_t *col = &columns[dev / (col_count / 8)][(dev % (col_count / 8)) * 8];
+    for (uint8_t i = 0; i < 8; i++)
+    {
+      src[i] = (orientation & MATRIX_REVERSE_SRC) ? col[7 - i] : col[i];
+    }
+    if (orientation & MATRIX_TRANSPOSE)
+    {
+      transpose8x8(src, rows);
+    }
+    else
+    {
+      memcpy(rows, src, 8);
+    }
+    for (uint8_t r = 0; r < 8; r++)
+    {
+      uint8_t x = rows[(orientation & MATRIX_REVERSE_ROWS) ? 7 - r : r];
+      if (orientation & MATRIX_REVERSE_BITS)
+      {
+        x = reverseByte(x);
+      }
+      Driver::setRow(dev, r, x);
+    }
+  }
+
   void setNumString(uint8_t offset, uint8_t num,
                     uint8_t width = 6, uint8_t space = 1,
-                    uint8_t *_data = NULL, uint8_t _data_count = 0)
+                    uint8_t *_data = NULL, uint16_t _data_count = 0)
   {
     setChar(offset, num / 10, width, _data, _data_count);
     setChar(offset + width + space, num % 10, width, _data, _data_count);
   }
 
-  void setDayOfWeakString(uint8_t offset, DateTime date, uint8_t *_data = NULL, uint8_t _data_count = 0)
+  // символ строки текущего языкового пакета
+  uint8_t getLangGlyph(uint8_t index)
+  {
+    return (pgm_read_byte(&lang_packs[lang * LANG_PACK_SIZE + index]));
+  }
+
+  void setDayOfWeakString(uint8_t offset, DateTime date, uint8_t *_data = NULL, uint16_t _data_count = 0)
   {
     uint8_t dow = getDayOfWeek(date.day(), date.month(), date.year());
     for (uint8_t j = 0; j < 3; j++)
     {
       setChar(offset + j * 7,
-              pgm_read_byte(&day_of_week[dow * 3 + j]), 5, _data, _data_count);
+              getLangGlyph(LANG_DAY_OF_WEEK + dow * 3 + j), 5, _data, _data_count);
     }
   }
 
-  void setTempString(uint8_t offset, int16_t temp, uint8_t *_data = NULL, uint8_t _data_count = 0)
+  void setTempString(uint8_t offset, int16_t temp, uint8_t *_data = NULL, uint16_t _data_count = 0)
   {
     // если температура выходит за диапазон, сформировать строку минусов
     if (temp > 99 || temp < -99)
     {
       for (uint8_t i = 0; i < 4; i++)
       {
-        setChar(offset + 2 + i * 7, 0x2D, 5, _data, _data_count);
+        setChar(offset + 2 + i * 7, GLYPH_MINUS, 5, _data, _data_count);
       }
     }
     else
@@ -293,12 +443,12 @@ private:
       // сформировать впереди плюс или минус
       if (temp != 0)
       {
-        (plus) ? setChar(plus_pos, 0x2B, 5, _data, _data_count)
-               : setChar(plus_pos, 0x2D, 5, _data, _data_count);
+        (plus) ? setChar(plus_pos, GLYPH_PLUS, 5, _data, _data_count)
+               : setChar(plus_pos, GLYPH_MINUS, 5, _data, _data_count);
       }
       // сформировать в конце знак градуса Цельсия
-      setChar(offset + 20, 0xB0, 5, _data, _data_count);
-      setChar(offset + 25, 0x43, 5, _data, _data_count);
+      setChar(offset + 20, GLYPH_DEGREE, 5, _data, _data_count);
+      setChar(offset + 25, GLYPH_C, 5, _data, _data_count);
     }
   }
 
@@ -307,15 +457,13 @@ private:
   {
     static const uint8_t PROGMEM offset[] = {1, 48, 82, 167};
 
-    return ((index < 9) ? pgm_read_byte(&offset[index]) : 0);
+    // строка сдвигается на смещение области 32х8, чтобы первый и последний кадры бегущей строки совпадали с экраном времени
+    return (((index < sizeof(offset)) ? pgm_read_byte(&offset[index]) : 0) + LAYOUT_OFFSET);
   }
 
-  void getDateString(uint8_t *_data, uint8_t _data_count, DateTime date)
+  void getDateString(uint8_t *_data, uint16_t _data_count, DateTime date)
   {
-    for (uint8_t i = 0; i < _data_count; i++)
-    {
-      _data[i] = 0x00;
-    }
+    memset(_data, 0x00, _data_count);
 
     uint8_t offset = getOffset(0);
     // формирование строки времени
@@ -344,8 +492,47 @@ private:
   }
 #endif
 
+  // вывод числа слоя часов (digit = 0) или минут (digit = 2); при включенной анимации изменившиеся цифры анимируются
+  void setNumLayer(uint8_t digit, int8_t num, uint8_t last)
+  {
+    uint8_t offset = (digit == 0) ? 0 : 16;
+    clearColumns(LAYOUT_OFFSET + offset, 15);
+#ifdef USE_DIGIT_ANIMATION
+    animator.cancel(digit);
+    animator.cancel(digit + 1);
+    if (num >= 0 && last < 100)
+    {
+      // пока выводится старое число, новые цифры появятся в ходе анимации
+      setNumString(offset + 1, last, 6, 1);
+      if (last / 10 != num / 10)
+      {
+        animator.start(digit, last / 10, num / 10);
+      }
+      if (last % 10 != num % 10)
+      {
+        animator.start(digit + 1, last % 10, num % 10);
+      }
+      return;
+    }
+#else
+    (void)last;
+#endif
+    if (num >= 0)
+    {
+      setNumString(offset + 1, num, 6, 1);
+    }
+  }
+
+  void invalidateLayers()
+  {
+    layers.invalidate();
+#ifdef USE_DIGIT_ANIMATION
+    animator.stop();
+#endif
+  }
+
   void setChar(uint8_t offset, uint8_t chr,
-               uint8_t width = 6, uint8_t *_arr = NULL, uint8_t _arr_length = 0)
+               uint8_t width = 6, uint8_t *_arr = NULL, uint16_t _arr_length = 0)
   {
     for (uint8_t j = offset, i = 0; i < width; j++, i++)
     {
@@ -371,16 +558,27 @@ private:
       }
       else
       {
-        if (j < 32)
-        {
-          shMAX72xxMini<cs_pin, 4>::setColumn(j / 8, j % 8, chr_data);
-        }
+        writeColumn(LAYOUT_OFFSET + j, chr_data);
       }
     }
   }
 
+#ifdef USE_STOPWATCH
+  void setSmallDigit(uint8_t offset, uint8_t num)
+  {
+    for (uint8_t i = 0; i < 3; i++)
+    {
+      writeColumn(LAYOUT_OFFSET + offset + i, pgm_read_byte(&font_digit_3x5[num * 3 + i]));
+    }
+  }
+#endif
+
 public:
-  DisplayMAX72xxMatrix() : shMAX72xxMini<cs_pin, 4>() { clear(); }
+  DisplayMAX72xxMatrix() : Driver()
+  {
+    setDirty();
+    clear();
+  }
 
   /**
    * @brief очистка экрана
@@ -389,18 +587,58 @@ public:
    */
   void clear(bool upd = false)
   {
-    shMAX72xxMini<cs_pin, 4>::clearAllDevices(upd);
+    invalidateLayers();
+    clearFrame();
+    if (upd)
+    {
+      show();
+    }
+  }
+
+  /**
+   * @brief запись столбца в буфер экрана
+   *
+   * @param col индекс столбца области 32х8 (0..31)
+   * @param data данные столбца
+   */
+  void setColumn(uint8_t col, uint8_t data)
+  {
+    invalidateLayers();
+    writeColumn(LAYOUT_OFFSET + col, data);
+  }
+
+  /**
+   * @brief установка поворота изображения
+   *
+   * @param dir поворот, 0..3 - на 0, 90, 180 и 270 градусов
+   */
+  void setDirection(uint8_t dir)
+  {
+    direction = dir & 0x03;
+    updateOrientation();
+  }
+
+  /**
+   * @brief включение отражения изображения по горизонтали
+   *
+   * @param _flip true - отражение включено
+   */
+  void setFlip(bool _flip)
+  {
+    flip = _flip;
+    updateOrientation();
   }
 
   /**
    * @brief запись символа в буфера экрана
    *
    * @param offset индекс столбца, с которого начинается отрисовка символа (0..31)
-   * @param chr символ для записи
+   * @param chr символ для записи; для шрифта 5х7 - номер символа в сжатом шрифте (GLYPH_* или символ языкового пакета, см. lang_packs.h)
    * @param width ширина символа, может иметь значение 5 или 6, определяет, какой набор символов будет использован: 5х7 (для текста) или 6х8 (для вывода цифр)
    */
   void setDispData(uint8_t offset, uint8_t chr, uint8_t width = 6)
   {
+    invalidateLayers();
     setChar(offset, chr, width);
   }
 
@@ -411,19 +649,78 @@ public:
    */
   void setColon(bool toDot = false)
   {
-    (toDot) ? shMAX72xxMini<cs_pin, 4>::setColumn(1, 7, 0b00000001)
-            : shMAX72xxMini<cs_pin, 4>::setColumn(1, 7, 0b00100100);
+    invalidateLayers();
+    writeColumn(LAYOUT_OFFSET + 15, (toDot) ? 0b00000001 : 0b00100100);
   }
 
   /**
    * @brief отрисовка на экране содержимого его буфера
    *
+   * @return true, если данные были переданы на экран; если изображение не изменилось, передача не выполняется
    */
-  void show()
+  bool show()
   {
-    shMAX72xxMini<cs_pin, 4>::update();
+    uint8_t flag = 0;
+    for (uint8_t i = 0; i < sizeof(dirty); i++)
+    {
+      flag |= dirty[i];
+    }
+    if (!flag)
+    {
+      return (false);
+    }
+    for (uint8_t i = 0; i < DEVICES; i++)
+    {
+      if (dirty[i >> 3] & (1 << (i & 0x07)))
+      {
+        renderDevice(i);
+      }
+    }
+    memset(dirty, 0x00, sizeof(dirty));
+    Driver::update();
+    return (true);
+  }
+
+#ifdef USE_DIGIT_ANIMATION
+  /**
+   * @brief формирование очередного кадра анимации смены цифр; вызывается задачей вывода на экран перед show()
+   *
+   * @return true, если кадр сформирован
+   */
+  bool animate()
+  {
+    if (!animator.isActive())
+    {
+      return (false);
+    }
+    uint32_t t = micros();
+    bool snapped = false;
+    animator.next();
+    for (uint8_t d = 0; d < 4; d++)
+    {
+      if (animator.isDigitActive(d))
+      {
+        // если бюджет кадра исчерпан, оставшиеся цифры выводятся в конечном виде
+        snapped = snapped || (micros() - t > ANIMATION_FRAME_BUDGET);
+        uint8_t offset = LAYOUT_OFFSET + animator.getDigitOffset(d);
+        for (uint8_t i = 0; i < ANIMATION_DIGIT_WIDTH; i++)
+        {
+          writeColumn(offset + i, (snapped) ? animator.getToColumn(d, i) : animator.getColumn(d, i));
+        }
+      }
+    }
+    animator.finish(micros() - t, snapped);
+    return (true);
   }
 
+  /**
+   * @brief вывод статистики времени формирования кадров анимации
+   *
+   * @param out поток для вывода, например, Serial
+   */
+  void printAnimationReport(Print &out) { animator.printReport(out); }
+#endif
+
   /**
    * @brief вывод на экран  времени; если задать какое-то из значений hour или minute отрицательным, эта часть экрана будет очищена - можно организовать мигание, например, в процессе настройки времени
    *
@@ -435,38 +732,47 @@ public:
    */
   void showTime(int8_t hour, int8_t minute, uint8_t second, bool show_colon, bool date = false)
   {
-    clear();
-    if (hour >= 0)
+    // перерисовываются только слои, данные которых изменились; если на экран выводилось что-то другое, экран очищается полностью
+    if (!layers.isActive())
     {
-      setNumString(1, hour, 6, 1);
+      clearFrame();
     }
-    if (minute >= 0)
+    if (layers.update(LAYER_HOURS, hour))
     {
-      setNumString(17, minute, 6, 1);
+      setNumLayer(0, hour, layers.getLastKey());
     }
-    if (show_colon)
+    if (layers.update(LAYER_MINUTES, minute))
+    {
+      setNumLayer(2, minute, layers.getLastKey());
+    }
+    if (layers.update(LAYER_COLON, show_colon | (date << 1)))
     {
-      setColon(date);
+      writeColumn(LAYOUT_OFFSET + 15, (!show_colon) ? 0x00 : (date) ? 0b00000001 : 0b00100100);
     }
 
 #ifdef SHOW_SECOND_COLUMN
-    // формирование секундного столбца
-    uint8_t col_sec = 0;
     uint8_t x = second / 5;
-    for (uint8_t i = 0; i < x; i++)
+    if (layers.update(LAYER_SECONDS, x))
     {
-      if (i < 6)
-      { // нарастание снизу вверх
-        col_sec += 1;
-        col_sec = col_sec << 1;
-      }
-      else
-      { // убывание снизу вверх
-        col_sec = col_sec << 1;
-        col_sec &= ~(1 << 7);
+      // формирование секундного столбца
+      uint8_t col_sec = 0;
+      for (uint8_t i = 0; i < x; i++)
+      {
+        if (i < 6)
+        { // нарастание снизу вверх
+          col_sec += 1;
+          col_sec = col_sec << 1;
+        }
+        else
+        { // убывание снизу вверх
+          col_sec = col_sec << 1;
+          col_sec &= ~(1 << 7);
+        }
       }
+      writeColumn(col_count - 1, col_sec); // секундный столбец - по правому краю экрана
     }
-    setColumn(31, col_sec);
+#else
+    (void)second;
 #endif
   }
 
@@ -490,29 +796,28 @@ public:
    */
   bool showDate(DateTime date, bool upd = false)
   {
-    static uint8_t n = 0;
+    static uint16_t n = 0;
     bool result = false;
 
     if (upd)
     {
 #ifdef USE_TICKER_FOR_DATE
-      n = 32;
+      n = col_count;
 #else
       n = 0;
 #endif
       return (result);
     }
-    shMAX72xxMini<cs_pin, 4>::clearAllDevices();
+    clear();
 
 // бегущая строка
 #ifdef USE_TICKER_FOR_DATE
-    uint8_t str_len = 200;
-    uint8_t date_str[str_len];
-    getDateString(date_str, str_len, date);
+    uint8_t date_str[TICKER_LENGTH];
+    getDateString(date_str, TICKER_LENGTH, date);
 
-    for (uint8_t i = 32, j = n; i > 0 && j > 0; i--, j--)
+    for (uint16_t i = col_count, j = n; i > 0 && j > 0; i--, j--)
     {
-      shMAX72xxMini<cs_pin, 4>::setColumn((i - 1) / 8, (i - 1) % 8, date_str[j - 1]);
+      writeColumn(i - 1, date_str[j - 1]);
     }
 // последовательный вывод - день недели, число и месяц, год
 #else
@@ -533,10 +838,10 @@ public:
     }
 #endif
 
-    shMAX72xxMini<cs_pin, 4>::update();
+    show();
 
 #ifdef USE_TICKER_FOR_DATE
-    result = (n++ >= str_len - 2);
+    result = (n++ >= TICKER_LENGTH - 2);
 #else
     result = (n++ >= 3);
 #endif
@@ -544,6 +849,56 @@ public:
     return (result);
   }
 
+  /**
+   * @brief установка языка вывода
+   *
+   * @param _lang номер языкового пакета, 0..LANG_COUNT-1; другие значения игнорируются
+   */
+  void setLanguage(uint8_t _lang)
+  {
+    if (_lang < LANG_COUNT && _lang != lang)
+    {
+      lang = _lang;
+      invalidateLayers();
+    }
+  }
+
+  /**
+   * @brief получение языка вывода
+   *
+   * @return uint8_t номер языкового пакета
+   */
+  uint8_t getLanguage() { return (lang); }
+
+  /**
+   * @brief вывод строки текущего языкового пакета шрифтом 5х7 с шагом 6 столбцов
+   *
+   * @param offset индекс столбца, с которого начинается строка
+   * @param index смещение строки в пакете (LANG_*)
+   * @param count количество символов
+   */
+  void setLangText(uint8_t offset, uint8_t index, uint8_t count = 3)
+  {
+    for (uint8_t i = 0; i < count; i++)
+    {
+      setDispData(offset + i * 6, getLangGlyph(index + i), 5);
+    }
+  }
+
+  /**
+   * @brief вывод на экран данных по настройке языка - названия текущего языка
+   *
+   * @param blink используется для мигания изменяемого значения
+   */
+  void showLanguageData(bool blink)
+  {
+    clear();
+    if (!blink)
+    {
+      setLangText(7, LANG_NAME);
+    }
+  }
+
   /**
    * @brief вывод на экран данных по настройке яркости экрана
    *
@@ -554,35 +909,53 @@ public:
    */
   void showBrightnessData(uint8_t br, bool blink, bool toSensor = false, bool toMin = false)
   {
-    shMAX72xxMini<cs_pin, 4>::clearAllDevices();
+    clear();
 
-#ifdef USE_RU_LANGUAGE
-    setChar(0, 0xDF, 5); // Я
-    setChar(6, 0xF0, 5); // р
-    uint8_t x = 0xEA;       // к
-    if (toSensor)
+    setChar(0, getLangGlyph(LANG_BRIGHTNESS), 5);
+    setChar(6, getLangGlyph(LANG_BRIGHTNESS + 1), 5);
+    // с датчиком света на месте третьего символа выводится номер настраиваемого уровня
+    setChar(12, (toSensor) ? GLYPH_0 + ((toMin) ? 0 : 1) : getLangGlyph(LANG_BRIGHTNESS + 2), 5);
+    writeColumn(LAYOUT_OFFSET + 18, 0b00100100);
+    if (!blink)
     {
-      x = (toMin) ? 0 : 1;
-      x += 0x30;
+      setChar(20, br / 10 + GLYPH_0, 5);
+      setChar(26, br % 10 + GLYPH_0, 5);
     }
-    setChar(12, x, 5);
-#else
-    setChar(0, 0x42, 5); // B
-    setChar(6, 0x72, 5); // r
-    if (toSensor)
+  }
+
+#ifdef USE_STOPWATCH
+  /**
+   * @brief вывод на экран времени секундомера или таймера; до 10 минут выводится м:сс и сотые доли секунды, с 10 минут - мм:сс и десятые доли секунды
+   *
+   * @param time время, сотых долей секунды
+   * @param show_colon отображать или нет двоеточие
+   */
+  void showTimerData(uint32_t time, bool show_colon)
+  {
+    clear();
+    uint8_t minute = time / 6000;
+    uint8_t second = time / 100 % 60;
+    uint8_t hundredth = time % 100;
+    // при выводе десятков минут изображение сдвигается на столбец вправо, а сотые доли не выводятся
+    uint8_t x = (minute < 10) ? 0 : 1;
+    if (x)
     {
-      uint8_t x = (toMin) ? 0 : 1;
-      x += 0x30;
-      setChar(12, x, 5);
+      setChar(0, GLYPH_0 + minute / 10, 5);
     }
-#endif
-    shMAX72xxMini<cs_pin, 4>::setColumn(2, 2, 0b00100100);
-    if (!blink)
+    setChar(5 + x, GLYPH_0 + minute % 10, 5);
+    if (show_colon)
+    {
+      writeColumn(LAYOUT_OFFSET + 11 + x, 0b00100100);
+    }
+    setChar(13 + x, GLYPH_0 + second / 10, 5);
+    setChar(19 + x, GLYPH_0 + second % 10, 5);
+    setSmallDigit(25 + x, hundredth / 10);
+    if (!x)
     {
-      setChar(20, br / 10 + 0x30, 5);
-      setChar(26, br % 10 + 0x30, 5);
+      setSmallDigit(29, hundredth % 10);
     }
   }
+#endif
 
   /**
    * @brief установка яркости экрана
@@ -592,9 +965,9 @@ public:
   void setBrightness(uint8_t brightness)
   {
     brightness = (brightness <= 15) ? brightness : 15;
-    for (uint8_t i = 0; i < 4; i++)
+    for (uint8_t i = 0; i < DEVICES; i++)
     {
-      shMAX72xxMini<cs_pin, 4>::setBrightness(i, brightness);
+      Driver::setBrightness(i, brightness);
     }
   }
 };
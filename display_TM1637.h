@@ -66,8 +66,9 @@ public:
   /**
    * @brief отрисовка на экране содержимого его буфера
    *
+   * @return true, если данные были переданы на экран
    */
-  void show()
+  bool show()
   {
     bool flag = false;
     static uint8_t _data[4] = {0x00, 0x00, 0x00, 0x00};
@@ -94,6 +95,7 @@ public:
       br = _brightness;
       TM1637Display::setSegments(data);
     }
+    return (flag);
   }
 
   /**
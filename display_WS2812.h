@@ -5,12 +5,21 @@
 #include <FastLED.h> // https://github.com/FastLED/FastLED
 #include <DS3231.h>  // https://github.com/NorthernWidget/DS3231
 #include "setting_for_WS2812.h"
+#include "hal.h"
+#ifdef USE_DIGIT_ANIMATION
+#include "digit_animation.h"
+#endif
 
 // ===================================================
 
-#define __ESPICHIPSET__ defined CHIPSET_LPD6803 || defined CHIPSET_LPD8806 || defined CHIPSET_WS2801 || defined CHIPSET_WS2803 || defined CHIPSET_SM16716 || defined CHIPSET_P9813 || defined CHIPSET_APA102 || defined CHIPSET_SK9822 || defined CHIPSET_DOTSTAR
+// defined в теле макроса не переносим между компиляторами, поэтому условие вычисляется здесь
+#if defined CHIPSET_LPD6803 || defined CHIPSET_LPD8806 || defined CHIPSET_WS2801 || defined CHIPSET_WS2803 || defined CHIPSET_SM16716 || defined CHIPSET_P9813 || defined CHIPSET_APA102 || defined CHIPSET_SK9822 || defined CHIPSET_DOTSTAR
+#define __ESPICHIPSET__ 1
+#else
+#define __ESPICHIPSET__ 0
+#endif
 
-// ==== класс для матрицы 8х32 адресных светодиодов ==
+// ==== класс для матрицы адресных светодиодов ======
 
 /**
  * @brief тип матрицы по расположению светодиодов
@@ -34,25 +43,76 @@ enum MatrixType : uint8_t
   BY_LINE
 };
 
+// элементы экрана, выводимые своим цветом; цвета задаются в setting_for_WS2812.h
+enum ColorSlot : uint8_t
+{
+  SLOT_DIGITS,        // цифры времени
+  SLOT_COLON,         // двоеточие
+  SLOT_SECONDS,       // секундный столбец
+  SLOT_TEXT,          // дата, экраны настроек и прочий текст
+  SLOT_TEMP,          // температура выше нуля
+  SLOT_TEMP_NEGATIVE, // температура ниже нуля
+  SLOT_TIMER          // секундомер и таймер
+};
+
+/**
+ * @brief матрица адресных светодиодов, соединенных змейкой по столбцам или по строкам; панель из нескольких матриц должна быть соединена так же, как одна матрица того же размера
+ *
+ * @tparam col_count ширина экрана в пикселях, кратна 8, не меньше 32
+ * @tparam row_count высота экрана в пикселях, кратна 8
+ */
+template <uint8_t col_count = 32, uint8_t row_count = 8>
 class DisplayWS2812Matrix
 {
 private:
+  static_assert(col_count >= 32 && col_count <= 128 && col_count % 8 == 0, "matrix width must be a multiple of 8 in the range 32..128");
+  static_assert(row_count >= 8 && row_count <= 32 && row_count % 8 == 0, "matrix height must be a multiple of 8 in the range 8..32");
+#if defined(USE_TICKER_FOR_DATE) && defined(USE_SMOOTH_TICKER)
+  static_assert((((uint32_t)TICKER_SPEED << 8) / TICKER_SMOOTH_FPS) & 0xFF, "smooth ticker step must have a fractional part: TICKER_SPEED must not be a multiple of TICKER_SMOOTH_FPS");
+#endif
+
+  static const uint8_t LAYOUT_OFFSET = (col_count - 32) / 2; // смещение области 32х8, в которой строится изображение, от левого края экрана
+  static const uint8_t TEXT_ROW = (row_count - 8) / 2;       // верхняя строка области 32х8
+  static const uint16_t TICKER_LENGTH = 168 + col_count;     // длина строки бегущей строки, столбцов
+
   CRGB *leds = NULL;
   MatrixType matrix_type = BY_COLUMNS;
-  uint8_t row_count = 8;
-  uint8_t col_count = 32;
-  CRGB color = CRGB::Red;
+  uint8_t ink = SLOT_TEXT; // элемент экрана, цветом которого выводятся символы и столбцы
+  bool alarm_on = false;
+  MatrixLayers layers;
+  uint8_t lang = LANG_DEFAULT; // язык вывода, номер языкового пакета
+#if defined(USE_TICKER_FOR_DATE) && defined(USE_TASK_PROFILER)
+  uint32_t ticker_render = 0; // суммарное время формирования кадров бегущей строки, мкс
+  uint32_t ticker_show = 0;   // суммарное время передачи кадров бегущей строки на экран, мкс
+  uint16_t ticker_frames = 0; // количество кадров бегущей строки
+#endif
+#ifdef USE_DIGIT_ANIMATION
+  DigitAnimator animator;
+#endif
+  bool changed = true; // буфер изменился после последней передачи на экран
+  uint32_t next_show = 0;            // момент, раньше которого следующая передача превысит WS2812_BLACKOUT_BUDGET, мс
+  uint32_t show_time = 0;            // время последней передачи данных на матрицу, мкс
+  volatile bool hold_request = false; // был фронт на пине кнопки
+  volatile uint16_t hold_timer = 0;   // момент последнего фронта на пине кнопки, мс
+  bool holding = false;              // передача задерживается из-за нажатия кнопки
+  uint16_t hold_start = 0;           // момент, с которого передача задерживается, мс
+#ifdef USE_TASK_PROFILER
+  uint32_t blackout = 0;       // суммарное время передачи данных на матрицу, мкс
+  uint16_t transfers = 0;      // количество передач
+  uint16_t coalesced = 0;      // количество вызовов show(), отложенных до следующего
+  uint32_t blackout_timer = 0; // начало периода сбора статистики, мс
+#endif
 
-  uint8_t getLedIndexOfStrip(uint8_t row, uint8_t col)
+  uint16_t getLedIndexOfStrip(uint8_t row, uint8_t col)
   {
-    uint8_t result = 0;
+    uint16_t result = 0;
     switch (matrix_type)
     {
     case BY_COLUMNS:
-      result = col * row_count + (((col >> 0) & 0x01) ? row_count - row - 1 : row);
+      result = (uint16_t)col * row_count + (((col >> 0) & 0x01) ? row_count - row - 1 : row);
       break;
     case BY_LINE:
-      result = row * col_count + (((row >> 0) & 0x01) ? col_count - col - 1 : col);
+      result = (uint16_t)row * col_count + (((row >> 0) & 0x01) ? col_count - col - 1 : col);
       break;
     }
     return (result);
@@ -60,30 +120,36 @@ private:
 
   void setNumString(uint8_t offset, uint8_t num,
                     uint8_t width = 6, uint8_t space = 1,
-                    uint8_t *_data = NULL, uint8_t _data_count = 0)
+                    uint8_t *_data = NULL, uint16_t _data_count = 0)
   {
     setChar(offset, num / 10, width, _data, _data_count);
     setChar(offset + width + space, num % 10, width, _data, _data_count);
   }
 
-  void setDayOfWeakString(uint8_t offset, DateTime date, uint8_t *_data = NULL, uint8_t _data_count = 0)
+  // символ строки текущего языкового пакета
+  uint8_t getLangGlyph(uint8_t index)
+  {
+    return (pgm_read_byte(&lang_packs[lang * LANG_PACK_SIZE + index]));
+  }
+
+  void setDayOfWeakString(uint8_t offset, DateTime date, uint8_t *_data = NULL, uint16_t _data_count = 0)
   {
     uint8_t dow = getDayOfWeek(date.day(), date.month(), date.year());
     for (uint8_t j = 0; j < 3; j++)
     {
       setChar(offset + j * 7,
-              pgm_read_byte(&day_of_week[dow * 3 + j]), 5, _data, _data_count);
+              getLangGlyph(LANG_DAY_OF_WEEK + dow * 3 + j), 5, _data, _data_count);
     }
   }
 
-  void setTempString(uint8_t offset, int16_t temp, uint8_t *_data = NULL, uint8_t _data_count = 0)
+  void setTempString(uint8_t offset, int16_t temp, uint8_t *_data = NULL, uint16_t _data_count = 0)
   {
     // если температура выходит за диапазон, сформировать строку минусов
     if (temp > 99 || temp < -99)
     {
       for (uint8_t i = 0; i < 4; i++)
       {
-        setChar(offset + 2 + i * 7, 0x2D, 5, _data, _data_count);
+        setChar(offset + 2 + i * 7, GLYPH_MINUS, 5, _data, _data_count);
       }
     }
     else
@@ -104,12 +170,12 @@ private:
       // сформировать впереди плюс или минус
       if (temp != 0)
       {
-        (plus) ? setChar(plus_pos, 0x2B, 5, _data, _data_count)
-               : setChar(plus_pos, 0x2D, 5, _data, _data_count);
+        (plus) ? setChar(plus_pos, GLYPH_PLUS, 5, _data, _data_count)
+               : setChar(plus_pos, GLYPH_MINUS, 5, _data, _data_count);
       }
       // сформировать в конце знак градуса Цельсия
-      setChar(offset + 20, 0xB0, 5, _data, _data_count);
-      setChar(offset + 25, 0x43, 5, _data, _data_count);
+      setChar(offset + 20, GLYPH_DEGREE, 5, _data, _data_count);
+      setChar(offset + 25, GLYPH_C, 5, _data, _data_count);
     }
   }
 
@@ -118,15 +184,13 @@ private:
   {
     static const uint8_t PROGMEM offset[] = {1, 48, 82, 167};
 
-    return ((index < 9) ? pgm_read_byte(&offset[index]) : 0);
+    // строка сдвигается на смещение области 32х8, чтобы первый и последний кадры бегущей строки совпадали с экраном времени
+    return (((index < sizeof(offset)) ? pgm_read_byte(&offset[index]) : 0) + LAYOUT_OFFSET);
   }
 
-  void getDateString(uint8_t *_data, uint8_t _data_count, DateTime date)
+  void getDateString(uint8_t *_data, uint16_t _data_count, DateTime date)
   {
-    for (uint8_t i = 0; i < _data_count; i++)
-    {
-      _data[i] = 0x00;
-    }
+    memset(_data, 0x00, _data_count);
 
     uint8_t offset = getOffset(0);
     // формирование строки времени
@@ -155,8 +219,149 @@ private:
   }
 #endif
 
+  // цвет текущего элемента экрана; цвета не хранятся в RAM, а берутся из настроек
+  CRGB getInkColor()
+  {
+    switch (ink)
+    {
+    case SLOT_DIGITS:
+      return ((alarm_on) ? CRGB(COLOR_TIME_ALARM) : CRGB(COLOR_TIME));
+    case SLOT_COLON:
+      return (CRGB(COLOR_COLON));
+    case SLOT_SECONDS:
+      return (CRGB(COLOR_SECONDS));
+    case SLOT_TEMP:
+      return (CRGB(COLOR_TEMP));
+    case SLOT_TEMP_NEGATIVE:
+      return (CRGB(COLOR_TEMP_NEGATIVE));
+    case SLOT_TIMER:
+      return (CRGB(COLOR_TIMER));
+    default:
+      return (CRGB(COLOR_TEXT));
+    }
+  }
+
+  // проверка, можно ли передать кадр сейчас: не исчерпан ли бюджет времени передачи и не идет ли дребезг контактов кнопки; кадр, который нельзя передать, остается в буфере и передается при следующем вызове show() вместе со всеми изменениями
+  bool isTransferAllowed()
+  {
+    if ((int32_t)(millis() - next_show) < 0)
+    {
+      return (false);
+    }
+    uint16_t now = millis();
+    uint8_t state = halDisableInterrupts();
+    bool hold = hold_request && (uint16_t)(now - hold_timer) < WS2812_HOLD_TIME;
+    if (!hold)
+    {
+      hold_request = false;
+    }
+    halRestoreInterrupts(state);
+    if (!hold)
+    {
+      holding = false;
+      return (true);
+    }
+    if (!holding)
+    {
+      holding = true;
+      hold_start = now;
+    }
+    return ((uint16_t)(now - hold_start) >= WS2812_HOLD_LIMIT);
+  }
+
+  // запись столбца области 32х8 цветом текущего элемента экрана; старший бит - верхняя строка
+  void writeColumn(uint8_t col, uint8_t _data)
+  {
+    if (col < col_count)
+    {
+      CRGB color = getInkColor();
+      for (uint8_t i = 0; i < 8; i++)
+      {
+        leds[getLedIndexOfStrip(TEXT_ROW + i, col)] =
+            (((_data) >> (7 - i)) & 0x01) ? color : CRGB::Black;
+      }
+      changed = true;
+    }
+  }
+
+#if (defined(USE_DIGIT_ANIMATION) && DIGIT_ANIMATION == ANIMATION_FADE) || (defined(USE_TICKER_FOR_DATE) && defined(USE_SMOOTH_TICKER))
+  // запись столбца, смешанного из двух: пиксели первого столбца выводятся с яркостью 255 - scale, второго - с яркостью scale; используется для плавной смены символов и плавной бегущей строки
+  void writeBlendColumn(uint8_t col, uint8_t from, uint8_t to, uint8_t scale)
+  {
+    if (col < col_count)
+    {
+      CRGB color = getInkColor();
+      for (uint8_t i = 0; i < 8; i++)
+      {
+        uint8_t mask = 0x80 >> i;
+        CRGB c = color;
+        c.nscale8_video(qadd8((from & mask) ? 255 - scale : 0, (to & mask) ? scale : 0));
+        leds[getLedIndexOfStrip(TEXT_ROW + i, col)] = c;
+      }
+      changed = true;
+    }
+  }
+#endif
+
+  void clearFrame()
+  {
+    for (uint16_t i = 0; i < (uint16_t)col_count * row_count; i++)
+    {
+      leds[i] = CRGB::Black;
+    }
+    changed = true;
+  }
+
+  void clearColumns(uint8_t col, uint8_t count)
+  {
+    for (uint8_t i = 0; i < count; i++)
+    {
+      writeColumn(col + i, 0x00);
+    }
+  }
+
+  // вывод числа слоя часов (digit = 0) или минут (digit = 2); при включенной анимации изменившиеся цифры анимируются
+  void setNumLayer(uint8_t digit, int8_t num, uint8_t last)
+  {
+    ink = SLOT_DIGITS;
+    uint8_t offset = (digit == 0) ? 0 : 16;
+    clearColumns(LAYOUT_OFFSET + offset, 15);
+#ifdef USE_DIGIT_ANIMATION
+    animator.cancel(digit);
+    animator.cancel(digit + 1);
+    if (num >= 0 && last < 100)
+    {
+      // пока выводится старое число, новые цифры появятся в ходе анимации
+      setNumString(offset + 1, last, 6, 1);
+      if (last / 10 != num / 10)
+      {
+        animator.start(digit, last / 10, num / 10);
+      }
+      if (last % 10 != num % 10)
+      {
+        animator.start(digit + 1, last % 10, num % 10);
+      }
+      return;
+    }
+#else
+    (void)last;
+#endif
+    if (num >= 0)
+    {
+      setNumString(offset + 1, num, 6, 1);
+    }
+  }
+
+  void invalidateLayers()
+  {
+    layers.invalidate();
+#ifdef USE_DIGIT_ANIMATION
+    animator.stop();
+#endif
+  }
+
   void setChar(uint8_t offset, uint8_t chr,
-               uint8_t width = 6, uint8_t *_arr = NULL, uint8_t _arr_length = 0)
+               uint8_t width = 6, uint8_t *_arr = NULL, uint16_t _arr_length = 0)
   {
     for (uint8_t j = offset, i = 0; i < width; j++, i++)
     {
@@ -182,26 +387,31 @@ private:
       }
       else
       {
-        if (j < 32)
-        {
-          setColumn(j, chr_data);
-        }
+        writeColumn(LAYOUT_OFFSET + j, chr_data);
       }
     }
   }
 
+#ifdef USE_STOPWATCH
+  void setSmallDigit(uint8_t offset, uint8_t num)
+  {
+    for (uint8_t i = 0; i < 3; i++)
+    {
+      writeColumn(LAYOUT_OFFSET + offset + i, pgm_read_byte(&font_digit_3x5[num * 3 + i]));
+    }
+  }
+#endif
+
 public:
   /**
    * @brief конструктор
    *
-   * @param _leds массив светодиодов
-   * @param _color цвет
+   * @param _leds массив светодиодов, используется библиотекой FastLED для передачи данных
    * @param _type тип матрицы, собрана по столбцам или построчно
    */
-  DisplayWS2812Matrix(CRGB *_leds, CRGB _color, MatrixType _type)
+  DisplayWS2812Matrix(CRGB *_leds, MatrixType _type)
   {
     leds = _leds;
-    color = _color;
     matrix_type = _type;
     clear(true);
   }
@@ -209,19 +419,14 @@ public:
   /**
    * @brief запись столбца в буфер экрана
    *
-   * @param col столбец
+   * @param col индекс столбца области 32х8 (0..31)
    * @param _data байт для записи
    */
   void setColumn(uint8_t col, uint8_t _data)
   {
-    if (col < 32)
-    {
-      for (uint8_t i = 0; i < 8; i++)
-      {
-        leds[getLedIndexOfStrip(i, col)] =
-            (((_data) >> (7 - i)) & 0x01) ? color : CRGB::Black;
-      }
-    }
+    invalidateLayers();
+    ink = SLOT_TEXT;
+    writeColumn(LAYOUT_OFFSET + col, _data);
   }
 
   /**
@@ -231,13 +436,12 @@ public:
    */
   void clear(bool upd = false)
   {
-    for (uint8_t i = 0; i < 32; i++)
-    {
-      setColumn(i, 0x00);
-    }
+    invalidateLayers();
+    clearFrame();
+    ink = SLOT_TEXT;
     if (upd)
     {
-      FastLED.show();
+      show();
     }
   }
 
@@ -245,15 +449,14 @@ public:
    * @brief запись символа в буфера экрана
    *
    * @param offset индекс столбца, с которого начинается отрисовка символа (0..31)
-   * @param chr символ для записи
+   * @param chr символ для записи; для шрифта 5х7 - номер символа в сжатом шрифте (GLYPH_* или символ языкового пакета, см. lang_packs.h)
    * @param width ширина символа, может иметь значение 5 или 6, определяет, какой набор символов будет использован: 5х7 (для текста) или 6х8 (для вывода цифр)
    */
   void setDispData(uint8_t offset, uint8_t chr, uint8_t width = 6)
   {
-    if (offset < 32)
-    {
-      setChar(offset, chr, width);
-    }
+    invalidateLayers();
+    ink = SLOT_TEXT;
+    setChar(offset, chr, width);
   }
 
   /**
@@ -263,16 +466,164 @@ public:
    */
   void setColon(bool toDot = false)
   {
-    (toDot) ? setColumn(15, 0b00000001) : setColumn(15, 0b00100100);
+    invalidateLayers();
+    writeColumn(LAYOUT_OFFSET + 15, (toDot) ? 0b00000001 : 0b00100100);
   }
 
   /**
    * @brief отрисовка на экране содержимого его буфера
    *
+   * @return true, если данные были переданы на экран; если изображение не изменилось, передача не выполняется
    */
-  void show()
+  bool show()
   {
+    if (!changed)
+    {
+      return (false);
+    }
+    if (!isTransferAllowed())
+    {
+#ifdef USE_TASK_PROFILER
+      coalesced++;
+#endif
+      return (false);
+    }
+    // при запрещенных прерываниях micros() теряет переполнения, поэтому время передачи измеряется аппаратным таймером; счетчик millis() FastLED на AVR корректирует после передачи
+    HalStamp start = halStamp();
     FastLED.show();
+    uint32_t t = halElapsedMicros(start);
+    next_show = millis() + (t * (1000 - WS2812_BLACKOUT_BUDGET) / WS2812_BLACKOUT_BUDGET + 999) / 1000;
+    show_time = t;
+#ifdef USE_TASK_PROFILER
+    blackout += t;
+    transfers++;
+#endif
+    changed = false;
+    return (true);
+  }
+
+  /**
+   * @brief задержка передачи данных на матрицу на время дребезга контактов кнопки, чтобы не терять фронты при запрещенных прерываниях; вызывается из обработчика прерывания по изменению уровня на пинах кнопок
+   *
+   */
+  void holdShow()
+  {
+    hold_timer = millis();
+    hold_request = true;
+  }
+
+  /**
+   * @brief получение времени последней передачи данных на матрицу, т.е. времени, на которое были запрещены прерывания
+   *
+   * @return uint32_t время, мкс; 0, если передач еще не было
+   */
+  uint32_t getBlackoutTime() { return (show_time); }
+
+  /**
+   * @brief сброс ограничения частоты передач: следующий вызов show() передает кадр без ожидания; используется при измерении времени передачи (benchmark.h)
+   *
+   */
+  void resetShowLimit() { next_show = millis(); }
+#ifdef USE_TASK_PROFILER
+  /**
+   * @brief вывод статистики передачи данных на матрицу: время с запрещенными прерываниями в пересчете на секунду, количество передач и количество отложенных кадров; после вывода статистика сбрасывается
+   *
+   * @param out поток для вывода, например, Serial
+   */
+  void printShowReport(Print &out)
+  {
+    uint32_t period = millis() - blackout_timer;
+    out.print(F("ws2812 blackout, us/s: "));
+    out.println((period > 0) ? blackout * 1000 / period : 0);
+    out.print(F("ws2812 transfers: "));
+    out.println(transfers);
+    out.print(F("ws2812 coalesced: "));
+    out.println(coalesced);
+    blackout = 0;
+    transfers = 0;
+    coalesced = 0;
+    blackout_timer = millis();
+  }
+#endif
+
+  /**
+   * @brief установка яркости экрана; новая яркость передается на экран при следующем вызове show()
+   *
+   * @param brightness значение яркости (0..255)
+   */
+  void setBrightness(uint8_t brightness)
+  {
+    // задача регулировки яркости вызывает метод несколько раз в секунду, поэтому кадр передается заново только при изменении яркости
+    if (brightness != FastLED.getBrightness())
+    {
+      FastLED.setBrightness(brightness);
+      changed = true;
+    }
+  }
+
+#ifdef USE_DIGIT_ANIMATION
+  /**
+   * @brief формирование очередного кадра анимации смены цифр; вызывается задачей вывода на экран перед show()
+   *
+   * @return true, если кадр сформирован
+   */
+  bool animate()
+  {
+    if (!animator.isActive())
+    {
+      return (false);
+    }
+    uint32_t t = micros();
+    bool snapped = false;
+    animator.next();
+    ink = SLOT_DIGITS;
+    for (uint8_t d = 0; d < 4; d++)
+    {
+      if (animator.isDigitActive(d))
+      {
+        // если бюджет кадра исчерпан, оставшиеся цифры выводятся в конечном виде
+        snapped = snapped || (micros() - t > ANIMATION_FRAME_BUDGET);
+        uint8_t offset = LAYOUT_OFFSET + animator.getDigitOffset(d);
+        for (uint8_t i = 0; i < ANIMATION_DIGIT_WIDTH; i++)
+        {
+#if DIGIT_ANIMATION == ANIMATION_FADE
+          if (!snapped && animator.getStep() < ANIMATION_STEPS)
+          {
+            writeBlendColumn(offset + i, animator.getFromColumn(d, i), animator.getToColumn(d, i),
+                             animator.getStep() * 255 / ANIMATION_STEPS);
+            continue;
+          }
+#endif
+          writeColumn(offset + i, (snapped) ? animator.getToColumn(d, i) : animator.getColumn(d, i));
+        }
+      }
+    }
+    ink = SLOT_TEXT;
+    animator.finish(micros() - t, snapped);
+    return (true);
+  }
+
+  /**
+   * @brief вывод статистики времени формирования кадров анимации
+   *
+   * @param out поток для вывода, например, Serial
+   */
+  void printAnimationReport(Print &out) { animator.printReport(out); }
+#endif
+
+  /**
+   * @brief установка флага включенного будильника; при включенном будильнике цифры времени выводятся цветом COLOR_TIME_ALARM
+   *
+   * @param _alarm_on будильник включен
+   */
+  void setAlarmFlag(bool _alarm_on)
+  {
+    if (alarm_on != _alarm_on)
+    {
+      alarm_on = _alarm_on;
+      // цифры, уже выведенные прежним цветом, перерисовываются
+      invalidateLayers();
+    }
   }
 
   /**
@@ -286,39 +637,51 @@ public:
    */
   void showTime(int8_t hour, int8_t minute, uint8_t second, bool show_colon, bool date = false)
   {
-    clear();
-    if (hour >= 0)
+    // перерисовываются только слои, данные которых изменились; если на экран выводилось что-то другое, экран очищается полностью
+    if (!layers.isActive())
     {
-      setNumString(1, hour, 6, 1);
+      clearFrame();
     }
-    if (minute >= 0)
+    if (layers.update(LAYER_HOURS, hour))
     {
-      setNumString(17, minute, 6, 1);
+      setNumLayer(0, hour, layers.getLastKey());
     }
-    if (show_colon)
+    if (layers.update(LAYER_MINUTES, minute))
+    {
+      setNumLayer(2, minute, layers.getLastKey());
+    }
+    if (layers.update(LAYER_COLON, show_colon | (date << 1)))
     {
-      setColon(date);
+      ink = SLOT_COLON;
+      writeColumn(LAYOUT_OFFSET + 15, (!show_colon) ? 0x00 : (date) ? 0b00000001 : 0b00100100);
     }
 
 #ifdef SHOW_SECOND_COLUMN
-    // формирование секундного столбца
-    uint8_t col_sec = 0;
     uint8_t x = second / 5;
-    for (uint8_t i = 0; i < x; i++)
+    if (layers.update(LAYER_SECONDS, x))
     {
-      if (i < 6)
-      { // нарастание снизу вверх
-        col_sec += 1;
-        col_sec = col_sec << 1;
-      }
-      else
-      { // убывание снизу вверх
-        col_sec = col_sec << 1;
-        col_sec &= ~(1 << 7);
+      ink = SLOT_SECONDS;
+      // формирование секундного столбца
+      uint8_t col_sec = 0;
+      for (uint8_t i = 0; i < x; i++)
+      {
+        if (i < 6)
+        { // нарастание снизу вверх
+          col_sec += 1;
+          col_sec = col_sec << 1;
+        }
+        else
+        { // убывание снизу вверх
+          col_sec = col_sec << 1;
+          col_sec &= ~(1 << 7);
+        }
       }
+      writeColumn(col_count - 1, col_sec); // секундный столбец - по правому краю экрана
     }
-    setColumn(31, col_sec);
+#else
+    (void)second;
 #endif
+    ink = SLOT_TEXT;
   }
 
   /**
@@ -329,7 +692,9 @@ public:
   void showTemp(int temp)
   {
     clear();
+    ink = (temp < 0) ? SLOT_TEMP_NEGATIVE : SLOT_TEMP;
     setTempString(1, temp);
+    ink = SLOT_TEXT;
   }
 
   /**
@@ -341,13 +706,19 @@ public:
    */
   bool showDate(DateTime date, bool upd = false)
   {
-    static uint8_t n = 0;
+#if defined(USE_TICKER_FOR_DATE) && defined(USE_SMOOTH_TICKER)
+    static uint32_t n = 0; // положение строки в 1/256 столбца
+#else
+    static uint16_t n = 0;
+#endif
     bool result = false;
 
     if (upd)
     {
-#ifdef USE_TICKER_FOR_DATE
-      n = 32;
+#if defined(USE_TICKER_FOR_DATE) && defined(USE_SMOOTH_TICKER)
+      n = (uint32_t)col_count << 8;
+#elif defined(USE_TICKER_FOR_DATE)
+      n = col_count;
 #else
       n = 0;
 #endif
@@ -357,14 +728,35 @@ public:
 
 // бегущая строка
 #ifdef USE_TICKER_FOR_DATE
-    uint8_t str_len = 200;
-    uint8_t date_str[str_len];
-    getDateString(date_str, str_len, date);
+#ifdef USE_TASK_PROFILER
+    HalStamp t = halStamp();
+#endif
+    uint8_t date_str[TICKER_LENGTH];
+    getDateString(date_str, TICKER_LENGTH, date);
 
-    for (uint8_t i = 32, j = n; i > 0 && j > 0; i--, j--)
+#ifdef USE_SMOOTH_TICKER
+    // столбец экрана смешивается из двух соседних столбцов строки пропорционально дробной части положения строки
+    uint16_t j = n >> 8;
+    uint8_t f = n & 0xFF;
+    for (uint16_t i = col_count; i > 0 && j > 0; i--, j--)
     {
-      setColumn(i, date_str[j - 1]);
+      writeBlendColumn(i - 1, date_str[j - 1], (j < TICKER_LENGTH) ? date_str[j] : 0x00, f);
     }
+#else
+    for (uint16_t i = col_count, j = n; i > 0 && j > 0; i--, j--)
+    {
+      writeColumn(i - 1, date_str[j - 1]);
+    }
+#endif
+#ifdef USE_TASK_PROFILER
+    ticker_render += halElapsedMicros(t);
+    t = halStamp();
+    show();
+    ticker_show += halElapsedMicros(t);
+    ticker_frames++;
+#else
+    show();
+#endif
 // последовательный вывод - день недели, число и месяц, год
 #else
     switch (n)
@@ -382,18 +774,109 @@ public:
       setNumString(17, date.year() % 100, 6, 2);
       break;
     }
+    show();
 #endif
 
-    FastLED.show();
+    // кадр, отложенный ограничением частоты передач или дребезгом кнопки (см. show()), остается в буфере, а положение строки не меняется: иначе при частоте кадров выше допустимой по WS2812_BLACKOUT_BUDGET строка пропускала бы столбцы
+    if (changed)
+    {
+      return (result);
+    }
 
-#ifdef USE_TICKER_FOR_DATE
-    result = (n++ >= str_len - 2);
+#if defined(USE_TICKER_FOR_DATE) && defined(USE_SMOOTH_TICKER)
+    // последний кадр выводится точно в конечном положении, без смешивания
+    result = ((n >> 8) >= TICKER_LENGTH - 2);
+    n += ((uint32_t)TICKER_SPEED << 8) / TICKER_SMOOTH_FPS;
+    if (!result && (n >> 8) >= TICKER_LENGTH - 2)
+    {
+      n = (uint32_t)(TICKER_LENGTH - 2) << 8;
+    }
+#elif defined(USE_TICKER_FOR_DATE)
+    result = (n++ >= TICKER_LENGTH - 2);
 #else
     result = (n++ >= 3);
 #endif
 
     return (result);
   }
+#if defined(USE_TICKER_FOR_DATE) && defined(USE_TASK_PROFILER)
+  /**
+   * @brief вывод затрат на бегущую строку в пересчете на секунду движения строки: время формирования кадров и время передачи их на экран; после вывода статистика сбрасывается
+   *
+   * @param out поток для вывода, например, Serial
+   */
+  void printTickerReport(Print &out)
+  {
+#ifdef USE_SMOOTH_TICKER
+    const uint32_t fps = TICKER_SMOOTH_FPS;
+#else
+    const uint32_t fps = TICKER_SPEED;
+#endif
+    out.print(F("ticker frames: "));
+    out.println(ticker_frames);
+    if (ticker_frames > 0)
+    {
+      out.print(F("ticker render, us/s: "));
+      out.println(ticker_render * fps / ticker_frames);
+      out.print(F("ticker show, us/s: "));
+      out.println(ticker_show * fps / ticker_frames);
+    }
+    ticker_render = 0;
+    ticker_show = 0;
+    ticker_frames = 0;
+  }
+#endif
+
+
+  /**
+   * @brief установка языка вывода
+   *
+   * @param _lang номер языкового пакета, 0..LANG_COUNT-1; другие значения игнорируются
+   */
+  void setLanguage(uint8_t _lang)
+  {
+    if (_lang < LANG_COUNT && _lang != lang)
+    {
+      lang = _lang;
+      invalidateLayers();
+    }
+  }
+
+  /**
+   * @brief получение языка вывода
+   *
+   * @return uint8_t номер языкового пакета
+   */
+  uint8_t getLanguage() { return (lang); }
+
+  /**
+   * @brief вывод строки текущего языкового пакета шрифтом 5х7 с шагом 6 столбцов
+   *
+   * @param offset индекс столбца, с которого начинается строка
+   * @param index смещение строки в пакете (LANG_*)
+   * @param count количество символов
+   */
+  void setLangText(uint8_t offset, uint8_t index, uint8_t count = 3)
+  {
+    for (uint8_t i = 0; i < count; i++)
+    {
+      setDispData(offset + i * 6, getLangGlyph(index + i), 5);
+    }
+  }
+
+  /**
+   * @brief вывод на экран данных по настройке языка - названия текущего языка
+   *
+   * @param blink используется для мигания изменяемого значения
+   */
+  void showLanguageData(bool blink)
+  {
+    clear();
+    if (!blink)
+    {
+      setLangText(7, LANG_NAME);
+    }
+  }
 
   /**
    * @brief вывод на экран данных по настройке яркости экрана
@@ -407,32 +890,55 @@ public:
   {
     clear();
 
-#ifdef USE_RU_LANGUAGE
-    setChar(0, 0xDF, 5); // Я
-    setChar(6, 0xF0, 5); // р
-    uint8_t x = 0xEA;       // к
-    if (toSensor)
+    setChar(0, getLangGlyph(LANG_BRIGHTNESS), 5);
+    setChar(6, getLangGlyph(LANG_BRIGHTNESS + 1), 5);
+    // с датчиком света на месте третьего символа выводится номер настраиваемого уровня
+    setChar(12, (toSensor) ? GLYPH_0 + ((toMin) ? 0 : 1) : getLangGlyph(LANG_BRIGHTNESS + 2), 5);
+    writeColumn(LAYOUT_OFFSET + 18, 0b00100100);
+    if (!blink)
     {
-      x = (toMin) ? 0 + 0x30 : 1 + 0x30;
+      setChar(20, br / 10 + GLYPH_0, 5);
+      setChar(26, br % 10 + GLYPH_0, 5);
     }
-    setChar(12, x, 5);
-#else
-    setChar(0, 0x42, 5); // B
-    setChar(6, 0x72, 5); // r
-    if (toSensor)
+  }
+
+#ifdef USE_STOPWATCH
+  /**
+   * @brief вывод на экран времени секундомера или таймера; до 10 минут выводится м:сс и сотые доли секунды, с 10 минут - мм:сс и десятые доли секунды
+   *
+   * @param time время, сотых долей секунды
+   * @param show_colon отображать или нет двоеточие
+   */
+  void showTimerData(uint32_t time, bool show_colon)
+  {
+    clear();
+    ink = SLOT_TIMER;
+    uint8_t minute = time / 6000;
+    uint8_t second = time / 100 % 60;
+    uint8_t hundredth = time % 100;
+    // при выводе десятков минут изображение сдвигается на столбец вправо, а сотые доли не выводятся
+    uint8_t x = (minute < 10) ? 0 : 1;
+    if (x)
     {
-      uint8_t x = (toMin) ? 0 : 1;
-      x += 0x30;
-      setChar(12, x, 5);
+      setChar(0, GLYPH_0 + minute / 10, 5);
     }
-#endif
-    setColumn(18, 0b00100100);
-    if (!blink)
+    setChar(5 + x, GLYPH_0 + minute % 10, 5);
+    if (show_colon)
     {
-      setChar(20, br / 10 + 0x30, 5);
-      setChar(26, br % 10 + 0x30, 5);
+      ink = SLOT_COLON;
+      writeColumn(LAYOUT_OFFSET + 11 + x, 0b00100100);
+      ink = SLOT_TIMER;
     }
+    setChar(13 + x, GLYPH_0 + second / 10, 5);
+    setChar(19 + x, GLYPH_0 + second % 10, 5);
+    setSmallDigit(25 + x, hundredth / 10);
+    if (!x)
+    {
+      setSmallDigit(29, hundredth % 10);
+    }
+    ink = SLOT_TEXT;
   }
+#endif
 };
 
 // ==== инициализация матрицы ========================
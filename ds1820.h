@@ -5,24 +5,38 @@
 
    Методы библиотеки
 
-   DS1820 temp_sensor(data_pin) - конструктор, data_pin - пин, к которому подключен датчик (наличие резистора 4.7кОм между пином данных и VCC обязательно)
+   DS1820 temp_sensor(data_pin) - конструктор, data_pin - пин, к которому подключен датчик (наличие резистора 4.7кОм между пином данных и VCC обязательно); поиск датчика на линии выполняется не в конструкторе, а при первом опросе, чтобы не задерживать запуск часов
 
    void readData() - опрос датчика; следует вызывать не чаще одного раза в секунду, а лучше реже, т.к. при слишком частом опросе микросхема датчика начинает вносить искажения в температуру за счет собственного разогрева; считанные данные помещаются в поле temp;
 
    int16_t getTemp() - получение ранее считанной из дачика температуры;
+
+   Кроме того, класс реализует асинхронный интерфейс clcSensor (см. sensors.h): start() дает команду на конвертацию, poll() считывает данные не ранее, чем через DS1820_CONVERSION_TIME мс после старта, result() возвращает температуру;
 */
 #pragma once
 #include <Arduino.h>
 #include <OneWire.h> // https://github.com/PaulStoffregen/OneWire
+#include "sensors.h"
 
 #define ERROR_TEMP -127
+#define DS1820_CONVERSION_TIME 750 // время конвертации при разрешении 12 бит, мс
 
-class DS1820 : public OneWire
+class DS1820 : public OneWire, public clcSensor
 {
 private:
   int16_t temp = ERROR_TEMP;
   uint8_t addr[8];
   uint8_t type_c = 10;
+  bool initialized = false; // поиск датчика на линии уже выполнен
+  uint32_t conv_timer = 0;
+
+  void startConversion()
+  {
+    OneWire::reset();
+    OneWire::select(addr);
+    OneWire::write(0x44, 1);
+    conv_timer = millis();
+  }
 
   bool checkData(uint8_t *data)
   {
@@ -41,9 +55,14 @@ private:
     return (result);
   }
 
-public:
-  DS1820(uint8_t data_pin) : OneWire(data_pin)
+  // поиск датчика на линии и определение его типа; выполняется один раз при первом опросе
+  void init()
   {
+    if (initialized)
+    {
+      return;
+    }
+    initialized = true;
     OneWire::reset();
     // если датчик найден
     if (OneWire::search(addr))
@@ -65,18 +84,39 @@ public:
       }
       if (type_c < 2)
       {
-        OneWire::reset();
-        OneWire::select(addr);
-        OneWire::write(0x44, 1);
+        startConversion();
       }
     }
   }
 
+public:
+  DS1820(uint8_t data_pin) : OneWire(data_pin) {}
+
   /**
    * @brief считывание показаний датчика; вызывать не чаще одного раза в секунду
    *
    */
   void readData()
+  {
+    if (!initialized)
+    {
+      // при первом вызове выполняется поиск датчика и запуск конвертации, данные будут получены при следующем вызове
+      init();
+      return;
+    }
+    if (type_c < 2)
+    {
+      readScratchpad();
+      // даем команду на конвертацию для следующего запроса
+      startConversion();
+    }
+  }
+
+  /**
+   * @brief считывание данных из памяти датчика без запуска новой конвертации
+   *
+   */
+  void readScratchpad()
   {
     if (type_c < 2)
     {
@@ -127,14 +167,52 @@ public:
           temp++;
         }
       }
+    }
+  }
 
-      // даем команду на конвертацию для следующего запроса
-      OneWire::reset();
-      OneWire::select(addr);
-      OneWire::write(0x44, 1);
+  /**
+   * @brief запуск конвертации температуры
+   *
+   * @return false, если датчик не найден
+   */
+  bool start()
+  {
+    if (!initialized)
+    {
+      // поиск датчика сам запускает конвертацию
+      init();
+      return (type_c < 2);
+    }
+    if (type_c < 2)
+    {
+      startConversion();
+    }
+    return (type_c < 2);
+  }
+
+  /**
+   * @brief считывание результата конвертации, если она уже завершена
+   *
+   * @return SensorState
+   */
+  SensorState poll()
+  {
+    if (millis() - conv_timer < DS1820_CONVERSION_TIME)
+    {
+      return (SENSOR_BUSY);
     }
+    readScratchpad();
+    return ((temp == ERROR_TEMP) ? SENSOR_ERROR : SENSOR_READY);
   }
 
+  /**
+   * @brief получение ранее считанной температуры
+   *
+   * @param channel номер канала; у датчика один канал - 0
+   * @return int16_t
+   */
+  int16_t result(uint8_t channel = 0) { return ((channel == 0) ? temp : SENSOR_NO_DATA); }
+
   /**
    * @brief получение ранее считанной температуры
    *
@@ -0,0 +1,126 @@
+/* Очередь событий главного цикла;
+
+   События помещаются в очередь из обработчиков прерываний - изменения уровня на пинах кнопок (PCINT) и сигнала SQW модуля DS3231 (INT0/INT1). Главный цикл разбирает очередь, после чего, если очередь пуста, переводит МК в режим сна idle, из которого его выводит любое прерывание, в том числе прерывание таймера 0, отсчитывающего millis(), т.е. истечение интервалов задач проверяется после каждого пробуждения.
+
+   Ведется статистика: количество пробуждений в секунду и доля времени, проведенного во сне. Пробуждения только по прерыванию таймера 0 (около 976 в секунду при 16 МГц, в любом режиме часов) не считаются: пробуждение относится к таймеру 0, если за время сна micros() перешло через границу переполнения таймера, а событий в очереди нет; остаются пробуждения по кнопкам, SQW, Serial и прочим прерываниям.
+*/
+#pragma once
+#include <Arduino.h>
+#include "hal.h"
+
+#define EVENT_QUEUE_SIZE 8 // размер очереди событий (степень двойки)
+
+enum EventType : uint8_t // тип события
+{
+  EVENT_NONE,    // событий нет
+  EVENT_BUTTON,  // изменение уровня на пине одной из кнопок
+  EVENT_RTC_TICK // импульс SQW модуля DS3231 - начало новой секунды
+};
+
+class EventQueue
+{
+private:
+  volatile uint8_t buf[EVENT_QUEUE_SIZE];
+  volatile uint8_t head = 0;
+  volatile uint8_t tail = 0;
+
+  uint16_t wakeups = 0;
+  uint16_t wakeups_per_sec = 0;
+  uint32_t sleep_time = 0;
+  uint8_t sleep_percent = 0;
+  uint32_t stat_timer = 0;
+
+  void updateStat()
+  {
+    uint32_t t = millis() - stat_timer;
+    if (t >= 1000)
+    {
+      wakeups_per_sec = wakeups * 1000ul / t;
+      sleep_percent = sleep_time / 10ul / t;
+      wakeups = 0;
+      sleep_time = 0;
+      stat_timer = millis();
+    }
+  }
+
+public:
+  EventQueue() {}
+
+  /**
+   * @brief добавление события в очередь; вызывается из обработчиков прерываний; если последнее необработанное событие такого же типа уже есть в очереди, новое не добавляется
+   *
+   * @param ev событие
+   */
+  void push(EventType ev)
+  {
+    uint8_t h = head;
+    if (h != tail && buf[(h - 1) & (EVENT_QUEUE_SIZE - 1)] == ev)
+    {
+      return;
+    }
+    uint8_t next = (h + 1) & (EVENT_QUEUE_SIZE - 1);
+    if (next != tail)
+    {
+      buf[h] = ev;
+      head = next;
+    }
+  }
+
+  /**
+   * @brief извлечение события из очереди
+   *
+   * @return EventType; EVENT_NONE, если очередь пуста
+   */
+  EventType pop()
+  {
+    EventType result = EVENT_NONE;
+    uint8_t irq = halDisableInterrupts();
+    if (head != tail)
+    {
+      result = (EventType)buf[tail];
+      tail = (tail + 1) & (EVENT_QUEUE_SIZE - 1);
+    }
+    halRestoreInterrupts(irq);
+    return (result);
+  }
+
+  /**
+   * @brief перевод МК в режим сна idle, если очередь событий пуста
+   *
+   */
+  void sleep()
+  {
+    uint32_t t = micros();
+    uint8_t irq = halDisableInterrupts();
+    if (head == tail)
+    {
+      halSleepIdle(); // прерывания разрешаются в момент засыпания, поэтому событие не будет потеряно
+      uint32_t now = micros();
+      sleep_time += now - t;
+      // пробуждение по прерыванию таймера 0 (millis()) не считается
+      if (head != tail || now / HAL_MILLIS_TICK_US == t / HAL_MILLIS_TICK_US)
+      {
+        wakeups++;
+      }
+    }
+    else
+    {
+      halRestoreInterrupts(irq);
+    }
+    updateStat();
+  }
+
+  /**
+   * @brief получение количества пробуждений МК за последнюю секунду без пробуждений по прерыванию таймера 0
+   *
+   * @return uint16_t
+   */
+  uint16_t getWakeupsPerSecond() { return (wakeups_per_sec); }
+
+  /**
+   * @brief получение доли времени, проведенного во сне за последнюю секунду, в процентах
+   *
+   * @return uint8_t
+   */
+  uint8_t getSleepPercent() { return (sleep_percent); }
+};
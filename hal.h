@@ -0,0 +1,406 @@
+/* Аппаратно-зависимые функции;
+
+   Здесь собраны все обращения к регистрам, прерываниям и режимам сна конкретного МК, чтобы остальной код часов использовал только Arduino API и функции этого файла. Для AVR используются прерывания по изменению уровня (PCINT), режимы сна idle и power-down, сторожевой таймер для пробуждения, таймер Timer1 для отметок времени и его канал сравнения A для прерывания с периодом 10 мс (секундомер и таймер), и сохранение регистра SREG; на других платформах функции сводятся к безопасным заменам: прерываний PCINT нет (кнопки опрашиваются в главном цикле), МК не засыпает, отметки времени берутся из micros(), прерывания 10 мс нет (интервалы отсчитываются по millis()), а запрет прерываний выполняется функциями noInterrupts()/interrupts().
+
+   Для переноса часов на другую платформу достаточно реализовать функции этого файла для нее.
+*/
+#pragma once
+#include <Arduino.h>
+#if defined(__AVR__)
+#include <avr/sleep.h>
+#include <avr/wdt.h>
+#endif
+
+#if defined(__AVR__) && defined(PCICR)
+#define HAL_PIN_CHANGE_AVAILABLE // МК поддерживает прерывания по изменению уровня на пинах
+#endif
+#if defined(__AVR__) && defined(WDTCSR) && defined(WDIE)
+#define HAL_WAKE_TIMER_AVAILABLE // сторожевой таймер может работать в режиме прерывания и будить МК из режима power-down
+#endif
+
+/**
+ * @brief запрет прерываний с сохранением их текущего состояния
+ *
+ * @return uint8_t состояние прерываний для halRestoreInterrupts()
+ */
+inline uint8_t halDisableInterrupts()
+{
+#if defined(__AVR__)
+  uint8_t state = SREG;
+  cli();
+  return (state);
+#else
+  noInterrupts();
+  return (1);
+#endif
+}
+
+/**
+ * @brief восстановление состояния прерываний, сохраненного halDisableInterrupts()
+ *
+ * @param state сохраненное состояние
+ */
+inline void halRestoreInterrupts(uint8_t state)
+{
+#if defined(__AVR__)
+  SREG = state;
+#else
+  if (state)
+  {
+    interrupts();
+  }
+#endif
+}
+
+/**
+ * @brief перевод МК в режим сна idle; вызывается при запрещенных прерываниях, которые разрешаются непосредственно перед засыпанием, поэтому прерывание, пришедшее после проверки условия засыпания, не будет пропущено
+ *
+ */
+inline void halSleepIdle()
+{
+#if defined(__AVR__)
+  set_sleep_mode(SLEEP_MODE_IDLE);
+  sleep_enable();
+  sei(); // инструкция после sei() выполняется до обработки прерываний
+  sleep_cpu();
+  sleep_disable();
+#else
+  interrupts();
+#endif
+}
+
+/**
+ * @brief включение прерывания по изменению уровня на пине
+ *
+ * @param pin номер пина
+ * @return false, если для пина прерывание недоступно
+ */
+inline bool halAttachPinChange(uint8_t pin)
+{
+#ifdef HAL_PIN_CHANGE_AVAILABLE
+  if (digitalPinToPCICR(pin) == NULL)
+  {
+    return (false);
+  }
+  *digitalPinToPCMSK(pin) |= bit(digitalPinToPCMSKbit(pin));
+  *digitalPinToPCICR(pin) |= bit(digitalPinToPCICRbit(pin));
+  return (true);
+#else
+  (void)pin;
+  return (false);
+#endif
+}
+
+/**
+ * @brief отключение прерывания по изменению уровня на пине; прерывания остальных пинов группы продолжают работать
+ *
+ * @param pin номер пина
+ */
+inline void halDetachPinChange(uint8_t pin)
+{
+#ifdef HAL_PIN_CHANGE_AVAILABLE
+  if (digitalPinToPCICR(pin) != NULL)
+  {
+    *digitalPinToPCMSK(pin) &= ~bit(digitalPinToPCMSKbit(pin));
+  }
+#else
+  (void)pin;
+#endif
+}
+
+// ==== энергосбережение =============================
+/**
+ * @brief перевод МК в режим сна power-down с отключенным АЦП; МК просыпается только от внешних прерываний (в том числе PCINT) и сторожевого таймера, таймер 0 при этом стоит, т.е. millis() за время сна не увеличивается
+ *
+ */
+inline void halSleepPowerDown()
+{
+#if defined(__AVR__)
+  uint8_t adc = ADCSRA;
+  ADCSRA = adc & ~bit(ADEN); // АЦП во сне потребляет заметный ток
+  set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+  cli();
+  sleep_enable();
+  sei(); // инструкция после sei() выполняется до обработки прерываний
+  sleep_cpu();
+  sleep_disable();
+  ADCSRA = adc;
+#endif
+}
+
+/**
+ * @brief запуск сторожевого таймера в режиме прерывания с периодом около 0,5 с для периодического пробуждения МК
+ *
+ */
+inline void halWakeTimerStart()
+{
+#ifdef HAL_WAKE_TIMER_AVAILABLE
+  uint8_t state = halDisableInterrupts();
+  wdt_reset();
+  WDTCSR = bit(WDCE) | bit(WDE);
+  WDTCSR = bit(WDIE) | bit(WDP2) | bit(WDP0); // только прерывание, без сброса МК; 0,5 с
+  halRestoreInterrupts(state);
+#endif
+}
+
+/**
+ * @brief остановка сторожевого таймера
+ *
+ */
+inline void halWakeTimerStop()
+{
+#ifdef HAL_WAKE_TIMER_AVAILABLE
+  uint8_t state = halDisableInterrupts();
+  wdt_reset();
+  WDTCSR = bit(WDCE) | bit(WDE);
+  WDTCSR = 0;
+  halRestoreInterrupts(state);
+#endif
+}
+
+// ==== Timer0 ======================================
+#define HAL_MILLIS_TICK_US (64ul * 256ul / (F_CPU / 1000000ul)) // период прерывания по переполнению Timer0, отсчитывающего millis() (делитель 64, 256 тиков), мкс; при 16 МГц - 1024 мкс; micros() / HAL_MILLIS_TICK_US - номер переполнения
+
+// ==== таймер =======================================
+#if defined(__AVR__) && defined(TCCR1B)
+#define HAL_TIMER_AVAILABLE // для отметок времени используется аппаратный таймер Timer1
+#endif
+#define HAL_TIMER_HZ (F_CPU / 256) // частота счета таймера отметок времени, Гц; при 16 МГц - 62500 Гц, т.е. 16 мкс
+#define HAL_TICK_PERIOD (HAL_TIMER_HZ / 100) // период прерывания 10 мс в тиках таймера отметок времени; при 16 МГц - 625
+
+/**
+ * @brief запуск свободно бегущего 16-битного таймера отметок времени без прерываний; если таймер уже работает в нужном режиме, он не перезапускается
+ *
+ * Функция init() Arduino запускает Timer1 в режиме 8-битной ШИМ (счет только до 255), поэтому таймер перенастраивается по фактическому режиму, а не по наличию тактирования.
+ */
+inline void halTimerBegin()
+{
+#ifdef HAL_TIMER_AVAILABLE
+  if (TCCR1A != 0 || TCCR1B != bit(CS12))
+  {
+    uint8_t state = halDisableInterrupts();
+    TCCR1A = 0;
+    TCCR1B = bit(CS12); // нормальный режим, делитель 256
+    TCNT1 = 0;
+    halRestoreInterrupts(state);
+  }
+#endif
+}
+
+/**
+ * @brief запуск таймера отметок времени с прерыванием по переполнению
+ *
+ */
+inline void halTimerStart()
+{
+#ifdef HAL_TIMER_AVAILABLE
+  halTimerBegin();
+  TIFR1 = bit(TOV1);
+  TIMSK1 |= bit(TOIE1);
+#endif
+}
+
+/**
+ * @brief получение текущего значения таймера отметок времени
+ *
+ * @return uint16_t значение в тиках HAL_TIMER_HZ, переполняется каждые 65536 тиков
+ */
+inline uint16_t halTimerRead()
+{
+#ifdef HAL_TIMER_AVAILABLE
+  return (TCNT1);
+#else
+  return ((uint16_t)((uint64_t)micros() * HAL_TIMER_HZ / 1000000ul));
+#endif
+}
+
+/**
+ * @brief отметка времени для измерения интервалов, в том числе включающих участки с запрещенными прерываниями
+ *
+ */
+struct HalStamp
+{
+  uint32_t ms;    // значение millis()
+  uint16_t ticks; // значение таймера отметок времени
+};
+
+/**
+ * @brief получение отметки времени
+ *
+ * @return HalStamp
+ */
+inline HalStamp halStamp()
+{
+  HalStamp result;
+  result.ms = millis();
+  result.ticks = halTimerRead();
+  return (result);
+}
+
+/**
+ * @brief получение времени, прошедшего от отметки; интервалы короче секунды отсчитываются по аппаратному таймеру, который, в отличие от micros(), не теряет переполнений при запрещенных прерываниях (например, во время передачи данных FastLED), более длинные - по millis()
+ *
+ * @param start отметка начала интервала
+ * @return uint32_t мкс
+ */
+inline uint32_t halElapsedMicros(const HalStamp &start)
+{
+  uint32_t ms = millis() - start.ms;
+  if (ms >= 1000)
+  {
+    // таймер отметок времени мог переполниться
+    return (ms * 1000);
+  }
+  return ((uint32_t)(uint16_t)(halTimerRead() - start.ticks) * 256 / (F_CPU / 1000000ul));
+}
+
+/**
+ * @brief запуск прерывания с периодом 10 мс по совпадению канала A таймера отметок времени; таймер при этом не перезапускается, поэтому отметки времени трассировки не сбиваются
+ *
+ */
+inline void halTickStart()
+{
+#ifdef HAL_TIMER_AVAILABLE
+  halTimerBegin();
+  uint8_t state = halDisableInterrupts();
+  // если прерывание уже работает, его фаза не сдвигается
+  if (!(TIMSK1 & bit(OCIE1A)))
+  {
+    OCR1A = TCNT1 + HAL_TICK_PERIOD;
+    TIFR1 = bit(OCF1A);
+    TIMSK1 |= bit(OCIE1A);
+  }
+  halRestoreInterrupts(state);
+#endif
+}
+
+/**
+ * @brief остановка прерывания с периодом 10 мс; таймер отметок времени продолжает счет
+ *
+ */
+inline void halTickStop()
+{
+#ifdef HAL_TIMER_AVAILABLE
+  TIMSK1 &= ~bit(OCIE1A);
+#endif
+}
+
+// ==== память =======================================
+#if defined(__AVR__)
+extern uint8_t __heap_start; // начало кучи (конец статических данных), задается компоновщиком
+extern char *__brkval;       // текущая граница кучи, 0 - куча не использовалась
+#endif
+
+/**
+ * @brief получение текущего значения указателя стека
+ *
+ * @return uint16_t адрес; 0, если недоступно
+ */
+inline uint16_t halStackPointer()
+{
+#if defined(__AVR__)
+  return (SP);
+#else
+  return (0);
+#endif
+}
+
+/**
+ * @brief получение адреса начала кучи - конца статических данных; в отличие от halHeapEnd() доступно до инициализации переменных
+ *
+ * @return uint16_t адрес; 0, если недоступно
+ */
+inline uint16_t halHeapStart()
+{
+#if defined(__AVR__)
+  return ((uint16_t)(uintptr_t)&__heap_start);
+#else
+  return (0);
+#endif
+}
+
+/**
+ * @brief получение адреса конца кучи - нижней границы области, доступной стеку
+ *
+ * @return uint16_t адрес; 0, если недоступно
+ */
+inline uint16_t halHeapEnd()
+{
+#if defined(__AVR__)
+  return ((__brkval != 0) ? (uint16_t)(uintptr_t)__brkval : (uint16_t)(uintptr_t)&__heap_start);
+#else
+  return (0);
+#endif
+}
+
+/**
+ * @brief объявление функции, выполняемой при старте МК до инициализации глобальных объектов; функция не должна использовать стек
+ *
+ */
+#if defined(__AVR__)
+#define HAL_EARLY_INIT(name)                                           \
+  void name() __attribute__((naked, used, section(".init3"))); \
+  void name()
+#else
+#define HAL_EARLY_INIT(name)                            \
+  void name() __attribute__((constructor(101))); \
+  void name()
+#endif
+
+/**
+ * @brief номер группы прерываний по изменению уровня (0..2), в которую входит пин; для номеров пинов, заданных числом, вычисляется и препроцессором, поэтому пригоден в #if
+ *
+ */
+#ifdef HAL_PIN_CHANGE_AVAILABLE
+#define HAL_PIN_CHANGE_GROUP(pin) digitalPinToPCICRbit(pin)
+#else
+#define HAL_PIN_CHANGE_GROUP(pin) 0xFF
+#endif
+
+/**
+ * @brief определение обработчика прерывания по изменению уровня для одной группы пинов; group - число 0..2 (см. HAL_PIN_CHANGE_GROUP()); определять нужно только группы с используемыми пинами, чтобы не занимать векторы, нужные другим библиотекам (например, SoftwareSerial)
+ *
+ */
+#ifdef HAL_PIN_CHANGE_AVAILABLE
+#define HAL_PIN_CHANGE_ISR(group, handler) \
+  ISR(PCINT##group##_vect) { handler(); }
+#else
+#define HAL_PIN_CHANGE_ISR(group, handler)
+#endif
+
+/**
+ * @brief определение обработчика прерывания по переполнению таймера отметок времени
+ *
+ */
+#ifdef HAL_TIMER_AVAILABLE
+#define HAL_TIMER_OVERFLOW_ISR(handler) \
+  ISR(TIMER1_OVF_vect) { handler(); }
+#else
+#define HAL_TIMER_OVERFLOW_ISR(handler)
+#endif
+
+/**
+ * @brief определение обработчика прерывания с периодом 10 мс; следующее совпадение отсчитывается от предыдущего, поэтому задержка входа в прерывание не накапливается
+ *
+ */
+#ifdef HAL_TIMER_AVAILABLE
+#define HAL_TICK_ISR(handler)   \
+  ISR(TIMER1_COMPA_vect)        \
+  {                             \
+    OCR1A += HAL_TICK_PERIOD;   \
+    handler();                  \
+  }
+#else
+#define HAL_TICK_ISR(handler)
+#endif
+
+/**
+ * @brief определение обработчика прерывания сторожевого таймера, используемого для пробуждения МК
+ *
+ */
+#ifdef HAL_WAKE_TIMER_AVAILABLE
+#define HAL_WAKE_TIMER_ISR(handler) \
+  ISR(WDT_vect) { handler(); }
+#else
+#define HAL_WAKE_TIMER_ISR(handler)
+#endif
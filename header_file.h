@@ -24,6 +24,17 @@
 // #define USE_ONECLICK_TO_SET_ALARM // использовать одинарный клик кнопкой Set для входа в настройки будильника, иначе вход по двойному клику
 #endif
 
+// ==== секундомер и таймер ==========================
+
+// #define USE_STOPWATCH // использовать секундомер с запоминанием кругов и таймер обратного отсчета; вход по клику (или двойному клику) кнопкой Set, свободному от будильника
+
+#ifdef USE_STOPWATCH
+#define STOPWATCH_LAP_COUNT 8         // количество запоминаемых кругов секундомера
+#define STOPWATCH_LAP_SHOW_TIME 2000  // время показа времени круга после его фиксации, мс
+#define COUNTDOWN_DEFAULT_MINUTES 5   // начальная установка таймера обратного отсчета, минут (1..99)
+#define COUNTDOWN_BUZZER_DURATION 10  // продолжительность сигнала по окончании отсчета таймера, секунд
+#endif
+
 // ==== датчики ======================================
 
 // #define USE_LIGHT_SENSOR // использовать или нет датчик света на пине А3 для регулировки яркости экрана
@@ -35,6 +46,84 @@
 // #define USE_NTC     // использовать для вывода температуры NTC термистор
 #endif
 
+#if defined(USE_TEMP_DATA) || defined(USE_LIGHT_SENSOR)
+#define USE_SENSORS // датчики опрашиваются общим менеджером датчиков, см. sensors.h
+#endif
+
+// ==== язык =========================================
+
+// #define USE_LANGUAGE_SETTING // (только для матричных экранов) выбирать язык вывода в режиме настройки; без этой опции язык задается строкой USE_RU_LANGUAGE в файле matrix_data.h
+
+#if defined(USE_LANGUAGE_SETTING) && !defined(MAX72XX_MATRIX_DISPLAY) && !defined(WS2812_MATRIX_DISPLAY)
+#undef USE_LANGUAGE_SETTING // семисегментные экраны выводят только цифры
+#endif
+
+// ==== кнопки =======================================
+
+#define USE_BUTTON_INTERRUPTS // фиксировать нажатия кнопок в прерывании по изменению уровня на пинах (на МК без PCINT, например, ATmega8, отключается автоматически)
+
+// ==== главный цикл =================================
+
+// #define USE_EVENT_LOOP // главный цикл обрабатывает события от прерываний, а в остальное время переводит МК в режим сна idle
+
+#ifdef USE_EVENT_LOOP
+#ifndef USE_BUTTON_INTERRUPTS
+#define USE_BUTTON_INTERRUPTS // главный цикл по событиям узнает о нажатии кнопок только из прерываний
+#endif
+// #define USE_RTC_SQW // считывать время из DS3231 только по сигналу SQW (1 Гц), а не каждые 50 мс
+// #define SHOW_EVENT_LOOP_STATS // раз в секунду выводить в Serial количество пробуждений МК и долю времени, проведенного во сне
+#endif
+
+// ==== энергосбережение =============================
+
+// #define USE_POWER_SAVE // гасить экран и переводить МК в режим сна power-down при отсутствии нажатий кнопок и в ночные часы; часы просыпаются от кнопок и раз в полсекунды для проверки времени и будильника
+
+#ifdef USE_POWER_SAVE
+#define POWER_SAVE_IDLE_TIMEOUT 600 // время без нажатий кнопок, после которого часы засыпают днем, секунд; 0 - днем не засыпать
+#define POWER_SAVE_NIGHT_TIMEOUT 10 // время без нажатий кнопок, после которого часы засыпают ночью, секунд
+#define POWER_SAVE_NIGHT_START 23   // начало ночного периода, час
+#define POWER_SAVE_NIGHT_END 7      // окончание ночного периода, час; если равно началу, ночного периода нет
+// #define SHOW_POWER_STATS // по получении символа 's' выводить в Serial время работы и время сна МК
+#endif
+
+#if defined(USE_BUTTON_INTERRUPTS) && !defined(PCICR)
+#undef USE_BUTTON_INTERRUPTS // у МК нет прерываний по изменению уровня на пинах (ATmega8, не AVR) - кнопки опрашиваются в главном цикле
+#ifdef USE_EVENT_LOOP
+#error "USE_EVENT_LOOP requires pin change interrupts"
+#endif
+#endif
+
+#if defined(USE_POWER_SAVE) && !defined(USE_BUTTON_INTERRUPTS)
+#error "USE_POWER_SAVE requires pin change interrupts"
+#endif
+
+// ==== отладка ======================================
+
+// #define USE_TASK_PROFILER // собирать статистику выполнения задач; отчет выводится в Serial по получении символа 'p'
+// #define USE_ACTIVITY_COUNTERS // считать обращения к DS3231, экрану, EEPROM, пищалке и события кнопок; отчет выводится в Serial по получении символа 'c'
+// #define USE_RENDER_BENCHMARK // по получении символа 'b' измерить время выполнения функций отрисовки и вывести результат в Serial
+// #define USE_RAM_MONITOR // контролировать запас свободной RAM и глубину стека задач; отчет выводится в Serial по получении символа 'm'
+#ifdef USE_RAM_MONITOR
+// #define SHOW_RAM_WARNING // при запасе свободной RAM меньше RAM_WARNING_THRESHOLD в режиме показа времени каждую вторую секунду выводить строку минусов
+#endif
+
+// #define USE_TRACE // записывать события часов в буфер трассировки; содержимое буфера выводится в Serial в двоичном виде по получении символа 't' (см. tools/trace_decode.py)
+
+// #define USE_SERIAL_PROTOCOL // принимать команды и отправлять телеметрию по двоичному протоколу через Serial (см. protocol.h и tools/clock_client.py)
+
+#ifdef USE_STOPWATCH
+// #define USE_STOPWATCH_SELF_TEST // по получении символа 'w' запустить секундомер на 100 мс и вывести в Serial отсчитанное время - проверка работы прерывания Timer1
+#endif
+
+#if defined(USE_TASK_PROFILER) || defined(USE_ACTIVITY_COUNTERS) || defined(USE_RENDER_BENCHMARK) || defined(USE_RAM_MONITOR) || defined(USE_TRACE) || defined(USE_SERIAL_PROTOCOL) || defined(SHOW_POWER_STATS) || defined(USE_STOPWATCH_SELF_TEST)
+#define USE_SERIAL_REQUESTS // отчеты выводятся в Serial по запросу
+#endif
+
+#if defined(SHOW_EVENT_LOOP_STATS) || defined(USE_SERIAL_REQUESTS)
+#define USE_SERIAL_OUTPUT    // используется вывод отладочной информации в Serial
+#define SERIAL_SPEED 115200  // скорость Serial, бод
+#endif
+
 // ===================================================
 
 // ==== пины =========================================
@@ -45,6 +134,9 @@
 
 #define DS3231_SDA_PIN A4 // пин для подключения вывода SDA модуля DS3231 (не менять!!!)
 #define DS3231_SCL_PIN A5 // пин для подключения вывода SCL модуля DS3231 (не менять!!!)
+#ifdef USE_RTC_SQW
+#define DS3231_SQW_PIN 2 // пин для подключения вывода SQW модуля DS3231 (только 2 или 3!!!)
+#endif
 
 #if defined(TM1637_DISPLAY)
 #define DISPLAY_CLK_PIN 11 // пин для подключения экрана - CLK
@@ -57,8 +149,10 @@
 // пины для подключения адресных светодиодов настраиваются в файле setting_for_WS2812.h
 #endif
 
+#if defined(USE_ALARM) || defined(USE_STOPWATCH)
+#define BUZZER_PIN 5 // пин для подключения пищалки
+#endif
 #ifdef USE_ALARM
-#define BUZZER_PIN 5    // пин для подключения пищалки
 #define ALARM_LED_PIN 7 // пин для подключения светодиода - индикатора будильника
 #endif
 
@@ -81,6 +175,9 @@
 #define MIN_BRIGHTNESS_VALUE 98 // индекс в EEPROM для сохранения  минимального значения яркости экрана
 #endif
 #define MAX_BRIGHTNESS_VALUE 99 // индекс в EEPROM для сохранения  максимального значение яркости экрана
+#ifdef USE_LANGUAGE_SETTING
+#define LANGUAGE_VALUE 97 // индекс в EEPROM для сохранения языка вывода
+#endif
 
 // ==== работа с экраном =============================
 enum DisplayMode : uint8_t
@@ -116,6 +213,17 @@ enum DisplayMode : uint8_t
   ,
   DISPLAY_MODE_SET_BRIGHTNESS_MAX // режим настройки максимального уровня яркости экрана
 #endif
+#ifdef USE_LANGUAGE_SETTING
+  ,
+  DISPLAY_MODE_SET_LANGUAGE // режим настройки языка вывода
+#endif
+#ifdef USE_STOPWATCH
+  ,
+  DISPLAY_MODE_STOPWATCH, // режим секундомера
+  DISPLAY_MODE_COUNTDOWN  // режим таймера обратного отсчета
+#endif
+  ,
+  DISPLAY_MODE_COUNT // количество режимов
 };
 
 // ==== опрос кнопок =================================
@@ -124,6 +232,7 @@ void checkSetButton();
 void checkUpDownButton();
 
 // ==== задачи =======================================
+void readRTC();
 void rtcNow();
 void blink();
 void returnToDefMode();
@@ -138,9 +247,9 @@ void runAlarmBuzzer();
 #endif
 #ifdef USE_TEMP_DATA
 void showTemp();
-#ifdef USE_DS18B20
-void checkDS18b20();
 #endif
+#ifdef USE_SENSORS
+void checkSensors();
 #endif
 #ifdef USE_LIGHT_SENSOR
 void setBrightness();
@@ -148,8 +257,25 @@ void setBrightness();
 #ifdef USE_SET_BRIGHTNESS_MODE
 void showBrightnessSetting();
 #endif
+#ifdef USE_LANGUAGE_SETTING
+void showLanguageSetting();
+#endif
+#ifdef USE_SERIAL_PROTOCOL
+void sendTelemetry();
+#endif
+#ifdef USE_STOPWATCH
+void showTimer();
+void checkCountdown();
+#endif
 
 // ==== вывод данных =================================
+/**
+ * @brief установка яркости экрана
+ *
+ * @param x уровень яркости
+ */
+void setDisplayBrightness(uint8_t x);
+
 /**
  * @brief вывод данных на экран
  *
@@ -182,5 +308,14 @@ void showAlarmState(uint8_t _state);
  * @param toUp увеличение (true) или уменьшение данных (false)
  * @param min минимально мозможное значение
  * @param toLoop если true, то изменение данных закольцовано, иначе только от минимума к максимуму и наоборот
+ * @param step шаг изменения данных, используется при автоповторе кнопок; при закольцованном изменении значение, перешедшее предел, продолжает счет с противоположной границы, иначе останавливается на пределе
+ */
+void checkData(uint8_t &dt, uint8_t max, bool toUp, uint8_t min = 0, bool toLoop = true, uint8_t step = 1);
+
+/**
+ * @brief запись байта в EEPROM; запись выполняется, только если значение отличается от уже записанного
+ *
+ * @param index индекс ячейки EEPROM
+ * @param value значение
  */
-void checkData(uint8_t &dt, uint8_t max, bool toUp, uint8_t min = 0, bool toLoop = true);
+void updateEEPROM(uint16_t index, uint8_t value);
@@ -0,0 +1,145 @@
+/* Замер функций отрисовки на компьютере: время одного вызова в наносекундах для экрана и опций конфигурации; результат выводится строками CSV
+
+   config,kernel,iterations,ns_per_op,baseline_ns_per_op,change_percent
+
+   Если первым аргументом передана таблица прошлого замера, для каждой функции выводятся ее прежнее время и изменение в процентах; иначе эти поля пустые. Время - наименьшее из нескольких замеров, каждый длительностью не меньше BENCH_MIN_TIME_NS; сравнивать имеет смысл только замеры, сделанные на одном компьютере в сборке без санитайзеров (-DHOST_SANITIZE=OFF -DCMAKE_BUILD_TYPE=Release).
+
+   Скетч в замер не входит: экран создается здесь так же, как в simple_clock.ino, а модель МК нужна только прослойкам библиотек экранов. Функции setChar(), getDateString() и getLedIndexOfStrip() закрыты в классах экранов, поэтому заголовки экранов подключаются с открытыми членами классов.
+*/
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <Arduino.h>
+#include <DS3231.h>
+#include <FastLED.h>
+#include "header_file.h"
+#define private public
+#if defined(TM1637_DISPLAY)
+#include "display_TM1637.h"
+#elif defined(MAX72XX_7SEGMENT_DISPLAY) || defined(MAX72XX_MATRIX_DISPLAY)
+#include "display_MAX72xx.h"
+#elif defined(WS2812_MATRIX_DISPLAY)
+#include "display_WS2812.h"
+#endif
+#undef private
+
+// скетч не запускается, но модель МК ссылается на его setup() и loop()
+void setup() {}
+void loop() {}
+
+const uint64_t BENCH_MIN_TIME_NS = 20000000ull; // наименьшая длительность одного замера
+const uint8_t BENCH_RUNS = 5;                   // количество замеров каждой функции
+
+#if defined(TM1637_DISPLAY)
+DisplayTM1637 disp(DISPLAY_CLK_PIN, DISPLAY_DAT_PIN);
+#elif defined(MAX72XX_7SEGMENT_DISPLAY)
+DisplayMAX72xx7segment<DISPLAY_CS_PIN> disp;
+#elif defined(MAX72XX_MATRIX_DISPLAY)
+DisplayMAX72xxMatrix<DISPLAY_CS_PIN, MATRIX_WIDTH, MATRIX_HEIGHT> disp;
+#elif defined(WS2812_MATRIX_DISPLAY)
+CRGB leds[MATRIX_WIDTH * MATRIX_HEIGHT];
+DisplayWS2812Matrix<MATRIX_WIDTH, MATRIX_HEIGHT> disp(leds, BY_COLUMNS);
+#endif
+
+volatile uint32_t bench_sink; // приемник результатов, не дающий компилятору выбросить вычисления
+
+std::map<std::string, double> baseline;
+
+void loadBaseline(const char *file_name)
+{
+  std::ifstream in(file_name);
+  std::string line;
+  while (std::getline(in, line))
+  {
+    // config,kernel,iterations,ns_per_op,...
+    std::stringstream s(line);
+    std::string config, kernel, iterations, ns;
+    if (std::getline(s, config, ',') && std::getline(s, kernel, ',') && std::getline(s, iterations, ',') &&
+        std::getline(s, ns, ',') && config == CLOCK_CONFIG)
+    {
+      baseline[kernel] = atof(ns.c_str());
+    }
+  }
+}
+
+void printResult(const char *kernel, uint32_t iterations, double ns)
+{
+  printf("%s,%s,%u,%.2f,", CLOCK_CONFIG, kernel, iterations, ns);
+  std::map<std::string, double>::const_iterator b = baseline.find(kernel);
+  if (b != baseline.end() && b->second > 0)
+  {
+    printf("%.2f,%+.1f\n", b->second, (ns - b->second) * 100.0 / b->second);
+  }
+  else
+  {
+    printf(",\n");
+  }
+}
+
+/**
+ * @brief замер функции и вывод результата; количество повторов удваивается, пока замер не займет BENCH_MIN_TIME_NS
+ *
+ * @param kernel имя функции
+ * @param fn функция, выполняющая один вызов; параметр - номер повтора
+ */
+template <typename F>
+void bench(const char *kernel, F fn)
+{
+  typedef std::chrono::steady_clock Clock;
+  uint32_t iterations = 1;
+  double best = 0;
+  for (uint8_t run = 0; run < BENCH_RUNS;)
+  {
+    Clock::time_point start = Clock::now();
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+      fn(i);
+    }
+    uint64_t time = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+    if (time < BENCH_MIN_TIME_NS)
+    {
+      iterations *= 2;
+      continue;
+    }
+    double ns = (double)time / iterations;
+    best = (run == 0 || ns < best) ? ns : best;
+    run++;
+  }
+  printResult(kernel, iterations, best);
+}
+
+int main(int argc, char **argv)
+{
+  if (argc > 1)
+  {
+    loadBaseline(argv[1]);
+  }
+#if defined(TM1637_DISPLAY) || defined(MAX72XX_7SEGMENT_DISPLAY)
+  bench("showTime", [](uint32_t i)
+        { disp.showTime(i % 24, i % 60, i & 0x01); });
+#else
+  // на матричных экранах showTime() с SHOW_SECOND_COLUMN выводит и столбец секунд
+  bench("showTime", [](uint32_t i)
+        { disp.showTime(i % 24, i % 60, i % 60, i & 0x01); });
+  bench("setChar", [](uint32_t i)
+        { disp.setChar(i & 0x1F, GLYPH_0 + (i % 10), 5); });
+  bench("setColumn", [](uint32_t i)
+        { disp.setColumn(i % MATRIX_WIDTH, (uint8_t)i); });
+  bench("getDayOfWeek", [](uint32_t i)
+        { bench_sink = getDayOfWeek(i % 28 + 1, i % 12 + 1, 2000 + i % 100); });
+#ifdef USE_TICKER_FOR_DATE
+  bench("getDateString", [](uint32_t i)
+        {
+          static uint8_t date_str[decltype(disp)::TICKER_LENGTH];
+          disp.getDateString(date_str, sizeof(date_str), DateTime(2024, i % 12 + 1, i % 28 + 1, i % 24, i % 60, 0));
+          bench_sink = date_str[i % sizeof(date_str)]; });
+#endif
+#endif
+#ifdef WS2812_MATRIX_DISPLAY
+  bench("getLedIndexOfStrip", [](uint32_t i)
+        { bench_sink = disp.getLedIndexOfStrip(i & 0x07, i % MATRIX_WIDTH); });
+#endif
+  return (0);
+}
@@ -0,0 +1,12 @@
+# Запуск замеров функций отрисовки (цель bench): -DPROGRAMS=<программы замера> -DOUTPUT=<таблица CSV> [-DBASELINE=<таблица прошлого замера>]
+set(table "config,kernel,iterations,ns_per_op,baseline_ns_per_op,change_percent\n")
+foreach(program ${PROGRAMS})
+  execute_process(COMMAND ${program} ${BASELINE} OUTPUT_VARIABLE rows RESULT_VARIABLE result)
+  if(NOT result EQUAL 0)
+    message(FATAL_ERROR "${program}: ${result}")
+  endif()
+  string(APPEND table "${rows}")
+endforeach()
+file(WRITE ${OUTPUT} "${table}")
+message("${table}")
+message("таблица сохранена в ${OUTPUT}")
@@ -0,0 +1,262 @@
+/* Прослойка библиотеки DS3231 (https://github.com/NorthernWidget/DS3231) для сборки на компьютере;
+   Методы, которые использует скетч, повторяют библиотеку вплоть до последовательности транзакций I2C (например, setSecond() сбрасывает флаг OSF отдельным чтением и записью регистра состояния), поэтому модель шины записывает тот же обмен, что и на МК.
+*/
+#pragma once
+#include <Arduino.h>
+#include <Wire.h>
+
+#define CLOCK_ADDRESS 0x68
+#define SECONDS_FROM_1970_TO_2000 946684800
+
+class DateTime
+{
+public:
+  DateTime(uint32_t t = 0)
+  {
+    t -= SECONDS_FROM_1970_TO_2000;
+    ss = t % 60;
+    t /= 60;
+    mm = t % 60;
+    t /= 60;
+    hh = t % 24;
+    uint16_t days = t / 24;
+    uint8_t leap;
+    for (yOff = 0;; ++yOff)
+    {
+      leap = yOff % 4 == 0;
+      if (days < 365 + leap)
+      {
+        break;
+      }
+      days -= 365 + leap;
+    }
+    for (m = 1;; ++m)
+    {
+      uint8_t daysPerMonth = daysInMonth(m);
+      if (leap && m == 2)
+      {
+        ++daysPerMonth;
+      }
+      if (days < daysPerMonth)
+      {
+        break;
+      }
+      days -= daysPerMonth;
+    }
+    d = days + 1;
+  }
+
+  DateTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour = 0, uint8_t min = 0, uint8_t sec = 0)
+  {
+    if (year >= 2000)
+    {
+      year -= 2000;
+    }
+    yOff = year;
+    m = month;
+    d = day;
+    hh = hour;
+    mm = min;
+    ss = sec;
+  }
+
+  uint16_t year() const { return (2000 + yOff); }
+  uint8_t month() const { return (m); }
+  uint8_t day() const { return (d); }
+  uint8_t hour() const { return (hh); }
+  uint8_t minute() const { return (mm); }
+  uint8_t second() const { return (ss); }
+
+  uint32_t unixtime(void) const
+  {
+    uint16_t days = date2days(yOff, m, d);
+    return ((((days * 24L + hh) * 60 + mm) * 60 + ss) + SECONDS_FROM_1970_TO_2000);
+  }
+
+protected:
+  uint8_t yOff, m, d, hh, mm, ss;
+
+  static uint8_t daysInMonth(uint8_t month)
+  {
+    static const uint8_t days[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    return (days[month - 1]);
+  }
+
+  static uint16_t date2days(uint16_t y, uint8_t m, uint8_t d)
+  {
+    if (y >= 2000)
+    {
+      y -= 2000;
+    }
+    uint16_t days = d;
+    for (uint8_t i = 1; i < m; ++i)
+    {
+      days += daysInMonth(i);
+    }
+    if (m > 2 && y % 4 == 0)
+    {
+      ++days;
+    }
+    return (days + 365 * y + (y + 3) / 4 - 1);
+  }
+};
+
+class RTClib
+{
+private:
+  static uint8_t bcd2bin(uint8_t val) { return (val - 6 * (val >> 4)); }
+
+public:
+  static DateTime now(TwoWire &_Wire = Wire)
+  {
+    _Wire.beginTransmission(CLOCK_ADDRESS);
+    _Wire.write(0);
+    _Wire.endTransmission();
+    _Wire.requestFrom(CLOCK_ADDRESS, 7);
+    uint16_t ss = bcd2bin(_Wire.read() & 0x7F);
+    uint16_t mm = bcd2bin(_Wire.read());
+    uint16_t hh = bcd2bin(_Wire.read());
+    _Wire.read();
+    uint16_t d = bcd2bin(_Wire.read());
+    uint16_t m = bcd2bin(_Wire.read());
+    uint16_t y = bcd2bin(_Wire.read()) + 2000;
+    return (DateTime(y, m, d, hh, mm, ss));
+  }
+};
+
+class DS3231
+{
+private:
+  TwoWire &_Wire;
+
+  byte decToBcd(byte val) { return ((val / 10 * 16) + (val % 10)); }
+
+  void writeRegister(byte reg, byte value)
+  {
+    _Wire.beginTransmission(CLOCK_ADDRESS);
+    _Wire.write(reg);
+    _Wire.write(value);
+    _Wire.endTransmission();
+  }
+
+  byte readRegister(byte reg)
+  {
+    _Wire.beginTransmission(CLOCK_ADDRESS);
+    _Wire.write(reg);
+    _Wire.endTransmission();
+    _Wire.requestFrom(CLOCK_ADDRESS, 1);
+    return (_Wire.read());
+  }
+
+protected:
+  byte readControlByte(bool which) { return (readRegister(which ? 0x0f : 0x0e)); }
+  void writeControlByte(byte control, bool which) { writeRegister(which ? 0x0f : 0x0e, control); }
+
+public:
+  DS3231() : _Wire(Wire) {}
+  DS3231(TwoWire &w) : _Wire(w) {}
+
+  void setSecond(byte Second)
+  {
+    writeRegister(0x00, decToBcd(Second));
+    byte temp_buffer = readControlByte(1);
+    writeControlByte((temp_buffer & 0b01111111), 1);
+  }
+
+  void setMinute(byte Minute) { writeRegister(0x01, decToBcd(Minute)); }
+
+  void setHour(byte Hour)
+  {
+    byte temp_hour;
+    bool h12 = (readRegister(0x02) & 0b01000000);
+    if (h12)
+    {
+      bool am_pm = (Hour > 11);
+      temp_hour = Hour;
+      if (temp_hour > 11)
+      {
+        temp_hour = temp_hour - 12;
+      }
+      if (temp_hour == 0)
+      {
+        temp_hour = 12;
+      }
+      temp_hour = decToBcd(temp_hour) | (am_pm << 5) | 0b01000000;
+    }
+    else
+    {
+      temp_hour = decToBcd(Hour) & 0b10111111;
+    }
+    writeRegister(0x02, temp_hour);
+  }
+
+  void setDoW(byte DoW) { writeRegister(0x03, decToBcd(DoW)); }
+  void setDate(byte Date) { writeRegister(0x04, decToBcd(Date)); }
+  void setMonth(byte Month) { writeRegister(0x05, decToBcd(Month)); }
+  void setYear(byte Year) { writeRegister(0x06, decToBcd(Year)); }
+
+  void setClockMode(bool h12)
+  {
+    byte temp_buffer = readRegister(0x02);
+    if (h12)
+    {
+      temp_buffer = temp_buffer | 0b01000000;
+    }
+    else
+    {
+      temp_buffer = temp_buffer & 0b10111111;
+    }
+    writeRegister(0x02, temp_buffer);
+  }
+
+  float getTemperature()
+  {
+    float temp3231;
+    _Wire.beginTransmission(CLOCK_ADDRESS);
+    _Wire.write(0x11);
+    _Wire.endTransmission();
+    _Wire.requestFrom(CLOCK_ADDRESS, 2);
+    if (_Wire.available())
+    {
+      byte tMSB = _Wire.read();
+      byte tLSB = _Wire.read();
+      int16_t itemp = (tMSB << 8 | (tLSB & 0xC0));
+      temp3231 = ((float)itemp / 256.0);
+    }
+    else
+    {
+      temp3231 = -9999;
+    }
+    return (temp3231);
+  }
+
+  void enableOscillator(bool TF, bool battery, byte frequency)
+  {
+    if (frequency > 3)
+    {
+      frequency = 3;
+    }
+    byte temp_buffer = readControlByte(0) & 0b11100111;
+    if (battery)
+    {
+      temp_buffer = temp_buffer | 0b01000000;
+    }
+    else
+    {
+      temp_buffer = temp_buffer & 0b10111111;
+    }
+    if (TF)
+    {
+      temp_buffer = temp_buffer & 0b01111011;
+    }
+    else
+    {
+      temp_buffer = temp_buffer | 0b10000000;
+    }
+    frequency = frequency << 3;
+    temp_buffer = temp_buffer | frequency;
+    writeControlByte(temp_buffer, 0);
+  }
+
+  bool oscillatorCheck() { return (!(readControlByte(1) & 0b10000000)); }
+};
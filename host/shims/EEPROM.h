@@ -0,0 +1,51 @@
+/* Прослойка библиотеки EEPROM для сборки на компьютере; повторяет EEPROM.h ядра Arduino AVR, ячейки хранит модель МК, которая записывает каждую запись (см. sim::eepromWrites()) */
+#pragma once
+#include <Arduino.h>
+
+struct EERef
+{
+  int index;
+  EERef(const int index) : index(index) {}
+  uint8_t operator*() const { return (sim::eepromRead(index)); }
+  operator uint8_t() const { return (**this); }
+  EERef &operator=(const EERef &ref) { return (*this = *ref); }
+  EERef &operator=(uint8_t in)
+  {
+    sim::eepromWrite(index, in);
+    return (*this);
+  }
+  EERef &update(uint8_t in) { return ((in != **this) ? *this = in : *this); }
+};
+
+struct EEPROMClass
+{
+  EERef operator[](const int idx) { return (idx); }
+  uint8_t read(int idx) { return (EERef(idx)); }
+  void write(int idx, uint8_t val) { (EERef(idx)) = val; }
+  void update(int idx, uint8_t val) { EERef(idx).update(val); }
+  uint16_t length() { return (E2END + 1); }
+
+  template <typename T>
+  T &get(int idx, T &t)
+  {
+    uint8_t *ptr = (uint8_t *)&t;
+    for (int count = sizeof(T); count; --count, ++idx)
+    {
+      *ptr++ = read(idx);
+    }
+    return (t);
+  }
+
+  template <typename T>
+  const T &put(int idx, const T &t)
+  {
+    const uint8_t *ptr = (const uint8_t *)&t;
+    for (int count = sizeof(T); count; --count, ++idx)
+    {
+      update(idx, *ptr++);
+    }
+    return (t);
+  }
+};
+
+static EEPROMClass EEPROM;
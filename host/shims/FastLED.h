@@ -0,0 +1,196 @@
+/* Прослойка библиотеки FastLED (https://github.com/FastLED/FastLED) для сборки на компьютере;
+   CRGB и используемые скетчем функции повторяют библиотеку. show() передает массивы светодиодов модели: для трехпроводных светодиодов (WS2812 и т.п.) на время передачи запрещаются прерывания, а счетчик millis() после нее поправляется так же, как это делает FastLED на AVR; модель записывает цвета в порядке R, G, B без учета порядка EOrder, яркость записывается отдельно.
+*/
+#pragma once
+#include <Arduino.h>
+
+inline uint8_t qadd8(uint8_t i, uint8_t j)
+{
+  unsigned int t = i + j;
+  return ((t > 255) ? 255 : (uint8_t)t);
+}
+
+inline uint8_t scale8(uint8_t i, uint8_t scale) { return ((uint8_t)(((uint16_t)i * (1 + (uint16_t)scale)) >> 8)); }
+
+inline uint8_t scale8_video(uint8_t i, uint8_t scale)
+{
+  return ((uint8_t)((((int)i * (int)scale) >> 8) + ((i && scale) ? 1 : 0)));
+}
+
+struct CRGB
+{
+  union
+  {
+    struct
+    {
+      uint8_t r;
+      uint8_t g;
+      uint8_t b;
+    };
+    uint8_t raw[3];
+  };
+
+  typedef enum
+  {
+    Black = 0x000000,
+    Blue = 0x0000FF,
+    Green = 0x008000,
+    Lime = 0x00FF00,
+    Red = 0xFF0000,
+    White = 0xFFFFFF,
+    Yellow = 0xFFFF00
+  } HTMLColorCode;
+
+  CRGB() {}
+  CRGB(uint8_t ir, uint8_t ig, uint8_t ib) : r(ir), g(ig), b(ib) {}
+  CRGB(uint32_t colorcode) : r((colorcode >> 16) & 0xFF), g((colorcode >> 8) & 0xFF), b((colorcode >> 0) & 0xFF) {}
+  CRGB(HTMLColorCode colorcode) : r((colorcode >> 16) & 0xFF), g((colorcode >> 8) & 0xFF), b((colorcode >> 0) & 0xFF) {}
+
+  CRGB &nscale8_video(uint8_t scaledown)
+  {
+    r = scale8_video(r, scaledown);
+    g = scale8_video(g, scaledown);
+    b = scale8_video(b, scaledown);
+    return (*this);
+  }
+
+  CRGB &nscale8(uint8_t scaledown)
+  {
+    r = scale8(r, scaledown);
+    g = scale8(g, scaledown);
+    b = scale8(b, scaledown);
+    return (*this);
+  }
+
+  bool operator==(const CRGB &rhs) const { return (r == rhs.r && g == rhs.g && b == rhs.b); }
+  bool operator!=(const CRGB &rhs) const { return (!(*this == rhs)); }
+};
+
+enum EOrder
+{
+  RGB = 0012,
+  RBG = 0021,
+  GRB = 0102,
+  GBR = 0120,
+  BRG = 0201,
+  BGR = 0210
+};
+
+enum ESPIChipsets
+{
+  LPD6803,
+  LPD8806,
+  WS2801,
+  WS2803,
+  SM16716,
+  P9813,
+  APA102,
+  SK9822,
+  DOTSTAR
+};
+
+// трехпроводные светодиоды; для модели важен только способ передачи, поэтому все типы одинаковы
+#define FASTLED_SIM_CLOCKLESS(name)                     \
+  template <uint8_t DATA_PIN, EOrder RGB_ORDER = RGB> \
+  class name                                          \
+  {                                                   \
+  };
+FASTLED_SIM_CLOCKLESS(SM16703)
+FASTLED_SIM_CLOCKLESS(TM1829)
+FASTLED_SIM_CLOCKLESS(TM1812)
+FASTLED_SIM_CLOCKLESS(TM1809)
+FASTLED_SIM_CLOCKLESS(TM1804)
+FASTLED_SIM_CLOCKLESS(TM1803)
+FASTLED_SIM_CLOCKLESS(UCS1903)
+FASTLED_SIM_CLOCKLESS(UCS1903B)
+FASTLED_SIM_CLOCKLESS(UCS1904)
+FASTLED_SIM_CLOCKLESS(UCS2903)
+FASTLED_SIM_CLOCKLESS(WS2812)
+FASTLED_SIM_CLOCKLESS(WS2852)
+FASTLED_SIM_CLOCKLESS(WS2812B)
+FASTLED_SIM_CLOCKLESS(GS1903)
+FASTLED_SIM_CLOCKLESS(SK6812)
+FASTLED_SIM_CLOCKLESS(SK6822)
+FASTLED_SIM_CLOCKLESS(APA106)
+FASTLED_SIM_CLOCKLESS(PL9823)
+FASTLED_SIM_CLOCKLESS(WS2811)
+FASTLED_SIM_CLOCKLESS(WS2813)
+FASTLED_SIM_CLOCKLESS(APA104)
+FASTLED_SIM_CLOCKLESS(WS2811_400)
+FASTLED_SIM_CLOCKLESS(GE8822)
+FASTLED_SIM_CLOCKLESS(GW6205)
+FASTLED_SIM_CLOCKLESS(GW6205_400)
+FASTLED_SIM_CLOCKLESS(LPD1886)
+FASTLED_SIM_CLOCKLESS(LPD1886_8BIT)
+#undef FASTLED_SIM_CLOCKLESS
+
+template <uint8_t DATA_PIN>
+class NEOPIXEL
+{
+};
+
+class CFastLED
+{
+private:
+  struct Controller
+  {
+    CRGB *data;
+    int count;
+    uint8_t pin;
+    bool clockless;
+  };
+
+  static const uint8_t MAX_CONTROLLERS = 4;
+  Controller controllers[MAX_CONTROLLERS];
+  uint8_t controller_count = 0;
+  uint8_t brightness = 255;
+
+  CFastLED &add(CRGB *data, int count, uint8_t pin, bool clockless)
+  {
+    if (controller_count < MAX_CONTROLLERS)
+    {
+      Controller c = {data, count, pin, clockless};
+      controllers[controller_count++] = c;
+    }
+    return (*this);
+  }
+
+public:
+  template <ESPIChipsets CHIPSET, uint8_t DATA_PIN, uint8_t CLOCK_PIN, EOrder RGB_ORDER>
+  CFastLED &addLeds(CRGB *data, int nLeds)
+  {
+    return (add(data, nLeds, DATA_PIN, false));
+  }
+
+  template <ESPIChipsets CHIPSET, EOrder RGB_ORDER>
+  CFastLED &addLeds(CRGB *data, int nLeds)
+  {
+    return (add(data, nLeds, 11, false)); // аппаратный SPI: MOSI - D11
+  }
+
+  template <template <uint8_t DATA_PIN, EOrder RGB_ORDER> class CHIPSET, uint8_t DATA_PIN, EOrder RGB_ORDER>
+  CFastLED &addLeds(CRGB *data, int nLeds)
+  {
+    return (add(data, nLeds, DATA_PIN, true));
+  }
+
+  template <template <uint8_t DATA_PIN> class CHIPSET, uint8_t DATA_PIN>
+  CFastLED &addLeds(CRGB *data, int nLeds)
+  {
+    return (add(data, nLeds, DATA_PIN, true));
+  }
+
+  void setBrightness(uint8_t scale) { brightness = scale; }
+  uint8_t getBrightness() { return (brightness); }
+
+  void show()
+  {
+    for (uint8_t i = 0; i < controller_count; i++)
+    {
+      const Controller &c = controllers[i];
+      sim::ledStripShow(c.pin, (const uint8_t *)c.data, (uint16_t)c.count, brightness, c.clockless);
+    }
+  }
+};
+
+extern CFastLED FastLED;
@@ -0,0 +1,30 @@
+/* Прослойка HardwareSerial.h для сборки на компьютере;
+   Serial работает через модель UART: передача идет с заданной скоростью через буфер на 64 байта (при заполнении буфера write() ждет), принятые байты подаются тестом (см. sim::serialInput()).
+*/
+#pragma once
+#include "Stream.h"
+#include "../sim/mcu.h"
+
+#define SERIAL_8N1 0x06
+
+class HardwareSerial : public Stream
+{
+public:
+  void begin(unsigned long baud) { sim::serialBegin(baud); }
+  void begin(unsigned long baud, uint8_t) { sim::serialBegin(baud); }
+  void end() { sim::serialEnd(); }
+  int available() { return (sim::serialAvailable()); }
+  int peek() { return (sim::serialPeek()); }
+  int read() { return (sim::serialRead()); }
+  int availableForWrite() { return (sim::serialAvailableForWrite()); }
+  void flush() { sim::serialFlush(); }
+  size_t write(uint8_t c)
+  {
+    sim::serialWrite(c);
+    return (1);
+  }
+  using Print::write;
+  operator bool() { return (true); }
+};
+
+extern HardwareSerial Serial;
@@ -0,0 +1,71 @@
+/* Прослойка библиотеки OneWire (https://github.com/PaulStoffregen/OneWire) для сборки на компьютере;
+   Интерфейс и crc8() повторяют библиотеку; обмен выполняет модель шины с одним датчиком DS18B20, которая, как и библиотека, запрещает прерывания на время каждого бита.
+*/
+#pragma once
+#include <Arduino.h>
+
+class OneWire
+{
+private:
+  uint8_t pin;
+  bool search_done = false;
+
+public:
+  OneWire(uint8_t pin) : pin(pin) { pinMode(pin, INPUT); }
+
+  uint8_t reset(void) { return (sim::oneWireReset(pin)); }
+
+  void select(const uint8_t rom[8])
+  {
+    write(0x55);
+    for (uint8_t i = 0; i < 8; i++)
+    {
+      write(rom[i]);
+    }
+  }
+
+  void skip() { write(0xCC); }
+
+  void write(uint8_t v, uint8_t power = 0)
+  {
+    (void)power;
+    sim::oneWireWrite(pin, v);
+  }
+
+  uint8_t read() { return (sim::oneWireRead(pin)); }
+
+  void reset_search() { search_done = false; }
+
+  // как и в библиотеке, после последнего найденного устройства поиск возвращает false и начинается заново
+  bool search(uint8_t *newAddr, bool search_mode = true)
+  {
+    (void)search_mode;
+    if (search_done)
+    {
+      search_done = false;
+      return (false);
+    }
+    search_done = sim::oneWireSearch(pin, newAddr, true);
+    return (search_done);
+  }
+
+  static uint8_t crc8(const uint8_t *addr, uint8_t len)
+  {
+    uint8_t crc = 0;
+    while (len--)
+    {
+      uint8_t inbyte = *addr++;
+      for (uint8_t i = 8; i; i--)
+      {
+        uint8_t mix = (crc ^ inbyte) & 0x01;
+        crc >>= 1;
+        if (mix)
+        {
+          crc ^= 0x8C;
+        }
+        inbyte >>= 1;
+      }
+    }
+    return (crc);
+  }
+};
@@ -0,0 +1,139 @@
+/* Прослойка Print.h для сборки на компьютере; вывод чисел и строк повторяет класс Print ядра Arduino */
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+class __FlashStringHelper;
+
+class Print
+{
+private:
+  size_t printNumber(unsigned long long n, uint8_t base)
+  {
+    char buf[8 * sizeof(n) + 1];
+    char *str = &buf[sizeof(buf) - 1];
+    *str = '\0';
+    if (base < 2)
+    {
+      base = 10;
+    }
+    do
+    {
+      char c = (char)(n % base);
+      n /= base;
+      *--str = (char)(c < 10 ? c + '0' : c + 'A' - 10);
+    } while (n);
+    return (write(str));
+  }
+
+  size_t printSigned(long long n, int base)
+  {
+    if (base == 10 && n < 0)
+    {
+      size_t t = print('-');
+      return (printNumber(0ull - (unsigned long long)n, 10) + t);
+    }
+    return (printNumber((unsigned long long)n, (uint8_t)base));
+  }
+
+  size_t printFloat(double number, uint8_t digits)
+  {
+    size_t n = 0;
+    if (isnan(number))
+    {
+      return (print("nan"));
+    }
+    if (isinf(number))
+    {
+      return (print("inf"));
+    }
+    if (number > 4294967040.0 || number < -4294967040.0)
+    {
+      return (print("ovf"));
+    }
+    if (number < 0.0)
+    {
+      n += print('-');
+      number = -number;
+    }
+    double rounding = 0.5;
+    for (uint8_t i = 0; i < digits; ++i)
+    {
+      rounding /= 10.0;
+    }
+    number += rounding;
+    unsigned long int_part = (unsigned long)number;
+    double remainder = number - (double)int_part;
+    n += print(int_part);
+    if (digits > 0)
+    {
+      n += print('.');
+    }
+    while (digits-- > 0)
+    {
+      remainder *= 10.0;
+      unsigned int to_print = (unsigned int)remainder;
+      n += print(to_print);
+      remainder -= to_print;
+    }
+    return (n);
+  }
+
+public:
+  virtual ~Print() {}
+
+  virtual size_t write(uint8_t) = 0;
+  virtual size_t write(const uint8_t *buffer, size_t size)
+  {
+    size_t n = 0;
+    while (size--)
+    {
+      if (write(*buffer++))
+      {
+        n++;
+      }
+      else
+      {
+        break;
+      }
+    }
+    return (n);
+  }
+  size_t write(const char *str) { return ((str == NULL) ? 0 : write((const uint8_t *)str, strlen(str))); }
+  size_t write(const char *buffer, size_t size) { return (write((const uint8_t *)buffer, size)); }
+  virtual int availableForWrite() { return (0); }
+  virtual void flush() {}
+
+  size_t print(const __FlashStringHelper *s) { return (write((const char *)s)); }
+  size_t print(const char s[]) { return (write(s)); }
+  size_t print(char c) { return (write((uint8_t)c)); }
+  size_t print(unsigned char n, int base = DEC) { return (printNumber(n, (uint8_t)base)); }
+  size_t print(int n, int base = DEC) { return (printSigned(n, base)); }
+  size_t print(unsigned int n, int base = DEC) { return (printNumber(n, (uint8_t)base)); }
+  size_t print(long n, int base = DEC) { return (printSigned(n, base)); }
+  size_t print(unsigned long n, int base = DEC) { return (printNumber(n, (uint8_t)base)); }
+  size_t print(long long n, int base = DEC) { return (printSigned(n, base)); }
+  size_t print(unsigned long long n, int base = DEC) { return (printNumber(n, (uint8_t)base)); }
+  size_t print(double n, int digits = 2) { return (printFloat(n, (uint8_t)digits)); }
+
+  size_t println(void) { return (write("\r\n")); }
+  template <typename T>
+  size_t println(T value)
+  {
+    size_t n = print(value);
+    return (n + println());
+  }
+  template <typename T>
+  size_t println(T value, int base)
+  {
+    size_t n = print(value, base);
+    return (n + println());
+  }
+};
@@ -0,0 +1,60 @@
+/* Прослойка библиотеки TM1637 (https://github.com/avishorp/TM1637) для сборки на компьютере;
+   Кодировка цифр и байт управления повторяют библиотеку; передачу выполняет модель экрана, которая тратит на нее то же время, что и побитовый обмен библиотеки с задержкой bitDelay, и записывает каждый переданный кадр.
+*/
+#pragma once
+#include <Arduino.h>
+
+#define SEG_A 0b00000001
+#define SEG_B 0b00000010
+#define SEG_C 0b00000100
+#define SEG_D 0b00001000
+#define SEG_E 0b00010000
+#define SEG_F 0b00100000
+#define SEG_G 0b01000000
+#define SEG_DP 0b10000000
+
+#define DEFAULT_BIT_DELAY 100
+
+class TM1637Display
+{
+private:
+  uint8_t m_pinClk;
+  uint8_t m_pinDIO;
+  uint8_t m_brightness = 0;
+  unsigned int m_bitDelay;
+
+public:
+  TM1637Display(uint8_t pinClk, uint8_t pinDIO, unsigned int bitDelay = DEFAULT_BIT_DELAY)
+  {
+    m_pinClk = pinClk;
+    m_pinDIO = pinDIO;
+    m_bitDelay = bitDelay;
+    pinMode(m_pinClk, INPUT);
+    pinMode(m_pinDIO, INPUT);
+    digitalWrite(m_pinClk, LOW);
+    digitalWrite(m_pinDIO, LOW);
+  }
+
+  void setBrightness(uint8_t brightness, bool on = true)
+  {
+    m_brightness = (brightness & 0x7) | (on ? 0x08 : 0x00);
+  }
+
+  void setSegments(const uint8_t segments[], uint8_t length = 4, uint8_t pos = 0)
+  {
+    sim::tm1637Write(m_pinClk, m_pinDIO, pos & 0x03, segments, length, m_brightness, m_bitDelay);
+  }
+
+  void clear()
+  {
+    uint8_t data[] = {0, 0, 0, 0};
+    setSegments(data);
+  }
+
+  uint8_t encodeDigit(uint8_t digit)
+  {
+    static const uint8_t digitToSegment[] = {0x3f, 0x06, 0x5b, 0x4f, 0x66, 0x6d, 0x7d, 0x07,
+                                             0x7f, 0x6f, 0x77, 0x7c, 0x39, 0x5e, 0x79, 0x71};
+    return (digitToSegment[digit & 0x0f]);
+  }
+};
@@ -0,0 +1,88 @@
+/* Прослойка библиотеки Wire для сборки на компьютере;
+   Интерфейс повторяет Wire ядра Arduino AVR (буферы по 32 байта, коды endTransmission()), транзакции выполняет модель шины I2C, к которой подключена модель DS3231 (адрес 0x68). Обмен занимает столько же времени, сколько на МК при частоте шины 100 кГц, и, как и на МК, требует разрешенных прерываний.
+*/
+#pragma once
+#include <Arduino.h>
+#include "Stream.h"
+
+#define BUFFER_LENGTH 32
+#define WIRE_HAS_END 1
+
+class TwoWire : public Stream
+{
+private:
+  uint8_t rx_buffer[BUFFER_LENGTH];
+  uint8_t rx_index = 0;
+  uint8_t rx_length = 0;
+  uint8_t tx_buffer[BUFFER_LENGTH];
+  uint8_t tx_length = 0;
+  uint8_t tx_address = 0;
+  bool transmitting = false;
+
+public:
+  void begin() { sim::i2cBegin(); }
+  void end() {}
+  void setClock(uint32_t clock) { sim::i2cSetClock(clock); }
+
+  void beginTransmission(uint8_t address)
+  {
+    transmitting = true;
+    tx_address = address;
+    tx_length = 0;
+  }
+  void beginTransmission(int address) { beginTransmission((uint8_t)address); }
+
+  uint8_t endTransmission(uint8_t sendStop = true)
+  {
+    (void)sendStop;
+    transmitting = false;
+    return (sim::i2cWrite(tx_address, tx_buffer, tx_length));
+  }
+
+  uint8_t requestFrom(uint8_t address, uint8_t quantity, uint8_t sendStop = true)
+  {
+    (void)sendStop;
+    if (quantity > BUFFER_LENGTH)
+    {
+      quantity = BUFFER_LENGTH;
+    }
+    rx_index = 0;
+    rx_length = sim::i2cRead(address, rx_buffer, quantity);
+    return (rx_length);
+  }
+  uint8_t requestFrom(int address, int quantity, int sendStop = 1)
+  {
+    return (requestFrom((uint8_t)address, (uint8_t)quantity, (uint8_t)sendStop));
+  }
+
+  size_t write(uint8_t data)
+  {
+    if (!transmitting || tx_length >= BUFFER_LENGTH)
+    {
+      return (0);
+    }
+    tx_buffer[tx_length++] = data;
+    return (1);
+  }
+  size_t write(const uint8_t *data, size_t quantity)
+  {
+    size_t n = 0;
+    while (quantity-- && write(*data++))
+    {
+      n++;
+    }
+    return (n);
+  }
+  size_t write(unsigned long n) { return (write((uint8_t)n)); }
+  size_t write(long n) { return (write((uint8_t)n)); }
+  size_t write(unsigned int n) { return (write((uint8_t)n)); }
+  size_t write(int n) { return (write((uint8_t)n)); }
+  using Print::write;
+
+  int available() { return (rx_length - rx_index); }
+  int read() { return ((rx_index < rx_length) ? rx_buffer[rx_index++] : -1); }
+  int peek() { return ((rx_index < rx_length) ? rx_buffer[rx_index] : -1); }
+  void flush() {}
+};
+
+extern TwoWire Wire;
@@ -0,0 +1,18 @@
+/* Прослойка avr/interrupt.h для сборки на компьютере;
+   Обработчик, объявленный через ISR(), - обычная функция с именем вектора; модель МК вызывает ее при наступлении прерывания (векторы без обработчика приводят к остановке модели, как переход на __bad_interrupt на AVR). Векторы, занятые ядром Arduino (INT0/INT1 для attachInterrupt(), Timer0, UART, TWI, Timer2 для tone()), определены в модели, поэтому их повторное определение в скетче, как и на AVR, дает ошибку компоновки.
+*/
+#pragma once
+#include <avr/io.h>
+
+#define ISR(vector, ...)       \
+  extern "C" void vector(void); \
+  void vector(void)
+#define ISR_BLOCK
+#define ISR_NOBLOCK
+#define ISR_NAKED
+#define EMPTY_INTERRUPT(vector) \
+  extern "C" void vector(void); \
+  void vector(void) {}
+
+#define sei() sim::irqEnable()
+#define cli() sim::irqDisable()
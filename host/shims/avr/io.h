@@ -0,0 +1,187 @@
+/* Прослойка avr/io.h для сборки на компьютере;
+   Регистры ATmega328P, к которым обращается код часов, представлены объектами SimReg8/SimReg16 (см. host/sim/mcu.h) - чтение и запись выполняет модель МК. Имена регистров - макросы, как и в avr-libc, поэтому проверки вида #if defined(PCICR) работают так же, как на AVR.
+*/
+#pragma once
+#include <stdint.h>
+#include "../../sim/mcu.h"
+
+#define __AVR__ 1
+#define __AVR_ATmega328P__ 1
+
+#define _BV(bit) (1 << (bit))
+
+#define RAMSTART 0x100
+#define RAMEND 0x8FF
+#define E2END 0x3FF
+#define FLASHEND 0x7FFF
+
+#define SIM_REG8(name, id) const SimReg8 sim_reg_##name = {sim::id};
+#define SIM_REG16(name, id) const SimReg16 sim_reg_##name = {sim::id};
+
+SIM_REG8(SREG, REG_SREG)
+SIM_REG16(SP, REG_SP)
+SIM_REG8(MCUSR, REG_MCUSR)
+SIM_REG8(SMCR, REG_SMCR)
+SIM_REG8(WDTCSR, REG_WDTCSR)
+SIM_REG8(EICRA, REG_EICRA)
+SIM_REG8(EIMSK, REG_EIMSK)
+SIM_REG8(EIFR, REG_EIFR)
+SIM_REG8(PCICR, REG_PCICR)
+SIM_REG8(PCIFR, REG_PCIFR)
+SIM_REG8(PCMSK0, REG_PCMSK0)
+SIM_REG8(PCMSK1, REG_PCMSK1)
+SIM_REG8(PCMSK2, REG_PCMSK2)
+SIM_REG8(ADCSRA, REG_ADCSRA)
+SIM_REG8(TCCR0A, REG_TCCR0A)
+SIM_REG8(TCCR0B, REG_TCCR0B)
+SIM_REG8(TCNT0, REG_TCNT0)
+SIM_REG8(TIMSK0, REG_TIMSK0)
+SIM_REG8(TIFR0, REG_TIFR0)
+SIM_REG8(TCCR1A, REG_TCCR1A)
+SIM_REG8(TCCR1B, REG_TCCR1B)
+SIM_REG8(TCCR1C, REG_TCCR1C)
+SIM_REG16(TCNT1, REG_TCNT1)
+SIM_REG16(OCR1A, REG_OCR1A)
+SIM_REG16(OCR1B, REG_OCR1B)
+SIM_REG16(ICR1, REG_ICR1)
+SIM_REG8(TIMSK1, REG_TIMSK1)
+SIM_REG8(TIFR1, REG_TIFR1)
+
+#define SREG sim_reg_SREG
+#define SP sim_reg_SP
+#define MCUSR sim_reg_MCUSR
+#define SMCR sim_reg_SMCR
+#define WDTCSR sim_reg_WDTCSR
+#define EICRA sim_reg_EICRA
+#define EIMSK sim_reg_EIMSK
+#define EIFR sim_reg_EIFR
+#define PCICR sim_reg_PCICR
+#define PCIFR sim_reg_PCIFR
+#define PCMSK0 sim_reg_PCMSK0
+#define PCMSK1 sim_reg_PCMSK1
+#define PCMSK2 sim_reg_PCMSK2
+#define ADCSRA sim_reg_ADCSRA
+#define TCCR0A sim_reg_TCCR0A
+#define TCCR0B sim_reg_TCCR0B
+#define TCNT0 sim_reg_TCNT0
+#define TIMSK0 sim_reg_TIMSK0
+#define TIFR0 sim_reg_TIFR0
+#define TCCR1A sim_reg_TCCR1A
+#define TCCR1B sim_reg_TCCR1B
+#define TCCR1C sim_reg_TCCR1C
+#define TCNT1 sim_reg_TCNT1
+#define OCR1A sim_reg_OCR1A
+#define OCR1B sim_reg_OCR1B
+#define ICR1 sim_reg_ICR1
+#define TIMSK1 sim_reg_TIMSK1
+#define TIFR1 sim_reg_TIFR1
+
+// SREG
+#define SREG_I 7
+// MCUSR
+#define WDRF 3
+#define BORF 2
+#define EXTRF 1
+#define PORF 0
+// SMCR
+#define SM2 3
+#define SM1 2
+#define SM0 1
+#define SE 0
+// WDTCSR
+#define WDIF 7
+#define WDIE 6
+#define WDP3 5
+#define WDCE 4
+#define WDE 3
+#define WDP2 2
+#define WDP1 1
+#define WDP0 0
+// EICRA, EIMSK, EIFR
+#define ISC11 3
+#define ISC10 2
+#define ISC01 1
+#define ISC00 0
+#define INT1 1
+#define INT0 0
+#define INTF1 1
+#define INTF0 0
+// PCICR, PCIFR
+#define PCIE2 2
+#define PCIE1 1
+#define PCIE0 0
+#define PCIF2 2
+#define PCIF1 1
+#define PCIF0 0
+// ADCSRA
+#define ADEN 7
+#define ADSC 6
+#define ADATE 5
+#define ADIF 4
+#define ADIE 3
+#define ADPS2 2
+#define ADPS1 1
+#define ADPS0 0
+// Timer0
+#define WGM01 1
+#define WGM00 0
+#define CS02 2
+#define CS01 1
+#define CS00 0
+#define OCIE0B 2
+#define OCIE0A 1
+#define TOIE0 0
+#define OCF0B 2
+#define OCF0A 1
+#define TOV0 0
+// Timer1
+#define COM1A1 7
+#define COM1A0 6
+#define COM1B1 5
+#define COM1B0 4
+#define WGM11 1
+#define WGM10 0
+#define ICNC1 7
+#define ICES1 6
+#define WGM13 4
+#define WGM12 3
+#define CS12 2
+#define CS11 1
+#define CS10 0
+#define ICIE1 5
+#define OCIE1B 2
+#define OCIE1A 1
+#define TOIE1 0
+#define ICF1 5
+#define OCF1B 2
+#define OCF1A 1
+#define TOV1 0
+
+// векторы прерываний ATmega328P
+#define _VECTOR(N) __vector_##N
+#define INT0_vect _VECTOR(1)
+#define INT1_vect _VECTOR(2)
+#define PCINT0_vect _VECTOR(3)
+#define PCINT1_vect _VECTOR(4)
+#define PCINT2_vect _VECTOR(5)
+#define WDT_vect _VECTOR(6)
+#define TIMER2_COMPA_vect _VECTOR(7)
+#define TIMER2_COMPB_vect _VECTOR(8)
+#define TIMER2_OVF_vect _VECTOR(9)
+#define TIMER1_CAPT_vect _VECTOR(10)
+#define TIMER1_COMPA_vect _VECTOR(11)
+#define TIMER1_COMPB_vect _VECTOR(12)
+#define TIMER1_OVF_vect _VECTOR(13)
+#define TIMER0_COMPA_vect _VECTOR(14)
+#define TIMER0_COMPB_vect _VECTOR(15)
+#define TIMER0_OVF_vect _VECTOR(16)
+#define SPI_STC_vect _VECTOR(17)
+#define USART_RX_vect _VECTOR(18)
+#define USART_UDRE_vect _VECTOR(19)
+#define USART_TX_vect _VECTOR(20)
+#define ADC_vect _VECTOR(21)
+#define EE_READY_vect _VECTOR(22)
+#define ANALOG_COMP_vect _VECTOR(23)
+#define TWI_vect _VECTOR(24)
+#define SPM_READY_vect _VECTOR(25)
+#define _VECTORS_SIZE 104
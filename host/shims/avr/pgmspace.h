@@ -0,0 +1,47 @@
+/* Прослойка avr/pgmspace.h для сборки на компьютере;
+   Память программ и ОЗУ на компьютере общие, поэтому PROGMEM ничего не делает, а функции pgm_read_*() читают ровно столько байт, сколько читают на AVR.
+*/
+#pragma once
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+#define PGM_P const char *
+#define PGM_VOID_P const void *
+#define PSTR(s) (s)
+
+inline uint8_t pgm_read_byte(const void *addr) { return (*(const uint8_t *)addr); }
+inline uint16_t pgm_read_word(const void *addr)
+{
+  uint16_t result;
+  memcpy(&result, addr, sizeof(result));
+  return (result);
+}
+inline uint32_t pgm_read_dword(const void *addr)
+{
+  uint32_t result;
+  memcpy(&result, addr, sizeof(result));
+  return (result);
+}
+inline float pgm_read_float(const void *addr)
+{
+  float result;
+  memcpy(&result, addr, sizeof(result));
+  return (result);
+}
+inline void *pgm_read_ptr(const void *addr)
+{
+  void *result;
+  memcpy(&result, addr, sizeof(result));
+  return (result);
+}
+#define pgm_read_byte_near(addr) pgm_read_byte(addr)
+#define pgm_read_word_near(addr) pgm_read_word(addr)
+#define pgm_read_dword_near(addr) pgm_read_dword(addr)
+
+#define memcpy_P memcpy
+#define strlen_P strlen
+#define strcpy_P strcpy
+#define strncpy_P strncpy
+#define strcmp_P strcmp
+#define strncmp_P strncmp
@@ -0,0 +1,36 @@
+/* Прослойка avr/wdt.h для сборки на компьютере */
+#pragma once
+#include <avr/io.h>
+
+#define WDTO_15MS 0
+#define WDTO_30MS 1
+#define WDTO_60MS 2
+#define WDTO_120MS 3
+#define WDTO_250MS 4
+#define WDTO_500MS 5
+#define WDTO_1S 6
+#define WDTO_2S 7
+#define WDTO_4S 8
+#define WDTO_8S 9
+
+#define wdt_reset() sim::wdtReset()
+
+inline void wdt_enable(uint8_t value)
+{
+  uint8_t sreg = SREG;
+  sim::irqDisable();
+  sim::wdtReset();
+  WDTCSR = _BV(WDCE) | _BV(WDE);
+  WDTCSR = _BV(WDE) | ((value & 0x08) ? _BV(WDP3) : 0) | (value & 0x07);
+  SREG = sreg;
+}
+
+inline void wdt_disable()
+{
+  uint8_t sreg = SREG;
+  sim::irqDisable();
+  sim::wdtReset();
+  WDTCSR = _BV(WDCE) | _BV(WDE);
+  WDTCSR = 0;
+  SREG = sreg;
+}
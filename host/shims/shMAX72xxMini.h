@@ -0,0 +1,150 @@
+/* Прослойка библиотеки shMAX72xxMini (https://github.com/VAleSh-Soft/shMAX72xxMini) для сборки на компьютере;
+   Буфер строк и порядок команд повторяют библиотеку: данные передаются на экран только методом update(), по одной команде на строку для всех модулей цепочки; модель экрана записывает кадр после каждого обновления, изменения яркости и режима отключения.
+*/
+#pragma once
+#include <Arduino.h>
+
+#define MAX72XX_NOOP 0x00
+#define MAX72XX_DECODEMODE 0x09
+#define MAX72XX_INTENSITY 0x0A
+#define MAX72XX_SCANLIMIT 0x0B
+#define MAX72XX_SHUTDOWN 0x0C
+#define MAX72XX_DISPLAYTEST 0x0F
+
+template <uint8_t cs_pin, uint8_t numDevices>
+class shMAX72xxMini
+{
+private:
+  uint8_t buf[numDevices * 8];
+
+  void sendCmd(uint8_t addr, uint8_t reg, uint8_t data)
+  {
+    uint16_t words[numDevices];
+    for (uint8_t i = 0; i < numDevices; i++)
+    {
+      words[i] = (i == addr) ? (uint16_t)((reg << 8) | data) : MAX72XX_NOOP;
+    }
+    sim::max72xxFrame(cs_pin, numDevices, words);
+  }
+
+  void sendCmdAll(uint8_t reg, uint8_t data)
+  {
+    uint16_t words[numDevices];
+    for (uint8_t i = 0; i < numDevices; i++)
+    {
+      words[i] = (uint16_t)((reg << 8) | data);
+    }
+    sim::max72xxFrame(cs_pin, numDevices, words);
+  }
+
+public:
+  shMAX72xxMini()
+  {
+    pinMode(cs_pin, OUTPUT);
+    digitalWrite(cs_pin, HIGH);
+    sendCmdAll(MAX72XX_DISPLAYTEST, 0);
+    sendCmdAll(MAX72XX_SCANLIMIT, 7);
+    sendCmdAll(MAX72XX_DECODEMODE, 0);
+    clearAllDevices(true);
+    shutdownAllDevices(false);
+  }
+
+  void shutdownDevice(uint8_t addr, bool state)
+  {
+    if (addr < numDevices)
+    {
+      sendCmd(addr, MAX72XX_SHUTDOWN, !state);
+      sim::max72xxCommit(cs_pin);
+    }
+  }
+
+  void shutdownAllDevices(bool state)
+  {
+    sendCmdAll(MAX72XX_SHUTDOWN, !state);
+    sim::max72xxCommit(cs_pin);
+  }
+
+  void setBrightness(uint8_t addr, uint8_t intensity)
+  {
+    if (addr < numDevices)
+    {
+      sendCmd(addr, MAX72XX_INTENSITY, intensity & 0x0F);
+      sim::max72xxCommit(cs_pin);
+    }
+  }
+
+  void clearDevice(uint8_t addr, bool upd = false)
+  {
+    if (addr < numDevices)
+    {
+      memset(&buf[addr * 8], 0, 8);
+    }
+    if (upd)
+    {
+      update();
+    }
+  }
+
+  void clearAllDevices(bool upd = false)
+  {
+    memset(buf, 0, sizeof(buf));
+    if (upd)
+    {
+      update();
+    }
+  }
+
+  void setRow(uint8_t addr, uint8_t row, uint8_t value, bool upd = false)
+  {
+    if (addr < numDevices && row < 8)
+    {
+      buf[addr * 8 + row] = value;
+    }
+    if (upd)
+    {
+      update();
+    }
+  }
+
+  uint8_t getRow(uint8_t addr, uint8_t row) { return ((addr < numDevices && row < 8) ? buf[addr * 8 + row] : 0); }
+
+  void update()
+  {
+    for (uint8_t row = 0; row < 8; row++)
+    {
+      uint16_t words[numDevices];
+      for (uint8_t i = 0; i < numDevices; i++)
+      {
+        words[i] = (uint16_t)(((row + 1) << 8) | buf[i * 8 + row]);
+      }
+      sim::max72xxFrame(cs_pin, numDevices, words);
+    }
+    sim::max72xxCommit(cs_pin);
+  }
+};
+
+static const uint8_t minusSegments = 0b00000001; // знак минуса - сегмент G
+
+template <uint8_t cs_pin, uint8_t numDevices, uint8_t numDigits>
+class shMAX72xx7Segment : public shMAX72xxMini<cs_pin, numDevices>
+{
+public:
+  shMAX72xx7Segment() : shMAX72xxMini<cs_pin, numDevices>() {}
+
+  // разряды нумеруются справа налево, по 8 на модуль
+  void setChar(uint8_t digit, uint8_t value, bool upd = false)
+  {
+    if (digit < numDigits)
+    {
+      shMAX72xxMini<cs_pin, numDevices>::setRow(digit / 8, digit % 8, value, upd);
+    }
+  }
+
+  // кодировка MAX72xx без декодирования: DP - бит 7, A - бит 6, ..., G - бит 0
+  uint8_t encodeDigit(uint8_t digit)
+  {
+    static const uint8_t digitToSegment[] = {0x7E, 0x30, 0x6D, 0x79, 0x33, 0x5B, 0x5F, 0x70,
+                                             0x7F, 0x7B, 0x77, 0x1F, 0x4E, 0x3D, 0x4F, 0x47};
+    return (digitToSegment[digit & 0x0f]);
+  }
+};
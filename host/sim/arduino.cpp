@@ -0,0 +1,491 @@
+/* Виртуальный МК ATmega328P - ядро Arduino: init(), пины, АЦП, tone(), внешние прерывания, задержки, EEPROM и UART;
+   Длительность функций ядра взята по порядку величины для Arduino AVR 16 МГц: digitalRead()/digitalWrite()/pinMode() - около 4 мкс, analogRead() - 112 мкс, запись байта в EEPROM - 3,4 мс, передача байта Serial на 115200 бод - 87 мкс.
+*/
+#include <string.h>
+#include <deque>
+#include <string>
+#include "internal.h"
+#include <Arduino.h>
+#include <Wire.h>
+#include <FastLED.h>
+
+HardwareSerial Serial;
+TwoWire Wire;
+CFastLED FastLED;
+
+namespace sim
+{
+  namespace
+  {
+    const uint32_t PIN_CYCLES = 64;       // digitalRead(), digitalWrite(), pinMode()
+    const uint32_t ADC_CYCLES = 1792;     // analogRead(), 13 тактов АЦП при делителе 128
+    const uint32_t MILLIS_CYCLES = 24;    // millis()
+    const uint32_t MICROS_CYCLES = 56;    // micros()
+    const uint64_t EEPROM_WRITE_CYCLES = 54400; // запись байта в EEPROM, 3,4 мс
+    const uint16_t EEPROM_SIZE = E2END + 1;
+    const uint8_t SERIAL_BUFFER_SIZE = 64;
+
+    uint8_t tone_pin = 0xFF;
+    uint32_t tone_generation = 0;
+    uint64_t eeprom_busy_until = 0;
+
+    struct Uart
+    {
+      bool begun = false;
+      uint64_t byte_cycles = CPU_HZ * 10 / 115200;
+      uint64_t tx_free_at = 0; // момент, когда передатчик освободится
+      std::string out;
+      uint8_t rx[SERIAL_BUFFER_SIZE];
+      uint8_t rx_head = 0;
+      uint8_t rx_tail = 0;
+      std::deque<uint8_t> hw; // приемник UART: байт в UDR0 и байт в сдвиговом регистре
+    };
+
+    Uart &uart()
+    {
+      static Uart u;
+      return (u);
+    }
+
+    uint8_t *eepromData()
+    {
+      static uint8_t data[EEPROM_SIZE];
+      static bool ready = (memset(data, 0xFF, sizeof(data)), true);
+      (void)ready;
+      return (data);
+    }
+
+    void eepromWait()
+    {
+      if (eeprom_busy_until > mcu.wall)
+      {
+        spend(eeprom_busy_until - mcu.wall);
+      }
+    }
+
+    void eepromCheck(int idx)
+    {
+      if (idx < 0 || idx >= EEPROM_SIZE)
+      {
+        fail("EEPROM: адрес %d вне 0..%u", idx, EEPROM_SIZE - 1);
+      }
+    }
+
+    uint32_t txQueued()
+    {
+      Uart &u = uart();
+      return ((u.tx_free_at > mcu.wall) ? (uint32_t)((u.tx_free_at - mcu.wall + u.byte_cycles - 1) / u.byte_cycles) : 0);
+    }
+
+    void stopTone()
+    {
+      if (tone_pin == 0xFF)
+      {
+        return;
+      }
+      std::vector<Note> &log = noteLog();
+      if (!log.empty() && log.back().end == 0)
+      {
+        log.back().end = mcu.wall;
+      }
+      mcu.pin[tone_pin].port = 0;
+      tone_pin = 0xFF;
+      tone_generation++;
+    }
+  } // namespace
+
+  // ==== пины =========================================
+
+  uint8_t pinLevel(uint8_t pin)
+  {
+    const Pin &p = mcu.pin[pin];
+    if (p.ddr)
+    {
+      return (p.port);
+    }
+    if (p.drive != 0)
+    {
+      return ((uint8_t)(p.drive - 1));
+    }
+    // вход с подтяжкой читается как 1, висящий вход - как 0
+    return (p.port);
+  }
+
+  void onPinChange(uint8_t pin, uint8_t level)
+  {
+    uint8_t group = (pin <= 7) ? 2 : ((pin <= 13) ? 0 : 1);
+    uint8_t bit = (uint8_t)((pin <= 7) ? pin : ((pin <= 13) ? pin - 8 : pin - 14));
+    if (mcu.reg[REG_PCMSK0 + group] & (1 << bit))
+    {
+      mcu.reg[REG_PCIFR] |= (uint8_t)(1 << group);
+    }
+    if ((pin == 2 || pin == 3) && !mcu.clock_stopped)
+    {
+      // фронты INT0/INT1 распознаются только при работающем тактовом генераторе
+      uint8_t n = (uint8_t)(pin - 2);
+      uint8_t isc = (mcu.reg[REG_EICRA] >> (2 * n)) & 0x03;
+      if (isc == CHANGE || (isc == FALLING && level == 0) || (isc == RISING && level == 1))
+      {
+        mcu.reg[REG_EIFR] |= (uint8_t)(1 << n);
+      }
+    }
+  }
+
+  void pinDrive(uint8_t pin, int8_t level)
+  {
+    uint8_t old = pinLevel(pin);
+    mcu.pin[pin].drive = (uint8_t)(level + 1);
+    uint8_t now = pinLevel(pin);
+    if (now != old)
+    {
+      onPinChange(pin, now);
+    }
+  }
+
+  void pinModeSet(uint8_t pin, uint8_t mode)
+  {
+    if (pin >= PIN_COUNT)
+    {
+      return;
+    }
+    uint8_t old = pinLevel(pin);
+    Pin &p = mcu.pin[pin];
+    switch (mode)
+    {
+    case INPUT:
+      p.ddr = 0;
+      p.port = 0;
+      break;
+    case INPUT_PULLUP:
+      p.ddr = 0;
+      p.port = 1;
+      break;
+    default:
+      p.ddr = 1;
+      break;
+    }
+    uint8_t now = pinLevel(pin);
+    if (now != old)
+    {
+      onPinChange(pin, now);
+    }
+    spend(PIN_CYCLES);
+  }
+
+  void pinWrite(uint8_t pin, uint8_t value)
+  {
+    if (pin >= PIN_COUNT)
+    {
+      return;
+    }
+    uint8_t old = pinLevel(pin);
+    Pin &p = mcu.pin[pin];
+    uint8_t out = p.port;
+    p.port = value ? 1 : 0;
+    uint8_t now = pinLevel(pin);
+    if (now != old)
+    {
+      onPinChange(pin, now);
+    }
+    if (p.ddr && p.port != out)
+    {
+      PinEvent e = {mcu.wall, pin, p.port};
+      pinEvents().push_back(e);
+    }
+    spend(PIN_CYCLES);
+  }
+
+  int pinRead(uint8_t pin)
+  {
+    spend(PIN_CYCLES);
+    return ((pin < PIN_COUNT) ? pinLevel(pin) : LOW);
+  }
+
+  int adcRead(uint8_t pin)
+  {
+    if (pin >= PIN_A0)
+    {
+      pin -= PIN_A0;
+    }
+    if (!(mcu.reg[REG_ADCSRA] & bit(ADEN)))
+    {
+      fail("analogRead() при выключенном АЦП (ADEN = 0)");
+    }
+    spend(ADC_CYCLES);
+    return (mcu.pin[PIN_A0 + (pin & 0x07)].analog);
+  }
+
+  void externalIsr(uint8_t n)
+  {
+    if (mcu.int_func[n] != NULL)
+    {
+      mcu.int_func[n]();
+    }
+  }
+
+  void pinAttach(uint8_t irq, void (*func)(void), int mode)
+  {
+    if (irq > 1)
+    {
+      return;
+    }
+    mcu.int_func[irq] = func;
+    EICRA = (uint8_t)((EICRA & ~(0x03 << (2 * irq))) | (mode << (2 * irq)));
+    EIMSK |= (uint8_t)(1 << irq);
+  }
+
+  void pinDetach(uint8_t irq)
+  {
+    if (irq > 1)
+    {
+      return;
+    }
+    EIMSK &= (uint8_t) ~(1 << irq);
+    mcu.int_func[irq] = NULL;
+  }
+
+  void toneStart(uint8_t pin, unsigned int frequency, unsigned long duration)
+  {
+    if (pin >= PIN_COUNT || (tone_pin != 0xFF && tone_pin != pin))
+    {
+      // как и в ядре Arduino, одновременно звучит только одна нота
+      return;
+    }
+    stopTone();
+    mcu.pin[pin].ddr = 1;
+    tone_pin = pin;
+    Note n = {mcu.wall, 0, pin, frequency};
+    noteLog().push_back(n);
+    if (duration > 0)
+    {
+      uint32_t generation = tone_generation;
+      schedule(mcu.wall + (uint64_t)duration * CYCLES_PER_MS, [generation]()
+               {
+                 if (generation == tone_generation)
+                 {
+                   stopTone();
+                 }
+               });
+    }
+    spend(PIN_CYCLES * 4);
+  }
+
+  void toneStop(uint8_t pin)
+  {
+    if (pin == tone_pin)
+    {
+      stopTone();
+    }
+    spend(PIN_CYCLES);
+  }
+
+  // ==== EEPROM =======================================
+
+  uint8_t eepromRead(int idx)
+  {
+    eepromCheck(idx);
+    eepromWait();
+    spend(8);
+    return (eepromData()[idx]);
+  }
+
+  void eepromWrite(int idx, uint8_t value)
+  {
+    eepromCheck(idx);
+    eepromWait();
+    EepromWrite w = {mcu.wall, (uint16_t)idx, eepromData()[idx], value};
+    eepromLog().push_back(w);
+    eepromData()[idx] = value;
+    eeprom_busy_until = mcu.wall + EEPROM_WRITE_CYCLES;
+    spend(16);
+  }
+
+  uint8_t *eeprom() { return (eepromData()); }
+
+  // ==== UART =========================================
+
+  uint64_t serialByteCycles() { return (uart().byte_cycles); }
+
+  void serialBegin(unsigned long baud)
+  {
+    Uart &u = uart();
+    u.begun = true;
+    u.byte_cycles = CPU_HZ * 10 / baud;
+    spend(64);
+  }
+
+  void serialEnd()
+  {
+    serialFlush();
+    uart().begun = false;
+    uart().hw.clear();
+  }
+
+  void serialReceive(uint8_t c)
+  {
+    Uart &u = uart();
+    if (!u.begun || mcu.clock_stopped || u.hw.size() >= 2)
+    {
+      // приемник выключен, МК спит в режиме power-down или байт не успели забрать из UDR0
+      statsRef().serial_dropped++;
+      return;
+    }
+    u.hw.push_back(c);
+  }
+
+  bool serialRxPending() { return (uart().begun && !uart().hw.empty()); }
+
+  void usartRxIsr()
+  {
+    // USART_RX_vect ядра Arduino: байт из UDR0 в кольцевой буфер
+    Uart &u = uart();
+    if (u.hw.empty())
+    {
+      return;
+    }
+    uint8_t c = u.hw.front();
+    u.hw.pop_front();
+    uint8_t next = (uint8_t)((u.rx_head + 1) % SERIAL_BUFFER_SIZE);
+    if (next == u.rx_tail)
+    {
+      statsRef().serial_dropped++;
+      return;
+    }
+    u.rx[u.rx_head] = c;
+    u.rx_head = next;
+    spend(40);
+  }
+
+  int serialAvailable()
+  {
+    spend(16);
+    Uart &u = uart();
+    return ((SERIAL_BUFFER_SIZE + u.rx_head - u.rx_tail) % SERIAL_BUFFER_SIZE);
+  }
+
+  int serialPeek()
+  {
+    spend(16);
+    Uart &u = uart();
+    return ((u.rx_head == u.rx_tail) ? -1 : u.rx[u.rx_tail]);
+  }
+
+  int serialRead()
+  {
+    spend(24);
+    Uart &u = uart();
+    if (u.rx_head == u.rx_tail)
+    {
+      return (-1);
+    }
+    uint8_t c = u.rx[u.rx_tail];
+    u.rx_tail = (uint8_t)((u.rx_tail + 1) % SERIAL_BUFFER_SIZE);
+    return (c);
+  }
+
+  int serialAvailableForWrite()
+  {
+    uint32_t queued = txQueued();
+    return ((queued >= SERIAL_BUFFER_SIZE - 1) ? 0 : (int)(SERIAL_BUFFER_SIZE - 1 - queued));
+  }
+
+  void serialWrite(uint8_t c)
+  {
+    Uart &u = uart();
+    if (!u.begun)
+    {
+      // передатчик выключен - байт теряется
+      return;
+    }
+    if (txQueued() >= SERIAL_BUFFER_SIZE)
+    {
+      // буфер заполнен - write() ждет, пока передатчик освободит место
+      statsRef().serial_tx_wait++;
+      spend(u.tx_free_at - (SERIAL_BUFFER_SIZE - 1) * u.byte_cycles - mcu.wall);
+    }
+    u.tx_free_at = ((u.tx_free_at > mcu.wall) ? u.tx_free_at : mcu.wall) + u.byte_cycles;
+    u.out.push_back((char)c);
+    spend(40);
+  }
+
+  void serialFlush()
+  {
+    Uart &u = uart();
+    if (u.begun && u.tx_free_at > mcu.wall)
+    {
+      spend(u.tx_free_at - mcu.wall);
+    }
+  }
+
+  void serialInput(const std::string &data)
+  {
+    uint64_t t = mcu.wall;
+    for (size_t i = 0; i < data.size(); i++)
+    {
+      t += uart().byte_cycles;
+      uint8_t c = (uint8_t)data[i];
+      schedule(t, [c]()
+               { serialReceive(c); });
+    }
+  }
+
+  std::string serialOutput() { return (uart().out); }
+  void serialClear() { uart().out.clear(); }
+} // namespace sim
+
+// ==== функции ядра Arduino ===========================
+
+void init(void)
+{
+  // как wiring.c: прерывания разрешены, Timer0 - fast PWM с делителем 64 и прерыванием по переполнению, Timer1 - PWM phase correct 8 бит с делителем 64, АЦП включен с делителем 128
+  sei();
+  TCCR0A = bit(WGM01) | bit(WGM00);
+  TCCR0B = bit(CS01) | bit(CS00);
+  TIMSK0 = bit(TOIE0);
+  TCCR1B = bit(CS11) | bit(CS10);
+  TCCR1A = bit(WGM10);
+  ADCSRA = bit(ADPS2) | bit(ADPS1) | bit(ADPS0) | bit(ADEN);
+}
+
+void initVariant(void) {}
+
+void pinMode(uint8_t pin, uint8_t mode) { sim::pinModeSet(pin, mode); }
+void digitalWrite(uint8_t pin, uint8_t val) { sim::pinWrite(pin, val); }
+int digitalRead(uint8_t pin) { return (sim::pinRead(pin)); }
+int analogRead(uint8_t pin) { return (sim::adcRead(pin)); }
+void analogReference(uint8_t) {}
+
+uint32_t millis(void)
+{
+  sim::spend(sim::MILLIS_CYCLES);
+  return (sim::millisNow());
+}
+
+uint32_t micros(void)
+{
+  sim::spend(sim::MICROS_CYCLES);
+  return (sim::microsNow());
+}
+
+void delay(uint32_t ms)
+{
+  if (!sim::irqEnabled())
+  {
+    sim::fail("delay() при запрещенных прерываниях - micros() стоит, задержка не закончится");
+  }
+  uint32_t start = sim::microsNow();
+  uint64_t need = (uint64_t)ms * 1000;
+  uint32_t elapsed;
+  while ((elapsed = sim::microsNow() - start) < need)
+  {
+    sim::spend((need - elapsed) * (F_CPU / 1000000ul));
+  }
+}
+
+void delayMicroseconds(unsigned int us) { sim::spend((uint64_t)us * (F_CPU / 1000000ul)); }
+
+void attachInterrupt(uint8_t interruptNum, void (*userFunc)(void), int mode) { sim::pinAttach(interruptNum, userFunc, mode); }
+void detachInterrupt(uint8_t interruptNum) { sim::pinDetach(interruptNum); }
+
+void tone(uint8_t pin, unsigned int frequency, unsigned long duration) { sim::toneStart(pin, frequency, duration); }
+void noTone(uint8_t pin) { sim::toneStop(pin); }
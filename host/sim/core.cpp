@@ -0,0 +1,725 @@
+/* Виртуальный МК ATmega328P - ход времени, регистры, прерывания, сон, таймеры Timer0/Timer1 и сторожевой таймер;
+   Время продвигается шагами до ближайшего события: переполнения Timer0, события Timer1 с разрешенным прерыванием, срабатывания сторожевого таймера или события из очереди (фронты на пинах, прием байтов, выходы часов реального времени и т.д.). После каждого шага, если флаг I установлен, выполняются ожидающие прерывания.
+*/
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <map>
+#include "internal.h"
+
+namespace sim
+{
+  Mcu mcu;
+
+  namespace
+  {
+    const uint8_t I_FLAG = 0x80;
+    const uint32_t ISR_CYCLES = 20;      // вход в обработчик прерывания и выход из него
+    const uint32_t T0_ISR_CYCLES = 60;   // обработчик переполнения Timer0 ядра Arduino
+    const uint64_t WAKEUP_CYCLES = 16384; // пуск кварцевого генератора после power-down (фьюзы Arduino - 16K CK)
+    const uint64_t NEVER = ~0ull;
+
+    // биты регистров
+    const uint8_t SE_BIT = 0x01;
+    const uint8_t SM_MASK = 0x0E;
+    const uint8_t SM_IDLE = 0x00;
+    const uint8_t SM_PWR_DOWN = 0x04;
+    const uint8_t WDIF_BIT = 0x80;
+    const uint8_t WDIE_BIT = 0x40;
+    const uint8_t WDP3_BIT = 0x20;
+    const uint8_t WDCE_BIT = 0x10;
+    const uint8_t WDE_BIT = 0x08;
+    const uint8_t TOV_BIT = 0x01;
+    const uint8_t OCFA_BIT = 0x02;
+    const uint8_t OCFB_BIT = 0x04;
+
+    std::multimap<uint64_t, std::function<void()>> &queue()
+    {
+      static std::multimap<uint64_t, std::function<void()>> q;
+      return (q);
+    }
+
+    uint16_t prescaler(uint8_t tccrb)
+    {
+      static const uint16_t div[8] = {0, 1, 8, 64, 256, 1024, 0xFFFF, 0xFFFF};
+      uint16_t p = div[tccrb & 0x07];
+      if (p == 0xFFFF)
+      {
+        fail("внешнее тактирование таймера моделью не поддерживается");
+      }
+      return (p);
+    }
+
+    // ==== Timer0 ===================================
+
+    uint16_t t0Prescaler() { return (prescaler(mcu.reg[REG_TCCR0B])); }
+
+    uint64_t t0Ticks()
+    {
+      uint16_t p = t0Prescaler();
+      return ((p == 0) ? 0 : mcu.cpu / p - mcu.t0_base);
+    }
+
+    uint64_t t0NextCpu()
+    {
+      uint16_t p = t0Prescaler();
+      return ((p == 0) ? NEVER : (mcu.t0_base + ((mcu.t0_seen + 1) << 8)) * p);
+    }
+
+    void t0Sync()
+    {
+      if (t0Prescaler() == 0)
+      {
+        return;
+      }
+      uint64_t total = t0Ticks() >> 8;
+      while (mcu.t0_seen < total)
+      {
+        mcu.t0_seen++;
+        if (mcu.reg[REG_TIFR0] & TOV_BIT)
+        {
+          statsRef().t0_lost++;
+        }
+        mcu.reg[REG_TIFR0] |= TOV_BIT;
+      }
+    }
+
+    // ==== Timer1 ===================================
+
+    uint8_t t1Mode() { return ((uint8_t)(((mcu.reg[REG_TCCR1B] >> 1) & 0x0C) | (mcu.reg[REG_TCCR1A] & 0x03))); }
+    uint16_t t1Prescaler() { return (prescaler(mcu.reg[REG_TCCR1B])); }
+
+    // расстояние в тиках до значения target; 0 заменяется полным периодом
+    uint32_t distance(uint32_t from, uint32_t target, uint32_t period)
+    {
+      uint32_t d = (target + period - from) % period;
+      return ((d == 0) ? period : d);
+    }
+
+    // фаза счетчика в режиме PWM phase correct 8 бит: 0..255 - прямой счет, 256..509 - обратный
+    uint32_t t1Phase() { return (mcu.t1_down ? 510u - mcu.t1_count : mcu.t1_count); }
+
+    uint32_t t1CompareDistance(uint16_t ocr)
+    {
+      if (t1Mode() == 0)
+      {
+        return (distance(mcu.t1_count, ocr, 65536));
+      }
+      if (ocr > 0xFF)
+      {
+        // в 8-битном режиме значения выше TOP никогда не совпадают со счетчиком
+        return (0);
+      }
+      uint32_t ph = t1Phase();
+      uint32_t d = distance(ph, ocr, 510);
+      if (ocr > 0 && ocr < 0xFF)
+      {
+        uint32_t d2 = distance(ph, 510 - ocr, 510);
+        d = (d2 < d) ? d2 : d;
+      }
+      return (d);
+    }
+
+    uint32_t t1OverflowDistance()
+    {
+      return ((t1Mode() == 0) ? 65536u - mcu.t1_count : distance(t1Phase(), 0, 510));
+    }
+
+    void t1Sync()
+    {
+      uint16_t p = t1Prescaler();
+      if (p == 0)
+      {
+        return;
+      }
+      uint64_t now = mcu.cpu / p;
+      uint64_t n = now - mcu.t1_done;
+      mcu.t1_done = now;
+      if (n == 0)
+      {
+        return;
+      }
+      uint32_t d = t1CompareDistance(mcu.ocr1a);
+      if (d != 0 && n >= d)
+      {
+        mcu.reg[REG_TIFR1] |= OCFA_BIT;
+      }
+      d = t1CompareDistance(mcu.ocr1b);
+      if (d != 0 && n >= d)
+      {
+        mcu.reg[REG_TIFR1] |= OCFB_BIT;
+      }
+      if (n >= t1OverflowDistance())
+      {
+        mcu.reg[REG_TIFR1] |= TOV_BIT;
+      }
+      if (t1Mode() == 0)
+      {
+        mcu.t1_count = (uint16_t)(mcu.t1_count + n);
+      }
+      else
+      {
+        uint32_t ph = (uint32_t)((t1Phase() + n) % 510);
+        mcu.t1_down = ph > 0xFF;
+        mcu.t1_count = (uint16_t)(mcu.t1_down ? 510 - ph : ph);
+      }
+    }
+
+    uint64_t t1NextCpu()
+    {
+      uint16_t p = t1Prescaler();
+      uint8_t mask = mcu.reg[REG_TIMSK1];
+      if (p == 0 || !(mask & (TOV_BIT | OCFA_BIT | OCFB_BIT)))
+      {
+        return (NEVER);
+      }
+      uint64_t best = NEVER;
+      uint32_t d;
+      if ((mask & OCFA_BIT) && (d = t1CompareDistance(mcu.ocr1a)) != 0 && d < best)
+      {
+        best = d;
+      }
+      if ((mask & OCFB_BIT) && (d = t1CompareDistance(mcu.ocr1b)) != 0 && d < best)
+      {
+        best = d;
+      }
+      if ((mask & TOV_BIT) && (d = t1OverflowDistance()) < best)
+      {
+        best = d;
+      }
+      return ((best == NEVER) ? NEVER : (mcu.t1_done + best) * p);
+    }
+
+    void t1Check()
+    {
+      uint8_t mode = t1Mode();
+      if (t1Prescaler() != 0 && mode != 0 && mode != 1)
+      {
+        fail("режим Timer1 WGM=%u моделью не поддерживается (только normal и PWM phase correct 8 бит)", mode);
+      }
+    }
+
+    // ==== сторожевой таймер ========================
+
+    bool wdtEnabled() { return (mcu.reg[REG_WDTCSR] & (WDE_BIT | WDIE_BIT)); }
+
+    uint64_t wdtPeriod()
+    {
+      uint8_t r = mcu.reg[REG_WDTCSR];
+      uint8_t idx = (uint8_t)((r & 0x07) | ((r & WDP3_BIT) ? 0x08 : 0));
+      // 2048 тактов генератора 128 кГц - 16 мс
+      return (256000ull << idx);
+    }
+
+    void wdtSync()
+    {
+      while (wdtEnabled() && mcu.wall >= mcu.wdt_start + wdtPeriod())
+      {
+        mcu.wdt_start += wdtPeriod();
+        if (mcu.reg[REG_WDTCSR] & WDIE_BIT)
+        {
+          mcu.reg[REG_WDTCSR] |= WDIF_BIT;
+        }
+        else
+        {
+          fail("сброс МК сторожевым таймером");
+        }
+      }
+    }
+
+    void wdtWrite(uint8_t v)
+    {
+      uint8_t old = mcu.reg[REG_WDTCSR];
+      uint8_t r = old;
+      if (v & WDIF_BIT)
+      {
+        r &= (uint8_t)~WDIF_BIT;
+      }
+      if (mcu.wdt_unlock)
+      {
+        // вторая запись временной последовательности - меняются все биты
+        mcu.wdt_unlock = false;
+        r = (uint8_t)((r & WDIF_BIT) | (v & ~(WDIF_BIT | WDCE_BIT)));
+      }
+      else
+      {
+        // без временной последовательности можно менять только WDIE и устанавливать WDE
+        r = (uint8_t)((r & ~WDIE_BIT) | (v & WDIE_BIT) | (v & WDE_BIT));
+        mcu.wdt_unlock = (v & (WDCE_BIT | WDE_BIT)) == (WDCE_BIT | WDE_BIT);
+      }
+      mcu.reg[REG_WDTCSR] = r;
+      if (!(old & (WDE_BIT | WDIE_BIT)) && wdtEnabled())
+      {
+        mcu.wdt_start = mcu.wall;
+      }
+    }
+
+    // ==== прерывания ===============================
+
+    bool int0Level(uint8_t n)
+    {
+      // прерывание по низкому уровню на INT0/INT1 (пины 2 и 3) ожидает все время, пока уровень низкий
+      return ((mcu.reg[REG_EIMSK] & (1 << n)) && ((mcu.reg[REG_EICRA] >> (2 * n)) & 0x03) == 0 && pinLevel((uint8_t)(2 + n)) == 0);
+    }
+
+    // номер ожидающего разрешенного прерывания с наивысшим приоритетом; 0 - нет
+    uint8_t pendingVector()
+    {
+      const uint8_t *r = mcu.reg;
+      for (uint8_t n = 0; n < 2; n++)
+      {
+        if ((r[REG_EIMSK] & r[REG_EIFR] & (1 << n)) || int0Level(n))
+        {
+          return ((uint8_t)(VEC_INT0 + n));
+        }
+      }
+      for (uint8_t g = 0; g < 3; g++)
+      {
+        if (r[REG_PCICR] & r[REG_PCIFR] & (1 << g))
+        {
+          return ((uint8_t)(VEC_PCINT0 + g));
+        }
+      }
+      if ((r[REG_WDTCSR] & WDIE_BIT) && (r[REG_WDTCSR] & WDIF_BIT))
+      {
+        return (VEC_WDT);
+      }
+      uint8_t t1 = r[REG_TIMSK1] & r[REG_TIFR1];
+      if (t1 & OCFA_BIT)
+      {
+        return (VEC_TIMER1_COMPA);
+      }
+      if (t1 & OCFB_BIT)
+      {
+        return (VEC_TIMER1_COMPB);
+      }
+      if (t1 & TOV_BIT)
+      {
+        return (VEC_TIMER1_OVF);
+      }
+      if (r[REG_TIMSK0] & r[REG_TIFR0] & TOV_BIT)
+      {
+        return (VEC_TIMER0_OVF);
+      }
+      if (serialRxPending())
+      {
+        return (VEC_USART_RX);
+      }
+      return (0);
+    }
+
+    // аппаратный сброс флага при переходе на вектор
+    void acknowledge(uint8_t vec)
+    {
+      uint8_t *r = mcu.reg;
+      switch (vec)
+      {
+      case VEC_INT0:
+      case VEC_INT1:
+        r[REG_EIFR] &= (uint8_t)~(1 << (vec - VEC_INT0));
+        break;
+      case VEC_PCINT0:
+      case VEC_PCINT1:
+      case VEC_PCINT2:
+        r[REG_PCIFR] &= (uint8_t)~(1 << (vec - VEC_PCINT0));
+        break;
+      case VEC_WDT:
+        r[REG_WDTCSR] &= (uint8_t)~WDIF_BIT;
+        if (r[REG_WDTCSR] & WDE_BIT)
+        {
+          // режим "прерывание, затем сброс"
+          r[REG_WDTCSR] &= (uint8_t)~WDIE_BIT;
+        }
+        break;
+      case VEC_TIMER1_COMPA:
+        r[REG_TIFR1] &= (uint8_t)~OCFA_BIT;
+        break;
+      case VEC_TIMER1_COMPB:
+        r[REG_TIFR1] &= (uint8_t)~OCFB_BIT;
+        break;
+      case VEC_TIMER1_OVF:
+        r[REG_TIFR1] &= (uint8_t)~TOV_BIT;
+        break;
+      case VEC_TIMER0_OVF:
+        r[REG_TIFR0] &= (uint8_t)~TOV_BIT;
+        break;
+      }
+    }
+
+    void setInterruptFlag(bool on)
+    {
+      bool was = irqEnabled();
+      if (on)
+      {
+        mcu.reg[REG_SREG] |= I_FLAG;
+        if (!was && mcu.irq_off_since != 0)
+        {
+          uint64_t t = mcu.wall - mcu.irq_off_since;
+          if (t > statsRef().irq_off_max)
+          {
+            statsRef().irq_off_max = t;
+          }
+        }
+      }
+      else
+      {
+        mcu.reg[REG_SREG] &= (uint8_t)~I_FLAG;
+        if (was)
+        {
+          mcu.irq_off_since = mcu.wall;
+        }
+      }
+    }
+
+    void runIsr(uint8_t vec)
+    {
+      statsRef().isr[vec]++;
+      mcu.dispatched++;
+      setInterruptFlag(false);
+      mcu.isr_depth++;
+      spend(ISR_CYCLES);
+      vectorTable()[vec]();
+      mcu.isr_depth--;
+      setInterruptFlag(true); // reti
+    }
+
+    bool wakeSourcePending()
+    {
+      const uint8_t *r = mcu.reg;
+      return ((r[REG_PCICR] & r[REG_PCIFR] & 0x07) ||
+              ((r[REG_WDTCSR] & WDIE_BIT) && (r[REG_WDTCSR] & WDIF_BIT)) ||
+              int0Level(0) || int0Level(1));
+    }
+
+    // продвижение времени до ближайшего события, но не дальше limit
+    void step(uint64_t limit)
+    {
+      uint64_t next = limit;
+      if (!mcu.clock_stopped)
+      {
+        uint64_t c = t0NextCpu();
+        if (c != NEVER && mcu.wall + (c - mcu.cpu) < next)
+        {
+          next = mcu.wall + (c - mcu.cpu);
+        }
+        c = t1NextCpu();
+        if (c != NEVER && mcu.wall + (c - mcu.cpu) < next)
+        {
+          next = mcu.wall + (c - mcu.cpu);
+        }
+      }
+      if (wdtEnabled() && mcu.wdt_start + wdtPeriod() < next)
+      {
+        next = mcu.wdt_start + wdtPeriod();
+      }
+      if (!queue().empty() && queue().begin()->first < next)
+      {
+        next = queue().begin()->first;
+      }
+      uint64_t deadline = harnessDeadline();
+      if (deadline > mcu.wall && deadline < next)
+      {
+        next = deadline;
+      }
+      if (next == NEVER)
+      {
+        fail("МК ждет прерывания, но ни одного источника нет - модель остановлена");
+      }
+      if (next > mcu.wall)
+      {
+        if (!mcu.clock_stopped)
+        {
+          mcu.cpu += next - mcu.wall;
+        }
+        mcu.wall = next;
+      }
+      t0Sync();
+      t1Sync();
+      wdtSync();
+      while (!queue().empty() && queue().begin()->first <= mcu.wall)
+      {
+        std::function<void()> fn = queue().begin()->second;
+        queue().erase(queue().begin());
+        fn();
+      }
+      if (!mcu.clock_stopped)
+      {
+        dispatch();
+      }
+      if (mcu.wall >= deadline)
+      {
+        harnessYield();
+      }
+    }
+  } // namespace
+
+  // ==== общие функции модели =========================
+
+  bool irqEnabled() { return (mcu.reg[REG_SREG] & I_FLAG); }
+
+  void dispatch()
+  {
+    uint64_t t = mcu.wall;
+    uint32_t guard = 0;
+    uint8_t vec;
+    while (irqEnabled() && (vec = pendingVector()) != 0)
+    {
+      if (mcu.wall == t && ++guard > 100000)
+      {
+        fail("прерывание %u вызывается непрерывно", vec);
+      }
+      acknowledge(vec);
+      runIsr(vec);
+    }
+  }
+
+  void schedule(uint64_t time, const std::function<void()> &fn)
+  {
+    queue().insert(std::make_pair(time, fn));
+  }
+
+  void spend(uint64_t cycles)
+  {
+    uint64_t target = mcu.wall + cycles;
+    while (mcu.wall < target)
+    {
+      step(target);
+    }
+    if (cycles == 0)
+    {
+      dispatch();
+    }
+  }
+
+  void poll() { dispatch(); }
+
+  void irqDisable() { setInterruptFlag(false); }
+
+  void irqEnable()
+  {
+    // как и на AVR, прерывания, ожидавшие sei(), выполняются после следующей команды - в модели при следующем обращении к ней (в том числе в sleep_cpu())
+    setInterruptFlag(true);
+  }
+
+  void wdtReset() { mcu.wdt_start = mcu.wall; }
+
+  void sleepCpu()
+  {
+    uint8_t smcr = mcu.reg[REG_SMCR];
+    if (!(smcr & SE_BIT))
+    {
+      return;
+    }
+    uint8_t mode = smcr & SM_MASK;
+    if (mode != SM_IDLE && mode != SM_PWR_DOWN)
+    {
+      fail("режим сна SM=%u моделью не поддерживается (только idle и power-down)", mode >> 1);
+    }
+    if (!irqEnabled())
+    {
+      fail("sleep_cpu() при запрещенных прерываниях - МК не проснется");
+    }
+    if (pendingVector() != 0)
+    {
+      // прерывание уже ожидает - МК просыпается сразу
+      (mode == SM_IDLE) ? statsRef().sleeps_idle++ : statsRef().sleeps_power_down++;
+      dispatch();
+      return;
+    }
+    uint64_t start = mcu.wall;
+    if (mode == SM_IDLE)
+    {
+      statsRef().sleeps_idle++;
+      uint32_t n = mcu.dispatched;
+      while (mcu.dispatched == n)
+      {
+        step(NEVER);
+      }
+      statsRef().idle_cycles += mcu.wall - start;
+      return;
+    }
+    statsRef().sleeps_power_down++;
+    mcu.clock_stopped = true;
+    while (!wakeSourcePending())
+    {
+      step(NEVER);
+    }
+    // МК стоит, пока запускается кварцевый генератор
+    uint64_t wake = mcu.wall + WAKEUP_CYCLES;
+    while (mcu.wall < wake)
+    {
+      step(wake);
+    }
+    mcu.clock_stopped = false;
+    statsRef().power_down_cycles += mcu.wall - start;
+    dispatch();
+  }
+
+  // ==== регистры =====================================
+
+  uint16_t regRead(uint8_t reg)
+  {
+    switch (reg)
+    {
+    case REG_SP:
+      return (stackPointer());
+    case REG_TCNT0:
+      return ((uint8_t)t0Ticks());
+    case REG_TIFR0:
+      t0Sync();
+      return (mcu.reg[reg]);
+    case REG_TCNT1:
+      t1Sync();
+      return (mcu.t1_count);
+    case REG_TIFR1:
+      t1Sync();
+      return (mcu.reg[reg]);
+    case REG_OCR1A:
+      return (mcu.ocr1a);
+    case REG_OCR1B:
+      return (mcu.ocr1b);
+    case REG_ICR1:
+      return (mcu.icr1);
+    case REG_WDTCSR:
+      wdtSync();
+      return (mcu.reg[reg]);
+    default:
+      if (reg >= REG_COUNT)
+      {
+        fail("чтение несуществующего регистра %u", reg);
+      }
+      return (mcu.reg[reg]);
+    }
+  }
+
+  void regWrite(uint8_t reg, uint16_t value)
+  {
+    uint8_t v = (uint8_t)value;
+    switch (reg)
+    {
+    case REG_SREG:
+      setInterruptFlag(v & I_FLAG);
+      mcu.reg[reg] = v;
+      break;
+    case REG_SP:
+      fail("запись указателя стека моделью не поддерживается");
+    case REG_WDTCSR:
+      wdtSync();
+      wdtWrite(v);
+      break;
+    case REG_EIFR:
+    case REG_PCIFR:
+      // флаги сбрасываются записью единицы
+      mcu.reg[reg] &= (uint8_t)~v;
+      break;
+    case REG_TIFR0:
+      t0Sync();
+      mcu.reg[reg] &= (uint8_t)~v;
+      break;
+    case REG_TIFR1:
+      t1Sync();
+      mcu.reg[reg] &= (uint8_t)~v;
+      break;
+    case REG_TCCR0B:
+      t0Sync();
+      mcu.reg[reg] = v;
+      if (t0Prescaler() != 0)
+      {
+        mcu.t0_base = mcu.cpu / t0Prescaler();
+        mcu.t0_seen = 0;
+      }
+      break;
+    case REG_TCNT0:
+      fail("запись TCNT0 сбивает millis() - моделью не поддерживается");
+    case REG_TCCR1A:
+    case REG_TCCR1B:
+      t1Sync();
+      mcu.reg[reg] = v;
+      if (t1Prescaler() != 0)
+      {
+        mcu.t1_done = mcu.cpu / t1Prescaler();
+      }
+      if (t1Mode() == 0)
+      {
+        mcu.t1_down = false;
+      }
+      t1Check();
+      break;
+    case REG_TCNT1:
+      t1Sync();
+      mcu.t1_count = (t1Mode() == 0) ? value : (uint16_t)(value & 0xFF);
+      mcu.t1_down = false;
+      break;
+    case REG_OCR1A:
+      t1Sync();
+      mcu.ocr1a = value;
+      break;
+    case REG_OCR1B:
+      t1Sync();
+      mcu.ocr1b = value;
+      break;
+    case REG_ICR1:
+      mcu.icr1 = value;
+      break;
+    case REG_TIMSK1:
+      t1Sync();
+      mcu.reg[reg] = v;
+      break;
+    default:
+      if (reg >= REG_COUNT)
+      {
+        fail("запись несуществующего регистра %u", reg);
+      }
+      mcu.reg[reg] = v;
+      break;
+    }
+  }
+
+  // ==== Timer0 и millis() ============================
+
+  void timer0Isr()
+  {
+    // TIMER0_OVF_vect ядра Arduino (wiring.c)
+    spend(T0_ISR_CYCLES);
+    uint32_t m = mcu.t0_millis + 1;
+    uint8_t f = (uint8_t)(mcu.t0_fract + 3);
+    if (f >= 125)
+    {
+      f -= 125;
+      m += 1;
+    }
+    mcu.t0_fract = f;
+    mcu.t0_millis = m;
+    mcu.t0_overflow_count++;
+  }
+
+  uint32_t millisNow() { return (mcu.t0_millis); }
+
+  uint32_t microsNow()
+  {
+    t0Sync();
+    uint32_t m = mcu.t0_overflow_count;
+    uint8_t t = (uint8_t)t0Ticks();
+    if ((mcu.reg[REG_TIFR0] & TOV_BIT) && t < 255)
+    {
+      m++;
+    }
+    return (((m << 8) + t) * 4);
+  }
+
+  void millisAdd(uint32_t ms) { mcu.t0_millis += ms; }
+
+  // ==== аварийная остановка ==========================
+
+  void fail(const char *format, ...)
+  {
+    fflush(stdout);
+    fprintf(stderr, "sim: %.3f ms: ", (double)mcu.wall / CYCLES_PER_MS);
+    va_list args;
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    fputc('\n', stderr);
+    abort();
+  }
+} // namespace sim
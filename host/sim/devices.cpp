@@ -0,0 +1,663 @@
+/* Виртуальный МК ATmega328P - внешние устройства часов: шина I2C с часами реального времени DS3231, экраны TM1637, MAX72xx и адресные светодиоды, шина 1-Wire с датчиком DS18B20;
+   Модели устройств подключены так же, как на схеме часов (выход SQW DS3231 - пин 2), и записывают все, что МК им передает, - кадры экрана и транзакции I2C.
+*/
+#include <string.h>
+#include <map>
+#include <vector>
+#include "internal.h"
+
+namespace sim
+{
+  namespace
+  {
+    const uint8_t RTC_ADDRESS = 0x68;
+    const uint8_t RTC_SQW_PIN = 2; // выход SQW DS3231 подключен к INT0
+    const uint32_t I2C_OVERHEAD_CYCLES = 320; // START, STOP и код библиотеки Wire
+    const uint32_t TM1637_PIN_CYCLES = 64;    // pinMode()/digitalRead() в библиотеке TM1637
+    const uint32_t SPI_CS_CYCLES = 128;       // переключение CS через digitalWrite()
+    const uint32_t LED_CLOCKLESS_CYCLES = 490; // 24 бита по 1,25 мкс и обработка пикселя FastLED
+    const uint32_t LED_SPI_CYCLES = 64;       // светодиоды с шиной SPI
+    const uint64_t DS18B20_CONVERSION_CYCLES = 750ull * 16000; // преобразование 12 бит, 750 мс
+
+    bool i2c_begun = false;
+    uint32_t i2c_bit_cycles = CPU_HZ / 100000;
+    uint32_t i2c_faults = 0;
+
+    // ==== DS3231 ===================================
+
+    struct DateFields
+    {
+      uint16_t year;
+      uint8_t month;
+      uint8_t day;
+      uint8_t hour;
+      uint8_t minute;
+      uint8_t second;
+    };
+
+    const uint8_t DAYS_IN_MONTH[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+
+    uint8_t daysInMonth(uint16_t year, uint8_t month)
+    {
+      return ((uint8_t)(DAYS_IN_MONTH[month - 1] + ((month == 2 && year % 4 == 0) ? 1 : 0)));
+    }
+
+    // секунды от 2000-01-01 00:00:00; как и DS3231, високосным считается каждый четвертый год
+    uint32_t toSeconds(const DateFields &f)
+    {
+      uint32_t days = 0;
+      for (uint16_t y = 2000; y < f.year; y++)
+      {
+        days += (y % 4 == 0) ? 366 : 365;
+      }
+      for (uint8_t m = 1; m < f.month; m++)
+      {
+        days += daysInMonth(f.year, m);
+      }
+      days += f.day - 1;
+      return (((days * 24 + f.hour) * 60 + f.minute) * 60 + f.second);
+    }
+
+    DateFields fromSeconds(uint32_t t)
+    {
+      DateFields f;
+      f.second = (uint8_t)(t % 60);
+      t /= 60;
+      f.minute = (uint8_t)(t % 60);
+      t /= 60;
+      f.hour = (uint8_t)(t % 24);
+      uint32_t days = t / 24;
+      f.year = 2000;
+      while (days >= ((f.year % 4 == 0) ? 366u : 365u))
+      {
+        days -= (f.year % 4 == 0) ? 366 : 365;
+        f.year++;
+      }
+      f.month = 1;
+      while (days >= daysInMonth(f.year, f.month))
+      {
+        days -= daysInMonth(f.year, f.month);
+        f.month++;
+      }
+      f.day = (uint8_t)(days + 1);
+      return (f);
+    }
+
+    uint8_t bcd(uint8_t v) { return ((uint8_t)(((v / 10) << 4) | (v % 10))); }
+    uint8_t unbcd(uint8_t v) { return ((uint8_t)((v >> 4) * 10 + (v & 0x0F))); }
+
+    struct Rtc
+    {
+      bool present = true;
+      uint8_t ptr = 0;
+      uint8_t alarm[7] = {0, 0, 0, 0, 0, 0, 0};
+      uint8_t control = 0x1C; // после подачи питания: INTCN = 1, RS2 = RS1 = 1
+      uint8_t status = 0x88;  // OSF = 1, EN32kHz = 1
+      uint8_t aging = 0;
+      int16_t temp_quarters = 25 * 4;
+      bool h12 = false;
+      uint32_t base = 0;    // время в момент origin, секунд от 2000-01-01
+      uint64_t origin = 0;  // начало секунды base, тактов
+      uint8_t dow_base = 1; // значение регистра дня недели в день base
+      uint32_t sqw_generation = 0;
+    };
+
+    Rtc &rtc()
+    {
+      static Rtc r;
+      return (r);
+    }
+
+    uint32_t rtcNow() { return (rtc().base + (uint32_t)((mcu.wall - rtc().origin) / CPU_HZ)); }
+
+    uint8_t rtcDow()
+    {
+      uint32_t days = rtcNow() / 86400 - rtc().base / 86400;
+      return ((uint8_t)((rtc().dow_base - 1 + days) % 7 + 1));
+    }
+
+    void sqwUpdate();
+
+    // новое время; фаза секунды сохраняется, если не записывались секунды
+    void rtcSetTime(const DateFields &f, bool reset_phase)
+    {
+      Rtc &r = rtc();
+      uint8_t dow = rtcDow();
+      uint64_t phase = reset_phase ? 0 : (mcu.wall - r.origin) % CPU_HZ;
+      r.base = toSeconds(f);
+      r.origin = mcu.wall - phase;
+      r.dow_base = dow;
+      sqwUpdate();
+    }
+
+    void sqwUpdate()
+    {
+      Rtc &r = rtc();
+      r.sqw_generation++;
+      if (r.control & 0x04)
+      {
+        // INTCN = 1: выход SQW/INT используется для будильников DS3231, которые модель не включает
+        pinDrive(RTC_SQW_PIN, -1);
+        return;
+      }
+      if (r.control & 0x18)
+      {
+        fail("DS3231: частота SQW, отличная от 1 Гц, моделью не поддерживается");
+      }
+      // меандр 1 Гц: низкий уровень в первой половине каждой секунды (спад совпадает со сменой секунд)
+      uint64_t phase = (mcu.wall - r.origin) % CPU_HZ;
+      bool low = phase < CPU_HZ / 2;
+      pinDrive(RTC_SQW_PIN, low ? 0 : -1);
+      uint32_t generation = r.sqw_generation;
+      uint64_t next = mcu.wall - phase + (low ? CPU_HZ / 2 : CPU_HZ);
+      schedule(next, [generation]()
+               {
+                 if (generation == rtc().sqw_generation)
+                 {
+                   sqwUpdate();
+                 }
+               });
+    }
+
+    uint8_t rtcRegister(uint8_t reg, const DateFields &f, uint8_t dow)
+    {
+      Rtc &r = rtc();
+      switch (reg)
+      {
+      case 0x00:
+        return (bcd(f.second));
+      case 0x01:
+        return (bcd(f.minute));
+      case 0x02:
+        if (r.h12)
+        {
+          uint8_t h = (uint8_t)(f.hour % 12);
+          return ((uint8_t)(0x40 | ((f.hour >= 12) ? 0x20 : 0) | bcd((h == 0) ? 12 : h)));
+        }
+        return (bcd(f.hour));
+      case 0x03:
+        return (dow);
+      case 0x04:
+        return (bcd(f.day));
+      case 0x05:
+        return (bcd(f.month));
+      case 0x06:
+        return (bcd((uint8_t)(f.year % 100)));
+      case 0x0E:
+        return (r.control);
+      case 0x0F:
+        return (r.status);
+      case 0x10:
+        return (r.aging);
+      case 0x11:
+        return ((uint8_t)(int8_t)(r.temp_quarters >> 2));
+      case 0x12:
+        return ((uint8_t)((r.temp_quarters & 0x03) << 6));
+      default:
+        return (r.alarm[reg - 0x07]);
+      }
+    }
+
+    void rtcWriteRegister(uint8_t reg, uint8_t v)
+    {
+      Rtc &r = rtc();
+      DateFields f = fromSeconds(rtcNow());
+      switch (reg)
+      {
+      case 0x00:
+        f.second = unbcd(v & 0x7F);
+        rtcSetTime(f, true);
+        break;
+      case 0x01:
+        f.minute = unbcd(v & 0x7F);
+        rtcSetTime(f, false);
+        break;
+      case 0x02:
+        r.h12 = v & 0x40;
+        if (r.h12)
+        {
+          uint8_t h = unbcd(v & 0x1F) % 12;
+          f.hour = (uint8_t)(h + ((v & 0x20) ? 12 : 0));
+        }
+        else
+        {
+          f.hour = unbcd(v & 0x3F);
+        }
+        rtcSetTime(f, false);
+        break;
+      case 0x03:
+        r.dow_base = (uint8_t)(((v & 0x07) + 6 - (rtcNow() / 86400 - r.base / 86400) % 7) % 7 + 1);
+        break;
+      case 0x04:
+        f.day = unbcd(v & 0x3F);
+        rtcSetTime(f, false);
+        break;
+      case 0x05:
+        f.month = unbcd(v & 0x1F);
+        rtcSetTime(f, false);
+        break;
+      case 0x06:
+        f.year = (uint16_t)(2000 + unbcd(v));
+        rtcSetTime(f, false);
+        break;
+      case 0x0E:
+        r.control = v;
+        sqwUpdate();
+        break;
+      case 0x0F:
+        // OSF, A2F, A1F сбрасываются записью нуля; BSY только для чтения
+        r.status = (uint8_t)((r.status & v & 0x83) | (v & 0x08) | (r.status & 0x04));
+        break;
+      case 0x10:
+        r.aging = v;
+        break;
+      case 0x11:
+      case 0x12:
+        break;
+      default:
+        r.alarm[reg - 0x07] = v;
+        break;
+      }
+    }
+
+    void rtcWrite(const uint8_t *data, uint8_t len)
+    {
+      Rtc &r = rtc();
+      if (len == 0)
+      {
+        return;
+      }
+      r.ptr = data[0];
+      for (uint8_t i = 1; i < len; i++)
+      {
+        rtcWriteRegister(r.ptr, data[i]);
+        r.ptr = (uint8_t)((r.ptr + 1) % 0x13);
+      }
+    }
+
+    void rtcRead(uint8_t *data, uint8_t len)
+    {
+      // регистры времени защелкиваются в начале чтения
+      Rtc &r = rtc();
+      DateFields f = fromSeconds(rtcNow());
+      uint8_t dow = rtcDow();
+      for (uint8_t i = 0; i < len; i++)
+      {
+        data[i] = rtcRegister(r.ptr, f, dow);
+        r.ptr = (uint8_t)((r.ptr + 1) % 0x13);
+      }
+    }
+
+    uint8_t i2cTransfer(uint8_t addr, uint8_t len)
+    {
+      if (!i2c_begun)
+      {
+        fail("обращение к шине I2C до Wire.begin()");
+      }
+      if (!irqEnabled())
+      {
+        fail("обмен по I2C при запрещенных прерываниях - библиотека Wire зависнет");
+      }
+      spend((uint64_t)(len + 1) * 9 * i2c_bit_cycles + I2C_OVERHEAD_CYCLES);
+      if (i2c_faults > 0)
+      {
+        i2c_faults--;
+        return (2);
+      }
+      return ((addr == RTC_ADDRESS && rtc().present) ? 0 : 2);
+    }
+
+    // ==== экраны ===================================
+
+    struct Tm1637
+    {
+      uint8_t digits[6];
+      uint8_t control;
+    };
+
+    std::map<uint8_t, Tm1637> &tm1637Models()
+    {
+      static std::map<uint8_t, Tm1637> m;
+      return (m);
+    }
+
+    struct Max72xx
+    {
+      std::vector<uint8_t> regs; // по 16 регистров на модуль
+      uint8_t devices;
+    };
+
+    std::map<uint8_t, Max72xx> &max72xxModels()
+    {
+      static std::map<uint8_t, Max72xx> m;
+      return (m);
+    }
+
+    // ==== DS18B20 ==================================
+
+    uint8_t crc8(const uint8_t *addr, uint8_t len)
+    {
+      uint8_t crc = 0;
+      while (len--)
+      {
+        uint8_t inbyte = *addr++;
+        for (uint8_t i = 8; i; i--)
+        {
+          uint8_t mix = (crc ^ inbyte) & 0x01;
+          crc >>= 1;
+          if (mix)
+          {
+            crc ^= 0x8C;
+          }
+          inbyte >>= 1;
+        }
+      }
+      return (crc);
+    }
+
+    enum OneWireState : uint8_t
+    {
+      OW_IDLE,
+      OW_ROM_COMMAND,
+      OW_MATCH_ROM,
+      OW_FUNCTION,
+      OW_READ
+    };
+
+    struct Ds18b20
+    {
+      bool present = true;
+      float temp = 25.0f;
+      int16_t raw = 0x0550; // 85 °C после подачи питания
+      uint8_t rom[8] = {0x28, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x00};
+      OneWireState state = OW_IDLE;
+      uint8_t count = 0;
+      bool selected = false;
+      uint64_t conversion_end = 0;
+      bool converting = false;
+      uint8_t out[9];
+      uint8_t out_len = 0;
+      uint8_t out_pos = 0;
+    };
+
+    Ds18b20 &ds18b20()
+    {
+      static Ds18b20 d;
+      static bool ready = (d.rom[7] = crc8(d.rom, 7), true);
+      (void)ready;
+      return (d);
+    }
+
+    void ds18b20Sync()
+    {
+      Ds18b20 &d = ds18b20();
+      if (d.converting && mcu.wall >= d.conversion_end)
+      {
+        d.converting = false;
+        d.raw = (int16_t)((d.temp >= 0) ? d.temp * 16 + 0.5f : d.temp * 16 - 0.5f);
+      }
+    }
+
+    // слот 1-Wire: библиотека OneWire запрещает прерывания на время каждого бита
+    void oneWireSlots(uint8_t bits)
+    {
+      for (uint8_t i = 0; i < bits; i++)
+      {
+        uint8_t sreg = mcu.reg[REG_SREG];
+        irqDisable();
+        spend(65 * 16);
+        regWrite(REG_SREG, sreg);
+        spend(5 * 16);
+      }
+    }
+  } // namespace
+
+  // ==== I2C ==========================================
+
+  void i2cBegin()
+  {
+    i2c_begun = true;
+    spend(64);
+  }
+
+  void i2cSetClock(uint32_t clock) { i2c_bit_cycles = CPU_HZ / clock; }
+
+  uint8_t i2cWrite(uint8_t addr, const uint8_t *data, uint8_t len)
+  {
+    uint8_t status = i2cTransfer(addr, len);
+    if (status == 0 && addr == RTC_ADDRESS)
+    {
+      rtcWrite(data, len);
+    }
+    I2cTransaction t = {mcu.wall, addr, false, std::vector<uint8_t>(data, data + len), status};
+    i2cTransactions().push_back(t);
+    return (status);
+  }
+
+  uint8_t i2cRead(uint8_t addr, uint8_t *data, uint8_t len)
+  {
+    uint8_t status = i2cTransfer(addr, len);
+    if (status == 0 && addr == RTC_ADDRESS)
+    {
+      rtcRead(data, len);
+    }
+    I2cTransaction t = {mcu.wall, addr, true, std::vector<uint8_t>(data, data + ((status == 0) ? len : 0)), status};
+    i2cTransactions().push_back(t);
+    return ((status == 0) ? len : 0);
+  }
+
+  void i2cFault(uint32_t count) { i2c_faults = count; }
+
+  // ==== часы реального времени =======================
+
+  void setRtc(uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute, uint8_t second)
+  {
+    DateFields f = {year, month, day, hour, minute, second};
+    rtcSetTime(f, true);
+    // день недели по дате: 2000-01-01 - суббота; в регистре 1 - понедельник, как его использует скетч
+    uint32_t days = toSeconds(f) / 86400;
+    rtc().dow_base = (uint8_t)((days + 5) % 7 + 1);
+    rtc().status &= (uint8_t)~0x80;
+  }
+
+  void setRtcTemperature(float temp)
+  {
+    rtc().temp_quarters = (int16_t)((temp >= 0) ? temp * 4 + 0.5f : temp * 4 - 0.5f);
+  }
+
+  uint32_t rtcSeconds() { return (rtcNow()); }
+
+  void setRtcPresent(bool present) { rtc().present = present; }
+
+  // ==== экраны =======================================
+
+  void tm1637Write(uint8_t clk, uint8_t dio, uint8_t pos, const uint8_t *segments, uint8_t len, uint8_t control, unsigned int bit_delay)
+  {
+    (void)dio;
+    // как в библиотеке TM1637: три посылки (команда записи данных, адрес и данные, команда управления), по 28 задержек на байт и по 4 на START/STOP
+    uint32_t bytes = (uint32_t)len + 3;
+    spend((uint64_t)(bytes * 28 + 12) * bit_delay * 16 + bytes * 29 * TM1637_PIN_CYCLES);
+    Tm1637 &m = tm1637Models()[clk];
+    for (uint8_t i = 0; i < len; i++)
+    {
+      m.digits[(pos + i) % 6] = segments[i];
+    }
+    m.control = control;
+    Frame f = {mcu.wall, FRAME_TM1637, std::vector<uint8_t>(m.digits, m.digits + 6), (uint8_t)(control & 0x07), (control & 0x08) != 0};
+    frameLog().push_back(f);
+  }
+
+  void max72xxFrame(uint8_t cs, uint8_t devices, const uint16_t *words)
+  {
+    spend((uint64_t)devices * 32 + SPI_CS_CYCLES);
+    Max72xx &m = max72xxModels()[cs];
+    if (m.regs.empty())
+    {
+      // после подачи питания все модули в режиме отключения
+      m.devices = devices;
+      m.regs.assign((size_t)devices * 16, 0);
+    }
+    for (uint8_t d = 0; d < devices && d < m.devices; d++)
+    {
+      uint8_t reg = (uint8_t)(words[d] >> 8);
+      if (reg > 0 && reg < 16)
+      {
+        m.regs[(size_t)d * 16 + reg] = (uint8_t)words[d];
+      }
+    }
+  }
+
+  void max72xxCommit(uint8_t cs)
+  {
+    Max72xx &m = max72xxModels()[cs];
+    Frame f = {mcu.wall, FRAME_MAX72XX, std::vector<uint8_t>(), 0, false};
+    for (uint8_t d = 0; d < m.devices; d++)
+    {
+      f.data.insert(f.data.end(), &m.regs[(size_t)d * 16 + 1], &m.regs[(size_t)d * 16 + 9]);
+    }
+    if (m.devices > 0)
+    {
+      f.brightness = m.regs[0x0A] & 0x0F;
+      f.on = m.regs[0x0C] & 0x01;
+    }
+    frameLog().push_back(f);
+  }
+
+  void ledStripShow(uint8_t pin, const uint8_t *rgb, uint16_t count, uint8_t brightness, bool clockless)
+  {
+    (void)pin;
+    if (clockless)
+    {
+      // как в FastLED для AVR (clockless_trinket.h): прерывания запрещены на все время передачи, после нее millis() поправляется на потерянные переполнения Timer0, а счетчик micros() - нет
+      uint8_t sreg = mcu.reg[REG_SREG];
+      irqDisable();
+      uint64_t cycles = (uint64_t)count * LED_CLOCKLESS_CYCLES;
+      spend(cycles);
+      uint32_t us = (uint32_t)(cycles / 16);
+      if (us > 1000)
+      {
+        millisAdd((us - 1000) >> 10);
+      }
+      regWrite(REG_SREG, sreg);
+    }
+    else
+    {
+      spend((uint64_t)count * LED_SPI_CYCLES);
+    }
+    Frame f = {mcu.wall, FRAME_LEDS, std::vector<uint8_t>(rgb, rgb + (size_t)count * 3), brightness, brightness > 0};
+    frameLog().push_back(f);
+    poll();
+  }
+
+  // ==== 1-Wire =======================================
+
+  bool oneWireReset(uint8_t pin)
+  {
+    (void)pin;
+    spend(960 * 16);
+    Ds18b20 &d = ds18b20();
+    d.state = d.present ? OW_ROM_COMMAND : OW_IDLE;
+    d.selected = false;
+    d.out_len = 0;
+    return (d.present);
+  }
+
+  void oneWireWrite(uint8_t pin, uint8_t value)
+  {
+    (void)pin;
+    oneWireSlots(8);
+    Ds18b20 &d = ds18b20();
+    ds18b20Sync();
+    switch (d.state)
+    {
+    case OW_ROM_COMMAND:
+      if (value == 0x55)
+      {
+        d.state = OW_MATCH_ROM;
+        d.count = 0;
+        d.selected = true;
+      }
+      else if (value == 0xCC)
+      {
+        d.state = OW_FUNCTION;
+        d.selected = true;
+      }
+      else if (value == 0x33)
+      {
+        memcpy(d.out, d.rom, 8);
+        d.out_len = 8;
+        d.out_pos = 0;
+        d.state = OW_READ;
+      }
+      else
+      {
+        d.state = OW_IDLE;
+      }
+      break;
+    case OW_MATCH_ROM:
+      d.selected = d.selected && value == d.rom[d.count];
+      if (++d.count == 8)
+      {
+        d.state = d.selected ? OW_FUNCTION : OW_IDLE;
+      }
+      break;
+    case OW_FUNCTION:
+      if (value == 0x44)
+      {
+        d.converting = true;
+        d.conversion_end = mcu.wall + DS18B20_CONVERSION_CYCLES;
+        d.state = OW_IDLE;
+      }
+      else if (value == 0xBE)
+      {
+        uint8_t s[9] = {(uint8_t)d.raw, (uint8_t)(d.raw >> 8), 0x4B, 0x46, 0x7F, 0xFF, 0x0C, 0x10, 0};
+        s[8] = crc8(s, 8);
+        memcpy(d.out, s, 9);
+        d.out_len = 9;
+        d.out_pos = 0;
+        d.state = OW_READ;
+      }
+      else
+      {
+        d.state = OW_IDLE;
+      }
+      break;
+    default:
+      break;
+    }
+  }
+
+  uint8_t oneWireRead(uint8_t pin)
+  {
+    (void)pin;
+    oneWireSlots(8);
+    Ds18b20 &d = ds18b20();
+    ds18b20Sync();
+    if (d.state == OW_READ && d.out_pos < d.out_len)
+    {
+      return (d.out[d.out_pos++]);
+    }
+    if (d.present && d.converting)
+    {
+      // во время преобразования датчик отвечает нулями
+      return (0x00);
+    }
+    return (0xFF);
+  }
+
+  bool oneWireSearch(uint8_t pin, uint8_t *rom, bool restart)
+  {
+    if (!oneWireReset(pin) || !restart)
+    {
+      return (false);
+    }
+    oneWireSlots(64 * 3);
+    memcpy(rom, ds18b20().rom, 8);
+    ds18b20().state = OW_FUNCTION;
+    ds18b20().selected = true;
+    return (true);
+  }
+
+  void setDs18b20(float temp) { ds18b20().temp = temp; }
+  void setDs18b20Present(bool present) { ds18b20().present = present; }
+} // namespace sim
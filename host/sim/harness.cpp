@@ -0,0 +1,390 @@
+/* Виртуальный МК ATmega328P - запуск скетча, внешние воздействия, записи и проверки для тестов (см. sim.h);
+   Скетч выполняется в отдельном контексте (ucontext) со своим стеком: sim::run() передает ему управление, а модель возвращает его тесту, как только время доходит до заданного срока, - даже если loop() в этот момент не закончен (например, часы спят в режиме power-down внутри loop()). Указатель стека SP моделируется по глубине стека скетча, отсчитанной от RAMEND, поэтому значения SP сравнимы между собой, но не с AVR - кадры функций на компьютере крупнее.
+*/
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <ucontext.h>
+#include "internal.h"
+#include <Arduino.h>
+#if defined(__SANITIZE_ADDRESS__)
+#include <sanitizer/common_interface_defs.h>
+#define SIM_ASAN_FIBERS
+#endif
+
+void setup(void);
+void loop(void);
+
+namespace sim
+{
+  namespace
+  {
+    const size_t SKETCH_STACK_SIZE = 1u << 20;
+    const uint8_t STACK_PAINT = 0xA5; // контрольный байт незанятой части стека скетча
+    const uint64_t NEVER = ~0ull;
+
+    uint64_t loop_cost = 50 * 16;
+    uint64_t boot_cycles = 0;
+    uint32_t check_total = 0;
+    uint32_t check_failed = 0;
+
+    ucontext_t harness_context;
+    ucontext_t sketch_context;
+    uint8_t *sketch_stack = NULL;
+    bool in_sketch = false;
+    uint64_t deadline = NEVER;
+#ifdef SIM_ASAN_FIBERS
+    const void *harness_stack_bottom = NULL;
+    size_t harness_stack_size = 0;
+#endif
+
+    void switchToHarness()
+    {
+      in_sketch = false;
+#ifdef SIM_ASAN_FIBERS
+      void *fake_stack = NULL;
+      __sanitizer_start_switch_fiber(&fake_stack, harness_stack_bottom, harness_stack_size);
+      swapcontext(&sketch_context, &harness_context);
+      __sanitizer_finish_switch_fiber(fake_stack, &harness_stack_bottom, &harness_stack_size);
+#else
+      swapcontext(&sketch_context, &harness_context);
+#endif
+      in_sketch = true;
+    }
+
+    void switchToSketch()
+    {
+      in_sketch = true;
+#ifdef SIM_ASAN_FIBERS
+      void *fake_stack = NULL;
+      __sanitizer_start_switch_fiber(&fake_stack, sketch_stack, SKETCH_STACK_SIZE);
+      swapcontext(&harness_context, &sketch_context);
+      __sanitizer_finish_switch_fiber(fake_stack, NULL, NULL);
+#else
+      swapcontext(&harness_context, &sketch_context);
+#endif
+      in_sketch = false;
+    }
+
+    // main() ядра Arduino
+    void sketchMain()
+    {
+#ifdef SIM_ASAN_FIBERS
+      __sanitizer_finish_switch_fiber(NULL, &harness_stack_bottom, &harness_stack_size);
+#endif
+      mcu.stack_top = (uintptr_t)(sketch_stack + SKETCH_STACK_SIZE);
+      init();
+      boot_cycles = mcu.wall;
+      setup();
+      switchToHarness();
+      for (;;)
+      {
+        loop();
+        spend(loop_cost);
+      }
+    }
+
+    // MAX72xx: DP - бит 7, A - бит 6, ..., G - бит 0; TM1637: A - бит 0, ..., G - бит 6, DP - бит 7
+    uint8_t maxToTm(uint8_t v)
+    {
+      uint8_t result = v & 0x80;
+      for (uint8_t s = 0; s < 7; s++)
+      {
+        if (v & (1 << (6 - s)))
+        {
+          result |= (uint8_t)(1 << s);
+        }
+      }
+      return (result);
+    }
+
+    char segmentChar(uint8_t v)
+    {
+      static const struct
+      {
+        uint8_t segments;
+        char c;
+      } table[] = {{0x3f, '0'}, {0x06, '1'}, {0x5b, '2'}, {0x4f, '3'}, {0x66, '4'}, {0x6d, '5'},
+                   {0x7d, '6'}, {0x07, '7'}, {0x7f, '8'}, {0x6f, '9'}, {0x77, 'A'}, {0x7c, 'b'},
+                   {0x39, 'C'}, {0x5e, 'd'}, {0x79, 'E'}, {0x71, 'F'}, {0x38, 'L'}, {0x5c, 'o'},
+                   {0x1d, 'u'}, {0x54, 'n'}, {0x50, 'r'}, {0x74, 'h'}, {0x40, '-'}, {0x08, '_'},
+                   {0x63, '*'}, {0x00, ' '}};
+      for (size_t i = 0; i < sizeof(table) / sizeof(table[0]); i++)
+      {
+        if (table[i].segments == v)
+        {
+          return (table[i].c);
+        }
+      }
+      return ('?');
+    }
+  } // namespace
+
+  Stats &statsRef()
+  {
+    static Stats s;
+    return (s);
+  }
+
+  std::vector<Frame> &frameLog()
+  {
+    static std::vector<Frame> v;
+    return (v);
+  }
+
+  std::vector<Note> &noteLog()
+  {
+    static std::vector<Note> v;
+    return (v);
+  }
+
+  std::vector<EepromWrite> &eepromLog()
+  {
+    static std::vector<EepromWrite> v;
+    return (v);
+  }
+
+  std::vector<I2cTransaction> &i2cTransactions()
+  {
+    static std::vector<I2cTransaction> v;
+    return (v);
+  }
+
+  std::vector<PinEvent> &pinEvents()
+  {
+    static std::vector<PinEvent> v;
+    return (v);
+  }
+
+  uint64_t harnessDeadline() { return (deadline); }
+
+  void harnessYield()
+  {
+    if (in_sketch && mcu.wall >= deadline)
+    {
+      switchToHarness();
+    }
+  }
+
+  uint16_t stackPointer()
+  {
+    uintptr_t here = (uintptr_t)__builtin_frame_address(0);
+    uintptr_t depth = (mcu.stack_top > here) ? mcu.stack_top - here : 0;
+    return ((depth < RAMEND) ? (uint16_t)(RAMEND - depth) : 0);
+  }
+
+  // ==== запуск скетча ================================
+
+  void boot()
+  {
+    if (sketch_stack != NULL)
+    {
+      fail("повторный вызов sim::boot()");
+    }
+    sketch_stack = new uint8_t[SKETCH_STACK_SIZE];
+    memset(sketch_stack, STACK_PAINT, SKETCH_STACK_SIZE);
+    getcontext(&sketch_context);
+    sketch_context.uc_stack.ss_sp = sketch_stack;
+    sketch_context.uc_stack.ss_size = SKETCH_STACK_SIZE;
+    sketch_context.uc_link = NULL;
+    makecontext(&sketch_context, sketchMain, 0);
+    switchToSketch();
+  }
+
+  void run(uint32_t ms)
+  {
+    if (sketch_stack == NULL)
+    {
+      fail("sim::run() до sim::boot()");
+    }
+    deadline = mcu.wall + (uint64_t)ms * CYCLES_PER_MS;
+    switchToSketch();
+    deadline = NEVER;
+  }
+
+  bool runUntil(const std::function<bool()> &cond, uint32_t timeout_ms)
+  {
+    for (uint32_t t = 0; t < timeout_ms; t++)
+    {
+      run(1);
+      if (cond())
+      {
+        return (true);
+      }
+    }
+    return (false);
+  }
+
+  void setLoopCost(uint32_t us) { loop_cost = (uint64_t)us * (CPU_HZ / 1000000ul); }
+
+  uint64_t cycles() { return (mcu.wall); }
+  uint64_t cpuCycles() { return (mcu.cpu); }
+  uint32_t nowMs() { return ((uint32_t)(mcu.wall / CYCLES_PER_MS)); }
+  uint64_t bootCycles() { return (boot_cycles); }
+
+  // в занятой части стека лежат кадры приостановленного скетча, отравленные AddressSanitizer, поэтому проверка идет без него
+  __attribute__((no_sanitize_address)) size_t stackUsage()
+  {
+    if (sketch_stack == NULL)
+    {
+      return (0);
+    }
+    size_t free = 0;
+    while (free < SKETCH_STACK_SIZE && sketch_stack[free] == STACK_PAINT)
+    {
+      free++;
+    }
+    return (SKETCH_STACK_SIZE - free);
+  }
+
+  // ==== внешние воздействия ==========================
+
+  void at(uint32_t delay_ms, const std::function<void()> &fn) { schedule(mcu.wall + (uint64_t)delay_ms * CYCLES_PER_MS, fn); }
+
+  void setButton(uint8_t pin, bool pressed) { pinDrive(pin, pressed ? 0 : -1); }
+
+  void press(uint8_t pin, uint32_t hold_ms, uint8_t bounce)
+  {
+    // при дребезге контакт переключается каждую миллисекунду и замыкается (размыкается) окончательно через 2 * bounce мс
+    for (uint32_t k = 0; k <= 2u * bounce; k++)
+    {
+      bool closed = (k % 2 == 0);
+      at(k, [pin, closed]()
+         { setButton(pin, closed); });
+      at(hold_ms + k, [pin, closed]()
+         { setButton(pin, !closed); });
+    }
+    run(hold_ms + 2u * bounce + 1);
+  }
+
+  void setAnalog(uint8_t pin, uint16_t value)
+  {
+    if (pin < PIN_COUNT)
+    {
+      mcu.pin[pin].analog = value;
+    }
+  }
+
+  // ==== записи модели ================================
+
+  const std::vector<Frame> &frames() { return (frameLog()); }
+  const std::vector<Note> &notes() { return (noteLog()); }
+  const std::vector<EepromWrite> &eepromWrites() { return (eepromLog()); }
+  const std::vector<I2cTransaction> &i2cLog() { return (i2cTransactions()); }
+  const std::vector<PinEvent> &pinLog() { return (pinEvents()); }
+
+  void clearLogs()
+  {
+    // последний кадр остается - по нему разбирается текущее изображение
+    if (frameLog().size() > 1)
+    {
+      frameLog().erase(frameLog().begin(), frameLog().end() - 1);
+    }
+    if (!noteLog().empty() && noteLog().back().end == 0)
+    {
+      noteLog().erase(noteLog().begin(), noteLog().end() - 1);
+    }
+    else
+    {
+      noteLog().clear();
+    }
+    eepromLog().clear();
+    i2cTransactions().clear();
+    pinEvents().clear();
+  }
+
+  const Stats &stats() { return (statsRef()); }
+
+  // ==== разбор кадров ================================
+
+  const Frame *lastFrame() { return (frameLog().empty() ? NULL : &frameLog().back()); }
+
+  uint8_t segments(const Frame &f, uint8_t index)
+  {
+    if (index > 3)
+    {
+      return (0);
+    }
+    switch (f.kind)
+    {
+    case FRAME_TM1637:
+      return (f.data[index]);
+    case FRAME_MAX72XX:
+      // разряды экрана MAX72xx - 7..4 слева направо
+      return ((f.data.size() >= 8) ? maxToTm(f.data[7 - index]) : 0);
+    default:
+      return (0);
+    }
+  }
+
+  uint8_t segments(uint8_t index)
+  {
+    const Frame *f = lastFrame();
+    return ((f == NULL) ? 0 : segments(*f, index));
+  }
+
+  std::string text(const Frame &f)
+  {
+    std::string s;
+    for (uint8_t i = 0; i < 4; i++)
+    {
+      uint8_t v = segments(f, i);
+      s += segmentChar(v & 0x7F);
+      if (i == 1 && (v & 0x80))
+      {
+        s += ':';
+      }
+    }
+    return (s);
+  }
+
+  std::string text()
+  {
+    const Frame *f = lastFrame();
+    return ((f == NULL) ? std::string("    ") : text(*f));
+  }
+
+  std::vector<uint8_t> ledColumns()
+  {
+    std::vector<uint8_t> columns;
+    const Frame *f = lastFrame();
+    if (f == NULL || f->kind != FRAME_LEDS)
+    {
+      return (columns);
+    }
+    // светодиоды по столбцам (BY_COLUMNS): четные столбцы сверху вниз, нечетные снизу вверх
+    size_t count = f->data.size() / 3;
+    columns.assign(count / 8, 0);
+    for (size_t col = 0; col < columns.size(); col++)
+    {
+      for (uint8_t row = 0; row < 8; row++)
+      {
+        size_t led = col * 8 + ((col & 0x01) ? 7 - row : row);
+        const uint8_t *rgb = &f->data[led * 3];
+        if (f->on && (rgb[0] || rgb[1] || rgb[2]))
+        {
+          columns[col] |= (uint8_t)(0x80 >> row);
+        }
+      }
+    }
+    return (columns);
+  }
+
+  // ==== проверки =====================================
+
+  void check(bool cond, const char *expr, const char *file, int line)
+  {
+    check_total++;
+    if (!cond)
+    {
+      check_failed++;
+      fprintf(stderr, "%s:%d: %.3f мс: не выполнено: %s\n", file, line, (double)mcu.wall / CYCLES_PER_MS, expr);
+    }
+  }
+
+  int checkResult()
+  {
+    fprintf(stderr, "проверок: %u, не выполнено: %u\n", check_total, check_failed);
+    return ((check_failed == 0) ? 0 : 1);
+  }
+} // namespace sim
@@ -0,0 +1,105 @@
+/* Виртуальный МК ATmega328P - общее состояние модели для файлов каталога host/sim;
+   Состояние ядра хранится в одной структуре с константной инициализацией, потому что к модели обращаются конструкторы глобальных объектов скетча еще до main(); контейнеры STL создаются при первом обращении.
+*/
+#pragma once
+#include <functional>
+#include "mcu.h"
+#include "sim.h"
+
+namespace sim
+{
+  const uint8_t PIN_COUNT = 22; // D0..D13, A0..A7
+
+  // номера векторов прерываний ATmega328P
+  enum Vector : uint8_t
+  {
+    VEC_INT0 = 1,
+    VEC_INT1 = 2,
+    VEC_PCINT0 = 3,
+    VEC_PCINT1 = 4,
+    VEC_PCINT2 = 5,
+    VEC_WDT = 6,
+    VEC_TIMER1_COMPA = 11,
+    VEC_TIMER1_COMPB = 12,
+    VEC_TIMER1_OVF = 13,
+    VEC_TIMER0_OVF = 16,
+    VEC_USART_RX = 18
+  };
+
+  struct Pin
+  {
+    uint8_t ddr;     // 1 - выход
+    uint8_t port;    // уровень выхода или подтяжка входа
+    uint8_t drive;   // внешний уровень: 0 - не задан, 1 - замкнут на GND, 2 - подан высокий уровень
+    uint16_t analog; // показание АЦП для аналоговых входов
+  };
+
+  struct Mcu
+  {
+    uint64_t wall;       // реальное время, тактов
+    uint64_t cpu;        // время тактового генератора, тактов
+    uint8_t reg[REG_COUNT];
+    uint8_t isr_depth;
+    bool clock_stopped;  // режим power-down
+    uint64_t irq_off_since;
+    uint32_t dispatched; // всего вызовов обработчиков прерываний
+
+    // Timer0 - millis()
+    uint64_t t0_base;    // номер такта предделителя, с которого идет счет
+    uint64_t t0_seen;    // учтенных переполнений
+    uint32_t t0_millis;
+    uint8_t t0_fract;
+    uint32_t t0_overflow_count;
+
+    // Timer1
+    uint16_t t1_count;
+    bool t1_down;        // обратный счет в режиме PWM phase correct
+    uint64_t t1_done;    // номер такта предделителя, до которого досчитан t1_count
+    uint16_t ocr1a;
+    uint16_t ocr1b;
+    uint16_t icr1;
+
+    // сторожевой таймер
+    bool wdt_unlock;
+    uint64_t wdt_start;
+
+    // внешние прерывания INT0/INT1
+    void (*int_func[2])(void);
+
+    Pin pin[PIN_COUNT];
+    uintptr_t stack_top; // вершина стека скетча, для модели указателя стека
+  };
+
+  extern Mcu mcu;
+
+  typedef void (*VectorFunc)(void);
+  VectorFunc *vectorTable();
+
+  bool irqEnabled();
+  void dispatch();
+  void schedule(uint64_t time, const std::function<void()> &fn);
+  void timer0Isr();
+  void externalIsr(uint8_t n);
+  uint16_t stackPointer();
+  void pinDrive(uint8_t pin, int8_t level); // -1 - отпустить пин, 0 - замкнуть на GND, 1 - подать высокий уровень
+  uint8_t pinLevel(uint8_t pin);
+  void onPinChange(uint8_t pin, uint8_t level);
+  Stats &statsRef();
+
+  // скетч выполняется в отдельном контексте со своим стеком; модель возвращает управление тесту, когда время доходит до срока, заданного sim::run()
+  uint64_t harnessDeadline();
+  void harnessYield();
+
+  // записи
+  std::vector<Frame> &frameLog();
+  std::vector<Note> &noteLog();
+  std::vector<EepromWrite> &eepromLog();
+  std::vector<I2cTransaction> &i2cTransactions();
+  std::vector<PinEvent> &pinEvents();
+
+  // UART
+  void serialReceive(uint8_t c);
+  bool serialRxPending();
+  void usartRxIsr();
+  uint64_t serialByteCycles();
+} // namespace sim
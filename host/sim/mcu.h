@@ -0,0 +1,153 @@
+/* Виртуальный МК ATmega328P 16 МГц - интерфейс для прослоек библиотек Arduino;
+   Заголовок подключается к скетчу через Arduino.h, поэтому в нем нет ни заголовков STL, ни функций стандартной библиотеки С, имена которых совпадают с именами объектов скетча (clock, alarm и т.п.). Все функции реализованы в библиотеке clock_sim (каталог host/sim).
+
+   Время модели считается в тактах МК (62,5 нс): реальное время идет всегда, время тактового генератора (по нему считают Timer0 и Timer1) останавливается в режиме power-down. Код скетча выполняется мгновенно, время продвигается только при обращениях к модели (задержки, ввод-вывод, передачи на экран и т.д.) и между проходами loop() (см. sim::setLoopCost()). Каждое обращение к модели - точка обработки прерываний: если флаг I установлен, ожидающие прерывания выполняются в порядке приоритета векторов ATmega328P.
+*/
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+namespace sim
+{
+  // ==== регистры =====================================
+  enum Reg : uint8_t
+  {
+    REG_SREG,
+    REG_SP,
+    REG_MCUSR,
+    REG_SMCR,
+    REG_WDTCSR,
+    REG_EICRA,
+    REG_EIMSK,
+    REG_EIFR,
+    REG_PCICR,
+    REG_PCIFR,
+    REG_PCMSK0,
+    REG_PCMSK1,
+    REG_PCMSK2,
+    REG_ADCSRA,
+    REG_TCCR0A,
+    REG_TCCR0B,
+    REG_TCNT0,
+    REG_TIMSK0,
+    REG_TIFR0,
+    REG_TCCR1A,
+    REG_TCCR1B,
+    REG_TCCR1C,
+    REG_TCNT1,
+    REG_OCR1A,
+    REG_OCR1B,
+    REG_ICR1,
+    REG_TIMSK1,
+    REG_TIFR1,
+    REG_COUNT
+  };
+
+  uint16_t regRead(uint8_t reg);
+  void regWrite(uint8_t reg, uint16_t value);
+
+  // ==== время и прерывания ===========================
+  const uint32_t CPU_HZ = 16000000ul;
+
+  /**
+   * @brief выполнение кода заданной длительности с текущим состоянием флага I; прерывания, наступившие за это время, обрабатываются в свои моменты
+   *
+   * @param cycles такты МК
+   */
+  void spend(uint64_t cycles);
+
+  /**
+   * @brief выполнение кода заданной длительности
+   *
+   * @param us микросекунды
+   */
+  inline void spendMicros(uint32_t us) { spend((uint64_t)us * (CPU_HZ / 1000000ul)); }
+
+  void poll();
+  void irqDisable(); // cli
+  void irqEnable();  // sei
+  void sleepCpu();
+  void wdtReset();
+
+  // ==== прослойки библиотек ==========================
+  void fail(const char *format, ...) __attribute__((format(printf, 1, 2), noreturn));
+
+  // Timer0 - счетчик millis(), как в ядре Arduino
+  uint32_t millisNow();
+  uint32_t microsNow();
+  void millisAdd(uint32_t ms); // поправка счетчика millis(), как это делает FastLED
+
+  // пины
+  void pinModeSet(uint8_t pin, uint8_t mode);
+  void pinWrite(uint8_t pin, uint8_t value);
+  int pinRead(uint8_t pin);
+  int adcRead(uint8_t pin);
+  void pinAttach(uint8_t irq, void (*func)(void), int mode);
+  void pinDetach(uint8_t irq);
+  void toneStart(uint8_t pin, unsigned int frequency, unsigned long duration);
+  void toneStop(uint8_t pin);
+
+  // EEPROM
+  uint8_t eepromRead(int idx);
+  void eepromWrite(int idx, uint8_t value);
+
+  // UART
+  void serialBegin(unsigned long baud);
+  void serialEnd();
+  int serialAvailable();
+  int serialPeek();
+  int serialRead();
+  int serialAvailableForWrite();
+  void serialWrite(uint8_t c);
+  void serialFlush();
+
+  // шина I2C; результат - код endTransmission(): 0 - успешно, 2 - нет ответа на адрес, 3 - нет ответа на данные
+  void i2cBegin();
+  void i2cSetClock(uint32_t clock);
+  uint8_t i2cWrite(uint8_t addr, const uint8_t *data, uint8_t len);
+  uint8_t i2cRead(uint8_t addr, uint8_t *data, uint8_t len);
+
+  // экраны
+  void tm1637Write(uint8_t clk, uint8_t dio, uint8_t pos, const uint8_t *segments, uint8_t len, uint8_t control, unsigned int bit_delay);
+  void max72xxFrame(uint8_t cs, uint8_t devices, const uint16_t *words); // words[dev] = (регистр << 8) | значение; регистр 0 - нет операции
+  void max72xxCommit(uint8_t cs);                                         // конец обновления экрана - запись кадра
+  void ledStripShow(uint8_t pin, const uint8_t *rgb, uint16_t count, uint8_t brightness, bool clockless);
+
+  // шина 1-Wire
+  bool oneWireReset(uint8_t pin);
+  void oneWireWrite(uint8_t pin, uint8_t value);
+  uint8_t oneWireRead(uint8_t pin);
+  bool oneWireSearch(uint8_t pin, uint8_t *rom, bool restart);
+} // namespace sim
+
+// регистр ввода-вывода МК; объекты только хранят номер регистра (и потому константны), значения хранит модель; аргументы операций шире регистра, чтобы выражения вида ~bit(x) усекались так же молча, как на AVR
+struct SimReg8
+{
+  uint8_t reg;
+  operator uint8_t() const { return ((uint8_t)sim::regRead(reg)); }
+  const SimReg8 &operator=(unsigned long long v) const
+  {
+    sim::regWrite(reg, (uint8_t)v);
+    return (*this);
+  }
+  const SimReg8 &operator=(const SimReg8 &other) const { return (*this = (uint8_t)other); }
+  const SimReg8 &operator|=(unsigned long long v) const { return (*this = (uint8_t)(*this | v)); }
+  const SimReg8 &operator&=(unsigned long long v) const { return (*this = (uint8_t)(*this & v)); }
+  const SimReg8 &operator^=(unsigned long long v) const { return (*this = (uint8_t)(*this ^ v)); }
+};
+
+struct SimReg16
+{
+  uint8_t reg;
+  operator uint16_t() const { return (sim::regRead(reg)); }
+  const SimReg16 &operator=(unsigned long long v) const
+  {
+    sim::regWrite(reg, (uint16_t)v);
+    return (*this);
+  }
+  const SimReg16 &operator=(const SimReg16 &other) const { return (*this = (uint16_t)other); }
+  const SimReg16 &operator+=(unsigned long long v) const { return (*this = (uint16_t)(*this + v)); }
+  const SimReg16 &operator-=(unsigned long long v) const { return (*this = (uint16_t)(*this - v)); }
+  const SimReg16 &operator|=(unsigned long long v) const { return (*this = (uint16_t)(*this | v)); }
+  const SimReg16 &operator&=(unsigned long long v) const { return (*this = (uint16_t)(*this & v)); }
+};
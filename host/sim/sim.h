@@ -0,0 +1,232 @@
+/* Виртуальный МК ATmega328P 16 МГц - интерфейс для тестов;
+   Тест собирается вместе со скетчем (см. host/CMakeLists.txt) и управляет моделью: запускает setup() и loop(), нажимает кнопки, подает байты в Serial, задает показания датчиков и часов реального времени, а затем проверяет записанные моделью кадры экрана, ноты пищалки, записи в EEPROM и транзакции I2C. Время модели - реальное время от подачи питания; см. также host/sim/mcu.h.
+*/
+#pragma once
+#include <stdint.h>
+#include <stdio.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace sim
+{
+  const uint32_t CYCLES_PER_MS = 16000ul;
+
+  // ==== запуск скетча ================================
+
+  /**
+   * @brief запуск скетча: init() ядра Arduino и setup()
+   *
+   */
+  void boot();
+
+  /**
+   * @brief выполнение loop() в течение заданного времени
+   *
+   * @param ms миллисекунды реального времени
+   */
+  void run(uint32_t ms);
+
+  /**
+   * @brief выполнение loop() до выполнения условия, но не дольше заданного времени
+   *
+   * @param cond условие, проверяется после каждого прохода loop()
+   * @param timeout_ms ограничение времени, мс
+   * @return true, если условие выполнилось
+   */
+  bool runUntil(const std::function<bool()> &cond, uint32_t timeout_ms);
+
+  /**
+   * @brief установка длительности одного прохода loop() без учета обращений к модели; по умолчанию 50 мкс; для долгих сценариев ее можно увеличить, чтобы модель работала быстрее
+   *
+   * @param us микросекунды
+   */
+  void setLoopCost(uint32_t us);
+
+  uint64_t cycles();      // реальное время от подачи питания, тактов
+  uint64_t cpuCycles();   // время работы тактового генератора МК, тактов
+  uint32_t nowMs();       // реальное время от подачи питания, мс
+  uint64_t bootCycles();  // момент вызова setup(), тактов
+
+  /**
+   * @brief наибольшая глубина стека скетча от запуска, байт; при запуске стек скетча заполняется контрольным байтом, и глубина определяется по границе незатертой области; в нее входят обработчики прерываний и код модели, выполняемый на стеке скетча. Кадры функций на компьютере крупнее, чем на AVR, а с AddressSanitizer еще крупнее, поэтому значения сравнимы только между собой в одной сборке; чтобы в глубину не попадал загрузчик, связывающий функции библиотек при первом вызове, тест запускается с LD_BIND_NOW=1 (так его запускает ctest)
+   *
+   */
+  size_t stackUsage();
+
+  // ==== внешние воздействия ==========================
+
+  /**
+   * @brief выполнение функции в заданный момент реального времени, в том числе во время сна МК
+   *
+   * @param delay_ms задержка от текущего момента, мс
+   * @param fn функция
+   */
+  void at(uint32_t delay_ms, const std::function<void()> &fn);
+
+  /**
+   * @brief замыкание или размыкание кнопки между пином и GND
+   *
+   */
+  void setButton(uint8_t pin, bool pressed);
+
+  /**
+   * @brief нажатие кнопки с дребезгом контактов; loop() при этом выполняется
+   *
+   * @param pin пин кнопки
+   * @param hold_ms время удержания, мс
+   * @param bounce количество дополнительных переключений контактов при нажатии и отпускании (по 1 мс)
+   */
+  void press(uint8_t pin, uint32_t hold_ms = 100, uint8_t bounce = 0);
+
+  void setAnalog(uint8_t pin, uint16_t value);
+  void serialInput(const std::string &data);
+  std::string serialOutput();
+  void serialClear();
+
+  void setRtc(uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute, uint8_t second);
+  void setRtcTemperature(float temp);
+  uint32_t rtcSeconds(); // текущее время часов реального времени, секунд от 2000-01-01 00:00:00
+  void setRtcPresent(bool present);
+  void setDs18b20(float temp);
+  void setDs18b20Present(bool present);
+
+  /**
+   * @brief отказ шины I2C: заданное количество следующих транзакций завершится без ответа устройства
+   *
+   */
+  void i2cFault(uint32_t count);
+
+  uint8_t *eeprom(); // содержимое EEPROM, 1024 байта; до boot() его можно заполнить
+
+  // ==== записи модели ================================
+
+  enum FrameKind : uint8_t
+  {
+    FRAME_TM1637,
+    FRAME_MAX72XX,
+    FRAME_LEDS
+  };
+
+  struct Frame
+  {
+    uint64_t time;  // момент окончания передачи, тактов
+    FrameKind kind;
+    std::vector<uint8_t> data; // TM1637 - 6 разрядов; MAX72xx - по 8 строк каждого модуля; светодиоды - R, G, B каждого
+    uint8_t brightness;        // TM1637 - 0..7, MAX72xx - 0..15 первого модуля, светодиоды - 0..255
+    bool on;                   // экран включен
+  };
+
+  struct Note
+  {
+    uint64_t start; // тактов
+    uint64_t end;   // тактов; 0 - нота еще звучит
+    uint8_t pin;
+    unsigned int frequency;
+  };
+
+  struct EepromWrite
+  {
+    uint64_t time;
+    uint16_t addr;
+    uint8_t old_value;
+    uint8_t value;
+  };
+
+  struct I2cTransaction
+  {
+    uint64_t time;
+    uint8_t addr;
+    bool read;
+    std::vector<uint8_t> data;
+    uint8_t status; // код endTransmission(); для чтения 0 - данные получены
+  };
+
+  struct PinEvent
+  {
+    uint64_t time;
+    uint8_t pin;
+    uint8_t level;
+  };
+
+  const std::vector<Frame> &frames();
+  const std::vector<Note> &notes();
+  const std::vector<EepromWrite> &eepromWrites();
+  const std::vector<I2cTransaction> &i2cLog();
+  const std::vector<PinEvent> &pinLog(); // изменения уровня на выходах, кроме пинов экранов
+  void clearLogs();
+
+  struct Stats
+  {
+    uint32_t isr[26];            // количество вызовов обработчиков по номерам векторов
+    uint32_t sleeps_idle;        // засыпаний в режиме idle
+    uint32_t sleeps_power_down;  // засыпаний в режиме power-down
+    uint64_t idle_cycles;        // время в режиме idle, тактов
+    uint64_t power_down_cycles;  // время в режиме power-down, тактов
+    uint64_t irq_off_max;        // самый долгий интервал с запрещенными прерываниями, тактов
+    uint32_t t0_lost;            // потерянных переполнений Timer0 (millis() отстает)
+    uint32_t serial_dropped;     // байт Serial, потерянных при приеме
+    uint32_t serial_tx_wait;     // ожиданий места в буфере передачи Serial
+  };
+  const Stats &stats();
+
+  // ==== разбор кадров ================================
+
+  /**
+   * @brief последний записанный кадр экрана
+   *
+   * @return указатель на кадр или NULL, если кадров не было
+   */
+  const Frame *lastFrame();
+
+  /**
+   * @brief сегменты разряда 7-сегментного экрана (TM1637 или MAX72xx) в последнем кадре в порядке битов TM1637 (A - бит 0, ..., G - бит 6, точка/двоеточие - бит 7)
+   *
+   * @param index разряд 0..3 слева направо
+   */
+  uint8_t segments(uint8_t index);
+  uint8_t segments(const Frame &f, uint8_t index); // то же для заданного кадра
+
+  /**
+   * @brief текст 7-сегментного экрана в последнем кадре: 4 символа, двоеточие (бит 7 второго разряда) передается символом ':' после второго разряда; нераспознанные сочетания сегментов - '?', пустой разряд - ' '
+   *
+   */
+  std::string text();
+  std::string text(const Frame &f); // то же для заданного кадра
+
+  /**
+   * @brief столбцы изображения 32х8 матрицы адресных светодиодов в последнем кадре (бит 7 - верхняя строка); светодиод считается горящим, если хотя бы одна его составляющая не равна нулю
+   *
+   */
+  std::vector<uint8_t> ledColumns();
+
+  // ==== проверки =====================================
+
+  void check(bool cond, const char *expr, const char *file, int line);
+  int checkResult(); // код возврата теста: 0, если все проверки прошли
+
+  // ==== аварийная остановка ==========================
+  void fail(const char *format, ...) __attribute__((format(printf, 1, 2), noreturn));
+} // namespace sim
+
+#define CHECK(cond) sim::check((cond), #cond, __FILE__, __LINE__)
+#define CHECK_EQ(a, b)                                                                            \
+  do                                                                                              \
+  {                                                                                               \
+    auto check_a_ = (a);                                                                          \
+    auto check_b_ = (b);                                                                          \
+    if (!(check_a_ == check_b_))                                                                  \
+    {                                                                                             \
+      fprintf(stderr, "  %s = %s, %s = %s\n", #a, sim::checkRepr(check_a_).c_str(), #b,           \
+              sim::checkRepr(check_b_).c_str());                                                  \
+    }                                                                                             \
+    sim::check(check_a_ == check_b_, #a " == " #b, __FILE__, __LINE__);                           \
+  } while (0)
+
+namespace sim
+{
+  inline std::string checkRepr(const std::string &v) { return ("\"" + v + "\""); }
+  inline std::string checkRepr(const char *v) { return (checkRepr(std::string(v))); }
+  template <typename T>
+  std::string checkRepr(const T &v) { return (std::to_string(v)); }
+} // namespace sim
@@ -0,0 +1,54 @@
+/* Виртуальный МК ATmega328P - таблица векторов прерываний;
+   Векторы, которые на AVR занимает ядро Arduino (INT0/INT1 для attachInterrupt(), Timer2 для tone(), Timer0 для millis(), UART для Serial, TWI для Wire), определены здесь обычными функциями, поэтому их повторное определение в скетче дает ошибку компоновки, как и на AVR. Остальные векторы определены слабыми символами: если скетч не задал обработчик через ISR(), срабатывание прерывания останавливает модель, как переход на __bad_interrupt сбрасывает AVR.
+*/
+#include "internal.h"
+
+#define SIM_BAD_VECTOR(n)                                                              \
+  void __vector_##n(void) __attribute__((weak));                                       \
+  void __vector_##n(void)                                                              \
+  {                                                                                    \
+    sim::fail("прерывание %d без обработчика (на AVR - __bad_interrupt и сброс МК)", n); \
+  }
+
+extern "C"
+{
+  void __vector_1(void) { sim::externalIsr(0); }
+  void __vector_2(void) { sim::externalIsr(1); }
+  SIM_BAD_VECTOR(3)
+  SIM_BAD_VECTOR(4)
+  SIM_BAD_VECTOR(5)
+  SIM_BAD_VECTOR(6)
+  void __vector_7(void) {} // Timer2 COMPA - tone(); модель записывает ноты без генерации прерываний
+  SIM_BAD_VECTOR(8)
+  SIM_BAD_VECTOR(9)
+  SIM_BAD_VECTOR(10)
+  SIM_BAD_VECTOR(11)
+  SIM_BAD_VECTOR(12)
+  SIM_BAD_VECTOR(13)
+  SIM_BAD_VECTOR(14)
+  SIM_BAD_VECTOR(15)
+  void __vector_16(void) { sim::timer0Isr(); }
+  SIM_BAD_VECTOR(17)
+  void __vector_18(void) { sim::usartRxIsr(); }
+  void __vector_19(void) {} // UART UDRE - передача Serial; модель считает ее время без прерываний
+  SIM_BAD_VECTOR(20)
+  SIM_BAD_VECTOR(21)
+  SIM_BAD_VECTOR(22)
+  SIM_BAD_VECTOR(23)
+  void __vector_24(void) {} // TWI - Wire
+  SIM_BAD_VECTOR(25)
+}
+
+namespace sim
+{
+  VectorFunc *vectorTable()
+  {
+    static VectorFunc table[26] = {
+        NULL, __vector_1, __vector_2, __vector_3, __vector_4, __vector_5, __vector_6,
+        __vector_7, __vector_8, __vector_9, __vector_10, __vector_11, __vector_12,
+        __vector_13, __vector_14, __vector_15, __vector_16, __vector_17, __vector_18,
+        __vector_19, __vector_20, __vector_21, __vector_22, __vector_23, __vector_24,
+        __vector_25};
+    return (table);
+  }
+} // namespace sim
@@ -0,0 +1,49 @@
+/* Время от подачи питания до первого кадра с текущим временем; первый же непустой кадр должен показывать время, считанное из DS3231, а не случайное значение */
+#include <algorithm>
+#include "sim.h"
+
+// предел времени до первого кадра; передача кадра на TM1637 с задержками библиотеки занимает около 20 мс
+const uint32_t FIRST_FRAME_LIMIT_US = 100000ul;
+
+bool isBlank(const sim::Frame &f)
+{
+  return (!f.on || std::all_of(f.data.begin(), f.data.end(), [](uint8_t v)
+                               { return (v == 0); }));
+}
+
+int main()
+{
+  sim::setRtc(2024, 5, 6, 12, 34, 50);
+  sim::setDs18b20(21.0f);
+  sim::boot();
+  sim::run(1000);
+
+  const sim::Frame *first = NULL;
+  for (const sim::Frame &f : sim::frames())
+  {
+    if (!isBlank(f))
+    {
+      first = &f;
+      break;
+    }
+  }
+  CHECK(first != NULL);
+  if (first == NULL)
+  {
+    return (sim::checkResult());
+  }
+
+  uint32_t first_us = (uint32_t)(first->time / (sim::CYCLES_PER_MS / 1000));
+  uint32_t setup_us = (uint32_t)(sim::bootCycles() / (sim::CYCLES_PER_MS / 1000));
+  printf("first frame, us: %u (setup() from %u)\n", first_us, setup_us);
+  CHECK(first_us < FIRST_FRAME_LIMIT_US);
+
+  // 7-сегментные экраны: кадр разбирается по сегментам
+  if (first->kind != sim::FRAME_LEDS && first->data.size() == 8)
+  {
+    std::string t = sim::text(*first);
+    t.erase(std::remove(t.begin(), t.end(), ':'), t.end());
+    CHECK_EQ(t, std::string("1234"));
+  }
+  return (sim::checkResult());
+}
@@ -0,0 +1,153 @@
+/* Переходы между режимами экрана по таблице mode_list (simple_clock.ino): для каждого включенного в конфигурации режима проверяются вход в него событием кнопок, переходы внутри него и выход; текущий режим читается из переменной displayMode скетча */
+#include "sim.h"
+#include "header_file.h"
+
+extern DisplayMode displayMode;
+
+// время автоматического возврата в режим показа времени AUTO_EXIT_TIMEOUT (simple_clock.ino) с запасом, мс
+const uint32_t AUTO_EXIT_MS = 6000 + 500;
+
+// после события выдерживается интервал двойного клика, чтобы одиночный клик успел выдаться и был обработан задачей режима
+void settle() { sim::run(400); }
+
+void click(uint8_t pin)
+{
+  sim::press(pin);
+  settle();
+}
+
+void dblClick(uint8_t pin)
+{
+  sim::press(pin);
+  sim::run(100);
+  sim::press(pin);
+  settle();
+}
+
+void longClick(uint8_t pin)
+{
+  sim::press(pin, 1200);
+  settle();
+}
+
+// одновременное удержание кнопок Up и Down
+void upDownLongClick()
+{
+  sim::setButton(BTN_UP_PIN, true);
+  sim::setButton(BTN_DOWN_PIN, true);
+  sim::run(1200);
+  sim::setButton(BTN_UP_PIN, false);
+  sim::setButton(BTN_DOWN_PIN, false);
+  settle();
+}
+
+void setClick() { click(BTN_SET_PIN); }
+void setDblClick() { dblClick(BTN_SET_PIN); }
+void setLongClick() { longClick(BTN_SET_PIN); }
+void upClick() { click(BTN_UP_PIN); }
+void downClick() { click(BTN_DOWN_PIN); }
+void autoExit() { sim::run(AUTO_EXIT_MS); }
+
+struct Step
+{
+  const char *event;
+  void (*action)();
+  DisplayMode mode; // режим после события
+};
+
+#if defined(USE_ALARM) && defined(USE_ONECLICK_TO_SET_ALARM)
+#define ALARM_ENTER setClick
+#define STOPWATCH_ENTER setDblClick
+#else
+#define ALARM_ENTER setDblClick
+#define STOPWATCH_ENTER setClick
+#endif
+
+static const Step steps[] = {
+    // настройка времени и даты
+    {"Set long", setLongClick, DISPLAY_MODE_SET_HOUR},
+    {"Set", setClick, DISPLAY_MODE_SET_MINUTE},
+#ifdef USE_CALENDAR
+    {"Set", setClick, DISPLAY_MODE_SET_DAY},
+    {"Set", setClick, DISPLAY_MODE_SET_MONTH},
+    {"Set", setClick, DISPLAY_MODE_SET_YEAR},
+#endif
+    {"Set", setClick, DISPLAY_MODE_SHOW_TIME},
+    {"Set long", setLongClick, DISPLAY_MODE_SET_HOUR},
+    {"Set long", setLongClick, DISPLAY_MODE_SHOW_TIME},
+    {"Set long", setLongClick, DISPLAY_MODE_SET_HOUR},
+    {"тайм-аут", autoExit, DISPLAY_MODE_SHOW_TIME},
+#ifdef USE_ALARM
+    // будильник выключен; клик при выключенном будильнике завершает настройку
+    {"Set (будильник)", ALARM_ENTER, DISPLAY_MODE_ALARM_ON_OFF},
+    {"Set", setClick, DISPLAY_MODE_SHOW_TIME},
+    {"Set (будильник)", ALARM_ENTER, DISPLAY_MODE_ALARM_ON_OFF},
+    {"Up", upClick, DISPLAY_MODE_ALARM_ON_OFF},
+    {"Set", setClick, DISPLAY_MODE_SET_ALARM_HOUR},
+    {"Set", setClick, DISPLAY_MODE_SET_ALARM_MINUTE},
+    {"Set", setClick, DISPLAY_MODE_SHOW_TIME},
+#endif
+#ifdef USE_STOPWATCH
+    {"Set (секундомер)", STOPWATCH_ENTER, DISPLAY_MODE_STOPWATCH},
+    {"Set", setClick, DISPLAY_MODE_COUNTDOWN},
+    {"Set long", setLongClick, DISPLAY_MODE_SHOW_TIME},
+#endif
+#ifdef USE_TEMP_DATA
+    {"Up", upClick, DISPLAY_MODE_SHOW_TEMP},
+    {"Up", upClick, DISPLAY_MODE_SHOW_TIME},
+    {"Up", upClick, DISPLAY_MODE_SHOW_TEMP},
+    {"тайм-аут", autoExit, DISPLAY_MODE_SHOW_TIME},
+#else
+    {"Up", upClick, DISPLAY_MODE_SHOW_TIME},
+#endif
+#ifdef USE_CALENDAR
+    {"Down", downClick, DISPLAY_MODE_SHOW_CALENDAR},
+    {"Down", downClick, DISPLAY_MODE_SHOW_TIME},
+    {"Down", downClick, DISPLAY_MODE_SHOW_CALENDAR},
+    {"Set long", setLongClick, DISPLAY_MODE_SET_DAY},
+    {"Set long", setLongClick, DISPLAY_MODE_SHOW_TIME},
+#else
+    {"Down", downClick, DISPLAY_MODE_SHOW_TIME},
+#endif
+#if defined(USE_SET_BRIGHTNESS_MODE)
+#ifdef USE_LIGHT_SENSOR
+    {"Up+Down long", upDownLongClick, DISPLAY_MODE_SET_BRIGHTNESS_MIN},
+    {"Set", setClick, DISPLAY_MODE_SET_BRIGHTNESS_MAX},
+#else
+    {"Up+Down long", upDownLongClick, DISPLAY_MODE_SET_BRIGHTNESS_MAX},
+#endif
+#ifdef USE_LANGUAGE_SETTING
+    {"Set", setClick, DISPLAY_MODE_SET_LANGUAGE},
+#endif
+    {"Set", setClick, DISPLAY_MODE_SHOW_TIME},
+#elif defined(USE_LANGUAGE_SETTING)
+    {"Up+Down long", upDownLongClick, DISPLAY_MODE_SET_LANGUAGE},
+    {"Set", setClick, DISPLAY_MODE_SHOW_TIME},
+#else
+    {"Up+Down long", upDownLongClick, DISPLAY_MODE_SHOW_TIME},
+#endif
+};
+
+int main()
+{
+  sim::setRtc(2024, 5, 6, 12, 34, 0);
+  sim::setRtcTemperature(23.5f);
+  sim::setAnalog(14 + 3, 600); // датчик света
+  sim::setAnalog(14, 512);     // NTC
+  sim::setDs18b20(21.0f);
+  sim::boot();
+  sim::run(1000);
+  CHECK_EQ((int)displayMode, (int)DISPLAY_MODE_SHOW_TIME);
+
+  for (const Step &step : steps)
+  {
+    DisplayMode from = displayMode;
+    step.action();
+    if (displayMode != step.mode)
+    {
+      fprintf(stderr, "  %d --%s--> %d, ожидался %d\n", from, step.event, displayMode, step.mode);
+    }
+    CHECK(displayMode == step.mode);
+  }
+  return (sim::checkResult());
+}
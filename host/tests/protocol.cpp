@@ -0,0 +1,178 @@
+/* Двоичный протокол (protocol.h, handleFrame() в simple_clock.ino): кадры подаются в Serial модели, ответы разбираются из вывода Serial; проверяются запросы с ответом и установка значений, восстановление после кадров с неверной контрольной суммой и длиной, ответ на неизвестную команду и отбрасывание ответов, не поместившихся в буфер передачи */
+#include <vector>
+#include "sim.h"
+#include "protocol.h"
+
+struct Reply
+{
+  uint8_t command;
+  std::vector<uint8_t> data;
+};
+
+std::string frame(uint8_t command, const std::vector<uint8_t> &data = std::vector<uint8_t>())
+{
+  std::string s;
+  s += (char)PROTOCOL_SYNC;
+  s += (char)data.size();
+  s += (char)command;
+  uint8_t crc = crc8Update(crc8Update(0, (uint8_t)data.size()), command);
+  for (size_t i = 0; i < data.size(); i++)
+  {
+    s += (char)data[i];
+    crc = crc8Update(crc, data[i]);
+  }
+  s += (char)crc;
+  return (s);
+}
+
+/**
+ * @brief разбор вывода Serial с начала последнего serialClear(); байты вне кадров с верной контрольной суммой пропускаются
+ *
+ * @return std::vector<Reply>
+ */
+std::vector<Reply> replies()
+{
+  std::string out = sim::serialOutput();
+  std::vector<Reply> result;
+  size_t i = 0;
+  while (i + 4 <= out.size())
+  {
+    uint8_t len = (uint8_t)out[i + 1];
+    if ((uint8_t)out[i] != PROTOCOL_SYNC || len > PROTOCOL_MAX_PAYLOAD || i + len + 4 > out.size())
+    {
+      i++;
+      continue;
+    }
+    uint8_t crc = 0;
+    for (size_t j = i + 1; j < i + len + 3; j++)
+    {
+      crc = crc8Update(crc, (uint8_t)out[j]);
+    }
+    if (crc != (uint8_t)out[i + len + 3])
+    {
+      i++;
+      continue;
+    }
+    Reply r;
+    r.command = (uint8_t)out[i + 2];
+    r.data.assign(out.begin() + i + 3, out.begin() + i + 3 + len);
+    result.push_back(r);
+    i += len + 4;
+  }
+  return (result);
+}
+
+/**
+ * @brief отправка запроса и получение единственного ответа на него
+ *
+ */
+Reply request(const std::string &input)
+{
+  sim::serialClear();
+  sim::serialInput(input);
+  sim::run(100);
+  std::vector<Reply> r = replies();
+  CHECK_EQ(r.size(), (size_t)1);
+  return (r.empty() ? Reply() : r[0]);
+}
+
+uint16_t getWord(const Reply &r, size_t index)
+{
+  return ((r.data.size() >= index + 2) ? (uint16_t)(r.data[index] | (r.data[index + 1] << 8)) : 0xFFFF);
+}
+
+Reply telemetry() { return (request(frame(CMD_GET_TELEMETRY))); }
+
+int main()
+{
+  sim::setRtc(2024, 5, 6, 12, 34, 50);
+  sim::setAnalog(14 + 3, 600); // датчик света
+  sim::boot();
+  sim::run(2000);
+
+  Reply r = request(frame(CMD_PING));
+  CHECK_EQ(r.command, (uint8_t)(CMD_PING | PROTOCOL_REPLY));
+  CHECK(r.data == std::vector<uint8_t>(1, PROTOCOL_VERSION));
+
+  // установка и чтение времени
+  r = request(frame(CMD_SET_TIME, {25, 2, 14, 8, 15, 0}));
+  CHECK_EQ(r.command, (uint8_t)(CMD_SET_TIME | PROTOCOL_REPLY));
+  CHECK(r.data == std::vector<uint8_t>(1, PROTOCOL_OK));
+  r = request(frame(CMD_GET_TIME));
+  CHECK_EQ(r.command, (uint8_t)(CMD_GET_TIME | PROTOCOL_REPLY));
+  CHECK_EQ(r.data.size(), (size_t)6);
+  if (r.data.size() == 6)
+  {
+    CHECK(std::vector<uint8_t>(r.data.begin(), r.data.begin() + 5) == std::vector<uint8_t>({25, 2, 14, 8, 15}));
+    CHECK(r.data[5] <= 1);
+  }
+  r = request(frame(CMD_SET_TIME, {25, 13, 14, 8, 15, 0}));
+  CHECK(r.data == std::vector<uint8_t>(1, PROTOCOL_ERR_VALUE));
+
+  // установка и чтение яркости; допустимый диапазон - из ответа часов
+  r = request(frame(CMD_GET_SETTINGS));
+  CHECK_EQ(r.command, (uint8_t)(CMD_GET_SETTINGS | PROTOCOL_REPLY));
+  CHECK_EQ(r.data.size(), (size_t)4);
+  uint8_t level_min = r.data.size() == 4 ? r.data[2] : 0;
+  uint8_t level_max = r.data.size() == 4 ? r.data[3] : 0;
+  CHECK(level_min < level_max);
+  r = request(frame(CMD_SET_SETTINGS, {(uint8_t)(level_max - 1), level_min}));
+  CHECK(r.data == std::vector<uint8_t>(1, PROTOCOL_OK));
+  r = request(frame(CMD_GET_SETTINGS));
+  CHECK(r.data.size() == 4 && r.data[0] == level_max - 1);
+  r = request(frame(CMD_SET_SETTINGS, {(uint8_t)(level_max + 1), level_min}));
+  CHECK(r.data == std::vector<uint8_t>(1, PROTOCOL_ERR_VALUE));
+  if (level_min > 0)
+  {
+    r = request(frame(CMD_SET_SETTINGS, {(uint8_t)(level_min - 1), level_min}));
+    CHECK(r.data == std::vector<uint8_t>(1, PROTOCOL_ERR_VALUE));
+  }
+
+  // кадр с неверной контрольной суммой отбрасывается без ответа, следующий за ним кадр принимается
+  uint16_t rx_errors = getWord(telemetry(), 12);
+  std::string bad = frame(CMD_PING);
+  bad[bad.size() - 1] ^= 0x5A;
+  r = request(bad + frame(CMD_PING));
+  CHECK_EQ(r.command, (uint8_t)(CMD_PING | PROTOCOL_REPLY));
+  CHECK_EQ(getWord(telemetry(), 12), (uint16_t)(rx_errors + 1));
+
+  // длина больше PROTOCOL_MAX_PAYLOAD - кадр отбрасывается сразу после байта длины
+  std::string oversized;
+  oversized += (char)PROTOCOL_SYNC;
+  oversized += (char)(PROTOCOL_MAX_PAYLOAD + 1);
+  r = request(oversized + frame(CMD_PING));
+  CHECK_EQ(r.command, (uint8_t)(CMD_PING | PROTOCOL_REPLY));
+  CHECK_EQ(getWord(telemetry(), 12), (uint16_t)(rx_errors + 2));
+
+  // неизвестная команда и неверная длина данных известной команды
+  r = request(frame(0x20));
+  CHECK_EQ(r.command, (uint8_t)CMD_ERROR);
+  CHECK(r.data == std::vector<uint8_t>({0x20, PROTOCOL_ERR_COMMAND}));
+  r = request(frame(CMD_PING, {1}));
+  CHECK_EQ(r.command, (uint8_t)CMD_ERROR);
+  CHECK(r.data == std::vector<uint8_t>({CMD_PING, PROTOCOL_ERR_LENGTH}));
+
+  // ответы (10 байт) длиннее запросов (4 байта): при потоке запросов буфер Serial и кольцевой буфер протокола заполняются, и лишние ответы отбрасываются целиком
+  const size_t burst = 40;
+  uint16_t tx_drops = getWord(telemetry(), 14);
+  std::string input;
+  for (size_t i = 0; i < burst; i++)
+  {
+    input += frame(CMD_GET_TIME);
+  }
+  sim::serialClear();
+  sim::serialInput(input);
+  sim::run(200);
+  std::vector<Reply> all = replies();
+  CHECK(all.size() < burst);
+  for (size_t i = 0; i < all.size(); i++)
+  {
+    CHECK_EQ(all[i].command, (uint8_t)(CMD_GET_TIME | PROTOCOL_REPLY));
+  }
+  CHECK_EQ((size_t)(getWord(telemetry(), 14) - tx_drops), burst - all.size());
+  // после освобождения буфера ответы снова передаются
+  r = request(frame(CMD_PING));
+  CHECK_EQ(r.command, (uint8_t)(CMD_PING | PROTOCOL_REPLY));
+
+  return (sim::checkResult());
+}
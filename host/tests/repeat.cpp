@@ -0,0 +1,47 @@
+/* Автоповтор кнопок Up/Down в режиме настройки минут: удержание кнопки заданное время с последующим сохранением времени в DS3231; результат сравнивается с расчетом по ступеням repeat_stages (simple_clock.ino) */
+#include "sim.h"
+
+const uint8_t BTN_SET = 4;
+const uint8_t BTN_DOWN = 6;
+const uint8_t BTN_UP = 9;
+
+// минута, сохраненная в DS3231 после удержания кнопки в режиме настройки минут; настройка начинается с 12:30
+int holdMinute(uint8_t pin, uint32_t hold_ms)
+{
+  sim::setRtc(2024, 5, 6, 12, 30, 0);
+  sim::run(1100);
+  sim::press(BTN_SET, 1200); // длинный клик - настройка часов
+  sim::run(500);
+  sim::press(BTN_SET); // клик - настройка минут; клик выдается по окончании интервала двойного клика
+  sim::run(500);
+  sim::press(pin, hold_ms);
+  sim::run(500);
+  sim::press(BTN_SET, 1200); // длинный клик - сохранение и выход из настройки
+  sim::run(500);
+  return ((int)(sim::rtcSeconds() / 60 % 60));
+}
+
+int main()
+{
+  sim::boot();
+  sim::run(1000);
+
+  // клик - шаг 1
+  CHECK_EQ(holdMinute(BTN_UP, 100), 31);
+  CHECK_EQ(holdMinute(BTN_DOWN, 100), 29);
+
+  // моменты от нажатия: 0 - нажатие (+1), 1000 - длинный клик (+1), далее клики серии; ступень меняется на клике, время
+  // удержания которого достигло hold_time, а новый интервал действует со следующего запланированного клика
+
+  // 1100..1500 через 100 мс: +5; всего +7
+  CHECK_EQ(holdMinute(BTN_UP, 1500), 37);
+  // 1100..2000 через 100 мс: +10, 2100..3000 через 50 мс: +19; всего +31
+  CHECK_EQ(holdMinute(BTN_UP, 3000), 1);
+  // до 3950: +50, 4000 и 4050 с шагом 5: +10, 4200..4950 через 150 мс: +30; всего +90
+  CHECK_EQ(holdMinute(BTN_UP, 5000), 0);
+  // до 4950: +90, 5100..5850: +30, 6000..7950 через 150 мс с шагом 10: +140; всего +260
+  CHECK_EQ(holdMinute(BTN_UP, 8000), 50);
+  CHECK_EQ(holdMinute(BTN_DOWN, 8000), 10);
+
+  return (sim::checkResult());
+}
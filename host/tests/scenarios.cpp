@@ -0,0 +1,342 @@
+/* Сценарии работы часов в ускоренном времени модели: час показа времени, смена освещенности, пропадание DS3231, бегущая строка даты и будильник в 06:00 в понедельник с тремя повторами сигнала; по записям модели проверяется поведение часов и выводится таблица счетчиков в формате CSV (строки "counts,конфигурация,сценарий,показатель,значение") */
+#include <algorithm>
+#include "sim.h"
+#include "header_file.h"
+#if defined(MAX72XX_MATRIX_DISPLAY) || defined(WS2812_MATRIX_DISPLAY)
+// нужны только макросы USE_TICKER_FOR_DATE и MATRIX_WIDTH; функции заголовка есть и в скетче, поэтому здесь они скрыты в отдельном пространстве имен
+namespace matrix_data
+{
+#include "matrix_data.h"
+}
+#endif
+
+extern DisplayMode displayMode;
+
+// проход loop() - 1 мс: на порядок быстрее модели при 50 мкс по умолчанию; кнопки и задачи отрабатывают так же
+const uint32_t LOOP_COST_US = 1000;
+
+// продолжительность и повторы сигнала будильника: ALARM_DURATION, ALARM_SNOOZE_DELAY, ALARM_REPETITION_COUNT (simple_clock.ino)
+const uint32_t ALARM_DURATION_MS = 60000ul;
+const uint32_t ALARM_SNOOZE_MS = 120000ul;
+const uint8_t ALARM_REPETITIONS = 3;
+
+// время автоматического возврата в режим показа времени AUTO_EXIT_TIMEOUT (simple_clock.ino) с запасом, мс
+const uint32_t AUTO_EXIT_MS = 6000 + 500;
+
+void report(const char *scenario, const char *metric, double value)
+{
+  printf("counts,%s,%s,%s,%.1f\n", CLOCK_CONFIG, scenario, metric, value);
+}
+
+template <typename T>
+size_t countSince(const std::vector<T> &log, uint64_t since)
+{
+  size_t n = 0;
+  for (const T &item : log)
+  {
+    n += (item.time >= since) ? 1 : 0;
+  }
+  return (n);
+}
+
+// ноты пищалки (без пауз, которые задаются нулевой частотой)
+std::vector<sim::Note> soundsSince(uint64_t since)
+{
+  std::vector<sim::Note> result;
+  for (const sim::Note &n : sim::notes())
+  {
+    if (n.start >= since && n.frequency > 0)
+    {
+      result.push_back(n);
+    }
+  }
+  return (result);
+}
+
+uint64_t ms(uint32_t v) { return ((uint64_t)v * sim::CYCLES_PER_MS); }
+
+bool isTime(uint8_t hour, uint8_t minute)
+{
+  const sim::Frame *f = sim::lastFrame();
+  if (f == NULL || f->kind == sim::FRAME_LEDS || f->data.size() != 8)
+  {
+    return (true); // изображение матриц не разбирается
+  }
+  std::string t = sim::text();
+  char expected[5];
+  snprintf(expected, sizeof(expected), "%02u%02u", hour, minute);
+  return (t.size() >= 4 && t.substr(0, 2) == std::string(expected, 2) &&
+          t.substr(t.size() - 2) == std::string(expected + 2, 2));
+}
+
+#ifdef USE_POWER_SAVE
+bool isAsleep()
+{
+  const sim::Frame *f = sim::lastFrame();
+  return (f == NULL || !f->on || std::all_of(f->data.begin(), f->data.end(), [](uint8_t v)
+                                             { return (v == 0); }));
+}
+#endif
+
+// ==== час показа времени ===========================
+void idleHour()
+{
+  sim::setRtc(2024, 5, 6, 12, 0, 0);
+  sim::run(2000);
+  sim::clearLogs();
+  uint64_t t0 = sim::cycles();
+  sim::run(3600000ul);
+
+  size_t i2c = countSince(sim::i2cLog(), t0);
+  size_t frames = countSince(sim::frames(), t0);
+  report("idle_hour", "i2c_per_hour", i2c);
+  report("idle_hour", "display_updates_per_min", frames / 60.0);
+  report("idle_hour", "eeprom_writes", countSince(sim::eepromWrites(), t0));
+  CHECK(i2c > 0);
+#ifdef SHOW_EVENT_LOOP_STATS
+  // пробуждения по прерыванию таймера 0 (около 976 в секунду) статистика не считает
+  std::string out = sim::serialOutput();
+  size_t pos = out.rfind("wakeups/s: ");
+  CHECK(pos != std::string::npos);
+  unsigned wakeups = (pos != std::string::npos) ? (unsigned)atoi(out.c_str() + pos + 11) : 0;
+  report("idle_hour", "wakeups_per_sec", wakeups);
+  CHECK(wakeups < 100);
+#endif
+#if defined(USE_RTC_SQW) && defined(USE_POWER_SAVE)
+  // во сне МК просыпается по обоим фронтам SQW и каждый раз считывает время: адрес регистра и чтение
+  CHECK(i2c <= 3600ul * 4 + 3600ul / 10);
+#elif defined(USE_RTC_SQW)
+  // время считывается раз в секунду по SQW: адрес регистра и чтение
+  CHECK(i2c <= 3600ul * 2 + 3600ul / 10);
+#endif
+  CHECK(frames > 0);
+  CHECK(sim::eepromWrites().empty()); // показ времени не изнашивает EEPROM
+  CHECK(soundsSince(t0).empty());
+#ifdef USE_POWER_SAVE
+  // через POWER_SAVE_IDLE_TIMEOUT без нажатий экран гаснет; нажатие, разбудившее часы, только включает экран
+  CHECK(isAsleep());
+  sim::press(BTN_SET_PIN);
+  sim::run(500);
+  CHECK(!isAsleep());
+  CHECK(displayMode == DISPLAY_MODE_SHOW_TIME);
+#endif
+  CHECK(isTime(13, 0));
+}
+
+// ==== освещенность =================================
+#ifdef USE_LIGHT_SENSOR
+uint8_t frameBrightness(uint8_t level)
+{
+  const sim::Frame *f = sim::lastFrame();
+  return ((f != NULL && f->kind == sim::FRAME_LEDS) ? level * 10 : level);
+}
+
+void lightLevels()
+{
+  sim::setAnalog(LIGHT_SENSOR_PIN, 100);
+  sim::run(5000);
+  const sim::Frame *f = sim::lastFrame();
+  CHECK(f != NULL && f->brightness == frameBrightness(sim::eeprom()[MIN_BRIGHTNESS_VALUE]));
+  report("light", "dark_brightness", (f != NULL) ? f->brightness : -1);
+
+  sim::setAnalog(LIGHT_SENSOR_PIN, 900);
+  sim::run(5000);
+  f = sim::lastFrame();
+  CHECK(f != NULL && f->brightness == frameBrightness(sim::eeprom()[MAX_BRIGHTNESS_VALUE]));
+  report("light", "bright_brightness", (f != NULL) ? f->brightness : -1);
+  sim::setAnalog(LIGHT_SENSOR_PIN, 600);
+}
+#endif
+
+// ==== пропадание DS3231 ============================
+void rtcLoss()
+{
+  sim::setRtc(2024, 5, 6, 14, 0, 0);
+  sim::run(2000);
+  uint64_t t0 = sim::cycles();
+  sim::setRtcPresent(false);
+  sim::run(5000);
+  sim::setRtcPresent(true);
+  sim::run(3000);
+
+  size_t failed = 0;
+  for (const sim::I2cTransaction &t : sim::i2cLog())
+  {
+    failed += (t.time >= t0 && t.status != 0) ? 1 : 0;
+  }
+  report("rtc_loss", "i2c_failed", failed);
+  CHECK(failed > 0);
+  CHECK(displayMode == DISPLAY_MODE_SHOW_TIME);
+  CHECK(isTime(14, 0)); // после восстановления связи часы снова показывают время DS3231
+}
+
+// ==== бегущая строка даты ==========================
+#if defined(USE_CALENDAR) && (defined(MAX72XX_MATRIX_DISPLAY) || defined(WS2812_MATRIX_DISPLAY)) && \
+    defined(USE_TICKER_FOR_DATE)
+#if defined(WS2812_MATRIX_DISPLAY) && !defined(USE_SMOOTH_TICKER)
+// столбец изображения на светодиодах, соединенных змейкой по столбцам (BY_COLUMNS в simple_clock.ino), как маска горящих пикселей
+uint32_t ledColumn(const sim::Frame &f, uint8_t col)
+{
+  uint32_t mask = 0;
+  for (uint8_t row = 0; row < MATRIX_HEIGHT; row++)
+  {
+    size_t led = (size_t)col * MATRIX_HEIGHT + ((col & 0x01) ? MATRIX_HEIGHT - row - 1 : row);
+    if (led * 3 + 2 < f.data.size() && (f.data[led * 3] | f.data[led * 3 + 1] | f.data[led * 3 + 2]))
+    {
+      mask |= 1ul << row;
+    }
+  }
+  return (mask);
+}
+
+// кадр b - кадр a, сдвинутый влево на shift столбцов
+bool isShifted(const sim::Frame &a, const sim::Frame &b, uint8_t shift)
+{
+  for (uint8_t col = 0; col + shift < MATRIX_WIDTH; col++)
+  {
+    if (ledColumn(b, col) != ledColumn(a, col + shift))
+    {
+      return (false);
+    }
+  }
+  return (true);
+}
+#endif
+
+void dateTicker()
+{
+  sim::setRtc(2024, 5, 6, 15, 0, 0);
+  sim::run(2000);
+  uint64_t t0 = sim::cycles();
+  sim::press(BTN_DOWN_PIN);
+  // клик распознается после паузы, в которой мог начаться двойной клик
+  sim::run(400);
+  uint32_t shown_ms = 400;
+  // бегущая строка выводится до конца и повторяется, пока идет показ календаря
+  while (shown_ms < 60000ul && displayMode != DISPLAY_MODE_SHOW_TIME)
+  {
+    sim::run(100);
+    shown_ms += 100;
+  }
+  size_t frames = countSince(sim::frames(), t0);
+  report("date_ticker", "shown_ms", shown_ms);
+  report("date_ticker", "display_updates_per_min", frames * 60000.0 / (shown_ms + 1));
+  CHECK(shown_ms > 1000);
+  CHECK(frames * 1000 / (shown_ms + 1) >= 10); // строка сдвигается не реже 10 раз в секунду
+#if defined(WS2812_MATRIX_DISPLAY) && !defined(USE_SMOOTH_TICKER)
+  // строка не пропускает столбцы, даже если частоту кадров ограничивает WS2812_BLACKOUT_BUDGET: каждый переданный кадр сдвинут относительно предыдущего на столбец или совпадает с ним (например, при смене яркости); иначе отличаются только кадры входа в режим и выхода из него
+  size_t jumps = 0;
+  const sim::Frame *prev = NULL;
+  for (const sim::Frame &f : sim::frames())
+  {
+    if (f.time >= t0 && f.kind == sim::FRAME_LEDS)
+    {
+      jumps += (prev != NULL && !isShifted(*prev, f, 1) && !isShifted(*prev, f, 0)) ? 1 : 0;
+      prev = &f;
+    }
+  }
+  report("date_ticker", "column_jumps", jumps);
+  CHECK(jumps <= 2);
+#endif
+  sim::run(AUTO_EXIT_MS);
+  CHECK(displayMode == DISPLAY_MODE_SHOW_TIME);
+}
+#endif
+
+// ==== будильник ====================================
+#ifdef USE_ALARM
+void alarmMonday()
+{
+  // 2024-05-06 - понедельник; будильник включен на 06:00 до запуска (см. main())
+  sim::setRtc(2024, 5, 6, 5, 59, 50);
+  sim::clearLogs();
+  sim::run(10000);
+  uint64_t alarm_time = sim::cycles();
+  CHECK(soundsSince(0).empty());
+
+  uint32_t total_ms = ALARM_REPETITIONS * ALARM_DURATION_MS + (ALARM_REPETITIONS - 1) * ALARM_SNOOZE_MS;
+  sim::run(total_ms + 60000ul);
+
+  // серии сигнала разделяются паузами больше 10 с
+  std::vector<sim::Note> sounds = soundsSince(alarm_time);
+  std::vector<std::pair<uint64_t, uint64_t>> bursts;
+  size_t notes_in_first = 0;
+  for (const sim::Note &n : sounds)
+  {
+    if (bursts.empty() || n.start - bursts.back().second > ms(10000))
+    {
+      bursts.push_back(std::make_pair(n.start, n.end));
+    }
+    bursts.back().second = n.end;
+    notes_in_first += (bursts.size() == 1) ? 1 : 0;
+  }
+
+  report("alarm", "bursts", bursts.size());
+  report("alarm", "notes", sounds.size());
+  report("alarm", "notes_per_burst", notes_in_first);
+  report("alarm", "eeprom_writes", countSince(sim::eepromWrites(), alarm_time));
+  CHECK_EQ(bursts.size(), (size_t)ALARM_REPETITIONS);
+  if (!bursts.empty())
+  {
+    uint64_t delay = bursts[0].first - alarm_time;
+    report("alarm", "first_note_delay_ms", (double)delay / sim::CYCLES_PER_MS);
+    CHECK(delay < ms(500));
+  }
+  for (size_t i = 0; i < bursts.size(); i++)
+  {
+    uint64_t duration = bursts[i].second - bursts[i].first;
+    CHECK(duration > ms(ALARM_DURATION_MS - 2000) && duration < ms(ALARM_DURATION_MS + 2000));
+    if (i > 0)
+    {
+      uint64_t pause = bursts[i].first - bursts[i - 1].second;
+      CHECK(pause > ms(ALARM_SNOOZE_MS - 2000) && pause < ms(ALARM_SNOOZE_MS + 2000));
+    }
+  }
+  CHECK(countSince(sim::eepromWrites(), alarm_time) == 0);
+
+  // на следующий день сигнал выключается любой кнопкой; нажатие не переключает режим
+  sim::setRtc(2024, 5, 7, 5, 59, 58);
+  sim::run(5000);
+  CHECK(!soundsSince(sim::cycles() - ms(1000)).empty());
+  sim::press(BTN_UP_PIN);
+  uint64_t pressed = sim::cycles();
+  sim::run(5000);
+  CHECK(soundsSince(pressed + ms(100)).empty());
+  CHECK(displayMode == DISPLAY_MODE_SHOW_TIME);
+}
+#endif
+
+int main()
+{
+#ifdef USE_ALARM
+  // будильник включен на 06:00 (360 минут от полуночи), см. alarm.h
+  sim::eeprom()[ALARM_EEPROM_INDEX] = 1;
+  sim::eeprom()[ALARM_EEPROM_INDEX + 1] = 360 & 0xFF;
+  sim::eeprom()[ALARM_EEPROM_INDEX + 2] = 360 >> 8;
+#endif
+  sim::setRtcTemperature(23.5f);
+#ifdef USE_LIGHT_SENSOR
+  sim::setAnalog(LIGHT_SENSOR_PIN, 600);
+#endif
+#ifdef USE_NTC
+  sim::setAnalog(NTC_PIN, 512);
+#endif
+  sim::setDs18b20(21.0f);
+  sim::setLoopCost(LOOP_COST_US);
+  sim::boot();
+  sim::run(1000);
+
+  idleHour();
+#ifdef USE_LIGHT_SENSOR
+  lightLevels();
+#endif
+  rtcLoss();
+#if defined(USE_CALENDAR) && (defined(MAX72XX_MATRIX_DISPLAY) || defined(WS2812_MATRIX_DISPLAY)) && \
+    defined(USE_TICKER_FOR_DATE)
+  dateTicker();
+#endif
+#ifdef USE_ALARM
+  alarmMonday();
+#endif
+  return (sim::checkResult());
+}
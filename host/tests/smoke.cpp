@@ -0,0 +1,49 @@
+/* Проверка сборки конфигурации: часы запускаются, показывают время, проходят по режимам кнопками и отвечают на запросы Serial без аварийной остановки модели */
+#include <algorithm>
+#include "sim.h"
+
+const uint8_t BTN_SET = 4;
+const uint8_t BTN_DOWN = 6;
+const uint8_t BTN_UP = 9;
+
+int main()
+{
+  sim::setRtc(2024, 5, 6, 12, 34, 50);
+  sim::setRtcTemperature(23.5f);
+  sim::setAnalog(14 + 3, 600); // датчик света
+  sim::setAnalog(14, 512);     // NTC
+  sim::setDs18b20(21.0f);
+  sim::boot();
+  sim::run(3000);
+
+  const sim::Frame *f = sim::lastFrame();
+  CHECK(f != NULL);
+  if (f != NULL && f->kind != sim::FRAME_LEDS && f->data.size() == 8)
+  {
+    std::string t = sim::text();
+    t.erase(std::remove(t.begin(), t.end(), ':'), t.end());
+    CHECK_EQ(t, std::string("1234"));
+  }
+  CHECK(sim::i2cLog().size() > 0);
+
+  // клики всеми кнопками, вход в настройку времени и выход из нее по таймауту
+  sim::press(BTN_SET, 100, 2);
+  sim::run(1000);
+  sim::press(BTN_UP, 100, 2);
+  sim::run(1000);
+  sim::press(BTN_DOWN, 100, 2);
+  sim::run(1000);
+  sim::press(BTN_SET, 1500, 2);
+  sim::run(500);
+  sim::press(BTN_UP, 100, 2);
+  sim::run(500);
+  sim::press(BTN_DOWN, 100, 2);
+  sim::run(15000);
+
+  // запросы отчетов; в конфигурациях без вывода в Serial байты просто теряются
+  sim::serialInput("pcstwb");
+  sim::run(5000);
+
+  CHECK(sim::lastFrame() != NULL);
+  return (sim::checkResult());
+}
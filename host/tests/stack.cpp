@@ -0,0 +1,98 @@
+/* Наибольшая глубина стека скетча на прогоне по основным режимам по закраске стека модели (sim::stackUsage()): часы проходят через показ времени, температуры и даты, настройку с автоповтором кнопок, сработавший будильник, секундомер, настройку яркости и отчеты по запросам из Serial; результат выводится строкой CSV "stack,конфигурация,host_max_bytes,значение". Это байты стека на компьютере, а не AVR, и не наихудший случай, а только наибольшая глубина на пройденных режимах; запас RAM под стек на AVR учитывает tools/footprint.py */
+#include "sim.h"
+#include "header_file.h"
+
+extern DisplayMode displayMode;
+
+// время автоматического возврата в режим показа времени AUTO_EXIT_TIMEOUT (simple_clock.ino) с запасом, мс
+const uint32_t AUTO_EXIT_MS = 6000 + 500;
+
+// предел глубины стека на компьютере; с AddressSanitizer кадры функций в несколько раз крупнее, поэтому предел задан с запасом и ловит только неограниченный рост стека (например, рекурсию)
+const size_t STACK_LIMIT = 64u * 1024u;
+
+void click(uint8_t pin)
+{
+  sim::press(pin);
+  sim::run(400);
+}
+
+void longClick(uint8_t pin)
+{
+  sim::press(pin, 1200);
+  sim::run(400);
+}
+
+int main()
+{
+#ifdef USE_ALARM
+  // будильник включен на 06:00 (360 минут от полуночи), см. alarm.h
+  sim::eeprom()[ALARM_EEPROM_INDEX] = 1;
+  sim::eeprom()[ALARM_EEPROM_INDEX + 1] = 360 & 0xFF;
+  sim::eeprom()[ALARM_EEPROM_INDEX + 2] = 360 >> 8;
+#endif
+  sim::setRtc(2024, 5, 6, 5, 59, 50);
+  sim::setRtcTemperature(23.5f);
+  sim::setAnalog(14 + 3, 600); // датчик света
+  sim::setAnalog(14, 512);     // NTC
+  sim::setDs18b20(21.0f);
+  sim::boot();
+  sim::run(2000);
+  size_t boot_usage = sim::stackUsage();
+
+  // сигнал будильника; любая кнопка его выключает
+  sim::run(12000);
+  click(BTN_UP_PIN);
+  sim::run(AUTO_EXIT_MS);
+  // дальше - дневное время, когда часы с USE_POWER_SAVE не засыпают через POWER_SAVE_NIGHT_TIMEOUT
+  sim::setRtc(2024, 5, 6, 12, 0, 0);
+  sim::run(2000);
+
+  // температура и дата (на матричных экранах - бегущая строка)
+  click(BTN_UP_PIN);
+  sim::run(3000);
+  click(BTN_UP_PIN);
+  click(BTN_DOWN_PIN);
+  sim::run(AUTO_EXIT_MS);
+
+  // настройка часов и минут с автоповтором кнопок, выход без сохранения по тайм-ауту
+  longClick(BTN_SET_PIN);
+  sim::press(BTN_UP_PIN, 3000);
+  click(BTN_SET_PIN);
+  sim::press(BTN_DOWN_PIN, 3000);
+  sim::run(AUTO_EXIT_MS);
+
+  // будильник или секундомер - в зависимости от опций их включает одиночный или двойной клик
+  click(BTN_SET_PIN);
+  click(BTN_SET_PIN);
+  sim::run(3000);
+  longClick(BTN_SET_PIN);
+  sim::press(BTN_SET_PIN);
+  sim::run(100);
+  click(BTN_SET_PIN);
+  sim::run(AUTO_EXIT_MS);
+
+  // настройка яркости (или языка) одновременным удержанием кнопок Up и Down
+  sim::setButton(BTN_UP_PIN, true);
+  sim::setButton(BTN_DOWN_PIN, true);
+  sim::run(1200);
+  sim::setButton(BTN_UP_PIN, false);
+  sim::setButton(BTN_DOWN_PIN, false);
+  sim::run(400);
+  click(BTN_UP_PIN);
+  sim::run(AUTO_EXIT_MS);
+
+  // смена освещенности и отчеты по запросам из Serial (символы, не включенные в конфигурации, игнорируются)
+  sim::setAnalog(14 + 3, 100);
+  sim::run(2000);
+  sim::serialInput("pcbtms");
+  sim::run(2000);
+  CHECK(displayMode == DISPLAY_MODE_SHOW_TIME);
+
+  size_t usage = sim::stackUsage();
+  printf("stack,%s,host_boot_bytes,%u\n", CLOCK_CONFIG, (unsigned)boot_usage);
+  printf("stack,%s,host_max_bytes,%u\n", CLOCK_CONFIG, (unsigned)usage);
+  CHECK(boot_usage > 0);
+  CHECK(usage >= boot_usage);
+  CHECK(usage < STACK_LIMIT);
+  return (sim::checkResult());
+}
@@ -0,0 +1,199 @@
+/* Языковые пакеты и сжатый шрифт 5х7 для матричных экранов;
+
+   Файл создан скриптом tools/font_pack.py из полного шрифта tools/font_5_7.h - не редактируйте его вручную. В шрифт включены только символы, которые выводятся на экран: цифры, знаки температуры и символы строк языковых пакетов; в строках пакетов символы заменены номерами в сжатом шрифте.
+
+   Объем шрифта и пакетов во flash (полный шрифт с таблицей дней недели - 1301 байт):
+   выбор языка в настройках - 48 символов, 300 байт, экономия 1001 байт;
+   только русский язык - 30 символов, 180 байт, экономия 1121 байт;
+   только английский язык - 33 символов, 195 байт, экономия 1106 байт;
+*/
+#pragma once
+#include <avr/pgmspace.h>
+
+// строки языкового пакета; смещения от начала пакета
+#define LANG_NAME 0        // название языка для экрана настройки
+#define LANG_DAY_OF_WEEK 3 // дни недели с воскресенья, по 3 символа
+#define LANG_BRIGHTNESS 24 // подпись настройки яркости; третий символ выводится, если нет датчика света
+#define LANG_ALARM 27      // подпись настройки будильника
+#define LANG_PACK_SIZE 30
+
+// символы, общие для всех пакетов; цифры 0..9 идут подряд
+#define GLYPH_0 0x00
+#define GLYPH_SPACE 0x0A
+#define GLYPH_PLUS 0x0B
+#define GLYPH_MINUS 0x0C
+#define GLYPH_DEGREE 0x0D
+#define GLYPH_C 0x0E
+
+#if defined(USE_LANGUAGE_SETTING)
+#define LANG_EN 0
+#define LANG_RU 1
+#define LANG_COUNT 2
+
+static const uint8_t PROGMEM font_5_7[] = {
+    0x3E, 0x51, 0x49, 0x45, 0x3E, // 0 0x30 -> 0x00
+    0x44, 0x42, 0x7F, 0x40, 0x40, // 1 0x31 -> 0x01
+    0x42, 0x61, 0x51, 0x49, 0x46, // 2 0x32 -> 0x02
+    0x21, 0x41, 0x45, 0x4B, 0x31, // 3 0x33 -> 0x03
+    0x18, 0x14, 0x12, 0x7F, 0x10, // 4 0x34 -> 0x04
+    0x27, 0x45, 0x45, 0x45, 0x39, // 5 0x35 -> 0x05
+    0x3C, 0x4A, 0x49, 0x49, 0x30, // 6 0x36 -> 0x06
+    0x01, 0x71, 0x09, 0x05, 0x03, // 7 0x37 -> 0x07
+    0x36, 0x49, 0x49, 0x49, 0x36, // 8 0x38 -> 0x08
+    0x06, 0x49, 0x49, 0x29, 0x1E, // 9 0x39 -> 0x09
+    0x00, 0x00, 0x00, 0x00, 0x00, // space 0x20 -> 0x0A
+    0x08, 0x08, 0x3E, 0x08, 0x08, // + 0x2B -> 0x0B
+    0x08, 0x08, 0x08, 0x08, 0x08, // - 0x2D -> 0x0C
+    0x06, 0x09, 0x09, 0x06, 0x00, // ° 0xB0 -> 0x0D
+    0x3E, 0x41, 0x41, 0x41, 0x22, // C 0x43 -> 0x0E
+    0x7F, 0x49, 0x49, 0x49, 0x41, // E 0x45 -> 0x0F
+    0x7F, 0x04, 0x08, 0x10, 0x7F, // N 0x4E -> 0x10
+    0x3E, 0x41, 0x49, 0x49, 0x7A, // G 0x47 -> 0x11
+    0x46, 0x49, 0x49, 0x49, 0x31, // S 0x53 -> 0x12
+    0x3F, 0x40, 0x40, 0x40, 0x3F, // U 0x55 -> 0x13
+    0x7F, 0x02, 0x0C, 0x02, 0x7F, // M 0x4D -> 0x14
+    0x3E, 0x41, 0x41, 0x41, 0x3E, // O 0x4F -> 0x15
+    0x03, 0x01, 0x7F, 0x01, 0x03, // T 0x54 -> 0x16
+    0x3F, 0x40, 0x3C, 0x40, 0x3F, // W 0x57 -> 0x17
+    0x7F, 0x41, 0x41, 0x22, 0x1C, // D 0x44 -> 0x18
+    0x7F, 0x08, 0x08, 0x08, 0x7F, // H 0x48 -> 0x19
+    0x7F, 0x09, 0x09, 0x09, 0x01, // F 0x46 -> 0x1A
+    0x7F, 0x09, 0x19, 0x29, 0x46, // R 0x52 -> 0x1B
+    0x00, 0x41, 0x7F, 0x41, 0x00, // I 0x49 -> 0x1C
+    0x7C, 0x12, 0x11, 0x12, 0x7C, // A 0x41 -> 0x1D
+    0x7F, 0x49, 0x49, 0x49, 0x36, // B 0x42 -> 0x1E
+    0x7C, 0x08, 0x04, 0x04, 0x08, // r 0x72 -> 0x1F
+    0x00, 0x41, 0x7F, 0x40, 0x00, // l 0x6C -> 0x20
+    0x7F, 0x09, 0x09, 0x09, 0x06, // Р 0xD0 -> 0x21
+    0x07, 0x48, 0x48, 0x48, 0x3F, // У 0xD3 -> 0x22
+    0x3E, 0x41, 0x41, 0x41, 0x22, // С 0xD1 -> 0x23
+    0x7F, 0x49, 0x49, 0x49, 0x36, // В 0xC2 -> 0x24
+    0x7F, 0x08, 0x14, 0x22, 0x41, // К 0xCA -> 0x25
+    0x7F, 0x01, 0x01, 0x01, 0x7F, // П 0xCF -> 0x26
+    0x7F, 0x08, 0x08, 0x08, 0x7F, // Н 0xCD -> 0x27
+    0xC0, 0x7F, 0x41, 0x7F, 0xC0, // Д 0xC4 -> 0x28
+    0x01, 0x01, 0x7F, 0x01, 0x01, // Т 0xD2 -> 0x29
+    0x07, 0x08, 0x08, 0x08, 0x7F, // Ч 0xD7 -> 0x2A
+    0x7F, 0x49, 0x49, 0x49, 0x31, // Б 0xC1 -> 0x2B
+    0x46, 0x29, 0x19, 0x09, 0x7F, // Я 0xDF -> 0x2C
+    0x7C, 0x14, 0x14, 0x14, 0x08, // р 0xF0 -> 0x2D
+    0x7C, 0x10, 0x10, 0x28, 0x44, // к 0xEA -> 0x2E
+    0xC0, 0x78, 0x44, 0x7C, 0xC0  // д 0xE4 -> 0x2F
+};
+
+static const uint8_t PROGMEM lang_packs[] = {
+    // LANG_EN
+    0x0F, 0x10, 0x11, // "ENG"
+    0x12, 0x13, 0x10, 0x14, 0x15, 0x10, 0x16, 0x13, 0x0F, 0x17, 0x0F, 0x18, 0x16, 0x19, 0x13, 0x1A, 0x1B, 0x1C, 0x12, 0x1D, 0x16, // "SUNMONTUEWEDTHUFRISAT"
+    0x1E, 0x1F, 0x0A, // "Br "
+    0x1D, 0x20, 0x1F, // "Alr"
+    // LANG_RU
+    0x21, 0x22, 0x23, // "РУС"
+    0x24, 0x23, 0x25, 0x26, 0x27, 0x28, 0x24, 0x29, 0x21, 0x23, 0x21, 0x28, 0x2A, 0x29, 0x24, 0x26, 0x29, 0x27, 0x23, 0x2B, 0x29, // "ВСКПНДВТРСРДЧТВПТНСБТ"
+    0x2C, 0x2D, 0x2E, // "Ярк"
+    0x2B, 0x2F, 0x2E  // "Бдк"
+};
+
+#ifdef USE_RU_LANGUAGE
+#define LANG_DEFAULT LANG_RU
+#else
+#define LANG_DEFAULT LANG_EN
+#endif
+
+#elif defined(USE_RU_LANGUAGE)
+#define LANG_RU 0
+#define LANG_COUNT 1
+
+static const uint8_t PROGMEM font_5_7[] = {
+    0x3E, 0x51, 0x49, 0x45, 0x3E, // 0 0x30 -> 0x00
+    0x44, 0x42, 0x7F, 0x40, 0x40, // 1 0x31 -> 0x01
+    0x42, 0x61, 0x51, 0x49, 0x46, // 2 0x32 -> 0x02
+    0x21, 0x41, 0x45, 0x4B, 0x31, // 3 0x33 -> 0x03
+    0x18, 0x14, 0x12, 0x7F, 0x10, // 4 0x34 -> 0x04
+    0x27, 0x45, 0x45, 0x45, 0x39, // 5 0x35 -> 0x05
+    0x3C, 0x4A, 0x49, 0x49, 0x30, // 6 0x36 -> 0x06
+    0x01, 0x71, 0x09, 0x05, 0x03, // 7 0x37 -> 0x07
+    0x36, 0x49, 0x49, 0x49, 0x36, // 8 0x38 -> 0x08
+    0x06, 0x49, 0x49, 0x29, 0x1E, // 9 0x39 -> 0x09
+    0x00, 0x00, 0x00, 0x00, 0x00, // space 0x20 -> 0x0A
+    0x08, 0x08, 0x3E, 0x08, 0x08, // + 0x2B -> 0x0B
+    0x08, 0x08, 0x08, 0x08, 0x08, // - 0x2D -> 0x0C
+    0x06, 0x09, 0x09, 0x06, 0x00, // ° 0xB0 -> 0x0D
+    0x3E, 0x41, 0x41, 0x41, 0x22, // C 0x43 -> 0x0E
+    0x7F, 0x09, 0x09, 0x09, 0x06, // Р 0xD0 -> 0x0F
+    0x07, 0x48, 0x48, 0x48, 0x3F, // У 0xD3 -> 0x10
+    0x3E, 0x41, 0x41, 0x41, 0x22, // С 0xD1 -> 0x11
+    0x7F, 0x49, 0x49, 0x49, 0x36, // В 0xC2 -> 0x12
+    0x7F, 0x08, 0x14, 0x22, 0x41, // К 0xCA -> 0x13
+    0x7F, 0x01, 0x01, 0x01, 0x7F, // П 0xCF -> 0x14
+    0x7F, 0x08, 0x08, 0x08, 0x7F, // Н 0xCD -> 0x15
+    0xC0, 0x7F, 0x41, 0x7F, 0xC0, // Д 0xC4 -> 0x16
+    0x01, 0x01, 0x7F, 0x01, 0x01, // Т 0xD2 -> 0x17
+    0x07, 0x08, 0x08, 0x08, 0x7F, // Ч 0xD7 -> 0x18
+    0x7F, 0x49, 0x49, 0x49, 0x31, // Б 0xC1 -> 0x19
+    0x46, 0x29, 0x19, 0x09, 0x7F, // Я 0xDF -> 0x1A
+    0x7C, 0x14, 0x14, 0x14, 0x08, // р 0xF0 -> 0x1B
+    0x7C, 0x10, 0x10, 0x28, 0x44, // к 0xEA -> 0x1C
+    0xC0, 0x78, 0x44, 0x7C, 0xC0  // д 0xE4 -> 0x1D
+};
+
+static const uint8_t PROGMEM lang_packs[] = {
+    // LANG_RU
+    0x0F, 0x10, 0x11, // "РУС"
+    0x12, 0x11, 0x13, 0x14, 0x15, 0x16, 0x12, 0x17, 0x0F, 0x11, 0x0F, 0x16, 0x18, 0x17, 0x12, 0x14, 0x17, 0x15, 0x11, 0x19, 0x17, // "ВСКПНДВТРСРДЧТВПТНСБТ"
+    0x1A, 0x1B, 0x1C, // "Ярк"
+    0x19, 0x1D, 0x1C  // "Бдк"
+};
+
+#define LANG_DEFAULT 0
+
+#else
+#define LANG_EN 0
+#define LANG_COUNT 1
+
+static const uint8_t PROGMEM font_5_7[] = {
+    0x3E, 0x51, 0x49, 0x45, 0x3E, // 0 0x30 -> 0x00
+    0x44, 0x42, 0x7F, 0x40, 0x40, // 1 0x31 -> 0x01
+    0x42, 0x61, 0x51, 0x49, 0x46, // 2 0x32 -> 0x02
+    0x21, 0x41, 0x45, 0x4B, 0x31, // 3 0x33 -> 0x03
+    0x18, 0x14, 0x12, 0x7F, 0x10, // 4 0x34 -> 0x04
+    0x27, 0x45, 0x45, 0x45, 0x39, // 5 0x35 -> 0x05
+    0x3C, 0x4A, 0x49, 0x49, 0x30, // 6 0x36 -> 0x06
+    0x01, 0x71, 0x09, 0x05, 0x03, // 7 0x37 -> 0x07
+    0x36, 0x49, 0x49, 0x49, 0x36, // 8 0x38 -> 0x08
+    0x06, 0x49, 0x49, 0x29, 0x1E, // 9 0x39 -> 0x09
+    0x00, 0x00, 0x00, 0x00, 0x00, // space 0x20 -> 0x0A
+    0x08, 0x08, 0x3E, 0x08, 0x08, // + 0x2B -> 0x0B
+    0x08, 0x08, 0x08, 0x08, 0x08, // - 0x2D -> 0x0C
+    0x06, 0x09, 0x09, 0x06, 0x00, // ° 0xB0 -> 0x0D
+    0x3E, 0x41, 0x41, 0x41, 0x22, // C 0x43 -> 0x0E
+    0x7F, 0x49, 0x49, 0x49, 0x41, // E 0x45 -> 0x0F
+    0x7F, 0x04, 0x08, 0x10, 0x7F, // N 0x4E -> 0x10
+    0x3E, 0x41, 0x49, 0x49, 0x7A, // G 0x47 -> 0x11
+    0x46, 0x49, 0x49, 0x49, 0x31, // S 0x53 -> 0x12
+    0x3F, 0x40, 0x40, 0x40, 0x3F, // U 0x55 -> 0x13
+    0x7F, 0x02, 0x0C, 0x02, 0x7F, // M 0x4D -> 0x14
+    0x3E, 0x41, 0x41, 0x41, 0x3E, // O 0x4F -> 0x15
+    0x03, 0x01, 0x7F, 0x01, 0x03, // T 0x54 -> 0x16
+    0x3F, 0x40, 0x3C, 0x40, 0x3F, // W 0x57 -> 0x17
+    0x7F, 0x41, 0x41, 0x22, 0x1C, // D 0x44 -> 0x18
+    0x7F, 0x08, 0x08, 0x08, 0x7F, // H 0x48 -> 0x19
+    0x7F, 0x09, 0x09, 0x09, 0x01, // F 0x46 -> 0x1A
+    0x7F, 0x09, 0x19, 0x29, 0x46, // R 0x52 -> 0x1B
+    0x00, 0x41, 0x7F, 0x41, 0x00, // I 0x49 -> 0x1C
+    0x7C, 0x12, 0x11, 0x12, 0x7C, // A 0x41 -> 0x1D
+    0x7F, 0x49, 0x49, 0x49, 0x36, // B 0x42 -> 0x1E
+    0x7C, 0x08, 0x04, 0x04, 0x08, // r 0x72 -> 0x1F
+    0x00, 0x41, 0x7F, 0x40, 0x00  // l 0x6C -> 0x20
+};
+
+static const uint8_t PROGMEM lang_packs[] = {
+    // LANG_EN
+    0x0F, 0x10, 0x11, // "ENG"
+    0x12, 0x13, 0x10, 0x14, 0x15, 0x10, 0x16, 0x13, 0x0F, 0x17, 0x0F, 0x18, 0x16, 0x19, 0x13, 0x1A, 0x1B, 0x1C, 0x12, 0x1D, 0x16, // "SUNMONTUEWEDTHUFRISAT"
+    0x1E, 0x1F, 0x0A, // "Br "
+    0x1D, 0x20, 0x1F  // "Alr"
+};
+
+#define LANG_DEFAULT 0
+#endif
@@ -0,0 +1,53 @@
+/* Небольшая библиотека для работы с датчиком освещенности - фоторезистором, включенным в делитель напряжения;
+   Выдает сглаженное значение АЦП в формате int16_t.
+
+   Методы библиотеки:
+
+   LightSensor light_sensor(_sensor_pin) - конструктор класса, _sensor_pin - аналоговый пин, куда подключен датчик;
+
+   int16_t result(channel = 0) - получение последнего сглаженного значения; у датчика один канал - 0;
+
+   Класс реализует асинхронный интерфейс clcSensor (см. sensors.h);
+*/
+#pragma once
+#include <Arduino.h>
+#include "sensors.h"
+
+class LightSensor : public clcSensor
+{
+private:
+  uint8_t sensor_pin;
+  uint16_t value = 0;
+
+public:
+  LightSensor(uint8_t _sensor_pin)
+  {
+    sensor_pin = _sensor_pin;
+  }
+
+  /**
+   * @brief запуск измерения; для фоторезистора подготовка не требуется
+   *
+   * @return true
+   */
+  bool start() { return (true); }
+
+  /**
+   * @brief считывание и сглаживание показаний датчика
+   *
+   * @return SensorState
+   */
+  SensorState poll()
+  {
+    value = (value * 2 + analogRead(sensor_pin)) / 3;
+    return (SENSOR_READY);
+  }
+
+  /**
+   * @brief получение последнего сглаженного значения
+   *
+   * @param channel номер канала; у датчика один канал - 0
+   * @return int16_t
+   */
+  int16_t result(uint8_t channel = 0) { return ((channel == 0) ? value : SENSOR_NO_DATA); }
+};
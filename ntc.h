@@ -11,14 +11,19 @@
     _balance_resistor - сопротивление второго резистора делителя напряжения, в Омах;
     _beta - бета-коэффициент датчика, см. данные производителя; если данных производителя нет, коэффициент можно расчитать, исходя из бета-формулы расчета температуры, которую можно легко найти в интернете.
 
-   int16_t getTemp() - получение температуры с датчика;
+   int16_t getTemp() - получение температуры с датчика; при обрыве или замыкании цепи датчика возвращает NTC_ERROR_TEMP;
 
    void setADCbitDepth(bit_depth) - установка разрядности АЦП используемого микроконтроллера; для Ардуино UNO, Nano, Pro Mini bit_depth = 10; (это значение по умолчанию)
+
+   Кроме того, класс реализует асинхронный интерфейс clcSensor (см. sensors.h): измерение выполняется в poll(), result() возвращает последнюю вычисленную температуру;
 */
 #pragma once
 #include <Arduino.h>
+#include "sensors.h"
+
+#define NTC_ERROR_TEMP -127
 
-class NTCSensor
+class NTCSensor : public clcSensor
 {
 private:
   uint16_t balance;
@@ -39,20 +44,61 @@ public:
     balance = _balance_resistor;
     resistor_room_temp = _resistor_std;
     beta = _beta;
+    cur_temp = 0;
+  }
+
+  /**
+   * @brief запуск измерения; для термистора подготовка не требуется
+   *
+   * @return true
+   */
+  bool start() { return (true); }
+
+  /**
+   * @brief измерение температуры
+   *
+   * @return SensorState
+   */
+  SensorState poll()
+  {
+    int16_t temp = getTemp();
+    if (temp == NTC_ERROR_TEMP)
+    {
+      return (SENSOR_ERROR);
+    }
+    cur_temp = temp;
+    return (SENSOR_READY);
   }
 
+  /**
+   * @brief получение последней вычисленной температуры
+   *
+   * @param channel номер канала; у датчика один канал - 0
+   * @return int16_t
+   */
+  int16_t result(uint8_t channel = 0) { return ((channel == 0) ? cur_temp : SENSOR_NO_DATA); }
+
   /**
    * @brief получение температуры с датчика
    *
-   * @return uint16_t
+   * @return int16_t
    */
-  uint16_t getTemp()
+  int16_t getTemp()
   {
     static uint16_t adcAverage = analogRead(sensor_pin);
 
     adcAverage = (adcAverage * 2 + analogRead(sensor_pin)) / 3;
+    // при обрыве цепи (0) и замыкании термистора (сопротивление 0) температуру не вычислить
+    if (adcAverage == 0)
+    {
+      return (NTC_ERROR_TEMP);
+    }
     // определяем текущее сопротивление термистора
     uint16_t rThermistor = balance * ((max_adc * 100 / adcAverage) - 100) / 100;
+    if (rThermistor == 0)
+    {
+      return (NTC_ERROR_TEMP);
+    }
     // получаем температуру в сотых долях градусов Кельвина
     uint16_t tKelvin = (beta * room_temp) /
                        ((beta + (room_temp * log((float)rThermistor / resistor_room_temp)) / 100));
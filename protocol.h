@@ -0,0 +1,270 @@
+/* Двоичный протокол обмена с компьютером по Serial;
+
+   Кадр: байт синхронизации PROTOCOL_SYNC, длина данных (0..PROTOCOL_MAX_PAYLOAD), код команды, данные, контрольная сумма CRC-8 (полином 0x07, начальное значение 0) по байтам длины, команды и данных. Кадры с неверной длиной или контрольной суммой отбрасываются, разбор продолжается со следующего байта синхронизации.
+
+   Прием выполняется побайтно конечным автоматом, поэтому входящие байты можно обрабатывать по мере поступления, не дожидаясь кадра целиком. Передаваемые кадры помещаются в кольцевой буфер и отправляются методом transmit() порциями, которые помещаются в буфер передачи Serial без ожидания; если кадр не помещается в буфер, он отбрасывается целиком. Вся память выделяется статически.
+
+   Методы:
+
+   bool receive(byte) - обработка принятого байта; false, если байт не относится к кадру (можно использовать для текстовых команд);
+   bool available() - принят кадр, ожидающий обработки;
+   uint8_t getCommand() - код команды принятого кадра;
+   uint8_t getLength() - длина данных принятого кадра;
+   uint8_t *getPayload() - данные принятого кадра;
+   void release() - освобождение принятого кадра для приема следующего;
+   bool send(cmd, data, len) - постановка кадра в очередь на передачу;
+   void transmit(port) - передача очереди в порт без ожидания;
+   uint16_t getRxErrors() - количество отброшенных принятых кадров;
+   uint16_t getTxDrops() - количество кадров, не поместившихся в буфер передачи;
+*/
+#pragma once
+#include <Arduino.h>
+
+#define PROTOCOL_SYNC 0xA5        // байт синхронизации кадра
+#define PROTOCOL_MAX_PAYLOAD 16   // максимальная длина данных кадра, байт
+#define PROTOCOL_TX_BUFFER_SIZE 64 // размер буфера передачи, байт (степень двойки)
+
+enum ProtocolCommand : uint8_t // команды часов; ответ на команду имеет код команды | PROTOCOL_REPLY; при изменении нужно обновить tools/clock_client.py
+{
+  CMD_PING = 0x01,          // проверка связи; ответ - версия протокола
+  CMD_GET_TIME = 0x02,      // ответ - год - 2000, месяц, число, часы, минуты, секунды
+  CMD_SET_TIME = 0x03,      // данные - как в ответе CMD_GET_TIME; ответ - код ошибки
+  CMD_GET_ALARM = 0x04,     // ответ - включен ли будильник, состояние будильника, время срабатывания в минутах от полуночи (uint16_t)
+  CMD_SET_ALARM = 0x05,     // данные - включен ли будильник, время срабатывания (uint16_t); ответ - код ошибки
+  CMD_GET_SETTINGS = 0x06,  // ответ - максимальная и минимальная яркость (0 без датчика света), допустимый диапазон яркости
+  CMD_SET_SETTINGS = 0x07,  // данные - максимальная и минимальная яркость; ответ - код ошибки
+  CMD_GET_TELEMETRY = 0x08, // ответ - телеметрия (см. описание в readme)
+  CMD_SET_TELEMETRY = 0x09, // данные - интервал периодической отправки телеметрии, x100 мс, 0 - отключить; ответ - код ошибки
+  CMD_ERROR = 0x7F          // ответ на неизвестную команду или команду с неверной длиной данных - код команды, код ошибки
+};
+
+enum ProtocolError : uint8_t // коды ошибок
+{
+  PROTOCOL_OK,
+  PROTOCOL_ERR_COMMAND,    // неизвестная команда
+  PROTOCOL_ERR_LENGTH,     // неверная длина данных
+  PROTOCOL_ERR_VALUE,      // значение вне допустимого диапазона
+  PROTOCOL_ERR_UNSUPPORTED // возможность отключена в настройках прошивки
+};
+
+#define PROTOCOL_VERSION 1
+#define PROTOCOL_REPLY 0x80 // признак ответа в коде команды
+
+static_assert((PROTOCOL_TX_BUFFER_SIZE & (PROTOCOL_TX_BUFFER_SIZE - 1)) == 0 && PROTOCOL_TX_BUFFER_SIZE <= 128,
+              "PROTOCOL_TX_BUFFER_SIZE must be a power of two up to 128");
+
+/**
+ * @brief обновление контрольной суммы CRC-8 (полином 0x07) очередным байтом
+ *
+ * @param crc текущее значение
+ * @param data байт данных
+ * @return uint8_t
+ */
+inline uint8_t crc8Update(uint8_t crc, uint8_t data)
+{
+  crc ^= data;
+  for (uint8_t i = 0; i < 8; i++)
+  {
+    crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1;
+  }
+  return (crc);
+}
+
+class SerialProtocol
+{
+private:
+  enum RxState : uint8_t
+  {
+    RX_SYNC,    // ожидание байта синхронизации
+    RX_LENGTH,  // длина данных
+    RX_COMMAND, // код команды
+    RX_PAYLOAD, // данные
+    RX_CRC,     // контрольная сумма
+    RX_READY    // кадр принят и ожидает обработки
+  };
+
+  RxState rx_state = RX_SYNC;
+  uint8_t rx_length = 0;
+  uint8_t rx_command = 0;
+  uint8_t rx_pos = 0;
+  uint8_t rx_crc = 0;
+  uint8_t rx_payload[PROTOCOL_MAX_PAYLOAD];
+  uint16_t rx_errors = 0;
+
+  uint8_t tx_buf[PROTOCOL_TX_BUFFER_SIZE];
+  uint8_t tx_head = 0;
+  uint8_t tx_tail = 0;
+  uint16_t tx_drops = 0;
+
+  void rxError()
+  {
+    if (rx_errors < 0xFFFF)
+    {
+      rx_errors++;
+    }
+    rx_state = RX_SYNC;
+  }
+
+  void txPut(uint8_t data)
+  {
+    tx_buf[tx_head] = data;
+    tx_head = (tx_head + 1) & (PROTOCOL_TX_BUFFER_SIZE - 1);
+  }
+
+public:
+  /**
+   * @brief обработка принятого байта
+   *
+   * @param data байт
+   * @return false, если байт не относится к кадру протокола
+   */
+  bool receive(uint8_t data)
+  {
+    switch (rx_state)
+    {
+    case RX_SYNC:
+      if (data != PROTOCOL_SYNC)
+      {
+        return (false);
+      }
+      rx_state = RX_LENGTH;
+      break;
+    case RX_LENGTH:
+      if (data > PROTOCOL_MAX_PAYLOAD)
+      {
+        rxError();
+        break;
+      }
+      rx_length = data;
+      rx_crc = crc8Update(0, data);
+      rx_state = RX_COMMAND;
+      break;
+    case RX_COMMAND:
+      rx_command = data;
+      rx_crc = crc8Update(rx_crc, data);
+      rx_pos = 0;
+      rx_state = (rx_length > 0) ? RX_PAYLOAD : RX_CRC;
+      break;
+    case RX_PAYLOAD:
+      rx_payload[rx_pos++] = data;
+      rx_crc = crc8Update(rx_crc, data);
+      if (rx_pos >= rx_length)
+      {
+        rx_state = RX_CRC;
+      }
+      break;
+    case RX_CRC:
+      if (data != rx_crc)
+      {
+        rxError();
+        break;
+      }
+      rx_state = RX_READY;
+      break;
+    case RX_READY:
+      // предыдущий кадр еще не обработан; новый кадр теряется
+      if (data == PROTOCOL_SYNC && rx_errors < 0xFFFF)
+      {
+        rx_errors++;
+      }
+      break;
+    }
+    return (true);
+  }
+
+  /**
+   * @brief проверка наличия принятого кадра
+   *
+   * @return true, если кадр принят и ожидает обработки
+   */
+  bool available() { return (rx_state == RX_READY); }
+
+  /**
+   * @brief получение кода команды принятого кадра
+   *
+   * @return uint8_t
+   */
+  uint8_t getCommand() { return (rx_command); }
+
+  /**
+   * @brief получение длины данных принятого кадра
+   *
+   * @return uint8_t
+   */
+  uint8_t getLength() { return (rx_length); }
+
+  /**
+   * @brief получение данных принятого кадра
+   *
+   * @return uint8_t*
+   */
+  uint8_t *getPayload() { return (rx_payload); }
+
+  /**
+   * @brief освобождение принятого кадра для приема следующего
+   *
+   */
+  void release() { rx_state = RX_SYNC; }
+
+  /**
+   * @brief постановка кадра в очередь на передачу
+   *
+   * @param command код команды
+   * @param data данные
+   * @param len длина данных, не больше PROTOCOL_MAX_PAYLOAD
+   * @return false, если кадр не помещается в буфер передачи
+   */
+  bool send(uint8_t command, const uint8_t *data, uint8_t len)
+  {
+    uint8_t used = (tx_head - tx_tail) & (PROTOCOL_TX_BUFFER_SIZE - 1);
+    if (len > PROTOCOL_MAX_PAYLOAD || used + len + 4 >= PROTOCOL_TX_BUFFER_SIZE)
+    {
+      if (tx_drops < 0xFFFF)
+      {
+        tx_drops++;
+      }
+      return (false);
+    }
+    uint8_t crc = crc8Update(crc8Update(0, len), command);
+    txPut(PROTOCOL_SYNC);
+    txPut(len);
+    txPut(command);
+    for (uint8_t i = 0; i < len; i++)
+    {
+      txPut(data[i]);
+      crc = crc8Update(crc, data[i]);
+    }
+    txPut(crc);
+    return (true);
+  }
+
+  /**
+   * @brief передача очереди в порт; передается столько байт, сколько помещается в буфер передачи порта без ожидания
+   *
+   * @param port порт, например, Serial
+   */
+  template <class T>
+  void transmit(T &port)
+  {
+    int16_t n = port.availableForWrite();
+    while (n-- > 0 && tx_tail != tx_head)
+    {
+      port.write(tx_buf[tx_tail]);
+      tx_tail = (tx_tail + 1) & (PROTOCOL_TX_BUFFER_SIZE - 1);
+    }
+  }
+
+  /**
+   * @brief получение количества отброшенных принятых кадров - с неверной длиной или контрольной суммой или пришедших до обработки предыдущего
+   *
+   * @return uint16_t
+   */
+  uint16_t getRxErrors() { return (rx_errors); }
+
+  /**
+   * @brief получение количества кадров, не поместившихся в буфер передачи
+   *
+   * @return uint16_t
+   */
+  uint16_t getTxDrops() { return (tx_drops); }
+};
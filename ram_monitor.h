@@ -0,0 +1,142 @@
+/* Контроль свободной RAM и глубины стека;
+
+   При старте МК, до инициализации глобальных объектов, вся свободная область между концом кучи и вершиной стека заполняется контрольным байтом STACK_CANARY. Стек растет вниз, в сторону кучи, и затирает контрольные байты, поэтому глубина стека определяется поиском первого затертого байта снизу, со стороны кучи, а минимальный за время работы запас свободной RAM - это количество нетронутых контрольных байтов.
+
+   Методы:
+
+   uint16_t getFreeMemory() - текущий размер свободной области между кучей и стеком, байт;
+   uint16_t getMinFreeMemory() - минимальный запас свободной RAM за время работы, байт;
+   uint16_t stackMark() - запоминание текущей вершины стека перед вызовом проверяемой функции;
+   uint16_t stackUsedSince(mark) - глубина стека, использованная после stackMark(), байт; после измерения область, затертая стеком, снова заполняется контрольными байтами, чтобы следующее измерение показывало глубину только своей функции;
+   bool isLow() - запас свободной RAM меньше RAM_WARNING_THRESHOLD;
+   void printReport(out) - вывод текущего и минимального запаса свободной RAM;
+
+   В глубину стека функции попадают и прерывания, пришедшие во время ее выполнения.
+*/
+#pragma once
+#include <Arduino.h>
+#include "hal.h"
+
+#define STACK_CANARY 0xC5          // контрольный байт, которым заполняется свободная RAM
+#define RAM_WARNING_THRESHOLD 64   // порог предупреждения о нехватке RAM, байт
+#define STACK_PAINT_RESERVE 2      // байты у вершины стека, которые не заполняются при старте
+
+// заполнение свободной RAM контрольными байтами при старте МК; функция выполняется до инициализации переменных и не должна использовать стек
+HAL_EARLY_INIT(ramPaintStack)
+{
+  // куча еще не используется, а __brkval до обнуления .bss не определена, поэтому граница берется по концу статических данных
+  uint8_t *p = (uint8_t *)halHeapStart();
+  uint8_t *top = (uint8_t *)halStackPointer();
+  if (p != 0)
+  {
+    while (p < top - STACK_PAINT_RESERVE)
+    {
+      *p++ = STACK_CANARY;
+    }
+  }
+}
+
+class RamMonitor
+{
+private:
+  uint16_t min_free = 0xFFFF;
+
+  void updateMinFree(uint16_t value)
+  {
+    if (value < min_free)
+    {
+      min_free = value;
+    }
+  }
+
+  // количество нетронутых контрольных байтов над концом кучи
+  uint16_t scanFree()
+  {
+    uint8_t *p = (uint8_t *)halHeapEnd();
+    uint8_t *top = (uint8_t *)halStackPointer();
+    uint16_t result = 0;
+    while (p + result < top && p[result] == STACK_CANARY)
+    {
+      result++;
+    }
+    return (result);
+  }
+
+public:
+  /**
+   * @brief получение текущего размера свободной области между кучей и стеком
+   *
+   * @return uint16_t размер, байт; 0, если недоступно
+   */
+  uint16_t getFreeMemory()
+  {
+    uint16_t sp = halStackPointer();
+    uint16_t heap = halHeapEnd();
+    return ((sp > heap) ? sp - heap : 0);
+  }
+
+  /**
+   * @brief получение минимального запаса свободной RAM за время работы
+   *
+   * @return uint16_t размер, байт
+   */
+  uint16_t getMinFreeMemory()
+  {
+    updateMinFree(scanFree());
+    return (min_free);
+  }
+
+  /**
+   * @brief запоминание текущей вершины стека перед вызовом проверяемой функции
+   *
+   * @return uint16_t метка для stackUsedSince()
+   */
+  uint16_t stackMark() { return (halStackPointer()); }
+
+  /**
+   * @brief получение глубины стека, использованной после вызова stackMark()
+   *
+   * @param mark метка, полученная stackMark()
+   * @return uint16_t глубина, байт
+   */
+  uint16_t stackUsedSince(uint16_t mark)
+  {
+    uint16_t free = scanFree();
+    updateMinFree(free);
+    uint8_t *low = (uint8_t *)halHeapEnd() + free;
+    if (mark == 0 || (uint16_t)low >= mark)
+    {
+      return (0);
+    }
+    uint16_t result = mark - (uint16_t)low;
+    // восстановление контрольных байтов до текущей вершины стека
+    uint8_t *top = (uint8_t *)halStackPointer() - STACK_PAINT_RESERVE;
+    for (uint8_t *p = low; p < top; p++)
+    {
+      *p = STACK_CANARY;
+    }
+    return (result);
+  }
+
+  /**
+   * @brief проверка запаса свободной RAM
+   *
+   * @return true, если запас меньше RAM_WARNING_THRESHOLD
+   */
+  bool isLow() { return (getMinFreeMemory() < RAM_WARNING_THRESHOLD); }
+
+  /**
+   * @brief вывод текущего и минимального запаса свободной RAM
+   *
+   * @param out поток для вывода, например, Serial
+   */
+  void printReport(Print &out)
+  {
+    out.print(F("free, B: "));
+    out.println(getFreeMemory());
+    out.print(F("min free, B: "));
+    out.println(getMinFreeMemory());
+  }
+};
+
+RamMonitor ram;
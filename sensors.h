@@ -0,0 +1,277 @@
+/* Общий интерфейс датчиков и планировщик их опроса;
+
+   Каждый датчик реализует асинхронный интерфейс clcSensor:
+
+   bool start() - запуск измерения (например, команда на конвертацию); возвращает false в случае ошибки;
+
+   SensorState poll() - опрос датчика; возвращает SENSOR_BUSY, пока измерение не завершено, SENSOR_READY, если получен новый результат, SENSOR_ERROR в случае ошибки;
+
+   uint8_t channels() - количество значений (каналов), которые выдает датчик за одно измерение; по умолчанию 1;
+
+   int16_t result(channel = 0) - получение последнего считанного значения канала channel; для несуществующего канала - SENSOR_NO_DATA;
+
+   Датчики регистрируются в менеджере SensorManager методом add(), где указывается интервал опроса и, при необходимости, функция, которая будет вызвана при получении нового результата. Метод SensorManager::tick() за один вызов выполняет не более одной операции с одним датчиком, поэтому обращения к разным датчикам никогда не происходят в одном и том же проходе; стартовые моменты датчиков при регистрации разносятся на SENSOR_STAGGER_STEP миллисекунд.
+
+   Для добавления нового датчика (например, BME280 с пакетным чтением регистров по I2C) достаточно унаследовать его класс от clcSensor, реализовать методы start(), poll() и result() и зарегистрировать экземпляр в setup() вызовом sensors.add(); датчик с несколькими значениями (у BME280 - температура, влажность и давление) переопределяет и channels(), а result() возвращает значение по номеру канала.
+*/
+#pragma once
+#include <Arduino.h>
+#include <DS3231.h> // https://github.com/NorthernWidget/DS3231
+#include "counters.h"
+
+#define MAX_SENSOR_COUNT 4       // максимальное количество датчиков в менеджере
+#define SENSOR_STAGGER_STEP 25   // разнос стартовых моментов опроса датчиков, мс
+#define SENSOR_NO_DATA INT16_MIN // значение несуществующего канала датчика
+
+enum SensorState : uint8_t // результат опроса датчика
+{
+  SENSOR_BUSY,  // измерение еще не завершено
+  SENSOR_READY, // получен новый результат
+  SENSOR_ERROR  // ошибка измерения
+};
+
+// ==== базовый класс датчика ========================
+class clcSensor
+{
+public:
+  /**
+   * @brief запуск измерения
+   *
+   * @return false в случае ошибки
+   */
+  virtual bool start() = 0;
+
+  /**
+   * @brief опрос датчика после запуска измерения
+   *
+   * @return SensorState
+   */
+  virtual SensorState poll() = 0;
+
+  /**
+   * @brief получение количества значений (каналов), которые выдает датчик за одно измерение
+   *
+   * @return uint8_t
+   */
+  virtual uint8_t channels() { return (1); }
+
+  /**
+   * @brief получение последнего считанного значения
+   *
+   * @param channel номер канала, 0..channels() - 1; без параметра - основное значение датчика
+   * @return int16_t; SENSOR_NO_DATA для несуществующего канала
+   */
+  virtual int16_t result(uint8_t channel = 0) = 0;
+};
+
+// ==== менеджер датчиков ============================
+class SensorManager
+{
+private:
+  struct SensorSlot
+  {
+    clcSensor *sensor;
+    void (*callback)();
+    uint16_t interval;     // интервал опроса, мс
+    uint32_t timer;        // момент последнего запуска измерения
+    uint16_t errors;       // количество ошибок
+    uint16_t latency;      // длительность последнего измерения, мс
+    uint16_t max_latency;  // максимальная длительность измерения, мс
+    bool busy;             // измерение запущено и еще не завершено
+  };
+
+  SensorSlot slots[MAX_SENSOR_COUNT];
+  uint8_t sensor_count = 0;
+  uint8_t cur = 0;
+
+  void setResult(SensorSlot &slot, SensorState state)
+  {
+    slot.busy = false;
+    if (state == SENSOR_ERROR)
+    {
+      if (slot.errors < 0xFFFF)
+      {
+        slot.errors++;
+      }
+      return;
+    }
+    uint32_t t = millis() - slot.timer;
+    slot.latency = (t < 0xFFFF) ? t : 0xFFFF;
+    if (slot.latency > slot.max_latency)
+    {
+      slot.max_latency = slot.latency;
+    }
+    if (slot.callback != NULL)
+    {
+      slot.callback();
+    }
+  }
+
+public:
+  SensorManager() {}
+
+  /**
+   * @brief регистрация датчика
+   *
+   * @param sensor датчик
+   * @param interval интервал опроса, мс
+   * @param callback функция, вызываемая при получении нового результата
+   * @return индекс датчика в менеджере или -1, если места для датчика нет
+   */
+  int8_t add(clcSensor *sensor, uint16_t interval, void (*callback)() = NULL)
+  {
+    if (sensor_count >= MAX_SENSOR_COUNT)
+    {
+      return (-1);
+    }
+    SensorSlot &slot = slots[sensor_count];
+    slot.sensor = sensor;
+    slot.callback = callback;
+    slot.interval = interval;
+    // первый запуск каждого датчика сдвигается, чтобы датчики не опрашивались одновременно
+    slot.timer = millis() - interval + SENSOR_STAGGER_STEP * (sensor_count + 1);
+    slot.errors = 0;
+    slot.latency = 0;
+    slot.max_latency = 0;
+    slot.busy = false;
+
+    return (sensor_count++);
+  }
+
+  /**
+   * @brief обработка датчиков; за один вызов выполняется не более одной операции с одним датчиком
+   *
+   */
+  void tick()
+  {
+    for (uint8_t i = 0; i < sensor_count; i++)
+    {
+      SensorSlot &slot = slots[cur];
+      if (++cur >= sensor_count)
+      {
+        cur = 0;
+      }
+
+      if (slot.busy)
+      {
+        SensorState state = slot.sensor->poll();
+        if (state != SENSOR_BUSY)
+        {
+          setResult(slot, state);
+        }
+        return;
+      }
+      if (millis() - slot.timer >= slot.interval)
+      {
+        slot.timer = millis();
+        if (slot.sensor->start())
+        {
+          slot.busy = true;
+        }
+        else
+        {
+          setResult(slot, SENSOR_ERROR);
+        }
+        return;
+      }
+    }
+  }
+
+  /**
+   * @brief получение количества зарегистрированных датчиков
+   *
+   * @return uint8_t
+   */
+  uint8_t getSensorCount() { return (sensor_count); }
+
+  /**
+   * @brief получение количества ошибок датчика
+   *
+   * @param index индекс датчика
+   * @return uint16_t
+   */
+  uint16_t getErrorCount(uint8_t index)
+  {
+    return ((index < sensor_count) ? slots[index].errors : 0);
+  }
+
+  /**
+   * @brief получение длительности последнего измерения датчика, мс
+   *
+   * @param index индекс датчика
+   * @return uint16_t
+   */
+  uint16_t getLatency(uint8_t index)
+  {
+    return ((index < sensor_count) ? slots[index].latency : 0);
+  }
+
+  /**
+   * @brief получение максимальной длительности измерения датчика, мс
+   *
+   * @param index индекс датчика
+   * @return uint16_t
+   */
+  uint16_t getMaxLatency(uint8_t index)
+  {
+    return ((index < sensor_count) ? slots[index].max_latency : 0);
+  }
+
+  /**
+   * @brief вывод статистики датчиков: номер датчика в порядке регистрации, количество ошибок, длительность последнего и максимальная длительность измерения, мс
+   *
+   * @param out поток для вывода, например, Serial
+   */
+  void printReport(Print &out)
+  {
+    out.println(F("sensor err lat max"));
+    for (uint8_t i = 0; i < sensor_count; i++)
+    {
+      out.print(i);
+      out.print(' ');
+      out.print(slots[i].errors);
+      out.print(' ');
+      out.print(slots[i].latency);
+      out.print(' ');
+      out.println(slots[i].max_latency);
+    }
+  }
+};
+
+// ==== встроенный датчик температуры DS3231 =========
+class DS3231TempSensor : public clcSensor
+{
+private:
+  DS3231 *rtc;
+  int16_t temp = 0;
+
+public:
+  DS3231TempSensor(DS3231 &_rtc) { rtc = &_rtc; }
+
+  /**
+   * @brief запуск измерения; DS3231 обновляет температуру самостоятельно раз в 64 секунды
+   *
+   * @return true
+   */
+  bool start() { return (true); }
+
+  /**
+   * @brief считывание температуры из регистров DS3231
+   *
+   * @return SensorState
+   */
+  SensorState poll()
+  {
+    COUNT_ACTIVITY(CNT_I2C);
+    temp = (int16_t)round(rtc->getTemperature());
+    return (SENSOR_READY);
+  }
+
+  /**
+   * @brief получение последней считанной температуры
+   *
+   * @param channel номер канала; у датчика один канал - 0
+   * @return int16_t
+   */
+  int16_t result(uint8_t channel = 0) { return ((channel == 0) ? temp : SENSOR_NO_DATA); }
+};
@@ -18,3 +18,21 @@
 // пины для подключения матрицы 
 #define DISPLAY_DIN_PIN 10 // пин для подключения экрана - DIN
 #define DISPLAY_CLK_PIN 11 // пин для подключения экрана - CLK (для четырехпроводных схем)
+
+// ==== ограничение частоты кадров ===================
+
+// на время передачи данных на матрицу FastLED запрещает прерывания (256 светодиодов - около 8 мс), поэтому передачи распределяются так, чтобы их суммарное время не превышало заданной доли каждой секунды; кадры, изменившиеся быстрее, объединяются; бегущая строка при этом не пропускает столбцы, а замедляется: 200 мс в секунду для 256 светодиодов - около 25 кадров в секунду, поэтому для TICKER_SPEED 50 без USE_SMOOTH_TICKER нужно около 400
+#define WS2812_BLACKOUT_BUDGET 200 // допустимое время передачи данных на матрицу, мс в секунду
+#define WS2812_HOLD_TIME 30        // задержка передачи после фронта на пине кнопки (на время дребезга), мс
+#define WS2812_HOLD_LIMIT 100      // максимальная задержка кадра из-за нажатий кнопок, мс
+
+// ==== цвета элементов экрана =======================
+
+#define COLOR_TIME CRGB::Red           // цифры времени
+#define COLOR_TIME_ALARM CRGB::Red     // цифры времени при включенном будильнике
+#define COLOR_COLON CRGB::Red          // двоеточие
+#define COLOR_SECONDS CRGB::Red        // секундный столбец
+#define COLOR_TEXT CRGB::Red           // дата, экраны настроек и прочий текст
+#define COLOR_TEMP CRGB::Red           // температура выше нуля
+#define COLOR_TEMP_NEGATIVE CRGB::Blue // температура ниже нуля
+#define COLOR_TIMER CRGB::Red          // секундомер и таймер
@@ -2,9 +2,12 @@
 #include <EEPROM.h>
 #include <avr/pgmspace.h>
 #include <DS3231.h>        // https://github.com/NorthernWidget/DS3231
-#include <shButton.h>      // https://github.com/VAleSh-Soft/shButton
-#include <shTaskManager.h> // https://github.com/VAleSh-Soft/shTaskManager
 #include "header_file.h"
+#include "hal.h"
+#include "task_manager.h"
+#include "buttons.h"
+#include "counters.h"
+#include "trace.h"
 #if defined(TM1637_DISPLAY)
 #include "display_TM1637.h"
 #elif defined(MAX72XX_7SEGMENT_DISPLAY) || defined(MAX72XX_MATRIX_DISPLAY)
@@ -16,6 +19,15 @@
 #ifdef USE_ALARM
 #include "alarm.h"
 #endif
+#ifdef USE_STOPWATCH
+#include "stopwatch.h"
+#endif
+#ifdef USE_EVENT_LOOP
+#include "events.h"
+#endif
+#ifdef USE_SENSORS
+#include "sensors.h"
+#endif
 #ifdef USE_TEMP_DATA
 #if defined(USE_DS18B20)
 #include "ds1820.h"
@@ -23,6 +35,15 @@
 #include "ntc.h"
 #endif
 #endif
+#ifdef USE_LIGHT_SENSOR
+#include "light_sensor.h"
+#endif
+#ifdef USE_RENDER_BENCHMARK
+#include "benchmark.h"
+#endif
+#ifdef USE_SERIAL_PROTOCOL
+#include "protocol.h"
+#endif
 
 // ==== настройки ====================================
 #ifdef USE_ALARM
@@ -31,7 +52,21 @@
 #define ALARM_REPETITION_COUNT 3 // количество повторов сигнала будильника
 #endif
 #define LIGHT_THRESHOLD 300 // порог переключения для датчика света
+#define SETTING_INTERVAL 50ul // интервал обработки кнопок в режимах настройки, мс; не больше наименьшего интервала автоповтора в repeat_stages, иначе повторы, пришедшие между вызовами, теряются
+#ifdef USE_SENSORS
+#define SENSOR_TICK_INTERVAL 50 // интервал обработки датчиков менеджером датчиков, мс; за один вызов выполняется одна операция с одним датчиком, поэтому интервал должен быть заметно меньше интервалов опроса датчиков
+#define DS18B20_INTERVAL 3000   // интервал опроса датчика DS18b20, мс
+#define NTC_INTERVAL 1000       // интервал опроса NTC термистора, мс
+#define RTC_TEMP_INTERVAL 5000  // интервал опроса встроенного датчика температуры DS3231, мс
+#define LIGHT_INTERVAL 100      // интервал опроса датчика света, мс
+#endif
+#ifdef USE_STOPWATCH
+#define TIMER_INTERVAL SETTING_INTERVAL // интервал обновления экрана секундомера и таймера, мс; на матричных экранах выводятся доли секунды, а в режиме таймера кнопками с автоповтором задаются минуты
+#endif
 #define AUTO_EXIT_TIMEOUT 6 // время автоматического возврата в режим показа текущего времени из любых других режимов при отсутствии активности пользователя, секунд
+#ifdef USE_EVENT_LOOP
+#define BTN_ACTIVE_TIMEOUT 1000 // время, в течение которого после последнего изменения уровня на пинах кнопок продолжается их опрос, мс
+#endif
 // ===================================================
 
 #if defined(TM1637_DISPLAY)
@@ -39,10 +74,10 @@ DisplayTM1637 disp(DISPLAY_CLK_PIN, DISPLAY_DAT_PIN);
 #elif defined(MAX72XX_7SEGMENT_DISPLAY)
 DisplayMAX72xx7segment<DISPLAY_CS_PIN> disp;
 #elif defined(MAX72XX_MATRIX_DISPLAY)
-DisplayMAX72xxMatrix<DISPLAY_CS_PIN> disp;
+DisplayMAX72xxMatrix<DISPLAY_CS_PIN, MATRIX_WIDTH, MATRIX_HEIGHT> disp;
 #elif defined(WS2812_MATRIX_DISPLAY)
-CRGB leds[256];
-DisplayWS2812Matrix disp(leds, CRGB::Red, BY_COLUMNS);
+CRGB leds[MATRIX_WIDTH * MATRIX_HEIGHT];
+DisplayWS2812Matrix<MATRIX_WIDTH, MATRIX_HEIGHT> disp(leds, BY_COLUMNS);
 #endif
 
 DS3231 clock; // SDA - A4, SCL - A5
@@ -50,44 +85,221 @@ RTClib RTC;
 #ifdef USE_ALARM
 Alarm alarm(ALARM_LED_PIN, ALARM_EEPROM_INDEX);
 #endif
+#ifdef USE_STOPWATCH
+Stopwatch stopwatch(false);
+Stopwatch countdown(true);
+uint8_t countdown_minutes = COUNTDOWN_DEFAULT_MINUTES; // установка таймера обратного отсчета, минут
+#endif
+#ifdef USE_SENSORS
+SensorManager sensors;
+#endif
 #ifdef USE_TEMP_DATA
 #if defined(USE_DS18B20)
 DS1820 temp_sensor(DS18B20_PIN); // вход датчика DS18b20
 #elif defined(USE_NTC)
 NTCSensor temp_sensor(NTC_PIN, 10000, 9850, 3950);
+#else
+DS3231TempSensor temp_sensor(clock); // встроенный датчик DS3231
 #endif
 #endif
+#ifdef USE_LIGHT_SENSOR
+LightSensor light_sensor(LIGHT_SENSOR_PIN);
+#endif
 
-shTaskManager tasks; // создаем список задач, количество задач укажем в setup()
-
-shHandle rtc_guard;              // опрос микросхемы RTC по таймеру, чтобы не дергать ее откуда попало
-shHandle blink_timer;            // блинк
-shHandle return_to_default_mode; // таймер автовозврата в режим показа времени из любого режима настройки
-shHandle set_time_mode;          // режим настройки времени
-shHandle display_guard;          // вывод данных на экран
+// ==== задачи =======================================
+// идентификаторы задач; порядок должен совпадать с порядком задач в списке task_list
+enum TaskHandle : uint8_t
+{
+  rtc_guard,              // опрос микросхемы RTC по таймеру, чтобы не дергать ее откуда попало
+  blink_timer,            // блинк
+  return_to_default_mode, // таймер автовозврата в режим показа времени из любого режима настройки
+  set_time_mode,          // режим настройки времени
+  display_guard,          // вывод данных на экран
 #ifdef USE_ALARM
-shHandle alarm_guard;  // отслеживание будильника
-shHandle alarm_buzzer; // пищалка будильника
+  alarm_guard,  // отслеживание будильника
+  alarm_buzzer, // пищалка будильника
 #endif
 #ifdef USE_CALENDAR
-shHandle show_calendar_mode; // режим вывода даты
+  show_calendar_mode, // режим вывода даты
 #endif
 #ifdef USE_TEMP_DATA
-shHandle show_temp_mode; // режим показа температуры
-#if defined(USE_DS18B20)
-shHandle ds18b20_guard; // опрос датчика DS18b20
+  show_temp_mode, // режим показа температуры
 #endif
+#ifdef USE_SENSORS
+  sensor_guard, // опрос датчиков
 #endif
-#ifdef USE_LIGHT_SENSOR
-shHandle light_sensor_guard; // отслеживание показаний датчика света
+#ifdef USE_SET_BRIGHTNESS_MODE
+  set_brightness_mode, // режим настройки яркости экрана
+#endif
+#ifdef USE_LANGUAGE_SETTING
+  set_language_mode, // режим настройки языка вывода
+#endif
+#ifdef USE_SERIAL_PROTOCOL
+  telemetry_timer, // периодическая отправка телеметрии
+#endif
+#ifdef USE_STOPWATCH
+  stopwatch_mode,   // режим секундомера и таймера
+  countdown_buzzer, // отслеживание окончания отсчета таймера и его сигнал
+#endif
+  TASK_COUNT // количество задач
+};
+
+#ifdef USE_CALENDAR
+#if defined(WS2812_MATRIX_DISPLAY) && defined(USE_TICKER_FOR_DATE) && defined(USE_SMOOTH_TICKER)
+#define CALENDAR_INTERVAL (1000ul / TICKER_SMOOTH_FPS)
+#elif (defined(WS2812_MATRIX_DISPLAY) || defined(MAX72XX_MATRIX_DISPLAY)) && defined(USE_TICKER_FOR_DATE)
+#define CALENDAR_INTERVAL (1000ul / TICKER_SPEED)
+#else
+#define CALENDAR_INTERVAL 1000ul
+#endif
+#endif
+
+// список задач: функция, интервал, активна ли задача при старте
+static const clcTask PROGMEM task_list[] = {
+    {rtcNow, 50ul, true},
+    {blink, 50ul, true},
+    {returnToDefMode, AUTO_EXIT_TIMEOUT * 1000ul, false},
+    {showTimeSetting, SETTING_INTERVAL, false},
+    {setDisp, 50ul, true},
+#ifdef USE_ALARM
+    {checkAlarm, 200ul, true},
+    {runAlarmBuzzer, 50ul, false},
+#endif
+#ifdef USE_CALENDAR
+    {showCalendar, CALENDAR_INTERVAL, false},
+#endif
+#ifdef USE_TEMP_DATA
+    {showTemp, 500ul, false},
+#endif
+#ifdef USE_SENSORS
+    {checkSensors, SENSOR_TICK_INTERVAL, true},
 #endif
 #ifdef USE_SET_BRIGHTNESS_MODE
-shHandle set_brightness_mode; // режим настройки яркости экрана
+    {showBrightnessSetting, SETTING_INTERVAL, false},
+#endif
+#ifdef USE_LANGUAGE_SETTING
+    {showLanguageSetting, SETTING_INTERVAL, false},
+#endif
+#ifdef USE_SERIAL_PROTOCOL
+    {sendTelemetry, 1000ul, false},
+#endif
+#ifdef USE_STOPWATCH
+    {showTimer, TIMER_INTERVAL, false},
+    {checkCountdown, 100ul, false},
 #endif
+};
+
+static_assert(sizeof(task_list) / sizeof(task_list[0]) == TASK_COUNT,
+              "task_list does not match TaskHandle");
+
+clcTaskManager<TASK_COUNT> tasks(task_list);
 
 DisplayMode displayMode = DISPLAY_MODE_SHOW_TIME;
 bool blink_flag = false; // флаг блинка, используется всем, что должно мигать
 DateTime curTime;
+#ifdef USE_EVENT_LOOP
+EventQueue events;
+uint32_t btn_timer = 0; // момент последней активности кнопок
+#endif
+#ifdef USE_RTC_SQW
+uint32_t rtc_timer = 0; // момент последнего считывания времени из DS3231
+#endif
+#ifdef USE_TASK_PROFILER
+uint32_t boot_time = 0; // время от запуска до вывода первого кадра, мкс
+#endif
+#ifdef USE_POWER_SAVE
+uint32_t power_timer = 0;      // момент последнего нажатия кнопки
+uint32_t power_sleep_time = 0; // суммарное время сна МК, мс
+uint32_t power_stat_timer = 0; // момент последнего сброса статистики сна
+#endif
+#ifdef USE_SERIAL_PROTOCOL
+SerialProtocol link;
+uint16_t rtc_errors = 0; // количество некорректных ответов DS3231
+uint16_t loop_rate = 0;  // частота главного цикла, раз в секунду
+#endif
+
+// ==== прерывания ===================================
+#ifdef USE_BUTTON_INTERRUPTS
+void buttonIsr()
+{
+  // прерывание группы PCINT вызывается и фронтами SQW (на время сна), которые кнопками не являются
+  if (!EventButton::capture())
+  {
+    return;
+  }
+  TRACE(TRACE_CAT_BUTTON, TRACE_BUTTON_EDGE, 0);
+#ifdef WS2812_MATRIX_DISPLAY
+  disp.holdShow();
+#endif
+#ifdef USE_EVENT_LOOP
+  events.push(EVENT_BUTTON);
+#endif
+}
+
+// векторы определяются только для групп PCINT, в которых есть пины кнопок или пин SQW (на время сна сигнал SQW принимается прерыванием PCINT)
+#ifdef USE_RTC_SQW
+#define SQW_PCINT_GROUP HAL_PIN_CHANGE_GROUP(DS3231_SQW_PIN)
+#else
+#define SQW_PCINT_GROUP 0xFF
+#endif
+#define PCINT_GROUP_USED(group) (HAL_PIN_CHANGE_GROUP(BTN_SET_PIN) == group ||  \
+                                 HAL_PIN_CHANGE_GROUP(BTN_UP_PIN) == group ||   \
+                                 HAL_PIN_CHANGE_GROUP(BTN_DOWN_PIN) == group || \
+                                 SQW_PCINT_GROUP == group)
+#if PCINT_GROUP_USED(0)
+HAL_PIN_CHANGE_ISR(0, buttonIsr)
+#define PCINT_GROUP_MASK_0 0x01
+#else
+#define PCINT_GROUP_MASK_0 0x00
+#endif
+#if PCINT_GROUP_USED(1)
+HAL_PIN_CHANGE_ISR(1, buttonIsr)
+#define PCINT_GROUP_MASK_1 0x02
+#else
+#define PCINT_GROUP_MASK_1 0x00
+#endif
+#if PCINT_GROUP_USED(2)
+HAL_PIN_CHANGE_ISR(2, buttonIsr)
+#define PCINT_GROUP_MASK_2 0x04
+#else
+#define PCINT_GROUP_MASK_2 0x00
+#endif
+// препроцессор не знает значений A0..A7 и считает их нулями, поэтому группа каждого пина перепроверяется компилятором
+#define PCINT_GROUP_MASK (PCINT_GROUP_MASK_0 | PCINT_GROUP_MASK_1 | PCINT_GROUP_MASK_2)
+#define PCINT_PIN_COVERED(pin) (HAL_PIN_CHANGE_GROUP(pin) > 2 || (PCINT_GROUP_MASK & (1 << HAL_PIN_CHANGE_GROUP(pin))))
+static_assert(PCINT_PIN_COVERED(BTN_SET_PIN) && PCINT_PIN_COVERED(BTN_UP_PIN) && PCINT_PIN_COVERED(BTN_DOWN_PIN),
+              "button pins must be given as numbers (14..21 for A0..A7) to select pin change vectors");
+#endif
+#ifdef USE_RTC_SQW
+void rtcSqwIsr()
+{
+  TRACE(TRACE_CAT_RTC, TRACE_RTC_SQW, 0);
+  events.push(EVENT_RTC_TICK);
+}
+#endif
+#if defined(USE_POWER_SAVE) && !defined(USE_RTC_SQW)
+void wakeTimerIsr() {} // прерывание нужно только для пробуждения МК
+
+HAL_WAKE_TIMER_ISR(wakeTimerIsr)
+#endif
+#ifdef USE_TRACE
+void traceTimerIsr() { trace.timerWrap(); }
+
+HAL_TIMER_OVERFLOW_ISR(traceTimerIsr)
+#endif
+#ifdef USE_STOPWATCH
+void timerTickIsr()
+{
+  stopwatch.tick();
+  countdown.tick();
+  if (!stopwatch.isRunning() && !countdown.isRunning())
+  {
+    halTickStop();
+  }
+}
+
+HAL_TICK_ISR(timerTickIsr)
+#endif
 
 // ==== класс кнопок с предварительной настройкой ====
 enum ButtonFlag : uint8_t
@@ -97,17 +309,39 @@ enum ButtonFlag : uint8_t
   BTN_FLAG_EXIT  // флаг кнопки - возврат в режим показа текущего времени
 };
 
-class clcButton : public shButton
+// ступени ускорения автоповтора кнопок Up/Down: с увеличением времени удержания кнопки интервал повтора сокращается, а шаг изменения значения растет
+struct RepeatStage
+{
+  uint16_t hold_time; // время удержания кнопки, начиная с которого действует ступень, мс
+  uint16_t interval;  // интервал автоповтора, мс
+  uint8_t step;       // шаг изменения значения
+};
+
+static const RepeatStage PROGMEM repeat_stages[] = {
+    {0, 100, 1},   // первая секунда автоповтора - шаг 1 каждые 100 мс
+    {2000, 50, 1}, // затем шаг 1 каждые 50 мс; наименьший интервал, задачи настройки вызываются с интервалом SETTING_INTERVAL
+    {4000, 150, 5},
+    {6000, 150, 10}};
+#define REPEAT_STAGE_COUNT (sizeof(repeat_stages) / sizeof(repeat_stages[0]))
+
+class clcButton : public EventButton
 {
 private:
   ButtonFlag _flag = BTN_FLAG_NONE;
+  uint8_t repeat_stage = 0;
+
+  void setRepeatStage(uint8_t stage)
+  {
+    repeat_stage = stage;
+    EventButton::setIntervalOfSerial(pgm_read_word(&repeat_stages[stage].interval));
+  }
 
 public:
-  clcButton(uint8_t button_pin) : shButton(button_pin)
+  clcButton(uint8_t button_pin) : EventButton(button_pin)
   {
-    shButton::setTimeoutOfLongClick(1000);
-    shButton::setLongClickMode(LCM_ONLYONCE);
-    shButton::setVirtualClickOn(true);
+    EventButton::setTimeoutOfLongClick(1000);
+    EventButton::setLongClickMode(LCM_ONLYONCE);
+    EventButton::setVirtualClickOn(true);
   }
 
   ButtonFlag getBtnFlag()
@@ -120,14 +354,45 @@ public:
     _flag = flag;
   }
 
+  /**
+   * @brief получение шага изменения значения для текущей ступени автоповтора
+   *
+   * @return uint8_t; 1, если кнопка не удерживается
+   */
+  uint8_t getRepeatStep()
+  {
+    return ((getLastState() == BTN_LONGCLICK) ? pgm_read_byte(&repeat_stages[repeat_stage].step) : 1);
+  }
+
   uint8_t getButtonState()
   {
-    uint8_t _state = shButton::getButtonState();
+    uint8_t _state = EventButton::getButtonState();
+#ifdef USE_POWER_SAVE
+    if (_state != BTN_RELEASED)
+    {
+      power_timer = millis();
+    }
+#endif
+#if defined(USE_ACTIVITY_COUNTERS) || defined(USE_TRACE)
+    if (_state != BTN_RELEASED && _state != BTN_PRESSED)
+    {
+      COUNT_ACTIVITY(CNT_BUTTON_EVENT);
+      TRACE(TRACE_CAT_BUTTON, TRACE_BUTTON_EVENT, (getPin() << 4) | _state);
+    }
+#endif
     switch (_state)
     {
     case BTN_DOWN:
     case BTN_DBLCLICK:
+      setRepeatStage(0);
+      // fall through - далее как для длинного клика
     case BTN_LONGCLICK:
+      // переход на следующую ступень автоповтора по времени удержания кнопки
+      if (repeat_stage < REPEAT_STAGE_COUNT - 1 &&
+          getHoldTime() >= pgm_read_word(&repeat_stages[repeat_stage + 1].hold_time))
+      {
+        setRepeatStage(repeat_stage + 1);
+      }
       // в любом режиме, кроме стандартного, каждый клик любой кнопки перезапускает таймер автовыхода в стандартный режим
       if (tasks.getTaskState(return_to_default_mode))
       {
@@ -138,7 +403,15 @@ public:
       if (alarm.getAlarmState() == ALARM_YES)
       {
         alarm.setAlarmState(ALARM_ON);
-        shButton::resetButtonState();
+        EventButton::resetButtonState();
+      }
+#endif
+#ifdef USE_STOPWATCH
+      // если закончился отсчет таймера, отключить его сигнал
+      if (countdown.isExpired())
+      {
+        countdown.clearExpired();
+        EventButton::resetButtonState();
       }
 #endif
       break;
@@ -152,94 +425,242 @@ clcButton btnSet(BTN_SET_PIN);   // кнопка Set - смена режима 
 clcButton btnUp(BTN_UP_PIN);     // кнопка Up - изменение часов/минут в режиме настройки
 clcButton btnDown(BTN_DOWN_PIN); // кнопка Down - изменение часов/минут в режиме настройки
 
-// ===================================================
-void checkButton()
+// ==== таблица режимов экрана =======================
+#define MODE_NONE 0xFF // нет перехода/нет задачи
+
+enum ModeField : uint8_t // значение, изменяемое кнопками Up/Down и мигающее в режиме настройки
 {
-  checkSetButton();
-  checkUpDownButton();
-}
+  MODE_FIELD_NONE,
+  MODE_FIELD_HOUR,  // левая пара разрядов (часы, день)
+  MODE_FIELD_MINUTE // правая пара разрядов (минуты, месяц, год)
+};
 
-void checkSetButton()
+enum ModeData : uint8_t // данные, которые считываются при входе в режим настройки и сохраняются при выходе из него
 {
-  switch (btnSet.getButtonState())
-  {
-  case BTN_ONECLICK:
-    switch (displayMode)
-    {
-    case DISPLAY_MODE_SET_HOUR:
-    case DISPLAY_MODE_SET_MINUTE:
-#ifdef USE_CALENDAR
-    case DISPLAY_MODE_SET_DAY:
-    case DISPLAY_MODE_SET_MONTH:
-    case DISPLAY_MODE_SET_YEAR:
+  MODE_DATA_NONE,
+  MODE_DATA_TIME,        // время
+  MODE_DATA_DATE,        // день и месяц
+  MODE_DATA_YEAR,        // год
+  MODE_DATA_ALARM,       // время срабатывания будильника
+  MODE_DATA_ALARM_ON_OFF // будильник включен/выключен
+};
+
+#define MODE_FLAG_SETTING 0x01 // режим настройки - кнопки Set/Up/Down управляют настройкой, а не переключают режимы
+#define MODE_FLAG_DATE 0x02    // на экран выводится дата
+#define MODE_FLAG_NO_COLON 0x04 // двоеточие не выводится
+#define MODE_FLAG_NO_LOOP 0x08 // значение не закольцовано - изменяется только от минимума до максимума
+#define MODE_FLAG_ON_OFF 0x10  // настройка вкл/выкл: автоповтор не используется, при выключении настройка завершается
+#define MODE_FLAG_NO_REPEAT 0x20 // автоповтор кнопок Up/Down не используется
+
+/**
+ * @brief описание режима экрана
+ *
+ * Для режимов вывода поля set_click ... updown_longclick задают режим, в который выполняется переход по соответствующему событию кнопок. Для режимов настройки set_click задает режим, в который выполняется переход после сохранения настройки кликом кнопки Set, а set_longclick, если не равно MODE_NONE, разрешает выход из настройки длинным кликом кнопки Set; остальные поля переходов не используются.
+ */
+struct ModeDescriptor
+{
+  uint8_t task;             // задача, выполняющая режим; MODE_NONE для режима вывода времени
+  uint8_t set_click;        // клик кнопки Set
+  uint8_t set_dblclick;     // двойной клик кнопки Set
+  uint8_t set_longclick;    // длинный клик кнопки Set
+  uint8_t up_click;         // клик кнопки Up
+  uint8_t down_click;       // клик кнопки Down
+  uint8_t updown_longclick; // одновременное удержание кнопок Up и Down
+  uint8_t field;            // ModeField
+  uint8_t min_value;        // минимальное значение настройки
+  uint8_t max_value;        // максимальное значение настройки
+  uint8_t flags;            // MODE_FLAG_*
+  uint8_t data;             // ModeData
+};
+
+// переходы, зависящие от набора опций
+#ifdef USE_STOPWATCH
+#define MODE_TIMER DISPLAY_MODE_STOPWATCH // секундомер - по клику кнопки Set, не занятому будильником
+#else
+#define MODE_TIMER MODE_NONE
+#endif
+#if defined(USE_ALARM) && defined(USE_ONECLICK_TO_SET_ALARM)
+#define MODE_SET_CLICK DISPLAY_MODE_ALARM_ON_OFF
+#define MODE_SET_DBLCLICK MODE_TIMER
+#elif defined(USE_ALARM)
+#define MODE_SET_CLICK MODE_TIMER
+#define MODE_SET_DBLCLICK DISPLAY_MODE_ALARM_ON_OFF
+#else
+#define MODE_SET_CLICK MODE_TIMER
+#define MODE_SET_DBLCLICK MODE_NONE
 #endif
-#ifdef USE_ALARM
-    case DISPLAY_MODE_SET_ALARM_HOUR:
-    case DISPLAY_MODE_SET_ALARM_MINUTE:
-    case DISPLAY_MODE_ALARM_ON_OFF:
+#ifdef USE_TEMP_DATA
+#define MODE_UP_CLICK DISPLAY_MODE_SHOW_TEMP
+#else
+#define MODE_UP_CLICK MODE_NONE
 #endif
-#ifdef USE_SET_BRIGHTNESS_MODE
-#ifdef USE_LIGHT_SENSOR
-    case DISPLAY_MODE_SET_BRIGHTNESS_MIN:
+#ifdef USE_CALENDAR
+#define MODE_DOWN_CLICK DISPLAY_MODE_SHOW_CALENDAR
+#define MODE_AFTER_MINUTE DISPLAY_MODE_SET_DAY
+#else
+#define MODE_DOWN_CLICK MODE_NONE
+#define MODE_AFTER_MINUTE DISPLAY_MODE_SHOW_TIME
+#endif
+#if defined(USE_SET_BRIGHTNESS_MODE) && defined(USE_LIGHT_SENSOR)
+#define MODE_UPDOWN_LONGCLICK DISPLAY_MODE_SET_BRIGHTNESS_MIN
+#elif defined(USE_SET_BRIGHTNESS_MODE)
+#define MODE_UPDOWN_LONGCLICK DISPLAY_MODE_SET_BRIGHTNESS_MAX
+#elif defined(USE_LANGUAGE_SETTING)
+#define MODE_UPDOWN_LONGCLICK DISPLAY_MODE_SET_LANGUAGE
+#else
+#define MODE_UPDOWN_LONGCLICK MODE_NONE
+#endif
+#ifdef USE_LANGUAGE_SETTING
+#define MODE_AFTER_BRIGHTNESS DISPLAY_MODE_SET_LANGUAGE
+#else
+#define MODE_AFTER_BRIGHTNESS DISPLAY_MODE_SHOW_TIME
 #endif
-    case DISPLAY_MODE_SET_BRIGHTNESS_MAX:
+#if defined(USE_SET_BRIGHTNESS_MODE) || defined(USE_SERIAL_PROTOCOL)
+#if defined(MAX72XX_7SEGMENT_DISPLAY) || defined(MAX72XX_MATRIX_DISPLAY)
+#define BRIGHTNESS_LEVEL_MIN 0
+#define BRIGHTNESS_LEVEL_MAX 15
+#elif defined(WS2812_MATRIX_DISPLAY)
+#define BRIGHTNESS_LEVEL_MIN 1
+#define BRIGHTNESS_LEVEL_MAX 25
+#else
+#define BRIGHTNESS_LEVEL_MIN 1
+#define BRIGHTNESS_LEVEL_MAX 7
 #endif
-      btnSet.setBtnFlag(BTN_FLAG_NEXT);
-      break;
-    case DISPLAY_MODE_SHOW_TIME:
-#ifdef USE_ALARM
-#ifdef USE_ONECLICK_TO_SET_ALARM
-      displayMode = DISPLAY_MODE_ALARM_ON_OFF;
 #endif
+
+// таблица режимов; порядок строк должен совпадать с порядком режимов в DisplayMode
+static const ModeDescriptor PROGMEM mode_list[] = {
+    // DISPLAY_MODE_SHOW_TIME
+    {MODE_NONE, MODE_SET_CLICK, MODE_SET_DBLCLICK, DISPLAY_MODE_SET_HOUR, MODE_UP_CLICK, MODE_DOWN_CLICK, MODE_UPDOWN_LONGCLICK,
+     MODE_FIELD_NONE, 0, 0, 0, MODE_DATA_NONE},
+    // DISPLAY_MODE_SET_HOUR
+    {set_time_mode, DISPLAY_MODE_SET_MINUTE, MODE_NONE, DISPLAY_MODE_SHOW_TIME, MODE_NONE, MODE_NONE, MODE_NONE,
+     MODE_FIELD_HOUR, 0, 23, MODE_FLAG_SETTING, MODE_DATA_TIME},
+    // DISPLAY_MODE_SET_MINUTE
+    {set_time_mode, MODE_AFTER_MINUTE, MODE_NONE, DISPLAY_MODE_SHOW_TIME, MODE_NONE, MODE_NONE, MODE_NONE,
+     MODE_FIELD_MINUTE, 0, 59, MODE_FLAG_SETTING, MODE_DATA_TIME},
+#ifdef USE_CALENDAR
+    // DISPLAY_MODE_SET_DAY; максимальное значение уточняется по текущему месяцу
+    {set_time_mode, DISPLAY_MODE_SET_MONTH, MODE_NONE, DISPLAY_MODE_SHOW_TIME, MODE_NONE, MODE_NONE, MODE_NONE,
+     MODE_FIELD_HOUR, 1, 31, MODE_FLAG_SETTING | MODE_FLAG_DATE, MODE_DATA_DATE},
+    // DISPLAY_MODE_SET_MONTH
+    {set_time_mode, DISPLAY_MODE_SET_YEAR, MODE_NONE, DISPLAY_MODE_SHOW_TIME, MODE_NONE, MODE_NONE, MODE_NONE,
+     MODE_FIELD_MINUTE, 1, 12, MODE_FLAG_SETTING | MODE_FLAG_DATE, MODE_DATA_DATE},
+    // DISPLAY_MODE_SET_YEAR
+    {set_time_mode, DISPLAY_MODE_SHOW_TIME, MODE_NONE, DISPLAY_MODE_SHOW_TIME, MODE_NONE, MODE_NONE, MODE_NONE,
+     MODE_FIELD_MINUTE, 0, 99, MODE_FLAG_SETTING | MODE_FLAG_DATE | MODE_FLAG_NO_COLON, MODE_DATA_YEAR},
 #endif
-      break;
-    default:
-      break;
-    }
-    break;
-  case BTN_DBLCLICK:
-    switch (displayMode)
-    {
-    case DISPLAY_MODE_SHOW_TIME:
 #ifdef USE_ALARM
-#ifndef USE_ONECLICK_TO_SET_ALARM
-      displayMode = DISPLAY_MODE_ALARM_ON_OFF;
+    // DISPLAY_MODE_ALARM_ON_OFF
+    {set_time_mode, DISPLAY_MODE_SET_ALARM_HOUR, MODE_NONE, DISPLAY_MODE_SHOW_TIME, MODE_NONE, MODE_NONE, MODE_NONE,
+     MODE_FIELD_HOUR, 0, 1, MODE_FLAG_SETTING | MODE_FLAG_ON_OFF, MODE_DATA_ALARM_ON_OFF},
+    // DISPLAY_MODE_SET_ALARM_HOUR
+    {set_time_mode, DISPLAY_MODE_SET_ALARM_MINUTE, MODE_NONE, DISPLAY_MODE_SHOW_TIME, MODE_NONE, MODE_NONE, MODE_NONE,
+     MODE_FIELD_HOUR, 0, 23, MODE_FLAG_SETTING, MODE_DATA_ALARM},
+    // DISPLAY_MODE_SET_ALARM_MINUTE
+    {set_time_mode, DISPLAY_MODE_SHOW_TIME, MODE_NONE, DISPLAY_MODE_SHOW_TIME, MODE_NONE, MODE_NONE, MODE_NONE,
+     MODE_FIELD_MINUTE, 0, 59, MODE_FLAG_SETTING, MODE_DATA_ALARM},
 #endif
+#ifdef USE_TEMP_DATA
+    // DISPLAY_MODE_SHOW_TEMP
+    {show_temp_mode, MODE_NONE, MODE_NONE, MODE_NONE, DISPLAY_MODE_SHOW_TIME, MODE_NONE, MODE_NONE,
+     MODE_FIELD_NONE, 0, 0, 0, MODE_DATA_NONE},
 #endif
-      break;
-    default:
-      break;
-    }
-    break;
-  case BTN_LONGCLICK:
-    switch (displayMode)
-    {
-    case DISPLAY_MODE_SHOW_TIME:
-      displayMode = DISPLAY_MODE_SET_HOUR;
-      break;
-#ifdef USE_CALENDAR
-    case DISPLAY_MODE_SHOW_CALENDAR:
-      tasks.stopTask(show_calendar_mode);
-      displayMode = DISPLAY_MODE_SET_DAY;
-      break;
-#endif
-    case DISPLAY_MODE_SET_HOUR:
-    case DISPLAY_MODE_SET_MINUTE:
 #ifdef USE_CALENDAR
-    case DISPLAY_MODE_SET_DAY:
-    case DISPLAY_MODE_SET_MONTH:
-    case DISPLAY_MODE_SET_YEAR:
+    // DISPLAY_MODE_SHOW_CALENDAR
+    {show_calendar_mode, MODE_NONE, MODE_NONE, DISPLAY_MODE_SET_DAY, MODE_NONE, DISPLAY_MODE_SHOW_TIME, MODE_NONE,
+     MODE_FIELD_NONE, 0, 0, 0, MODE_DATA_NONE},
 #endif
-#ifdef USE_ALARM
-    case DISPLAY_MODE_SET_ALARM_HOUR:
-    case DISPLAY_MODE_SET_ALARM_MINUTE:
-    case DISPLAY_MODE_ALARM_ON_OFF:
+#ifdef USE_SET_BRIGHTNESS_MODE
+#ifdef USE_LIGHT_SENSOR
+    // DISPLAY_MODE_SET_BRIGHTNESS_MIN
+    {set_brightness_mode, DISPLAY_MODE_SET_BRIGHTNESS_MAX, MODE_NONE, MODE_NONE, MODE_NONE, MODE_NONE, MODE_NONE,
+     MODE_FIELD_NONE, BRIGHTNESS_LEVEL_MIN, BRIGHTNESS_LEVEL_MAX, MODE_FLAG_SETTING | MODE_FLAG_NO_LOOP, MODE_DATA_NONE},
+#endif
+    // DISPLAY_MODE_SET_BRIGHTNESS_MAX
+    {set_brightness_mode, MODE_AFTER_BRIGHTNESS, MODE_NONE, MODE_NONE, MODE_NONE, MODE_NONE, MODE_NONE,
+     MODE_FIELD_NONE, BRIGHTNESS_LEVEL_MIN, BRIGHTNESS_LEVEL_MAX, MODE_FLAG_SETTING | MODE_FLAG_NO_LOOP, MODE_DATA_NONE},
+#endif
+#ifdef USE_LANGUAGE_SETTING
+    // DISPLAY_MODE_SET_LANGUAGE
+    {set_language_mode, DISPLAY_MODE_SHOW_TIME, MODE_NONE, MODE_NONE, MODE_NONE, MODE_NONE, MODE_NONE,
+     MODE_FIELD_NONE, 0, LANG_COUNT - 1, MODE_FLAG_SETTING, MODE_DATA_NONE},
+#endif
+#ifdef USE_STOPWATCH
+    // DISPLAY_MODE_STOPWATCH; кнопки Up/Down управляют секундомером, клик кнопки Set - переход к таймеру
+    {stopwatch_mode, DISPLAY_MODE_COUNTDOWN, MODE_NONE, DISPLAY_MODE_SHOW_TIME, MODE_NONE, MODE_NONE, MODE_NONE,
+     MODE_FIELD_NONE, 0, 0, MODE_FLAG_SETTING | MODE_FLAG_NO_REPEAT, MODE_DATA_NONE},
+    // DISPLAY_MODE_COUNTDOWN; кнопки Up/Down настраивают минуты таймера, клик кнопки Set запускает и останавливает отсчет
+    {stopwatch_mode, DISPLAY_MODE_SHOW_TIME, MODE_NONE, DISPLAY_MODE_SHOW_TIME, MODE_NONE, MODE_NONE, MODE_NONE,
+     MODE_FIELD_NONE, 1, 99, MODE_FLAG_SETTING, MODE_DATA_NONE},
 #endif
+};
+
+static_assert(sizeof(mode_list) / sizeof(mode_list[0]) == DISPLAY_MODE_COUNT,
+              "mode_list does not match DisplayMode");
+
+// чтение поля описания текущего режима
+#define MODE_DATA(field) pgm_read_byte(&mode_list[displayMode].field)
+
+/**
+ * @brief переход в новый режим из режима вывода; задача текущего режима останавливается
+ *
+ * @param mode новый режим; при MODE_NONE ничего не происходит
+ */
+void changeDisplayMode(uint8_t mode)
+{
+  if (mode == MODE_NONE)
+  {
+    return;
+  }
+  if (mode == DISPLAY_MODE_SHOW_TIME)
+  {
+    returnToDefMode();
+    return;
+  }
+  uint8_t task = MODE_DATA(task);
+  if (task != MODE_NONE)
+  {
+    tasks.stopTask(task);
+  }
+  displayMode = (DisplayMode)mode;
+  TRACE(TRACE_CAT_MODE, TRACE_MODE_CHANGE, mode);
+}
+
+// ===================================================
+void checkButton()
+{
+  checkSetButton();
+  checkUpDownButton();
+}
+
+void checkSetButton()
+{
+  uint8_t _state = btnSet.getButtonState();
+  if (MODE_DATA(flags) & MODE_FLAG_SETTING)
+  {
+    // в режимах настройки кнопка Set только выставляет флаг, который обрабатывается задачей режима
+    if (_state == BTN_ONECLICK)
+    {
+      btnSet.setBtnFlag(BTN_FLAG_NEXT);
+    }
+    else if (_state == BTN_LONGCLICK && MODE_DATA(set_longclick) != MODE_NONE)
+    {
       btnSet.setBtnFlag(BTN_FLAG_EXIT);
-      break;
-    default:
-      break;
     }
+    return;
+  }
+
+  switch (_state)
+  {
+  case BTN_ONECLICK:
+    changeDisplayMode(MODE_DATA(set_click));
+    break;
+  case BTN_DBLCLICK:
+    changeDisplayMode(MODE_DATA(set_dblclick));
+    break;
+  case BTN_LONGCLICK:
+    changeDisplayMode(MODE_DATA(set_longclick));
     break;
   }
 }
@@ -253,9 +674,7 @@ void checkUDbtn(clcButton &btn)
     btn.setBtnFlag(BTN_FLAG_NEXT);
     break;
   case BTN_LONGCLICK:
-#ifdef USE_ALARM
-    if (displayMode != DISPLAY_MODE_ALARM_ON_OFF)
-#endif
+    if (!(MODE_DATA(flags) & (MODE_FLAG_ON_OFF | MODE_FLAG_NO_REPEAT)))
     {
       btn.setBtnFlag(BTN_FLAG_NEXT);
     }
@@ -265,54 +684,19 @@ void checkUDbtn(clcButton &btn)
 
 void checkUpDownButton()
 {
-  btnUp.getButtonState();
-  btnDown.getButtonState();
+  bool setting = MODE_DATA(flags) & MODE_FLAG_SETTING;
+  // в режимах настройки следующее состояние кнопки забирается из очереди только после того, как задача режима обработала предыдущее; иначе повторы, пришедшие между ее вызовами (например, во время передачи кадра на экран), теряются
+  if (!setting || btnUp.getBtnFlag() == BTN_FLAG_NONE)
+  {
+    btnUp.getButtonState();
+  }
+  if (!setting || btnDown.getBtnFlag() == BTN_FLAG_NONE)
+  {
+    btnDown.getButtonState();
+  }
 
-  switch (displayMode)
+  if (setting)
   {
-  case DISPLAY_MODE_SHOW_TIME:
-#ifdef USE_TEMP_DATA
-    if (btnUp.getLastState() == BTN_ONECLICK)
-    {
-      displayMode = DISPLAY_MODE_SHOW_TEMP;
-    }
-#endif
-#ifdef USE_CALENDAR
-    if (btnDown.getLastState() == BTN_ONECLICK)
-    {
-      displayMode = DISPLAY_MODE_SHOW_CALENDAR;
-    }
-#endif
-#ifdef USE_SET_BRIGHTNESS_MODE
-    if (btnUp.isSecondButtonPressed(btnDown, BTN_LONGCLICK) ||
-        btnDown.isSecondButtonPressed(btnUp, BTN_LONGCLICK))
-    {
-#ifdef USE_LIGHT_SENSOR
-      displayMode = DISPLAY_MODE_SET_BRIGHTNESS_MIN;
-#else
-      displayMode = DISPLAY_MODE_SET_BRIGHTNESS_MAX;
-#endif
-    }
-#endif
-    break;
-  case DISPLAY_MODE_SET_HOUR:
-  case DISPLAY_MODE_SET_MINUTE:
-#ifdef USE_CALENDAR
-  case DISPLAY_MODE_SET_DAY:
-  case DISPLAY_MODE_SET_MONTH:
-  case DISPLAY_MODE_SET_YEAR:
-#endif
-#ifdef USE_ALARM
-  case DISPLAY_MODE_SET_ALARM_HOUR:
-  case DISPLAY_MODE_SET_ALARM_MINUTE:
-  case DISPLAY_MODE_ALARM_ON_OFF:
-#endif
-#ifdef USE_SET_BRIGHTNESS_MODE
-#ifdef USE_LIGHT_SENSOR
-  case DISPLAY_MODE_SET_BRIGHTNESS_MIN:
-#endif
-  case DISPLAY_MODE_SET_BRIGHTNESS_MAX:
-#endif
     if (!btnDown.isButtonClosed())
     {
       checkUDbtn(btnUp);
@@ -321,34 +705,75 @@ void checkUpDownButton()
     {
       checkUDbtn(btnDown);
     }
-    break;
-#ifdef USE_TEMP_DATA
-  case DISPLAY_MODE_SHOW_TEMP:
-    if (btnUp.getLastState() == BTN_ONECLICK)
-    {
-      returnToDefMode();
-    }
-    break;
-#endif
-#ifdef USE_CALENDAR
-  case DISPLAY_MODE_SHOW_CALENDAR:
-    if (btnDown.getLastState() == BTN_ONECLICK)
-    {
-      returnToDefMode();
-    }
-    break;
-#endif
-  default:
-    break;
+    return;
+  }
+
+  uint8_t mode = MODE_NONE;
+  if (btnUp.getLastState() == BTN_ONECLICK)
+  {
+    mode = MODE_DATA(up_click);
+  }
+  else if (btnDown.getLastState() == BTN_ONECLICK)
+  {
+    mode = MODE_DATA(down_click);
+  }
+  if (MODE_DATA(updown_longclick) != MODE_NONE &&
+      (btnUp.isSecondButtonPressed(btnDown, BTN_LONGCLICK) ||
+       btnDown.isSecondButtonPressed(btnUp, BTN_LONGCLICK)))
+  {
+    mode = MODE_DATA(updown_longclick);
   }
+  changeDisplayMode(mode);
 }
 
 // ===================================================
-void rtcNow()
+// при ошибке обмена по I2C библиотека возвращает значения вне допустимого диапазона
+bool isRtcTimeValid()
 {
+  return (curTime.second() <= 59 && curTime.minute() <= 59 && curTime.hour() <= 23 &&
+          curTime.month() >= 1 && curTime.month() <= 12);
+}
+
+void readRTC()
+{
+  COUNT_ACTIVITY(CNT_I2C);
   curTime = RTC.now();
-  if (displayMode == DISPLAY_MODE_SHOW_TIME)
+  TRACE(TRACE_CAT_RTC, TRACE_RTC_READ, curTime.second());
+#ifdef USE_SERIAL_PROTOCOL
+  if (!isRtcTimeValid())
   {
+    rtc_errors++;
+  }
+#endif
+#ifdef USE_RTC_SQW
+  rtc_timer = millis();
+#endif
+}
+
+void rtcNow()
+{
+#ifdef USE_RTC_SQW
+  // время обновляется по сигналу SQW; здесь только страховка на случай его отсутствия
+  if (millis() - rtc_timer >= 1100)
+  {
+    readRTC();
+  }
+#else
+  readRTC();
+#endif
+  if (displayMode == DISPLAY_MODE_SHOW_TIME)
+  {
+#ifdef SHOW_RAM_WARNING
+    // предупреждение о нехватке RAM - строка минусов каждую вторую секунду
+    if ((curTime.second() & 0x01) && ram.isLow())
+    {
+      disp.showTemp(-100);
+      return;
+    }
+#endif
+#if defined(WS2812_MATRIX_DISPLAY) && defined(USE_ALARM)
+    disp.setAlarmFlag(alarm.getOnOffAlarm());
+#endif
 #if defined(MAX72XX_MATRIX_DISPLAY) || defined(WS2812_MATRIX_DISPLAY)
     disp.showTime(curTime.hour(), curTime.minute(), curTime.second(), blink_flag);
 #else
@@ -366,59 +791,102 @@ void blink()
     cur_sec = curTime.second();
     blink_flag = true;
     tmr = millis();
+    TRACE(TRACE_CAT_RTC, TRACE_BLINK, 1);
   }
   else if (blink_flag && millis() - tmr >= 500)
   {
     blink_flag = false;
+    TRACE(TRACE_CAT_RTC, TRACE_BLINK, 0);
   }
 }
 
 void returnToDefMode()
 {
-  switch (displayMode)
+  if (MODE_DATA(flags) & MODE_FLAG_SETTING)
+  {
+    // выход из режима настройки с сохранением выполняется задачей режима
+    btnSet.setBtnFlag(BTN_FLAG_EXIT);
+  }
+  else
+  {
+    uint8_t task = MODE_DATA(task);
+    if (task != MODE_NONE)
+    {
+      displayMode = DISPLAY_MODE_SHOW_TIME;
+      TRACE(TRACE_CAT_MODE, TRACE_MODE_CHANGE, DISPLAY_MODE_SHOW_TIME);
+      tasks.stopTask(task);
+    }
+  }
+  tasks.stopTask(return_to_default_mode);
+}
+
+void stopSetting(TaskHandle task)
+{
+  tasks.stopTask(task);
+  tasks.stopTask(return_to_default_mode);
+}
+
+void loadTimeData(uint8_t data, uint8_t &hour, uint8_t &minute)
+{
+  switch (data)
   {
-  case DISPLAY_MODE_SET_HOUR:
-  case DISPLAY_MODE_SET_MINUTE:
+  case MODE_DATA_TIME:
+    hour = curTime.hour();
+    minute = curTime.minute();
+    break;
 #ifdef USE_CALENDAR
-  case DISPLAY_MODE_SET_DAY:
-  case DISPLAY_MODE_SET_MONTH:
-  case DISPLAY_MODE_SET_YEAR:
+  case MODE_DATA_DATE:
+    hour = curTime.day();
+    minute = curTime.month();
+    break;
+  case MODE_DATA_YEAR:
+    hour = 20;
+    minute = curTime.year() % 100;
+    break;
 #endif
 #ifdef USE_ALARM
-  case DISPLAY_MODE_SET_ALARM_HOUR:
-  case DISPLAY_MODE_SET_ALARM_MINUTE:
-  case DISPLAY_MODE_ALARM_ON_OFF:
-#endif
-#ifdef USE_SET_BRIGHTNESS_MODE
-#ifdef USE_LIGHT_SENSOR
-  case DISPLAY_MODE_SET_BRIGHTNESS_MIN:
-#endif
-  case DISPLAY_MODE_SET_BRIGHTNESS_MAX:
-#endif
-    btnSet.setBtnFlag(BTN_FLAG_EXIT);
+  case MODE_DATA_ALARM:
+    hour = alarm.getAlarmPoint() / 60;
+    minute = alarm.getAlarmPoint() % 60;
     break;
-#ifdef USE_TEMP_DATA
-  case DISPLAY_MODE_SHOW_TEMP:
-    displayMode = DISPLAY_MODE_SHOW_TIME;
-    tasks.stopTask(show_temp_mode);
+  case MODE_DATA_ALARM_ON_OFF:
+    hour = (uint8_t)alarm.getOnOffAlarm();
     break;
 #endif
+  }
+}
+
+void saveTimeData(uint8_t data, uint8_t hour, uint8_t minute)
+{
+  switch (data)
+  {
+  case MODE_DATA_TIME:
+    COUNT_ACTIVITY(CNT_I2C);
+    clock.setHour(hour);
+    clock.setMinute(minute);
+    clock.setSecond(0);
+    break;
 #ifdef USE_CALENDAR
-  case DISPLAY_MODE_SHOW_CALENDAR:
-    displayMode = DISPLAY_MODE_SHOW_TIME;
-    tasks.stopTask(show_calendar_mode);
+  case MODE_DATA_DATE:
+    COUNT_ACTIVITY(CNT_I2C);
+    clock.setDate(hour);
+    clock.setMonth(minute);
+    readRTC();
+    break;
+  case MODE_DATA_YEAR:
+    COUNT_ACTIVITY(CNT_I2C);
+    clock.setYear(minute);
     break;
 #endif
-  default:
+#ifdef USE_ALARM
+  case MODE_DATA_ALARM:
+    alarm.setAlarmPoint(hour * 60 + minute);
+    break;
+  case MODE_DATA_ALARM_ON_OFF:
+    alarm.setOnOffAlarm((bool)hour);
     break;
+#endif
   }
-  tasks.stopTask(return_to_default_mode);
-}
-
-void stopSetting(shHandle task)
-{
-  tasks.stopTask(task);
-  tasks.stopTask(return_to_default_mode);
 }
 
 void showTimeSetting()
@@ -434,47 +902,13 @@ void showTimeSetting()
   {
     tasks.startTask(set_time_mode);
     tasks.startTask(return_to_default_mode);
-    switch (displayMode)
-    {
-#ifdef USE_ALARM
-    case DISPLAY_MODE_SET_ALARM_HOUR:
-    case DISPLAY_MODE_SET_ALARM_MINUTE:
-      curHour = alarm.getAlarmPoint() / 60;
-      curMinute = alarm.getAlarmPoint() % 60;
-      break;
-    case DISPLAY_MODE_ALARM_ON_OFF:
-      curHour = (uint8_t)alarm.getOnOffAlarm();
-      break;
-#endif
-    default:
-      break;
-    }
     time_checked = false;
   }
 
+  // пока данные не изменены кнопками, они обновляются, чтобы на экране было актуальное время
   if (!time_checked)
   {
-    switch (displayMode)
-    {
-    case DISPLAY_MODE_SET_HOUR:
-    case DISPLAY_MODE_SET_MINUTE:
-      curHour = curTime.hour();
-      curMinute = curTime.minute();
-      break;
-#ifdef USE_CALENDAR
-    case DISPLAY_MODE_SET_DAY:
-    case DISPLAY_MODE_SET_MONTH:
-      curHour = curTime.day();
-      curMinute = curTime.month();
-      break;
-    case DISPLAY_MODE_SET_YEAR:
-      curHour = 20;
-      curMinute = curTime.year() % 100;
-      break;
-#endif
-    default:
-      break;
-    }
+    loadTimeData(MODE_DATA(data), curHour, curMinute);
   }
 
   // опрос кнопок =====================
@@ -482,143 +916,60 @@ void showTimeSetting()
   {
     if (time_checked)
     {
-      switch (displayMode)
-      {
-      case DISPLAY_MODE_SET_HOUR:
-      case DISPLAY_MODE_SET_MINUTE:
-        clock.setHour(curHour);
-        clock.setMinute(curMinute);
-        clock.setSecond(0);
-        break;
-#ifdef USE_CALENDAR
-      case DISPLAY_MODE_SET_DAY:
-      case DISPLAY_MODE_SET_MONTH:
-        clock.setDate(curHour);
-        clock.setMonth(curMinute);
-        rtcNow();
-        break;
-      case DISPLAY_MODE_SET_YEAR:
-        clock.setYear(curMinute);
-        break;
-#endif
-#ifdef USE_ALARM
-      case DISPLAY_MODE_SET_ALARM_HOUR:
-      case DISPLAY_MODE_SET_ALARM_MINUTE:
-        alarm.setAlarmPoint(curHour * 60 + curMinute);
-        break;
-      case DISPLAY_MODE_ALARM_ON_OFF:
-        alarm.setOnOffAlarm((bool)curHour);
-        break;
-#endif
-      default:
-        break;
-      }
+      saveTimeData(MODE_DATA(data), curHour, curMinute);
       time_checked = false;
     }
-    if (btnSet.getBtnFlag() == BTN_FLAG_NEXT)
-    {
-      switch (displayMode)
-      {
-      case DISPLAY_MODE_SET_HOUR:
-#ifdef USE_CALENDAR
-      case DISPLAY_MODE_SET_MINUTE:
-      case DISPLAY_MODE_SET_DAY:
-      case DISPLAY_MODE_SET_MONTH:
-#endif
-#ifdef USE_ALARM
-      case DISPLAY_MODE_SET_ALARM_HOUR:
-#endif
-        displayMode = DisplayMode(uint8_t(displayMode + 1));
-        stopSetting(set_time_mode);
-        break;
-#ifdef USE_ALARM
-      case DISPLAY_MODE_ALARM_ON_OFF:
-        displayMode = (curHour) ? DISPLAY_MODE_SET_ALARM_HOUR : DISPLAY_MODE_SHOW_TIME;
-        stopSetting(set_time_mode);
-        break;
-#endif
-      default:
-        displayMode = DISPLAY_MODE_SHOW_TIME;
-        stopSetting(set_time_mode);
-        break;
-      }
-    }
-    else
+    uint8_t mode = DISPLAY_MODE_SHOW_TIME;
+    if (btnSet.getBtnFlag() == BTN_FLAG_NEXT && (curHour || !(MODE_DATA(flags) & MODE_FLAG_ON_OFF)))
     {
-      displayMode = DISPLAY_MODE_SHOW_TIME;
-      stopSetting(set_time_mode);
+      mode = MODE_DATA(set_click);
     }
+    displayMode = (DisplayMode)mode;
+    stopSetting(set_time_mode);
     btnSet.setBtnFlag(BTN_FLAG_NONE);
   }
 
   if ((btnUp.getBtnFlag() == BTN_FLAG_NEXT) || (btnDown.getBtnFlag() == BTN_FLAG_NEXT))
   {
     bool dir = btnUp.getBtnFlag() == BTN_FLAG_NEXT;
-    switch (displayMode)
-    {
-    case DISPLAY_MODE_SET_HOUR:
-#ifdef USE_ALARM
-    case DISPLAY_MODE_SET_ALARM_HOUR:
-#endif
-      checkData(curHour, 23, dir);
-      break;
-    case DISPLAY_MODE_SET_MINUTE:
-#ifdef USE_ALARM
-    case DISPLAY_MODE_SET_ALARM_MINUTE:
-#endif
-      checkData(curMinute, 59, dir);
-      break;
-#ifdef USE_ALARM
-    case DISPLAY_MODE_ALARM_ON_OFF:
-      checkData(curHour, 1, true);
-      break;
-#endif
+    uint8_t step = (dir) ? btnUp.getRepeatStep() : btnDown.getRepeatStep();
+    uint8_t max = MODE_DATA(max_value);
 #ifdef USE_CALENDAR
-    case DISPLAY_MODE_SET_DAY:
-      uint8_t i;
-      i = pgm_read_byte(&days_of_month[curMinute - 1]);
+    if (displayMode == DISPLAY_MODE_SET_DAY)
+    {
+      max = pgm_read_byte(&days_of_month[curMinute - 1]);
       if (curMinute == 2 && (curTime.year() % 4 == 0))
       {
-        i++;
+        max++;
       }
-      checkData(curHour, i, dir, 1);
-      break;
-    case DISPLAY_MODE_SET_MONTH:
-      checkData(curMinute, 12, dir, 1);
-      break;
-    case DISPLAY_MODE_SET_YEAR:
-      checkData(curMinute, 99, dir);
-      break;
-#endif
-    default:
-      break;
     }
+#endif
+    uint8_t &x = (MODE_DATA(field) == MODE_FIELD_HOUR) ? curHour : curMinute;
+    checkData(x, max, dir, MODE_DATA(min_value), true, step);
     time_checked = true;
     btnUp.setBtnFlag(BTN_FLAG_NONE);
     btnDown.setBtnFlag(BTN_FLAG_NONE);
   }
 
   // вывод данных на экран ============
-  switch (displayMode)
-  {
 #ifdef USE_ALARM
-  case DISPLAY_MODE_ALARM_ON_OFF:
+  if (MODE_DATA(flags) & MODE_FLAG_ON_OFF)
+  {
     showAlarmState(curHour);
-    break;
-#endif
-  default:
-    showTimeData(curHour, curMinute);
-    break;
+    return;
   }
+#endif
+  showTimeData(curHour, curMinute);
 }
 
-#ifdef USE_TEMP_DATA
-#ifdef USE_DS18B20
-void checkDS18b20()
+#ifdef USE_SENSORS
+void checkSensors()
 {
-  temp_sensor.readData();
+  sensors.tick();
 }
 #endif
+
+#ifdef USE_TEMP_DATA
 void showTemp()
 {
   if (!tasks.getTaskState(show_temp_mode))
@@ -627,17 +978,21 @@ void showTemp()
     tasks.startTask(show_temp_mode);
   }
 
-#if defined(USE_DS18B20) || defined(USE_NTC)
-  disp.showTemp(temp_sensor.getTemp());
-#else
-  disp.showTemp((int)round(clock.getTemperature()));
-#endif
+  disp.showTemp(temp_sensor.result());
 }
 #endif
 
 void setDisp()
 {
-  disp.show();
+#if defined(USE_DIGIT_ANIMATION) && (defined(MAX72XX_MATRIX_DISPLAY) || defined(WS2812_MATRIX_DISPLAY))
+  disp.animate();
+#endif
+  bool shown = disp.show();
+  if (shown)
+  {
+    COUNT_ACTIVITY(CNT_DISPLAY_SHOW);
+  }
+  TRACE(TRACE_CAT_DISPLAY, TRACE_DISPLAY_SHOW, shown);
 }
 
 #ifdef USE_CALENDAR
@@ -656,12 +1011,20 @@ void showCalendar()
 }
 #endif
 
+#if defined(USE_ALARM) || defined(USE_STOPWATCH)
+// "мелодия" пищалки будильника и таймера: первая строка - частота, вторая строка - длительность; один проход - одна секунда
+static const PROGMEM uint32_t buzzer_melody[2][8] = {
+    {2000, 0, 2000, 0, 2000, 0, 2000, 0},
+    {70, 70, 70, 70, 70, 70, 70, 510}};
+#endif
+
 #ifdef USE_ALARM
 void checkAlarm()
 {
   alarm.tick(curTime);
   if (alarm.getAlarmState() == ALARM_YES && !tasks.getTaskState(alarm_buzzer))
   {
+    TRACE(TRACE_CAT_ALARM, TRACE_ALARM_STATE, ALARM_YES);
     runAlarmBuzzer();
   }
 }
@@ -671,10 +1034,6 @@ void runAlarmBuzzer()
   static uint8_t n = 0;
   static uint8_t k = 0;
   static uint8_t m = 0;
-  // "мелодия" пищалки: первая строка - частота, вторая строка - длительность
-  static const PROGMEM uint32_t pick[2][8] = {
-      {2000, 0, 2000, 0, 2000, 0, 2000, 0},
-      {70, 70, 70, 70, 70, 70, 70, 510}};
 
   if (!tasks.getTaskState(alarm_buzzer))
   {
@@ -689,8 +1048,13 @@ void runAlarmBuzzer()
     return;
   }
 
-  tone(BUZZER_PIN, pgm_read_dword(&pick[0][n]), pgm_read_dword(&pick[1][n]));
-  tasks.setTaskInterval(alarm_buzzer, pgm_read_dword(&pick[1][n]), true);
+  if (pgm_read_dword(&buzzer_melody[0][n]))
+  {
+    COUNT_ACTIVITY(CNT_BUZZER_NOTE);
+    TRACE(TRACE_CAT_ALARM, TRACE_BUZZER_NOTE, n);
+  }
+  tone(BUZZER_PIN, pgm_read_dword(&buzzer_melody[0][n]), pgm_read_dword(&buzzer_melody[1][n]));
+  tasks.setTaskInterval(alarm_buzzer, pgm_read_dword(&buzzer_melody[1][n]), true);
   if (++n >= 8)
   {
     n = 0;
@@ -722,8 +1086,7 @@ void setBrightness()
   }
 #endif
 
-  static uint16_t b;
-  b = (b * 2 + analogRead(LIGHT_SENSOR_PIN)) / 3;
+  int16_t b = light_sensor.result();
   uint8_t x = 1;
   if (b < LIGHT_THRESHOLD)
   {
@@ -733,7 +1096,7 @@ void setBrightness()
   {
     x = EEPROM.read(MAX_BRIGHTNESS_VALUE);
   }
-  disp.setBrightness(x);
+  setDisplayBrightness(x);
 }
 #endif
 
@@ -758,52 +1121,27 @@ void showBrightnessSetting()
   // ==== опрос кнопок ===============================
   if (btnSet.getBtnFlag() > BTN_FLAG_NONE)
   {
-    switch (displayMode)
-    {
-    case DISPLAY_MODE_SET_BRIGHTNESS_MAX:
-      EEPROM.update(MAX_BRIGHTNESS_VALUE, x);
-      displayMode = DISPLAY_MODE_SHOW_TIME;
-      stopSetting(set_brightness_mode);
-      break;
 #ifdef USE_LIGHT_SENSOR
-    case DISPLAY_MODE_SET_BRIGHTNESS_MIN:
-      EEPROM.update(MIN_BRIGHTNESS_VALUE, x);
-      if (btnSet.getBtnFlag() == BTN_FLAG_NEXT)
-      {
-        displayMode = DISPLAY_MODE_SET_BRIGHTNESS_MAX;
-      }
-      else
-        displayMode = DISPLAY_MODE_SHOW_TIME;
-      stopSetting(set_brightness_mode);
-      break;
+    updateEEPROM((displayMode == DISPLAY_MODE_SET_BRIGHTNESS_MIN) ? MIN_BRIGHTNESS_VALUE : MAX_BRIGHTNESS_VALUE, x);
+#else
+    updateEEPROM(MAX_BRIGHTNESS_VALUE, x);
 #endif
-    default:
-      break;
-    }
+    displayMode = (btnSet.getBtnFlag() == BTN_FLAG_NEXT) ? (DisplayMode)MODE_DATA(set_click) : DISPLAY_MODE_SHOW_TIME;
+    stopSetting(set_brightness_mode);
     btnSet.setBtnFlag(BTN_FLAG_NONE);
   }
 
   if ((btnUp.getBtnFlag() == BTN_FLAG_NEXT) || (btnDown.getBtnFlag() == BTN_FLAG_NEXT))
   {
     bool dir = btnUp.getBtnFlag() == BTN_FLAG_NEXT;
-#if defined(MAX72XX_7SEGMENT_DISPLAY) || defined(MAX72XX_MATRIX_DISPLAY)
-    checkData(x, 15, dir, 0, false);
-#elif defined(WS2812_MATRIX_DISPLAY)
-    checkData(x, 25, dir, 1, false);
-#else
-    checkData(x, 7, dir, 1, false);
-#endif
+    checkData(x, MODE_DATA(max_value), dir, MODE_DATA(min_value), false);
 
     btnUp.setBtnFlag(BTN_FLAG_NONE);
     btnDown.setBtnFlag(BTN_FLAG_NONE);
   }
 
   // ==== вывод данных на экран ======================
-#if defined(WS2812_MATRIX_DISPLAY)
-  FastLED.setBrightness(x * 10);
-#else
-  disp.setBrightness(x);
-#endif
+  setDisplayBrightness(x);
   bool blink = !blink_flag && !btnUp.isButtonClosed() && !btnDown.isButtonClosed();
   bool snr = false;
 #ifdef USE_LIGHT_SENSOR
@@ -814,188 +1152,355 @@ void showBrightnessSetting()
 }
 #endif
 
-// ===================================================
-void showTimeData(uint8_t hour, uint8_t minute)
+#ifdef USE_LANGUAGE_SETTING
+void showLanguageSetting()
 {
-  // если наступило время блинка и кнопки Up/Down не нажаты, то стереть соответствующие разряды; при нажатых кнопках Up/Down во время изменения данных ничего не мигает
-  if (!blink_flag && !btnUp.isButtonClosed() && !btnDown.isButtonClosed())
+  static uint8_t x = 0;
+
+  if (!tasks.getTaskState(set_language_mode))
   {
-    switch (displayMode)
-    {
-    case DISPLAY_MODE_SET_HOUR:
-#ifdef USE_CALENDAR
-    case DISPLAY_MODE_SET_DAY:
-#endif
-#ifdef USE_ALARM
-    case DISPLAY_MODE_SET_ALARM_HOUR:
-#endif
-      hour = -1;
-      break;
-    case DISPLAY_MODE_SET_MINUTE:
-#ifdef USE_CALENDAR
-    case DISPLAY_MODE_SET_MONTH:
-    case DISPLAY_MODE_SET_YEAR:
-#endif
-#ifdef USE_ALARM
-    case DISPLAY_MODE_SET_ALARM_MINUTE:
-#endif
-      minute = -1;
-      break;
-    default:
-      break;
-    }
+    tasks.startTask(set_language_mode);
+    tasks.startTask(return_to_default_mode);
+    x = disp.getLanguage();
   }
 
-  bool toDate = false;
-  bool toColon = false;
-#if defined(USE_CALENDAR)
-  toDate = (displayMode >= DISPLAY_MODE_SET_DAY && displayMode <= DISPLAY_MODE_SET_YEAR);
-  toColon = displayMode != DISPLAY_MODE_SET_YEAR;
-#endif
-#if defined(MAX72XX_MATRIX_DISPLAY) || defined(WS2812_MATRIX_DISPLAY)
-  disp.showTime(hour, minute, 0, toColon, toDate);
-#else
-  disp.showTime(hour, minute, toColon);
-#endif
-}
-
-#ifdef USE_ALARM
-void showAlarmState(uint8_t _state)
-{
-#if defined(TM1637_DISPLAY)
-  disp.setDispData(0, 0b01110111); // "A"
-  disp.setDispData(1, 0b10111000); // "L:"
-  disp.setDispData(2, 0x00);
-#elif defined(MAX72XX_7SEGMENT_DISPLAY)
-  disp.setDispData(0, 0b01110111); // "A"
-  disp.setDispData(1, 0b10001110); // "L:"
-  disp.setDispData(2, 0x00);
-#elif defined(MAX72XX_MATRIX_DISPLAY) || defined(WS2812_MATRIX_DISPLAY)
-  disp.clear();
-#ifdef USE_RU_LANGUAGE
-  disp.setDispData(1, 0xC1, 5);  // "Б"
-  disp.setDispData(7, 0xE4, 5);  // "д"
-  disp.setDispData(13, 0xEA, 5); // "к"
-#else
-  disp.setDispData(1, 0x41, 5);  // "A"
-  disp.setDispData(7, 0x6C, 5);  // "l"
-  disp.setDispData(13, 0x6D, 5); // "r"
-#endif
-#ifdef MAX72XX_MATRIX_DISPLAY
-  disp.setColumn(2, 5, 0b00100100);
-#else
-  disp.setColumn(21, 0b00100100);
-#endif
-#endif
-
-  if (!blink_flag && !btnUp.isButtonClosed() && !btnDown.isButtonClosed())
+  // ==== опрос кнопок ===============================
+  if (btnSet.getBtnFlag() > BTN_FLAG_NONE)
   {
-#if defined(TM1637_DISPLAY) || defined(MAX72XX_7SEGMENT_DISPLAY)
-    disp.setDispData(3, 0x00);
-#endif
+    updateEEPROM(LANGUAGE_VALUE, x);
+    displayMode = (btnSet.getBtnFlag() == BTN_FLAG_NEXT) ? (DisplayMode)MODE_DATA(set_click) : DISPLAY_MODE_SHOW_TIME;
+    stopSetting(set_language_mode);
+    btnSet.setBtnFlag(BTN_FLAG_NONE);
   }
-  else
+
+  if ((btnUp.getBtnFlag() == BTN_FLAG_NEXT) || (btnDown.getBtnFlag() == BTN_FLAG_NEXT))
   {
-#if defined(TM1637_DISPLAY)
-    disp.setDispData(3, (_state) ? 0b01011100 : 0b00001000);
-#elif defined(MAX72XX_7SEGMENT_DISPLAY)
-    disp.setDispData(3, (_state) ? 0b00011101 : 0b00001000);
-#elif defined(MAX72XX_MATRIX_DISPLAY) || defined(WS2812_MATRIX_DISPLAY)
-    disp.setDispData(25, (_state) ? 0x0C : 0x0B);
-#endif
+    bool dir = btnUp.getBtnFlag() == BTN_FLAG_NEXT;
+    checkData(x, MODE_DATA(max_value), dir, MODE_DATA(min_value), true);
+
+    btnUp.setBtnFlag(BTN_FLAG_NONE);
+    btnDown.setBtnFlag(BTN_FLAG_NONE);
   }
+
+  // ==== вывод данных на экран ======================
+  // язык меняется сразу, чтобы название выводилось выбранным языком
+  disp.setLanguage(x);
+  disp.showLanguageData(!blink_flag && !btnUp.isButtonClosed() && !btnDown.isButtonClosed());
 }
 #endif
 
-// ===================================================
-void checkData(uint8_t &dt, uint8_t max, bool toUp, uint8_t min, bool toLoop)
+#ifdef USE_STOPWATCH
+void showTimer()
 {
-  (toUp) ? dt++ : dt--;
-  if ((dt > max) || (min > 0 && dt < min))
+  static uint32_t last_key = 0xFFFFFFFF; // выведенное на экран изображение; экран перерисовывается только при его изменении
+  static uint8_t lap = 0;                // номер просматриваемого круга, начиная с 1; 0 - вывод текущего времени
+  static uint32_t lap_timer = 0;         // момент фиксации круга
+
+  bool is_countdown = displayMode == DISPLAY_MODE_COUNTDOWN;
+  Stopwatch &timer = (is_countdown) ? countdown : stopwatch;
+
+  if (!tasks.getTaskState(stopwatch_mode))
   {
-    if (toLoop)
+    tasks.startTask(stopwatch_mode);
+    last_key = 0xFFFFFFFF;
+    lap = 0;
+    if (is_countdown && !countdown.isRunning() && countdown.getTime() == 0)
     {
-      dt = (toUp) ? min : max;
-    }
-    else
-    {
-      dt = (toUp) ? max : min;
+      countdown.reset(countdown_minutes * 6000ul);
     }
   }
-}
 
-// ===================================================
-void setDisplay()
-{
-  switch (displayMode)
+  // ==== опрос кнопок ===============================
+  if (btnSet.getBtnFlag() > BTN_FLAG_NONE)
   {
-  case DISPLAY_MODE_SET_HOUR:
-  case DISPLAY_MODE_SET_MINUTE:
-#ifdef USE_CALENDAR
-  case DISPLAY_MODE_SET_DAY:
-  case DISPLAY_MODE_SET_MONTH:
-  case DISPLAY_MODE_SET_YEAR:
-#endif
-#ifdef USE_ALARM
-  case DISPLAY_MODE_SET_ALARM_HOUR:
-  case DISPLAY_MODE_SET_ALARM_MINUTE:
-  case DISPLAY_MODE_ALARM_ON_OFF:
-#endif
-    if (!tasks.getTaskState(set_time_mode))
+    bool next = btnSet.getBtnFlag() == BTN_FLAG_NEXT;
+    btnSet.setBtnFlag(BTN_FLAG_NONE);
+    if (is_countdown && next)
     {
-      showTimeSetting();
+      // клик кнопки Set в режиме таймера - пуск/остановка отсчета
+      if (countdown.isRunning())
+      {
+        countdown.stop();
+      }
+      else
+      {
+        if (countdown.getTime() == 0)
+        {
+          countdown.reset(countdown_minutes * 6000ul);
+        }
+        countdown.start();
+        tasks.startTask(countdown_buzzer);
+      }
     }
-    break;
-#ifdef USE_TEMP_DATA
-  case DISPLAY_MODE_SHOW_TEMP:
-    if (!tasks.getTaskState(show_temp_mode))
+    else
     {
-      showTemp();
+      // отсчет при выходе из режима не останавливается
+      displayMode = (next) ? (DisplayMode)MODE_DATA(set_click) : DISPLAY_MODE_SHOW_TIME;
+      stopSetting(stopwatch_mode);
+      return;
     }
-    break;
-#endif
-#ifdef USE_CALENDAR
-  case DISPLAY_MODE_SHOW_CALENDAR:
-    if (!tasks.getTaskState(show_calendar_mode))
+  }
+
+  if ((btnUp.getBtnFlag() == BTN_FLAG_NEXT) || (btnDown.getBtnFlag() == BTN_FLAG_NEXT))
+  {
+    bool dir = btnUp.getBtnFlag() == BTN_FLAG_NEXT;
+    if (is_countdown)
     {
-      showCalendar();
+      // минуты таймера настраиваются, только пока отсчет остановлен
+      if (!countdown.isRunning())
+      {
+        uint8_t step = (dir) ? btnUp.getRepeatStep() : btnDown.getRepeatStep();
+        checkData(countdown_minutes, MODE_DATA(max_value), dir, MODE_DATA(min_value), true, step);
+        countdown.reset(countdown_minutes * 6000ul);
+      }
     }
-    break;
+    else if (dir)
+    {
+      // Up - пуск/остановка секундомера
+      if (stopwatch.isRunning())
+      {
+        stopwatch.stop();
+      }
+      else
+      {
+        stopwatch.start();
+      }
+      lap = 0;
+    }
+    else if (stopwatch.isRunning())
+    {
+      // Down при идущем отсчете - фиксация круга и показ его времени
+      if (stopwatch.addLap())
+      {
+        lap = stopwatch.getLapCount();
+        lap_timer = millis();
+      }
+    }
+    else if (lap < stopwatch.getLapCount())
+    {
+      // Down при остановленном секундомере - просмотр кругов по очереди, после последнего круга - сброс
+      lap++;
+    }
+    else
+    {
+      stopwatch.reset();
+      lap = 0;
+    }
+
+    btnUp.setBtnFlag(BTN_FLAG_NONE);
+    btnDown.setBtnFlag(BTN_FLAG_NONE);
+  }
+
+  // пока идет отсчет, автовозврат в режим показа времени не выполняется
+  if (timer.isRunning())
+  {
+    tasks.stopTask(return_to_default_mode);
+  }
+  else if (!tasks.getTaskState(return_to_default_mode))
+  {
+    tasks.startTask(return_to_default_mode);
+  }
+
+  // ==== вывод данных на экран ======================
+  if (lap && stopwatch.isRunning() && millis() - lap_timer >= STOPWATCH_LAP_SHOW_TIME)
+  {
+    lap = 0;
+  }
+  uint32_t t = (lap) ? stopwatch.getLap(lap - 1) : timer.getTime();
+  // двоеточие горит, пока идет отсчет, и мигает, если отсчет остановлен или выводится время круга
+  bool colon = (timer.isRunning() && !lap) || blink_flag;
+#if defined(MAX72XX_MATRIX_DISPLAY) || defined(WS2812_MATRIX_DISPLAY)
+  uint32_t key = (t << 1) | colon;
+  if (key != last_key)
+  {
+    disp.showTimerData(t, colon);
+  }
+#else
+  // семисегментные экраны выводят мм:сс; у таймера секунды округляются вверх, чтобы ноль выводился только по окончании отсчета
+  t = (is_countdown) ? (t + 99) / 100 : t / 100;
+  uint32_t key = (t << 1) | colon;
+  if (key != last_key)
+  {
+    disp.showTime(t / 60, t % 60, colon);
+  }
 #endif
-#ifdef USE_SET_BRIGHTNESS_MODE
-#ifdef USE_LIGHT_SENSOR
-  case DISPLAY_MODE_SET_BRIGHTNESS_MIN:
+  last_key = key;
+}
+
+void checkCountdown()
+{
+  static uint8_t n = 0;
+  static uint8_t k = 0;
+
+  countdown.update();
+  if (!countdown.isExpired())
+  {
+    if (!countdown.isRunning())
+    { // отсчет остановлен или сигнал отключен кнопкой
+      tasks.stopTask(countdown_buzzer);
+      tasks.setTaskInterval(countdown_buzzer, 100, false);
+    }
+    n = 0;
+    k = 0;
+    return;
+  }
+
+  if (pgm_read_dword(&buzzer_melody[0][n]))
+  {
+    COUNT_ACTIVITY(CNT_BUZZER_NOTE);
+    TRACE(TRACE_CAT_ALARM, TRACE_BUZZER_NOTE, n);
+  }
+  tone(BUZZER_PIN, pgm_read_dword(&buzzer_melody[0][n]), pgm_read_dword(&buzzer_melody[1][n]));
+  tasks.setTaskInterval(countdown_buzzer, pgm_read_dword(&buzzer_melody[1][n]), true);
+  if (++n >= 8)
+  {
+    n = 0;
+    if (++k >= COUNTDOWN_BUZZER_DURATION)
+    { // отключение сигнала через заданное число секунд
+      countdown.clearExpired();
+    }
+  }
+}
 #endif
-  case DISPLAY_MODE_SET_BRIGHTNESS_MAX:
-    if (!tasks.getTaskState(set_brightness_mode))
+
+// ===================================================
+void setDisplayBrightness(uint8_t x)
+{
+#if defined(WS2812_MATRIX_DISPLAY)
+  disp.setBrightness(x * 10);
+#else
+  disp.setBrightness(x);
+#endif
+}
+
+void showTimeData(uint8_t hour, uint8_t minute)
+{
+  // если наступило время блинка и кнопки Up/Down не нажаты, то стереть соответствующие разряды; при нажатых кнопках Up/Down во время изменения данных ничего не мигает
+  if (!blink_flag && !btnUp.isButtonClosed() && !btnDown.isButtonClosed())
+  {
+    switch (MODE_DATA(field))
     {
-      showBrightnessSetting();
+    case MODE_FIELD_HOUR:
+      hour = -1;
+      break;
+    case MODE_FIELD_MINUTE:
+      minute = -1;
+      break;
     }
-    break;
+  }
+
+  bool toColon = false;
+#if defined(USE_CALENDAR)
+  toColon = !(MODE_DATA(flags) & MODE_FLAG_NO_COLON);
 #endif
-  default:
-    break;
+#if defined(MAX72XX_MATRIX_DISPLAY) || defined(WS2812_MATRIX_DISPLAY)
+  bool toDate = MODE_DATA(flags) & MODE_FLAG_DATE;
+  disp.showTime(hour, minute, 0, toColon, toDate);
+#else
+  disp.showTime(hour, minute, toColon);
+#endif
+}
+
+#ifdef USE_ALARM
+void showAlarmState(uint8_t _state)
+{
+#if defined(TM1637_DISPLAY)
+  disp.setDispData(0, 0b01110111); // "A"
+  disp.setDispData(1, 0b10111000); // "L:"
+  disp.setDispData(2, 0x00);
+#elif defined(MAX72XX_7SEGMENT_DISPLAY)
+  disp.setDispData(0, 0b01110111); // "A"
+  disp.setDispData(1, 0b10001110); // "L:"
+  disp.setDispData(2, 0x00);
+#elif defined(MAX72XX_MATRIX_DISPLAY) || defined(WS2812_MATRIX_DISPLAY)
+  disp.clear();
+  disp.setLangText(1, LANG_ALARM);
+  disp.setColumn(21, 0b00100100);
+#endif
+
+  if (!blink_flag && !btnUp.isButtonClosed() && !btnDown.isButtonClosed())
+  {
+#if defined(TM1637_DISPLAY) || defined(MAX72XX_7SEGMENT_DISPLAY)
+    disp.setDispData(3, 0x00);
+#endif
+  }
+  else
+  {
+#if defined(TM1637_DISPLAY)
+    disp.setDispData(3, (_state) ? 0b01011100 : 0b00001000);
+#elif defined(MAX72XX_7SEGMENT_DISPLAY)
+    disp.setDispData(3, (_state) ? 0b00011101 : 0b00001000);
+#elif defined(MAX72XX_MATRIX_DISPLAY) || defined(WS2812_MATRIX_DISPLAY)
+    disp.setDispData(25, (_state) ? 0x0C : 0x0B);
+#endif
+  }
+}
+#endif
+
+// ===================================================
+void checkData(uint8_t &dt, uint8_t max, bool toUp, uint8_t min, bool toLoop, uint8_t step)
+{
+  // расчет ведется в int16_t, чтобы шаг больше единицы не приводил к переполнению uint8_t
+  int16_t x = (toUp) ? dt + step : dt - step;
+  if (x > max || x < min)
+  {
+    if (toLoop)
+    {
+      // при шаге 1 значение переходит на противоположную границу диапазона, при большем шаге - продолжает счет с нее
+      uint8_t range = max - min + 1;
+      x = (x < min) ? x + range : x - range;
+    }
+    else
+    {
+      x = (toUp) ? max : min;
+    }
+  }
+  dt = x;
+}
+
+void updateEEPROM(uint16_t index, uint8_t value)
+{
+  if (EEPROM.read(index) != value)
+  {
+    COUNT_ACTIVITY(CNT_EEPROM_WRITE);
+    EEPROM.write(index, value);
+  }
+}
+
+// ===================================================
+void setDisplay()
+{
+  // режим выполняется своей задачей; если задача еще не запущена, ее функция вызывается сразу и запускает задачу
+  uint8_t task = MODE_DATA(task);
+  if (task != MODE_NONE && !tasks.getTaskState(task))
+  {
+    TaskCallback callback = (TaskCallback)pgm_read_ptr(&task_list[task].callback);
+    callback();
   }
 }
 
 // ===================================================
 void setup()
 {
-  // ==== часы =======================================
-  Wire.begin();
-  clock.setClockMode(false); // 24-часовой режим
-  rtcNow();
+  // сначала выполняется только то, что нужно для вывода на экран текущего времени, остальное инициализируется после вывода первого кадра
 
-  // ==== кнопки Up/Down =============================
-  btnUp.setLongClickMode(LCM_CLICKSERIES);
-  btnUp.setIntervalOfSerial(100);
-  btnDown.setLongClickMode(LCM_CLICKSERIES);
-  btnDown.setIntervalOfSerial(100);
+  // ==== экраны =======================================
+  Wire.begin();
+#if defined(WS2812_MATRIX_DISPLAY) || defined(USE_TASK_PROFILER)
+  // время передачи данных на матрицу и время выполнения задач измеряются таймером отметок времени
+  halTimerBegin();
+#endif
+#if defined(WS2812_MATRIX_DISPLAY)
+  setFastLEDData(leds, MATRIX_WIDTH * MATRIX_HEIGHT);
 
-// ==== датчики ======================================
-#if defined(USE_NTC)
-  temp_sensor.setADCbitDepth(10); // установить разрядность АЦП вашего МК, для AVR обычно равна 10 бит
+#elif defined(MAX72XX_MATRIX_DISPLAY) || defined(MAX72XX_7SEGMENT_DISPLAY)
+  disp.shutdownAllDevices(false);
+#ifdef MAX72XX_MATRIX_DISPLAY
+  disp.setDirection(2); // задайте нужный вам поворот картинки (0-3)
+  // disp.setFlip(true);   // раскомментируйте, если нужно включить отражение картинки по горизонтали
+#endif
 #endif
+
   // проверить корректность заданных уровней яркости
   uint8_t x = EEPROM.read(MAX_BRIGHTNESS_VALUE);
 #if defined(MAX72XX_7SEGMENT_DISPLAY) || defined(MAX72XX_MATRIX_DISPLAY)
@@ -1005,7 +1510,7 @@ void setup()
 #else
   x = ((x > 7) || (x == 0)) ? 7 : x;
 #endif
-  EEPROM.update(MAX_BRIGHTNESS_VALUE, x);
+  updateEEPROM(MAX_BRIGHTNESS_VALUE, x);
 #ifdef USE_LIGHT_SENSOR
   x = EEPROM.read(MIN_BRIGHTNESS_VALUE);
 #if defined(MAX72XX_7SEGMENT_DISPLAY) || defined(MAX72XX_MATRIX_DISPLAY)
@@ -1015,90 +1520,608 @@ void setup()
 #else
   x = ((x > 7) || (x == 0)) ? 1 : x;
 #endif
-  EEPROM.update(MIN_BRIGHTNESS_VALUE, x);
+  updateEEPROM(MIN_BRIGHTNESS_VALUE, x);
+#endif
+#ifdef USE_LANGUAGE_SETTING
+  x = EEPROM.read(LANGUAGE_VALUE);
+  x = (x >= LANG_COUNT) ? LANG_DEFAULT : x;
+  updateEEPROM(LANGUAGE_VALUE, x);
+  disp.setLanguage(x);
 #endif
 
-// ==== экраны =======================================
-#if defined(WS2812_MATRIX_DISPLAY)
-  setFastLEDData(leds, 256);
+#ifdef USE_LIGHT_SENSOR
+  // выставить минимальную яркость из настроек, чтобы при включении не сверкало максимальной яркостью; рабочая яркость будет установлена по первому опросу датчика света; нулевая яркость WS2812 гасит матрицу, поэтому минимум для нее не меньше 1
+  setDisplayBrightness(EEPROM.read(MIN_BRIGHTNESS_VALUE));
+#else
+  setDisplayBrightness(EEPROM.read(MAX_BRIGHTNESS_VALUE));
+#endif
 
-#elif defined(MAX72XX_MATRIX_DISPLAY) || defined(MAX72XX_7SEGMENT_DISPLAY)
-  disp.shutdownAllDevices(false);
-#ifdef MAX72XX_MATRIX_DISPLAY
-  disp.setDirection(2); // задайте нужный вам поворот картинки (0-3)
-  // disp.setFlip(true);   // раскомментируйте, если нужно включить отражение картинки по горизонтали
+  // ==== первый кадр ================================
+  // время считывается из DS3231 одной транзакцией и сразу выводится на экран
+#ifdef USE_RTC_SQW
+  readRTC(); // rtcNow() ждет импульса SQW, а прерывание от него еще не подключено
 #endif
+  rtcNow();
+  setDisp();
+#ifdef USE_TASK_PROFILER
+  boot_time = micros();
 #endif
 
-// выставить яркость в минимум, чтобы при включении не сверкало максимальной яркостью
-#if defined(WS2812_MATRIX_DISPLAY)
-  FastLED.setBrightness(0);
-#elif defined(MAX72XX_MATRIX_DISPLAY) || defined(MAX72XX_7SEGMENT_DISPLAY)
-  disp.setBrightness(0);
-#else
-  disp.setBrightness(1);
+  // ==== часы =======================================
+  // 24-часовой режим хранится в DS3231 и устанавливается при каждом запуске, поэтому первое считывание уже выполняется в этом режиме
+  clock.setClockMode(false);
+#ifdef USE_RTC_SQW
+  clock.enableOscillator(true, false, 0); // включить на выводе SQW меандр 1 Гц
+  pinMode(DS3231_SQW_PIN, INPUT_PULLUP);  // выход SQW - открытый сток
+  attachInterrupt(digitalPinToInterrupt(DS3231_SQW_PIN), rtcSqwIsr, FALLING);
+#endif
+#ifdef USE_ALARM
+  alarm.begin();
+#endif
+
+#ifdef USE_BUTTON_INTERRUPTS
+  // ==== прерывания от кнопок =======================
+  halAttachPinChange(BTN_SET_PIN);
+  halAttachPinChange(BTN_UP_PIN);
+  halAttachPinChange(BTN_DOWN_PIN);
+#endif
+#ifdef USE_SERIAL_OUTPUT
+  Serial.begin(SERIAL_SPEED);
+#endif
+#ifdef USE_TRACE
+  trace.begin();
 #endif
 
+  // ==== кнопки Up/Down =============================
+  btnUp.setLongClickMode(LCM_CLICKSERIES);
+  btnDown.setLongClickMode(LCM_CLICKSERIES);
+
   // ==== задачи =====================================
-  uint8_t task_count = 5; // базовое количество задач
-#ifdef USE_LIGHT_SENSOR
-  task_count++;
+  tasks.init();
+
+  // ==== датчики ======================================
+  // датчики опрашиваются задачей; первый опрос (для DS18b20 - вместе с поиском датчика на линии) выполняется уже после запуска часов
+#if defined(USE_NTC)
+  temp_sensor.setADCbitDepth(10); // установить разрядность АЦП вашего МК, для AVR обычно равна 10 бит
 #endif
-#ifdef USE_TEMP_DATA
-  task_count++;
+#ifdef USE_SENSORS
 #if defined(USE_DS18B20)
-  task_count++;
+  sensors.add(&temp_sensor, DS18B20_INTERVAL);
+#elif defined(USE_NTC)
+  sensors.add(&temp_sensor, NTC_INTERVAL);
+#elif defined(USE_TEMP_DATA)
+  sensors.add(&temp_sensor, RTC_TEMP_INTERVAL);
 #endif
+#ifdef USE_LIGHT_SENSOR
+  sensors.add(&light_sensor, LIGHT_INTERVAL, setBrightness);
 #endif
-#ifdef USE_CALENDAR
-  task_count++;
 #endif
-#ifdef USE_ALARM
-  task_count += 2;
+}
+
+#ifdef USE_EVENT_LOOP
+void dispatchEvents()
+{
+  EventType ev;
+  while ((ev = events.pop()) != EVENT_NONE)
+  {
+    switch (ev)
+    {
+    case EVENT_BUTTON:
+      btn_timer = millis();
+      break;
+#ifdef USE_RTC_SQW
+    case EVENT_RTC_TICK:
+      readRTC();
+      break;
+#endif
+    default:
+      break;
+    }
+  }
+
+  // кнопки опрашиваются, пока хотя бы одна из них нажата, и еще BTN_ACTIVE_TIMEOUT после этого, чтобы отработали одиночный и двойной клики
+  if (millis() - btn_timer < BTN_ACTIVE_TIMEOUT)
+  {
+    checkButton();
+    if (btnSet.isButtonClosed() || btnUp.isButtonClosed() || btnDown.isButtonClosed())
+    {
+      btn_timer = millis();
+    }
+  }
+}
+
+#ifdef SHOW_EVENT_LOOP_STATS
+void printEventLoopStats()
+{
+  static uint32_t timer = 0;
+  if (millis() - timer >= 1000)
+  {
+    timer = millis();
+    Serial.print(F("wakeups/s: "));
+    Serial.print(events.getWakeupsPerSecond());
+    Serial.print(F(", sleep: "));
+    Serial.print(events.getSleepPercent());
+    Serial.println(F("%"));
+  }
+}
 #endif
-#ifdef USE_SET_BRIGHTNESS_MODE
-  task_count++;
 #endif
-  tasks.init(task_count);
 
-  rtc_guard = tasks.addTask(50ul, rtcNow);
-  blink_timer = tasks.addTask(50ul, blink);
-  return_to_default_mode = tasks.addTask(AUTO_EXIT_TIMEOUT * 1000ul, returnToDefMode, false);
-  set_time_mode = tasks.addTask(100ul, showTimeSetting, false);
+#ifdef USE_SERIAL_PROTOCOL
+// ==== двоичный протокол ============================
+// длина данных каждой команды; индекс - код команды
+static const uint8_t PROGMEM request_length[] = {0xFF, 0, 0, 6, 0, 3, 0, 2, 0, 1};
+
+void putWord(uint8_t *buf, uint16_t value)
+{
+  buf[0] = (uint8_t)value;
+  buf[1] = (uint8_t)(value >> 8);
+}
+
+void sendStatus(uint8_t command, uint8_t status)
+{
+  link.send(command | PROTOCOL_REPLY, &status, 1);
+}
+
+void sendTelemetry()
+{
+  uint8_t buf[16];
+  uint32_t uptime = millis() / 1000;
+  putWord(buf, (uint16_t)uptime);
+  putWord(buf + 2, (uint16_t)(uptime >> 16));
+  putWord(buf + 4, loop_rate);
+  int16_t temp = INT16_MIN; // INT16_MIN - нет данных
+  int16_t light = INT16_MIN;
 #ifdef USE_TEMP_DATA
-  show_temp_mode = tasks.addTask(500ul, showTemp, false);
-#if defined(USE_DS18B20)
-  ds18b20_guard = tasks.addTask(3000ul, checkDS18b20);
+  temp = temp_sensor.result();
 #endif
+#ifdef USE_LIGHT_SENSOR
+  light = light_sensor.result();
+#endif
+  putWord(buf + 6, (uint16_t)temp);
+  putWord(buf + 8, (uint16_t)light);
+  putWord(buf + 10, rtc_errors);
+  putWord(buf + 12, link.getRxErrors());
+  putWord(buf + 14, link.getTxDrops());
+  link.send(CMD_GET_TELEMETRY | PROTOCOL_REPLY, buf, sizeof(buf));
+}
+
+uint8_t setTimeData(const uint8_t *data)
+{
+  // число проверяется так же, как в режиме настройки даты - в диапазоне 1..31
+  if (data[0] > 99 || data[1] == 0 || data[1] > 12 || data[2] == 0 || data[2] > 31 ||
+      data[3] > 23 || data[4] > 59 || data[5] > 59)
+  {
+    return (PROTOCOL_ERR_VALUE);
+  }
+  COUNT_ACTIVITY(CNT_I2C);
+  clock.setYear(data[0]);
+  clock.setMonth(data[1]);
+  clock.setDate(data[2]);
+  clock.setHour(data[3]);
+  clock.setMinute(data[4]);
+  clock.setSecond(data[5]);
+  readRTC();
+  return (PROTOCOL_OK);
+}
+
+uint8_t setAlarmData(const uint8_t *data)
+{
+#ifdef USE_ALARM
+  uint16_t point = data[1] | (data[2] << 8);
+  if (data[0] > 1 || point > MAX_DATA)
+  {
+    return (PROTOCOL_ERR_VALUE);
+  }
+  alarm.setAlarmPoint(point);
+  alarm.setOnOffAlarm((bool)data[0]);
+  return (PROTOCOL_OK);
+#else
+  (void)data;
+  return (PROTOCOL_ERR_UNSUPPORTED);
 #endif
-#ifdef USE_CALENDAR
-#if (defined(WS2812_MATRIX_DISPLAY) || defined(MAX72XX_MATRIX_DISPLAY)) && defined(USE_TICKER_FOR_DATE)
-  uint32_t t = 1000ul / TICKER_SPEED;
+}
+
+bool isBrightnessLevel(uint8_t value)
+{
+  // при нулевой минимальной яркости сравнение с ней всегда ложно (и дает предупреждение компилятора)
+#if BRIGHTNESS_LEVEL_MIN > 0
+  if (value < BRIGHTNESS_LEVEL_MIN)
+  {
+    return (false);
+  }
+#endif
+  return (value <= BRIGHTNESS_LEVEL_MAX);
+}
+
+uint8_t setSettingsData(const uint8_t *data)
+{
+  if (!isBrightnessLevel(data[0]))
+  {
+    return (PROTOCOL_ERR_VALUE);
+  }
+#ifdef USE_LIGHT_SENSOR
+  if (!isBrightnessLevel(data[1]))
+  {
+    return (PROTOCOL_ERR_VALUE);
+  }
+  updateEEPROM(MAX_BRIGHTNESS_VALUE, data[0]);
+  updateEEPROM(MIN_BRIGHTNESS_VALUE, data[1]);
+  setBrightness();
 #else
-  uint32_t t = 1000ul;
+  // без датчика света минимальная яркость не используется и игнорируется
+  updateEEPROM(MAX_BRIGHTNESS_VALUE, data[0]);
+  setDisplayBrightness(data[0]);
 #endif
-  show_calendar_mode = tasks.addTask(t, showCalendar, false);
+  return (PROTOCOL_OK);
+}
+
+void handleFrame()
+{
+  uint8_t command = link.getCommand();
+  uint8_t *data = link.getPayload();
+  uint8_t buf[6];
+
+  if (command == 0 || command >= sizeof(request_length))
+  {
+    buf[0] = command;
+    buf[1] = PROTOCOL_ERR_COMMAND;
+    link.send(CMD_ERROR, buf, 2);
+  }
+  else if (link.getLength() != pgm_read_byte(&request_length[command]))
+  {
+    buf[0] = command;
+    buf[1] = PROTOCOL_ERR_LENGTH;
+    link.send(CMD_ERROR, buf, 2);
+  }
+  else
+  {
+    switch (command)
+    {
+    case CMD_PING:
+      sendStatus(command, PROTOCOL_VERSION);
+      break;
+    case CMD_GET_TIME:
+      buf[0] = curTime.year() % 100;
+      buf[1] = curTime.month();
+      buf[2] = curTime.day();
+      buf[3] = curTime.hour();
+      buf[4] = curTime.minute();
+      buf[5] = curTime.second();
+      link.send(command | PROTOCOL_REPLY, buf, 6);
+      break;
+    case CMD_SET_TIME:
+      sendStatus(command, setTimeData(data));
+      break;
+    case CMD_GET_ALARM:
+#ifdef USE_ALARM
+      buf[0] = alarm.getOnOffAlarm();
+      buf[1] = alarm.getAlarmState();
+      putWord(buf + 2, alarm.getAlarmPoint());
+      link.send(command | PROTOCOL_REPLY, buf, 4);
+#else
+      buf[0] = command;
+      buf[1] = PROTOCOL_ERR_UNSUPPORTED;
+      link.send(CMD_ERROR, buf, 2);
+#endif
+      break;
+    case CMD_SET_ALARM:
+      sendStatus(command, setAlarmData(data));
+      break;
+    case CMD_GET_SETTINGS:
+      buf[0] = EEPROM.read(MAX_BRIGHTNESS_VALUE);
+#ifdef USE_LIGHT_SENSOR
+      buf[1] = EEPROM.read(MIN_BRIGHTNESS_VALUE);
+#else
+      buf[1] = 0;
+#endif
+      buf[2] = BRIGHTNESS_LEVEL_MIN;
+      buf[3] = BRIGHTNESS_LEVEL_MAX;
+      link.send(command | PROTOCOL_REPLY, buf, 4);
+      break;
+    case CMD_SET_SETTINGS:
+      sendStatus(command, setSettingsData(data));
+      break;
+    case CMD_GET_TELEMETRY:
+      sendTelemetry();
+      break;
+    case CMD_SET_TELEMETRY:
+      if (data[0] == 0)
+      {
+        tasks.stopTask(telemetry_timer);
+      }
+      else
+      {
+        tasks.setTaskInterval(telemetry_timer, data[0] * 100ul, true);
+      }
+      sendStatus(command, PROTOCOL_OK);
+      break;
+    }
+  }
+  link.release();
+}
+
+void updateLoopRate()
+{
+  static uint16_t count = 0;
+  static uint32_t timer = 0;
+  count++;
+  if (millis() - timer >= 1000)
+  {
+    timer = millis();
+    loop_rate = count;
+    count = 0;
+  }
+}
+#endif
+
+#ifdef USE_POWER_SAVE
+// ==== энергосбережение =============================
+bool isNightTime()
+{
+  uint8_t h = curTime.hour();
+#if POWER_SAVE_NIGHT_START < POWER_SAVE_NIGHT_END
+  return (h >= POWER_SAVE_NIGHT_START && h < POWER_SAVE_NIGHT_END);
+#elif POWER_SAVE_NIGHT_START > POWER_SAVE_NIGHT_END
+  return (h >= POWER_SAVE_NIGHT_START || h < POWER_SAVE_NIGHT_END);
+#else
+  return (false);
 #endif
+}
+
+bool isPowerSaveTime()
+{
+  // в режимах настройки, при сработавшем будильнике и при идущем отсчете секундомера или таймера часы не засыпают; без ответа DS3231 тоже: час не определен, а время сна отсчитывается по DS3231
+  if (displayMode != DISPLAY_MODE_SHOW_TIME || !isRtcTimeValid())
+  {
+    return (false);
+  }
 #ifdef USE_ALARM
-  alarm_guard = tasks.addTask(200ul, checkAlarm);
-  alarm_buzzer = tasks.addTask(50ul, runAlarmBuzzer, false);
+  if (alarm.getAlarmState() == ALARM_YES || tasks.getTaskState(alarm_buzzer))
+  {
+    return (false);
+  }
+#endif
+#ifdef USE_STOPWATCH
+  // в режиме power-down таймер, отсчитывающий время секундомера и таймера, останавливается
+  if (stopwatch.isRunning() || countdown.isRunning() || countdown.isExpired())
+  {
+    return (false);
+  }
 #endif
-  display_guard = tasks.addTask(50ul, setDisp);
-#if defined(USE_LIGHT_SENSOR)
-  light_sensor_guard = tasks.addTask(100ul, setBrightness);
+  uint32_t idle = millis() - power_timer;
+  if (isNightTime())
+  {
+    return (idle >= POWER_SAVE_NIGHT_TIMEOUT * 1000ul);
+  }
+  return (POWER_SAVE_IDLE_TIMEOUT > 0 && idle >= POWER_SAVE_IDLE_TIMEOUT * 1000ul);
+}
+
+bool isAnyButtonClosed()
+{
+  return (digitalRead(BTN_SET_PIN) == LOW || digitalRead(BTN_UP_PIN) == LOW || digitalRead(BTN_DOWN_PIN) == LOW);
+}
+
+void setDisplaySleep(bool sleep)
+{
+#if defined(TM1637_DISPLAY)
+  if (sleep)
+  {
+    disp.sleep();
+  }
+#elif defined(MAX72XX_7SEGMENT_DISPLAY)
+  if (sleep)
+  {
+    disp.sleep();
+  }
+  disp.shutdownAllDevices(sleep);
+#elif defined(MAX72XX_MATRIX_DISPLAY)
+  if (sleep)
+  {
+    disp.clear(true);
+  }
+  disp.shutdownAllDevices(sleep);
 #elif defined(WS2812_MATRIX_DISPLAY)
-  FastLED.setBrightness(EEPROM.read(MAX_BRIGHTNESS_VALUE) * 10);
+  if (sleep)
+  {
+    disp.clear(true);
+  }
+#endif
+}
+
+void checkPowerSave()
+{
+  if (!isPowerSaveTime())
+  {
+    return;
+  }
+
+  setDisplaySleep(true);
+#ifdef USE_RTC_SQW
+  // INT0/INT1 по фронту не будят МК из режима power-down, поэтому на время сна сигнал SQW принимается прерыванием PCINT
+  halAttachPinChange(DS3231_SQW_PIN);
 #else
-  disp.setBrightness(EEPROM.read(MAX_BRIGHTNESS_VALUE));
+  halWakeTimerStart();
 #endif
-#ifdef USE_SET_BRIGHTNESS_MODE
-  set_brightness_mode = tasks.addTask(100ul, showBrightnessSetting, false);
+#ifdef USE_SERIAL_OUTPUT
+  Serial.flush();
 #endif
+
+  // millis() во сне не увеличивается, поэтому время сна определяется по часам DS3231
+  uint32_t start = curTime.unixtime();
+  uint32_t awake = millis();
+  bool button = false;
+  do
+  {
+    halSleepPowerDown();
+    button = isAnyButtonClosed();
+    readRTC();
+#ifdef USE_ALARM
+    checkAlarm();
+#endif
+  } while (!button && isPowerSaveTime());
+
+#ifdef USE_RTC_SQW
+  halDetachPinChange(DS3231_SQW_PIN);
+#else
+  halWakeTimerStop();
+#endif
+  uint32_t wall = isRtcTimeValid() ? (curTime.unixtime() - start) * 1000ul : 0;
+  awake = millis() - awake;
+  power_sleep_time += (wall > awake) ? wall - awake : 0;
+
+  if (button)
+  {
+    // нажатие, разбудившее часы, только включает экран и до отпускания кнопки игнорируется
+    delay(BTN_DEBOUNCE_TIMEOUT + 10);
+    btnSet.getButtonState();
+    btnUp.getButtonState();
+    btnDown.getButtonState();
+    btnSet.resetButtonState();
+    btnUp.resetButtonState();
+    btnDown.resetButtonState();
+    power_timer = millis();
+  }
+  setDisplaySleep(false);
 }
 
+#ifdef SHOW_POWER_STATS
+void printPowerStats()
+{
+  uint32_t active = millis() - power_stat_timer;
+  uint32_t total = active + power_sleep_time;
+  Serial.print(F("active, s: "));
+  Serial.println(active / 1000);
+  Serial.print(F("sleep, s: "));
+  Serial.println(power_sleep_time / 1000);
+  Serial.print(F("sleep, %: "));
+  Serial.println((total > 0) ? (uint32_t)((uint64_t)power_sleep_time * 100 / total) : 0);
+  power_sleep_time = 0;
+  power_stat_timer = millis();
+}
+#endif
+#endif
+
+#ifdef USE_STOPWATCH_SELF_TEST
+// проверка отсчета секундомера: за 100 мс должно набраться 10 сотых долей секунды; работающий или остановленный с ненулевым временем секундомер не трогается
+void checkStopwatchTick()
+{
+  if (stopwatch.isRunning() || stopwatch.getTime() != 0)
+  {
+    Serial.println(F("stopwatch busy"));
+    return;
+  }
+  stopwatch.start();
+  delay(100);
+  uint32_t t = stopwatch.getTime();
+  stopwatch.reset();
+  Serial.print(F("stopwatch, cs/100ms: "));
+  Serial.print(t);
+  Serial.println((t >= 9 && t <= 11) ? F(" ok") : F(" FAIL"));
+}
+#endif
+
+#ifdef USE_SERIAL_REQUESTS
+void checkSerialRequest()
+{
+  while (Serial.available())
+  {
+    uint8_t c = Serial.read();
+#ifdef USE_SERIAL_PROTOCOL
+    // байты кадров протокола обрабатываются протоколом, остальные - как текстовые команды
+    if (link.receive(c))
+    {
+      if (link.available())
+      {
+        handleFrame();
+      }
+      continue;
+    }
+#endif
+    switch (c)
+    {
+#ifdef USE_TASK_PROFILER
+    case 'p':
+      Serial.print(F("boot, us: "));
+      Serial.println(boot_time);
+      tasks.printReport(Serial);
+#if defined(USE_DIGIT_ANIMATION) && (defined(MAX72XX_MATRIX_DISPLAY) || defined(WS2812_MATRIX_DISPLAY))
+      disp.printAnimationReport(Serial);
+#endif
+#if defined(WS2812_MATRIX_DISPLAY) && defined(USE_TICKER_FOR_DATE)
+      disp.printTickerReport(Serial);
+#endif
+#ifdef WS2812_MATRIX_DISPLAY
+      disp.printShowReport(Serial);
+#endif
+#ifdef USE_SENSORS
+      sensors.printReport(Serial);
+#endif
+      break;
+#endif
+#ifdef USE_ACTIVITY_COUNTERS
+    case 'c':
+      activity.printReport(Serial);
+      break;
+#endif
+#ifdef USE_RENDER_BENCHMARK
+    case 'b':
+      runRenderBenchmark(disp, Serial);
+      break;
+#endif
+#ifdef USE_RAM_MONITOR
+    case 'm':
+      tasks.printStackReport(Serial);
+      break;
+#endif
+#ifdef USE_TRACE
+    case 't':
+      trace.dump(Serial);
+      break;
+#endif
+#ifdef SHOW_POWER_STATS
+    case 's':
+      printPowerStats();
+      break;
+#endif
+#ifdef USE_STOPWATCH_SELF_TEST
+    case 'w':
+      checkStopwatchTick();
+      break;
+#endif
+    }
+  }
+#ifdef USE_SERIAL_PROTOCOL
+  link.transmit(Serial);
+#endif
+}
+#endif
+
 void loop()
 {
+#ifdef USE_SERIAL_REQUESTS
+  checkSerialRequest();
+#endif
+#ifdef USE_SERIAL_PROTOCOL
+  updateLoopRate();
+#endif
+#ifdef USE_EVENT_LOOP
+  dispatchEvents();
+  tasks.tick();
+  setDisplay();
+#ifdef SHOW_EVENT_LOOP_STATS
+  printEventLoopStats();
+#endif
+#ifdef USE_POWER_SAVE
+  checkPowerSave();
+#endif
+  events.sleep();
+#else
   checkButton();
   tasks.tick();
   setDisplay();
+#ifdef USE_POWER_SAVE
+  checkPowerSave();
+#endif
+#endif
 }
@@ -0,0 +1,196 @@
+/* Секундомер и таймер обратного отсчета;
+
+   Время считается в сотых долях секунды. Счет ведется в прерывании с периодом 10 мс (см. halTickStart() и HAL_TICK_ISR в hal.h), которое вызывает метод tick(): секундомер увеличивает время, таймер уменьшает его и по достижении нуля останавливается и выставляет флаг срабатывания. Прерывание отсчитывается от аппаратного таймера, поэтому точность счета не зависит от загрузки главного цикла и времени вывода на экран. На платформах без таймера отметок времени (HAL_TIMER_AVAILABLE не определен) время досчитывается по millis() при каждом обращении к нему.
+
+   Секундомер запоминает до STOPWATCH_LAP_COUNT отметок кругов - время от старта на момент фиксации круга; после заполнения списка новые круги не запоминаются.
+
+   Методы:
+
+   void tick() - отсчет 10 мс; вызывается из прерывания;
+   void update() - досчет времени по millis() на платформах без таймера отметок времени;
+   void start() - запуск счета; таймер с нулевым временем не запускается;
+   void stop() - остановка счета;
+   void reset(time) - остановка и установка времени, сотых долей секунды; список кругов очищается;
+   bool isRunning() - идет ли счет;
+   bool isExpired() - закончился ли отсчет таймера;
+   void clearExpired() - сброс флага окончания отсчета;
+   uint32_t getTime() - текущее время, сотых долей секунды;
+   bool addLap() - фиксация круга; false, если список кругов заполнен;
+   uint8_t getLapCount() - количество зафиксированных кругов;
+   uint32_t getLap(index) - время круга - от предыдущей отметки до отметки index, сотых долей секунды;
+*/
+#pragma once
+#include <Arduino.h>
+#include "hal.h"
+
+#define STOPWATCH_MAX_TIME 599999ul // максимальное время секундомера - 99:59.99, сотых долей секунды
+
+class Stopwatch
+{
+private:
+  bool countdown;
+  volatile uint32_t time = 0; // сотых долей секунды
+  volatile bool running = false;
+  volatile bool expired = false;
+  uint32_t laps[STOPWATCH_LAP_COUNT];
+  uint8_t lap_count = 0;
+#ifndef HAL_TIMER_AVAILABLE
+  uint32_t last_update = 0;
+#endif
+
+public:
+  /**
+   * @brief конструктор
+   *
+   * @param _countdown true - таймер обратного отсчета, false - секундомер
+   */
+  Stopwatch(bool _countdown) : countdown(_countdown) {}
+
+  /**
+   * @brief отсчет 10 мс; вызывается из прерывания с периодом 10 мс
+   *
+   */
+  void tick()
+  {
+    if (!running)
+    {
+      return;
+    }
+    if (countdown)
+    {
+      if (--time == 0)
+      {
+        running = false;
+        expired = true;
+      }
+    }
+    else if (time < STOPWATCH_MAX_TIME)
+    {
+      time++;
+    }
+  }
+
+  /**
+   * @brief досчет времени по millis() на платформах без таймера отметок времени; при наличии таймера ничего не делает
+   *
+   */
+  void update()
+  {
+#ifndef HAL_TIMER_AVAILABLE
+    uint32_t now = millis();
+    while (running && now - last_update >= 10)
+    {
+      last_update += 10;
+      tick();
+    }
+#endif
+  }
+
+  /**
+   * @brief запуск счета; таймер с нулевым временем не запускается
+   *
+   */
+  void start()
+  {
+    if (countdown && time == 0)
+    {
+      return;
+    }
+#ifndef HAL_TIMER_AVAILABLE
+    last_update = millis();
+#endif
+    running = true;
+    halTickStart();
+  }
+
+  /**
+   * @brief остановка счета
+   *
+   */
+  void stop()
+  {
+    update();
+    running = false;
+  }
+
+  /**
+   * @brief остановка счета и установка времени; список кругов очищается
+   *
+   * @param _time время, сотых долей секунды
+   */
+  void reset(uint32_t _time = 0)
+  {
+    uint8_t state = halDisableInterrupts();
+    running = false;
+    time = _time;
+    halRestoreInterrupts(state);
+    lap_count = 0;
+  }
+
+  /**
+   * @brief проверка, идет ли счет
+   *
+   * @return true, если идет
+   */
+  bool isRunning() { return (running); }
+
+  /**
+   * @brief проверка, закончился ли отсчет таймера
+   *
+   * @return true, если закончился и флаг еще не сброшен
+   */
+  bool isExpired() { return (expired); }
+
+  /**
+   * @brief сброс флага окончания отсчета
+   *
+   */
+  void clearExpired() { expired = false; }
+
+  /**
+   * @brief получение текущего времени
+   *
+   * @return uint32_t сотых долей секунды
+   */
+  uint32_t getTime()
+  {
+    update();
+    uint8_t state = halDisableInterrupts();
+    uint32_t result = time;
+    halRestoreInterrupts(state);
+    return (result);
+  }
+
+  /**
+   * @brief фиксация круга - запоминание текущего времени
+   *
+   * @return false, если список кругов заполнен
+   */
+  bool addLap()
+  {
+    if (lap_count >= STOPWATCH_LAP_COUNT)
+    {
+      return (false);
+    }
+    laps[lap_count++] = getTime();
+    return (true);
+  }
+
+  /**
+   * @brief получение количества зафиксированных кругов
+   *
+   * @return uint8_t
+   */
+  uint8_t getLapCount() { return (lap_count); }
+
+  /**
+   * @brief получение времени круга
+   *
+   * @param index номер круга, 0..getLapCount()-1
+   * @return uint32_t время от предыдущей отметки (для первого круга - от старта) до отметки круга, сотых долей секунды
+   */
+  uint32_t getLap(uint8_t index)
+  {
+    return ((index == 0) ? laps[0] : laps[index] - laps[index - 1]);
+  }
+};
@@ -0,0 +1,443 @@
+/* Небольшой диспетчер задач со статически заданным списком задач;
+
+   Список задач задается на этапе компиляции массивом clcTask, размещенным во flash (PROGMEM); индекс задачи в массиве является ее идентификатором. Вся память под задачи выделяется статически, размер определяется параметром шаблона task_count.
+
+   Активные задачи хранятся в минимальной куче (min-heap), упорядоченной по моменту следующего запуска, поэтому метод tick() проверяет только вершину кучи - выбор ближайшей задачи выполняется за O(1), а перепланирование задачи - за O(log n).
+
+   Методы:
+
+   void init() - запуск задач, помеченных в списке как активные при старте;
+   void tick() - выполнение всех задач, время запуска которых наступило;
+   void startTask(id) - запуск задачи; первое выполнение - через интервал задачи;
+   void stopTask(id) - остановка задачи;
+   void restartTask(id) - перезапуск задачи, отсчет интервала начинается заново;
+   bool getTaskState(id) - получение состояния задачи - активна/нет;
+   void setTaskInterval(id, interval, restart) - установка нового интервала задачи, при restart = true задача перезапускается;
+   uint32_t getNextDeadline() - получение времени до запуска ближайшей задачи, мс;
+
+   Если определен макрос USE_TASK_PROFILER, для каждой задачи собирается статистика: количество вызовов, минимальное, среднее и максимальное время выполнения в микросекундах, максимальное опоздание запуска; кроме того, строится общая гистограмма опозданий запуска задач и считается частота вызова tick(), т.е. частота главного цикла. Отчет выводится методом printReport(); без USE_TASK_PROFILER код сбора статистики не компилируется.
+
+   Начало и окончание выполнения каждой задачи записываются в буфер трассировки (см. trace.h) как события категории TRACE_CAT_TASK.
+
+   Если определен макрос USE_RAM_MONITOR, для каждой задачи запоминается максимальная глубина стека, использованная ею с момента запуска часов (см. ram_monitor.h); отчет выводится методом printStackReport().
+*/
+#pragma once
+#include <Arduino.h>
+#include <avr/pgmspace.h>
+#include "hal.h"
+#include "trace.h"
+#ifdef USE_RAM_MONITOR
+#include "ram_monitor.h"
+#endif
+
+#define TASK_NOT_ACTIVE 0xFF
+#ifdef USE_TASK_PROFILER
+#define LATENESS_BUCKET_COUNT 6 // количество интервалов гистограммы опозданий: 0, 1, 2..3, 4..7, 8..15, 16+ мс
+#endif
+
+typedef void (*TaskCallback)(void);
+
+/**
+ * @brief описание задачи в списке задач
+ */
+struct clcTask
+{
+  TaskCallback callback; // функция задачи
+  uint32_t interval;     // интервал запуска задачи, мс
+  bool active;           // активна ли задача при старте
+};
+
+template <uint8_t task_count>
+class clcTaskManager
+{
+private:
+  static_assert(task_count > 0 && task_count < TASK_NOT_ACTIVE,
+                "task_count must be in range 1..254");
+
+  const clcTask *task_list; // список задач во flash
+  uint32_t interval[task_count];
+  uint32_t deadline[task_count];
+  uint8_t heap[task_count];     // куча активных задач
+  uint8_t heap_pos[task_count]; // позиция задачи в куче или TASK_NOT_ACTIVE
+  uint8_t heap_size = 0;
+#ifdef USE_RAM_MONITOR
+  uint16_t stack_depth[task_count]; // максимальная глубина стека задачи, байт
+#endif
+
+#ifdef USE_TASK_PROFILER
+  struct TaskStat
+  {
+    uint16_t count;    // количество вызовов
+    uint16_t min_time; // минимальное время выполнения, мкс
+    uint16_t max_time; // максимальное время выполнения, мкс
+    uint32_t sum_time; // суммарное время выполнения, мкс
+    uint16_t max_late; // максимальное опоздание запуска, мс
+  };
+  TaskStat stat[task_count];
+  uint16_t lateness[LATENESS_BUCKET_COUNT];
+  uint32_t loop_count = 0;
+  uint32_t stat_timer = 0;
+
+  void addStat(uint8_t id, uint32_t time, uint32_t late)
+  {
+    TaskStat &st = stat[id];
+    uint16_t t = (time < 0xFFFF) ? time : 0xFFFF;
+    if (st.count < 0xFFFF)
+    {
+      st.count++;
+      st.sum_time += t;
+    }
+    if (t < st.min_time)
+    {
+      st.min_time = t;
+    }
+    if (t > st.max_time)
+    {
+      st.max_time = t;
+    }
+    if (late > st.max_late)
+    {
+      st.max_late = (late < 0xFFFF) ? late : 0xFFFF;
+    }
+    uint8_t b = 0;
+    while (late > 0 && b < LATENESS_BUCKET_COUNT - 1)
+    {
+      b++;
+      late >>= 1;
+    }
+    if (lateness[b] < 0xFFFF)
+    {
+      lateness[b]++;
+    }
+  }
+#endif
+
+  bool isEarlier(uint8_t a, uint8_t b)
+  {
+    return ((int32_t)(deadline[heap[a]] - deadline[heap[b]]) < 0);
+  }
+
+  void swap(uint8_t a, uint8_t b)
+  {
+    uint8_t t = heap[a];
+    heap[a] = heap[b];
+    heap[b] = t;
+    heap_pos[heap[a]] = a;
+    heap_pos[heap[b]] = b;
+  }
+
+  void siftUp(uint8_t i)
+  {
+    while (i > 0)
+    {
+      uint8_t p = (i - 1) / 2;
+      if (!isEarlier(i, p))
+      {
+        break;
+      }
+      swap(i, p);
+      i = p;
+    }
+  }
+
+  void siftDown(uint8_t i)
+  {
+    while (true)
+    {
+      uint8_t l = i * 2 + 1;
+      uint8_t r = l + 1;
+      uint8_t m = i;
+      if (l < heap_size && isEarlier(l, m))
+      {
+        m = l;
+      }
+      if (r < heap_size && isEarlier(r, m))
+      {
+        m = r;
+      }
+      if (m == i)
+      {
+        break;
+      }
+      swap(i, m);
+      i = m;
+    }
+  }
+
+  void schedule(uint8_t id)
+  {
+    deadline[id] = millis() + interval[id];
+    if (heap_pos[id] == TASK_NOT_ACTIVE)
+    {
+      heap[heap_size] = id;
+      heap_pos[id] = heap_size;
+      siftUp(heap_size++);
+    }
+    else
+    {
+      siftUp(heap_pos[id]);
+      siftDown(heap_pos[id]);
+    }
+  }
+
+public:
+  /**
+   * @brief конструктор
+   *
+   * @param _task_list список задач, размещенный в PROGMEM
+   */
+  clcTaskManager(const clcTask *_task_list)
+  {
+    task_list = _task_list;
+    for (uint8_t i = 0; i < task_count; i++)
+    {
+      heap_pos[i] = TASK_NOT_ACTIVE;
+#ifdef USE_RAM_MONITOR
+      stack_depth[i] = 0;
+#endif
+    }
+#ifdef USE_TASK_PROFILER
+    resetStat();
+#endif
+  }
+
+  /**
+   * @brief запуск задач, помеченных в списке как активные при старте
+   *
+   */
+  void init()
+  {
+    for (uint8_t i = 0; i < task_count; i++)
+    {
+      interval[i] = pgm_read_dword(&task_list[i].interval);
+      if (pgm_read_byte(&task_list[i].active))
+      {
+        schedule(i);
+      }
+    }
+  }
+
+  /**
+   * @brief выполнение задач, время запуска которых наступило
+   *
+   */
+  void tick()
+  {
+#ifdef USE_TASK_PROFILER
+    loop_count++;
+#endif
+    // ограничение количества запусков за один вызов защищает от зацикливания на задачах с нулевым интервалом
+    for (uint8_t i = 0; i < task_count && heap_size > 0; i++)
+    {
+      uint8_t id = heap[0];
+      if ((int32_t)(millis() - deadline[id]) < 0)
+      {
+        break;
+      }
+#ifdef USE_TASK_PROFILER
+      uint32_t late = millis() - deadline[id];
+      HalStamp t = halStamp();
+#endif
+      // задача перепланируется до вызова, чтобы внутри нее можно было остановить или перезапустить ее
+      schedule(id);
+      TaskCallback callback = (TaskCallback)pgm_read_ptr(&task_list[id].callback);
+      TRACE(TRACE_CAT_TASK, TRACE_TASK_BEGIN, id);
+#ifdef USE_RAM_MONITOR
+      uint16_t mark = ram.stackMark();
+      callback();
+      uint16_t depth = ram.stackUsedSince(mark);
+      if (depth > stack_depth[id])
+      {
+        stack_depth[id] = depth;
+      }
+#else
+      callback();
+#endif
+      TRACE(TRACE_CAT_TASK, TRACE_TASK_END, id);
+#ifdef USE_TASK_PROFILER
+      addStat(id, halElapsedMicros(t), late);
+#endif
+    }
+  }
+
+  /**
+   * @brief запуск задачи; если задача уже запущена, ничего не происходит
+   *
+   * @param id идентификатор задачи
+   */
+  void startTask(uint8_t id)
+  {
+    if (id < task_count && heap_pos[id] == TASK_NOT_ACTIVE)
+    {
+      schedule(id);
+    }
+  }
+
+  /**
+   * @brief остановка задачи
+   *
+   * @param id идентификатор задачи
+   */
+  void stopTask(uint8_t id)
+  {
+    if (id >= task_count || heap_pos[id] == TASK_NOT_ACTIVE)
+    {
+      return;
+    }
+    uint8_t i = heap_pos[id];
+    heap_pos[id] = TASK_NOT_ACTIVE;
+    if (i != --heap_size)
+    {
+      uint8_t moved = heap[heap_size];
+      heap[i] = moved;
+      heap_pos[moved] = i;
+      siftUp(i);
+      siftDown(heap_pos[moved]);
+    }
+  }
+
+  /**
+   * @brief перезапуск задачи - отсчет интервала начинается заново
+   *
+   * @param id идентификатор задачи
+   */
+  void restartTask(uint8_t id)
+  {
+    if (id < task_count)
+    {
+      schedule(id);
+    }
+  }
+
+  /**
+   * @brief получение состояния задачи
+   *
+   * @param id идентификатор задачи
+   * @return true, если задача активна
+   */
+  bool getTaskState(uint8_t id)
+  {
+    return ((id < task_count) ? heap_pos[id] != TASK_NOT_ACTIVE : false);
+  }
+
+  /**
+   * @brief установка нового интервала задачи
+   *
+   * @param id идентификатор задачи
+   * @param _interval новый интервал, мс
+   * @param restart перезапустить задачу
+   */
+  void setTaskInterval(uint8_t id, uint32_t _interval, bool restart)
+  {
+    if (id < task_count)
+    {
+      interval[id] = _interval;
+      if (restart)
+      {
+        schedule(id);
+      }
+    }
+  }
+
+  /**
+   * @brief получение времени до запуска ближайшей задачи
+   *
+   * @return время в мс; 0, если время запуска уже наступило; 0xFFFFFFFF, если активных задач нет
+   */
+  uint32_t getNextDeadline()
+  {
+    if (heap_size == 0)
+    {
+      return (0xFFFFFFFF);
+    }
+    int32_t t = (int32_t)(deadline[heap[0]] - millis());
+    return ((t > 0) ? t : 0);
+  }
+
+#ifdef USE_TASK_PROFILER
+  /**
+   * @brief сброс статистики задач
+   *
+   */
+  void resetStat()
+  {
+    for (uint8_t i = 0; i < task_count; i++)
+    {
+      stat[i].count = 0;
+      stat[i].min_time = 0xFFFF;
+      stat[i].max_time = 0;
+      stat[i].sum_time = 0;
+      stat[i].max_late = 0;
+    }
+    for (uint8_t i = 0; i < LATENESS_BUCKET_COUNT; i++)
+    {
+      lateness[i] = 0;
+    }
+    loop_count = 0;
+    stat_timer = millis();
+  }
+
+  /**
+   * @brief вывод отчета по задачам с момента последнего сброса статистики; после вывода статистика сбрасывается
+   *
+   * @param out поток для вывода, например, Serial
+   */
+  void printReport(Print &out)
+  {
+    uint32_t t = millis() - stat_timer;
+    out.print(F("loop/s: "));
+    out.println((t > 0) ? loop_count * 1000ul / t : 0);
+    out.println(F("id cnt min avg max late"));
+    for (uint8_t i = 0; i < task_count; i++)
+    {
+      TaskStat &st = stat[i];
+      out.print(i);
+      out.print(' ');
+      out.print(st.count);
+      out.print(' ');
+      out.print((st.count) ? st.min_time : 0);
+      out.print(' ');
+      out.print((st.count) ? st.sum_time / st.count : 0);
+      out.print(' ');
+      out.print(st.max_time);
+      out.print(' ');
+      out.println(st.max_late);
+    }
+    out.print(F("late:"));
+    for (uint8_t i = 0; i < LATENESS_BUCKET_COUNT; i++)
+    {
+      out.print(' ');
+      out.print(lateness[i]);
+    }
+    out.println();
+    resetStat();
+  }
+#endif
+
+#ifdef USE_RAM_MONITOR
+  /**
+   * @brief получение максимальной глубины стека задачи с момента запуска часов
+   *
+   * @param id идентификатор задачи
+   * @return uint16_t глубина, байт
+   */
+  uint16_t getTaskStackDepth(uint8_t id) { return ((id < task_count) ? stack_depth[id] : 0); }
+
+  /**
+   * @brief вывод максимальной глубины стека каждой задачи и запаса свободной RAM
+   *
+   * @param out поток для вывода, например, Serial
+   */
+  void printStackReport(Print &out)
+  {
+    ram.printReport(out);
+    out.println(F("id stack"));
+    for (uint8_t i = 0; i < task_count; i++)
+    {
+      out.print(i);
+      out.print(' ');
+      out.println(stack_depth[i]);
+    }
+  }
+#endif
+};
@@ -0,0 +1,206 @@
+#!/usr/bin/env python3
+"""Клиент двоичного протокола часов (USE_SERIAL_PROTOCOL, см. protocol.h).
+
+Формат кадра: 0xA5, длина данных, код команды, данные, CRC-8 (полином 0x07)
+по байтам длины, команды и данных. Ответ на команду имеет код команды | 0x80.
+
+Запуск (из корня репозитория):
+
+    python3 tools/clock_client.py --port /dev/ttyUSB0 ping
+    python3 tools/clock_client.py --port /dev/ttyUSB0 get-time
+    python3 tools/clock_client.py --port /dev/ttyUSB0 set-time                 # время компьютера
+    python3 tools/clock_client.py --port /dev/ttyUSB0 set-time "2025-01-31 07:30:00"
+    python3 tools/clock_client.py --port /dev/ttyUSB0 get-alarm
+    python3 tools/clock_client.py --port /dev/ttyUSB0 set-alarm 06:45 on
+    python3 tools/clock_client.py --port /dev/ttyUSB0 get-settings
+    python3 tools/clock_client.py --port /dev/ttyUSB0 set-settings 7 1        # максимальная и минимальная яркость
+    python3 tools/clock_client.py --port /dev/ttyUSB0 telemetry --period 1.0  # поток телеметрии, Ctrl+C - выход
+
+Порт может быть и псевдотерминалом (pty), например, созданным socat для
+эмулятора. Нужен пакет pyserial.
+"""
+
+import argparse
+import datetime
+import struct
+import sys
+import time
+
+SYNC = 0xA5
+MAX_PAYLOAD = 16
+REPLY = 0x80
+
+# коды команд - как ProtocolCommand в protocol.h
+CMD_PING = 0x01
+CMD_GET_TIME = 0x02
+CMD_SET_TIME = 0x03
+CMD_GET_ALARM = 0x04
+CMD_SET_ALARM = 0x05
+CMD_GET_SETTINGS = 0x06
+CMD_SET_SETTINGS = 0x07
+CMD_GET_TELEMETRY = 0x08
+CMD_SET_TELEMETRY = 0x09
+CMD_ERROR = 0x7F
+
+ERRORS = ["ok", "unknown command", "bad length", "bad value", "not supported by firmware"]
+ALARM_STATES = ["off", "on", "ringing"]
+TELEMETRY = struct.Struct("<IHhhHHH")
+NO_DATA = -32768
+
+
+class ProtocolError(Exception):
+    pass
+
+
+def crc8(data):
+    crc = 0
+    for b in data:
+        crc ^= b
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+
+def encode(command, payload=b""):
+    if len(payload) > MAX_PAYLOAD:
+        raise ValueError("payload is too long")
+    body = bytes([len(payload), command]) + bytes(payload)
+    return bytes([SYNC]) + body + bytes([crc8(body)])
+
+
+class Parser:
+    """Побайтный разбор кадров - так же, как в часах; кадры с ошибками пропускаются."""
+
+    def __init__(self):
+        self.buf = bytearray()
+
+    def feed(self, data):
+        frames = []
+        self.buf.extend(data)
+        while True:
+            start = self.buf.find(bytes([SYNC]))
+            if start < 0:
+                self.buf.clear()
+                break
+            del self.buf[:start]
+            if len(self.buf) < 2:
+                break
+            length = self.buf[1]
+            if length > MAX_PAYLOAD:
+                del self.buf[:1]
+                continue
+            size = length + 4
+            if len(self.buf) < size:
+                break
+            frame = bytes(self.buf[:size])
+            if crc8(frame[1:-1]) == frame[-1]:
+                frames.append((frame[2], frame[3:-1]))
+                del self.buf[:size]
+            else:
+                del self.buf[:1]
+        return frames
+
+
+class Clock:
+    def __init__(self, port, baud, timeout):
+        import serial  # pyserial
+
+        self.ser = serial.Serial(port, baud, timeout=0.05)
+        self.timeout = timeout
+        self.parser = Parser()
+        time.sleep(2)  # открытие порта перезапускает большинство плат Arduino
+        self.ser.reset_input_buffer()
+
+    def frames(self):
+        """Чтение принятых кадров; текстовый вывод часов пропускается."""
+        return self.parser.feed(self.ser.read(256))
+
+    def request(self, command, payload=b""):
+        self.ser.write(encode(command, payload))
+        deadline = time.time() + self.timeout
+        while time.time() < deadline:
+            for cmd, data in self.frames():
+                if cmd == CMD_ERROR and data[:1] == bytes([command]):
+                    raise ProtocolError(ERRORS[data[1]] if data[1] < len(ERRORS) else "error %d" % data[1])
+                if cmd == command | REPLY:
+                    return data
+        raise ProtocolError("no reply to command 0x%02X" % command)
+
+    def command(self, command, payload=b""):
+        status = self.request(command, payload)[0]
+        if status:
+            raise ProtocolError(ERRORS[status] if status < len(ERRORS) else "error %d" % status)
+
+
+def format_telemetry(data):
+    uptime, loop_rate, temp, light, rtc_errors, rx_errors, tx_drops = TELEMETRY.unpack(data)
+    fmt = lambda v: "-" if v == NO_DATA else str(v)
+    return "uptime %d s, loop %d/s, temp %s, light %s, rtc errors %d, rx errors %d, tx drops %d" % (
+        uptime, loop_rate, fmt(temp), fmt(light), rtc_errors, rx_errors, tx_drops)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--port", required=True, help="последовательный порт часов")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--timeout", type=float, default=1.0, help="время ожидания ответа, с")
+    sub = parser.add_subparsers(dest="cmd", required=True)
+    sub.add_parser("ping")
+    sub.add_parser("get-time")
+    p = sub.add_parser("set-time")
+    p.add_argument("time", nargs="?", help="ГГГГ-ММ-ДД ЧЧ:ММ:СС; по умолчанию - время компьютера")
+    sub.add_parser("get-alarm")
+    p = sub.add_parser("set-alarm")
+    p.add_argument("time", help="ЧЧ:ММ")
+    p.add_argument("state", choices=["on", "off"])
+    sub.add_parser("get-settings")
+    p = sub.add_parser("set-settings")
+    p.add_argument("max", type=int, help="максимальная яркость")
+    p.add_argument("min", type=int, nargs="?", default=0, help="минимальная яркость (только с датчиком света)")
+    p = sub.add_parser("telemetry")
+    p.add_argument("--period", type=float, default=0, help="интервал периодической телеметрии, с; 0 - один запрос")
+    args = parser.parse_args()
+
+    clock = Clock(args.port, args.baud, args.timeout)
+    try:
+        if args.cmd == "ping":
+            print("protocol version %d" % clock.request(CMD_PING)[0])
+        elif args.cmd == "get-time":
+            y, mo, d, h, mi, s = clock.request(CMD_GET_TIME)
+            print("20%02d-%02d-%02d %02d:%02d:%02d" % (y, mo, d, h, mi, s))
+        elif args.cmd == "set-time":
+            t = datetime.datetime.strptime(args.time, "%Y-%m-%d %H:%M:%S") if args.time else datetime.datetime.now()
+            clock.command(CMD_SET_TIME, bytes([t.year % 100, t.month, t.day, t.hour, t.minute, t.second]))
+        elif args.cmd == "get-alarm":
+            on, state, point = struct.unpack("<BBH", clock.request(CMD_GET_ALARM))
+            print("%02d:%02d %s (%s)" % (point // 60, point % 60, "on" if on else "off",
+                                        ALARM_STATES[state] if state < len(ALARM_STATES) else state))
+        elif args.cmd == "set-alarm":
+            h, m = (int(v) for v in args.time.split(":"))
+            clock.command(CMD_SET_ALARM, struct.pack("<BH", args.state == "on", h * 60 + m))
+        elif args.cmd == "get-settings":
+            bmax, bmin, lo, hi = clock.request(CMD_GET_SETTINGS)
+            print("brightness max %d, min %d (range %d..%d)" % (bmax, bmin, lo, hi))
+        elif args.cmd == "set-settings":
+            clock.command(CMD_SET_SETTINGS, bytes([args.max, args.min]))
+        elif args.cmd == "telemetry":
+            if args.period <= 0:
+                print(format_telemetry(clock.request(CMD_GET_TELEMETRY)))
+                return 0
+            clock.command(CMD_SET_TELEMETRY, bytes([max(1, min(255, round(args.period * 10)))]))
+            try:
+                while True:
+                    for cmd, data in clock.frames():
+                        if cmd == CMD_GET_TELEMETRY | REPLY:
+                            print(format_telemetry(data))
+                            sys.stdout.flush()
+            except KeyboardInterrupt:
+                clock.command(CMD_SET_TELEMETRY, b"\x00")
+    except ProtocolError as e:
+        print("error: %s" % e, file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
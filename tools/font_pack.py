@@ -0,0 +1,204 @@
+#!/usr/bin/env python3
+"""Сборка языковых пакетов и сжатого шрифта 5х7 для матричных экранов (lang_packs.h).
+
+Скрипт берет полный шрифт 5х7 в кодировке cp1251 из tools/font_5_7.h, строки
+языковых пакетов из таблицы PACKS ниже и оставляет в шрифте только символы,
+которые действительно выводятся на экран: цифры, знаки температуры и символы
+строк пакетов. Символы в строках пакетов заменяются номерами в сжатом шрифте.
+Шрифт и пакеты формируются для трех конфигураций, выбираемых при компиляции:
+выбор языка в настройках (USE_LANGUAGE_SETTING, все пакеты), только русский
+(USE_RU_LANGUAGE) и только английский. Для каждой конфигурации выводится объем
+таблиц во flash и экономия по сравнению с полным шрифтом.
+
+Запуск (из корня репозитория):
+
+    python3 tools/font_pack.py           # записать lang_packs.h и вывести отчет
+    python3 tools/font_pack.py --check   # только проверить, что lang_packs.h соответствует шрифту и пакетам
+
+Новый язык добавляется строкой в PACKS; после запуска скрипта нужно добавить
+его в описание настройки языка в readme.
+"""
+
+import argparse
+import os
+import re
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+FONT_FILE = os.path.join(ROOT, "tools", "font_5_7.h")
+OUT_FILE = os.path.join(ROOT, "lang_packs.h")
+GLYPH_WIDTH = 5
+ENCODING = "cp1251"
+
+# символы, общие для всех пакетов; цифры должны идти подряд с начала шрифта
+COMMON = [("0", "GLYPH_0"), ("1", None), ("2", None), ("3", None), ("4", None), ("5", None),
+          ("6", None), ("7", None), ("8", None), ("9", None),
+          (" ", "GLYPH_SPACE"), ("+", "GLYPH_PLUS"), ("-", "GLYPH_MINUS"), ("°", "GLYPH_DEGREE"), ("C", "GLYPH_C")]
+
+# строки пакета - в порядке размещения в пакете: имя поля, длина, описание
+FIELDS = [
+    ("name", 3, "LANG_NAME", "название языка для экрана настройки"),
+    ("day_of_week", 21, "LANG_DAY_OF_WEEK", "дни недели с воскресенья, по 3 символа"),
+    ("brightness", 3, "LANG_BRIGHTNESS", "подпись настройки яркости; третий символ выводится, если нет датчика света"),
+    ("alarm", 3, "LANG_ALARM", "подпись настройки будильника"),
+]
+
+# языковые пакеты: макрос номера языка и строки
+PACKS = [
+    ("LANG_EN", {
+        "name": "ENG",
+        "day_of_week": "SUNMONTUEWEDTHUFRISAT",
+        "brightness": "Br ",
+        "alarm": "Alr",
+    }),
+    ("LANG_RU", {
+        "name": "РУС",
+        "day_of_week": "ВСКПНДВТРСРДЧТВПТНСБТ",
+        "brightness": "Ярк",
+        "alarm": "Бдк",
+    }),
+]
+
+# конфигурации: условие препроцессора и включаемые пакеты
+CONFIGS = [
+    ("defined(USE_LANGUAGE_SETTING)", "выбор языка в настройках", ["LANG_EN", "LANG_RU"]),
+    ("defined(USE_RU_LANGUAGE)", "только русский язык", ["LANG_RU"]),
+    (None, "только английский язык", ["LANG_EN"]),
+]
+
+FULL_DOW_SIZE = 21  # таблица дней недели прежнего формата
+
+
+def read_font(path):
+    """Чтение полного шрифта: список из 256 символов по GLYPH_WIDTH байт."""
+    with open(path, encoding="utf-8") as f:
+        text = f.read()
+    body = text[text.index("{") + 1:text.index("};")]
+    values = [int(v, 16) for v in re.findall(r"0x[0-9A-Fa-f]{2}", re.sub(r"//[^\n]*|/\*.*?\*/", "", body))]
+    if len(values) != 256 * GLYPH_WIDTH:
+        raise ValueError("%s: expected %d bytes, got %d" % (path, 256 * GLYPH_WIDTH, len(values)))
+    return [values[i * GLYPH_WIDTH:(i + 1) * GLYPH_WIDTH] for i in range(256)]
+
+
+def code(ch):
+    return ch.encode(ENCODING)[0]
+
+
+def build_config(packs):
+    """Список кодов символов сжатого шрифта и строки пакетов в номерах сжатого шрифта."""
+    codes = [code(ch) for ch, _ in COMMON]
+    for name in packs:
+        strings = dict(PACKS)[name]
+        for field, length, _, _ in FIELDS:
+            s = strings[field]
+            if len(s) != length:
+                raise ValueError("%s.%s: expected %d characters" % (name, field, length))
+            codes.extend(c for c in (code(ch) for ch in s) if c not in codes)
+    if len(codes) > 256:
+        raise ValueError("too many glyphs")
+    index = {c: i for i, c in enumerate(codes)}
+    rows = []
+    for name in packs:
+        strings = dict(PACKS)[name]
+        rows.append((name, [[index[code(ch)] for ch in strings[field]] for field, _, _, _ in FIELDS]))
+    return codes, rows
+
+
+def table_size(codes, rows):
+    return len(codes) * GLYPH_WIDTH + sum(sum(len(f) for f in fields) for _, fields in rows)
+
+
+def char_name(c):
+    ch = bytes([c]).decode(ENCODING)
+    return "space" if ch == " " else ch
+
+
+def render_config(font, codes, rows):
+    out = []
+    for i, name in enumerate(n for n, _ in rows):
+        out.append("#define %s %d" % (name, i))
+    out.append("#define LANG_COUNT %d" % len(rows))
+    out.append("")
+    out.append("static const uint8_t PROGMEM font_5_7[] = {")
+    for i, c in enumerate(codes):
+        sep = "," if i < len(codes) - 1 else " "
+        out.append("    %s%s // %s 0x%02X -> 0x%02X" % (", ".join("0x%02X" % b for b in font[c]), sep,
+                                                       char_name(c), c, i))
+    out.append("};")
+    out.append("")
+    out.append("static const uint8_t PROGMEM lang_packs[] = {")
+    for n, (name, fields) in enumerate(rows):
+        strings = dict(PACKS)[name]
+        out.append("    // %s" % name)
+        for k, ((field, _, _, _), data) in enumerate(zip(FIELDS, fields)):
+            last = n == len(rows) - 1 and k == len(FIELDS) - 1
+            out.append("    %s%s // \"%s\"" % (", ".join("0x%02X" % b for b in data), " " if last else ",",
+                                            strings[field]))
+    out.append("};")
+    return out
+
+
+def render(font):
+    full = 256 * GLYPH_WIDTH + FULL_DOW_SIZE
+    configs = []
+    for cond, title, packs in CONFIGS:
+        codes, rows = build_config(packs)
+        configs.append((cond, title, codes, rows, table_size(codes, rows)))
+
+    lines = ["/* Языковые пакеты и сжатый шрифт 5х7 для матричных экранов;", "",
+             "   Файл создан скриптом tools/font_pack.py из полного шрифта tools/font_5_7.h - не редактируйте его вручную. "
+             "В шрифт включены только символы, которые выводятся на экран: цифры, знаки температуры и символы строк "
+             "языковых пакетов; в строках пакетов символы заменены номерами в сжатом шрифте.", "",
+             "   Объем шрифта и пакетов во flash (полный шрифт с таблицей дней недели - %d байт):" % full]
+    for _, title, codes, rows, size in configs:
+        lines.append("   %s - %d символов, %d байт, экономия %d байт;" % (title, len(codes), size, full - size))
+    lines += ["*/", "#pragma once", "#include <avr/pgmspace.h>", "", "// строки языкового пакета; смещения от начала пакета"]
+    offset = 0
+    width = max(len("#define %s %d" % (m, 0)) for _, _, m, _ in FIELDS) + 1
+    for field, length, macro, descr in FIELDS:
+        lines.append(("#define %s %d" % (macro, offset)).ljust(width) + "// " + descr)
+        offset += length
+    lines.append("#define LANG_PACK_SIZE %d" % offset)
+    lines += ["", "// символы, общие для всех пакетов; цифры 0..9 идут подряд"]
+    for i, (ch, macro) in enumerate(COMMON):
+        if macro:
+            lines.append("#define %s 0x%02X" % (macro, i))
+    for n, (cond, _, codes, rows, _) in enumerate(configs):
+        lines.append("")
+        if cond is None:
+            lines.append("#else")
+        else:
+            lines.append("%s %s" % ("#if" if n == 0 else "#elif", cond))
+        lines += render_config(font, codes, rows)
+        if cond == "defined(USE_LANGUAGE_SETTING)":
+            lines += ["", "#ifdef USE_RU_LANGUAGE", "#define LANG_DEFAULT LANG_RU", "#else",
+                      "#define LANG_DEFAULT LANG_EN", "#endif"]
+        else:
+            lines += ["", "#define LANG_DEFAULT 0"]
+    lines.append("#endif")
+    return "\n".join(lines) + "\n", full, configs
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--check", action="store_true", help="проверить, что lang_packs.h не устарел")
+    args = parser.parse_args()
+
+    text, full, configs = render(read_font(FONT_FILE))
+    print("configuration,glyphs,bytes,saving")
+    for _, title, codes, _, size in configs:
+        print("%s,%d,%d,%d" % (title, len(codes), size, full - size))
+
+    if args.check:
+        with open(OUT_FILE, encoding="utf-8") as f:
+            if f.read() != text:
+                print("lang_packs.h is out of date; run tools/font_pack.py", file=sys.stderr)
+                return 1
+        return 0
+    with open(OUT_FILE, "w", encoding="utf-8") as f:
+        f.write(text)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,184 @@
+#!/usr/bin/env python3
+"""Отчет о размере прошивки для всех поддерживаемых сочетаний опций часов.
+
+Для каждого сочетания экрана и опций из header_file.h/matrix_data.h скетч
+копируется во временный каталог, в копии включаются нужные строки #define,
+после чего скетч собирается arduino-cli, а размеры секций берутся из
+avr-size. Результат выводится в формате CSV: экран, опции, flash (.text +
+.data), .data, .bss, статическая RAM (.data + .bss), запас RAM под стек и
+список МК, в которые сборка не помещается: flash больше доступной или
+статическая RAM вместе с запасом под стек больше RAM МК.
+
+Глубина стека при сборке не определяется, поэтому запас под стек задается
+ключом --stack-reserve (по умолчанию STACK_RESERVE). Фактическую глубину
+можно измерить на плате: в сборке с USE_RAM_MONITOR по символу 'm' в Serial
+выводится минимальный запас свободной RAM за время работы (min free), и
+глубина стека с прерываниями - это RAM МК - статическая RAM - min free.
+Цифры теста stack из каталога host для этого не годятся - это байты стека
+модели на компьютере, а не AVR.
+
+Запуск (из корня репозитория):
+
+    python3 tools/footprint.py                  # все сочетания
+    python3 tools/footprint.py --quick          # базовая сборка и каждая опция по отдельности
+    python3 tools/footprint.py --display TM1637_DISPLAY --jobs 4 > footprint.csv
+    python3 tools/footprint.py --stack-reserve 320      # свой запас RAM под стек
+
+Нужны arduino-cli с установленным ядром arduino:avr, библиотеками из readme
+и avr-size (входит в ядро arduino:avr или в пакет binutils-avr).
+"""
+
+import argparse
+import concurrent.futures
+import glob
+import itertools
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+
+SKETCH_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+SKETCH_NAME = "simple_clock"
+
+DISPLAYS = [
+    "TM1637_DISPLAY",
+    "MAX72XX_7SEGMENT_DISPLAY",
+    "MAX72XX_MATRIX_DISPLAY",
+    "WS2812_MATRIX_DISPLAY",
+]
+MATRIX_DISPLAYS = ("MAX72XX_MATRIX_DISPLAY", "WS2812_MATRIX_DISPLAY")
+
+OPTIONS = [
+    "USE_CALENDAR",
+    "USE_ALARM",
+    "USE_TEMP_DATA",
+    "USE_LIGHT_SENSOR",
+    "USE_SET_BRIGHTNESS_MODE",
+]
+TEMP_SENSORS = [None, "USE_DS18B20", "USE_NTC"]  # None - встроенный датчик DS3231
+
+# запас RAM под стек (вложенные вызовы главного цикла, задач и экранов, прерывания), байт; оценка, которую стоит заменить измерением на плате (см. описание выше)
+STACK_RESERVE = 256
+
+# доступные скетчу flash и RAM, байт; для ATmega8/88 - без загрузчика, для ATmega168/328 - с загрузчиком Arduino Pro Mini
+MCU_LIMITS = [
+    ("atmega8", 8192, 1024),
+    ("atmega88", 8192, 1024),
+    ("atmega168", 16384 - 2048, 1024),
+    ("atmega328", 32768 - 2048, 2048),
+]
+
+
+def combinations(displays, quick):
+    """Перечисление сочетаний (экран, набор опций)."""
+    for disp in displays:
+        if quick:
+            sets = [()] + [(opt,) for opt in OPTIONS]
+        else:
+            sets = []
+            for n in range(len(OPTIONS) + 1):
+                sets.extend(itertools.combinations(OPTIONS, n))
+        for opts in sets:
+            variants = [list(opts)]
+            if "USE_TEMP_DATA" in opts and not quick:
+                variants = [list(opts) + ([s] if s else []) for s in TEMP_SENSORS]
+            for v in variants:
+                # для матричных экранов с календарем проверяются оба варианта вывода даты - бегущей строкой и последовательно
+                if disp in MATRIX_DISPLAYS and "USE_CALENDAR" in v:
+                    yield disp, v + ["!USE_TICKER_FOR_DATE"]
+                    yield disp, v + ["USE_TICKER_FOR_DATE"]
+                else:
+                    yield disp, v + ["!USE_TICKER_FOR_DATE"]
+
+
+def set_define(text, name, enable):
+    """Включение/выключение строки #define name в тексте файла."""
+    on = re.compile(r"^(\s*)#define %s\b" % name, re.M)
+    off = re.compile(r"^(\s*)//\s*#define %s\b" % name, re.M)
+    if enable:
+        return off.sub(r"\1#define %s" % name, text)
+    return on.sub(r"\1// #define %s" % name, text)
+
+
+def prepare_sketch(dst, disp, opts):
+    """Копирование скетча и включение нужных опций."""
+    sketch = os.path.join(dst, SKETCH_NAME)
+    os.makedirs(sketch)
+    for f in glob.glob(os.path.join(SKETCH_DIR, "*.h")) + glob.glob(os.path.join(SKETCH_DIR, "*.ino")):
+        shutil.copy(f, sketch)
+    for fname in ("header_file.h", "matrix_data.h"):
+        path = os.path.join(sketch, fname)
+        with open(path, encoding="utf-8") as f:
+            text = f.read()
+        if fname == "header_file.h":
+            for d in DISPLAYS:
+                text = set_define(text, d, d == disp)
+            for o in OPTIONS + [s for s in TEMP_SENSORS if s]:
+                text = set_define(text, o, o in opts)
+        else:
+            for o in opts:
+                text = set_define(text, o.lstrip("!"), not o.startswith("!"))
+        with open(path, "w", encoding="utf-8") as f:
+            f.write(text)
+    return sketch
+
+
+def section_sizes(elf, avr_size):
+    """Размеры секций .text, .data и .bss из avr-size -A."""
+    out = subprocess.run([avr_size, "-A", elf], capture_output=True, text=True, check=True).stdout
+    sizes = {}
+    for line in out.splitlines():
+        parts = line.split()
+        if len(parts) >= 2 and parts[0] in (".text", ".data", ".bss"):
+            sizes[parts[0]] = int(parts[1])
+    return sizes.get(".text", 0), sizes.get(".data", 0), sizes.get(".bss", 0)
+
+
+def build(disp, opts, args):
+    with tempfile.TemporaryDirectory() as tmp:
+        sketch = prepare_sketch(tmp, disp, opts)
+        build_path = os.path.join(tmp, "build")
+        res = subprocess.run(
+            [args.arduino_cli, "compile", "--fqbn", args.fqbn, "--build-path", build_path, sketch],
+            capture_output=True, text=True)
+        if res.returncode != 0:
+            return disp, opts, None, res.stderr.strip().splitlines()[-1:] or ["build failed"]
+        elf = os.path.join(build_path, SKETCH_NAME + ".ino.elf")
+        return disp, opts, section_sizes(elf, args.avr_size), None
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--display", choices=DISPLAYS, action="append", help="проверять только указанный экран")
+    parser.add_argument("--quick", action="store_true", help="базовая сборка и каждая опция по отдельности")
+    parser.add_argument("--fqbn", default="arduino:avr:pro:cpu=16MHzatmega328", help="плата для сборки")
+    parser.add_argument("--arduino-cli", default="arduino-cli")
+    parser.add_argument("--avr-size", default="avr-size")
+    parser.add_argument("--jobs", type=int, default=1, help="количество параллельных сборок")
+    parser.add_argument("--stack-reserve", type=int, default=STACK_RESERVE,
+                        help="запас RAM под стек, байт (по умолчанию %d)" % STACK_RESERVE)
+    args = parser.parse_args()
+
+    combos = list(combinations(args.display or DISPLAYS, args.quick))
+    print("display,options,flash,data,bss,ram,stack,does_not_fit")
+    failed = 0
+    with concurrent.futures.ThreadPoolExecutor(max_workers=args.jobs) as pool:
+        for disp, opts, sizes, err in pool.map(lambda c: build(c[0], c[1], args), combos):
+            flags = " ".join(o for o in opts if not o.startswith("!"))
+            if sizes is None:
+                failed += 1
+                print("%s,%s,error,,,,,%s" % (disp, flags, " ".join(err).replace(",", ";")))
+                continue
+            text, data, bss = sizes
+            flash, ram = text + data, data + bss
+            stack = args.stack_reserve
+            over = [mcu for mcu, max_flash, max_ram in MCU_LIMITS if flash > max_flash or ram + stack > max_ram]
+            print("%s,%s,%d,%d,%d,%d,%d,%s" % (disp, flags, flash, data, bss, ram, stack, " ".join(over)))
+            sys.stdout.flush()
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,181 @@
+#!/usr/bin/env python3
+"""Расшифровка буфера трассировки часов (USE_TRACE, см. trace.h).
+
+Скрипт отправляет часам символ 't', принимает двоичный дамп буфера
+трассировки и выводит временную диаграмму: время от первой записи в мс,
+интервал от предыдущей записи, категорию, событие и аргумент. Для задач
+дополнительно выводится длительность выполнения. Дамп можно сохранить в файл
+(--save) и расшифровать позже (--file), а также преобразовать в формат
+Chrome Trace Event (--chrome) для просмотра в chrome://tracing или Perfetto.
+
+Запуск (из корня репозитория):
+
+    python3 tools/trace_decode.py --port /dev/ttyUSB0
+    python3 tools/trace_decode.py --port /dev/ttyUSB0 --save trace.bin
+    python3 tools/trace_decode.py --file trace.bin --chrome trace.json
+
+Для работы с портом нужен пакет pyserial.
+"""
+
+import argparse
+import json
+import struct
+import sys
+import time
+
+HEADER = struct.Struct("<3sBBBBI")
+RECORD = struct.Struct("<HBB")
+FORMAT_VERSION = 1
+
+# коды событий и категории - в том же порядке, что и TraceEvent в trace.h
+EVENTS = [
+    ("timer_wrap", "timer"),
+    ("task_begin", "task"),
+    ("task_end", "task"),
+    ("button_edge", "button"),
+    ("button_event", "button"),
+    ("display_show", "display"),
+    ("rtc_read", "rtc"),
+    ("rtc_sqw", "rtc"),
+    ("blink", "rtc"),
+    ("alarm_state", "alarm"),
+    ("buzzer_note", "alarm"),
+    ("mode_change", "mode"),
+]
+BUTTON_STATES = ["released", "up", "pressed", "down", "dblclick", "oneclick", "longclick"]
+
+
+def read_dump(data):
+    """Разбор дампа; возвращает частоту таймера, количество потерянных записей и список записей."""
+    if len(data) < HEADER.size:
+        raise ValueError("dump is too short")
+    magic, version, count, lost, mask, hz = HEADER.unpack_from(data)
+    if magic != b"TRC" or version != FORMAT_VERSION:
+        raise ValueError("unknown dump format")
+    size = HEADER.size + count * RECORD.size
+    if len(data) < size:
+        raise ValueError("dump is truncated: %d of %d bytes" % (len(data), size))
+    records = [RECORD.unpack_from(data, HEADER.size + i * RECORD.size) for i in range(count)]
+    return hz, lost, records
+
+
+def unwrap(records):
+    """Перевод 16-битных отметок времени в непрерывные; уменьшение отметки означает переполнение таймера.
+
+    Часы записывают событие timer_wrap при каждом переполнении, поэтому между двумя
+    записями таймер не может переполниться больше одного раза.
+    """
+    result = []
+    base = 0
+    prev = None
+    for t, event, arg in records:
+        if prev is not None and t < prev:
+            base += 0x10000
+        prev = t
+        result.append((base + t, event, arg))
+    return result
+
+
+def describe(event, arg):
+    name, cat = EVENTS[event] if event < len(EVENTS) else ("event_%d" % event, "unknown")
+    if name == "button_event":
+        state = arg & 0x0F
+        arg_text = "pin %d %s" % (arg >> 4, BUTTON_STATES[state] if state < len(BUTTON_STATES) else state)
+    elif name in ("button_edge", "rtc_sqw", "timer_wrap"):
+        arg_text = ""
+    else:
+        arg_text = str(arg)
+    return name, cat, arg_text
+
+
+def print_timeline(hz, lost, records, out):
+    if lost:
+        out.write("# %d older records were overwritten\n" % lost)
+    out.write("%10s %9s  %-8s %-13s %s\n" % ("time, ms", "+ms", "category", "event", "arg"))
+    if not records:
+        return
+    start = records[0][0]
+    prev = start
+    task_begin = {}
+    for t, event, arg in records:
+        name, cat, arg_text = describe(event, arg)
+        if name == "timer_wrap":
+            continue
+        if name == "task_begin":
+            task_begin[arg] = t
+        elif name == "task_end" and arg in task_begin:
+            arg_text += " (%.3f ms)" % ((t - task_begin.pop(arg)) * 1000.0 / hz)
+        out.write("%10.3f %9.3f  %-8s %-13s %s\n" % (
+            (t - start) * 1000.0 / hz, (t - prev) * 1000.0 / hz, cat, name, arg_text))
+        prev = t
+
+
+def chrome_trace(hz, records):
+    """Преобразование в формат Chrome Trace Event: задачи - интервалы, остальные события - отметки."""
+    events = []
+    for t, event, arg in records:
+        name, cat, arg_text = describe(event, arg)
+        ts = t * 1000000.0 / hz
+        if name == "timer_wrap":
+            continue
+        if name in ("task_begin", "task_end"):
+            events.append({"name": "task %d" % arg, "cat": cat, "ph": "B" if name == "task_begin" else "E",
+                           "ts": ts, "pid": 0, "tid": "tasks"})
+        else:
+            events.append({"name": name, "cat": cat, "ph": "i", "s": "t", "ts": ts, "pid": 0, "tid": cat,
+                           "args": {"arg": arg_text}})
+    return {"traceEvents": events, "displayTimeUnit": "ms"}
+
+
+def read_port(port, baud, timeout):
+    import serial  # pyserial
+
+    with serial.Serial(port, baud, timeout=timeout) as ser:
+        time.sleep(2)  # открытие порта перезапускает большинство плат Arduino
+        ser.reset_input_buffer()
+        ser.write(b"t")
+        # поиск заголовка - в порт может выводиться и другая отладочная информация
+        buf = b""
+        deadline = time.time() + timeout
+        while b"TRC" not in buf and time.time() < deadline:
+            buf += ser.read(1)
+        buf = buf[buf.find(b"TRC"):]
+        buf += ser.read(HEADER.size - len(buf))
+        if len(buf) < HEADER.size:
+            raise ValueError("no trace dump received")
+        count = buf[4]
+        buf += ser.read(count * RECORD.size)
+        return buf
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    src = parser.add_mutually_exclusive_group(required=True)
+    src.add_argument("--port", help="последовательный порт часов")
+    src.add_argument("--file", help="файл с сохраненным дампом")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--timeout", type=float, default=3.0, help="время ожидания дампа, с")
+    parser.add_argument("--save", help="сохранить полученный дамп в файл")
+    parser.add_argument("--chrome", help="сохранить диаграмму в формате Chrome Trace Event")
+    args = parser.parse_args()
+
+    if args.port:
+        data = read_port(args.port, args.baud, args.timeout)
+    else:
+        with open(args.file, "rb") as f:
+            data = f.read()
+    if args.save:
+        with open(args.save, "wb") as f:
+            f.write(data)
+
+    hz, lost, records = read_dump(data)
+    records = unwrap(records)
+    print_timeline(hz, lost, records, sys.stdout)
+    if args.chrome:
+        with open(args.chrome, "w") as f:
+            json.dump(chrome_trace(hz, records), f)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,196 @@
+/* Трассировка событий часов;
+
+   События записываются в кольцевой буфер в RAM компактными записями по 4 байта: отметка времени от аппаратного таймера (см. halTimerRead()), код события и однобайтовый аргумент. Запись занимает несколько тактов и может выполняться из задач, прерываний и кода экранов, не искажая временных соотношений, как это делает вывод в Serial. При заполнении буфера самые старые записи затираются.
+
+   События разбиты на категории; запись событий каждой категории включается битом маски, проверка которой - единственные накладные расходы отключенной категории. При каждом переполнении таймера записывается событие TRACE_TIMER_WRAP, что позволяет восстановить абсолютное время на стороне компьютера.
+
+   Методы:
+
+   void begin() - запуск таймера отметок времени;
+   void setMask(mask) - установка маски категорий событий;
+   uint8_t getMask() - получение маски категорий событий;
+   void add(event, arg) - запись события;
+   void dump(out) - вывод содержимого буфера в двоичном виде и очистка буфера;
+
+   Формат вывода: заголовок "TRC", версия формата, количество записей, количество потерянных записей (до 255), маска, частота таймера в Гц (uint32_t, little-endian), затем записи: отметка времени (uint16_t, little-endian), код события, аргумент. Расшифровка выполняется скриптом tools/trace_decode.py.
+
+   События записываются макросом TRACE(category, event, arg); если макрос USE_TRACE не определен, макрос пуст и код трассировки не компилируется.
+*/
+#pragma once
+#include <Arduino.h>
+
+#ifdef USE_TRACE
+#include "hal.h"
+
+#define TRACE_BUFFER_SIZE 32 // размер буфера, записей (степень двойки); каждая запись занимает 4 байта RAM
+#define TRACE_FORMAT_VERSION 1
+
+static_assert((TRACE_BUFFER_SIZE & (TRACE_BUFFER_SIZE - 1)) == 0 && TRACE_BUFFER_SIZE <= 128,
+              "TRACE_BUFFER_SIZE must be a power of two up to 128");
+
+enum TraceCategory : uint8_t // категории событий - биты маски
+{
+  TRACE_CAT_TASK = 0x01,    // выполнение задач
+  TRACE_CAT_BUTTON = 0x02,  // кнопки
+  TRACE_CAT_DISPLAY = 0x04, // передача данных на экран
+  TRACE_CAT_RTC = 0x08,     // считывание времени, блинк
+  TRACE_CAT_ALARM = 0x10,   // будильник
+  TRACE_CAT_MODE = 0x20,    // смена режимов экрана
+  TRACE_CAT_ALL = 0xFF
+};
+
+enum TraceEvent : uint8_t // коды событий; при изменении нужно обновить tools/trace_decode.py
+{
+  TRACE_TIMER_WRAP,   // переполнение таймера отметок времени
+  TRACE_TASK_BEGIN,   // начало выполнения задачи, аргумент - идентификатор задачи
+  TRACE_TASK_END,     // окончание выполнения задачи, аргумент - идентификатор задачи
+  TRACE_BUTTON_EDGE,  // прерывание по изменению уровня на пинах кнопок
+  TRACE_BUTTON_EVENT, // событие кнопки, аргумент - пин кнопки * 16 + событие
+  TRACE_DISPLAY_SHOW, // вызов show() экрана, аргумент - 1, если данные переданы
+  TRACE_RTC_READ,     // считывание времени из DS3231, аргумент - секунды
+  TRACE_RTC_SQW,      // импульс SQW от DS3231
+  TRACE_BLINK,        // изменение флага блинка, аргумент - новое значение
+  TRACE_ALARM_STATE,  // срабатывание будильника, аргумент - состояние будильника
+  TRACE_BUZZER_NOTE,  // нота пищалки, аргумент - номер ноты
+  TRACE_MODE_CHANGE   // смена режима экрана, аргумент - новый режим
+};
+
+struct TraceRecord
+{
+  uint16_t time; // отметка времени, тики таймера
+  uint8_t event; // код события
+  uint8_t arg;   // аргумент
+};
+
+class TraceBuffer
+{
+private:
+  TraceRecord buf[TRACE_BUFFER_SIZE];
+  volatile uint8_t mask;
+  uint8_t head = 0;  // индекс следующей записи
+  uint8_t count = 0; // количество записей в буфере
+  uint8_t lost = 0;  // количество затертых записей
+
+  void writeWord(Print &out, uint16_t value)
+  {
+    out.write((uint8_t)value);
+    out.write((uint8_t)(value >> 8));
+  }
+
+public:
+  /**
+   * @brief конструктор
+   *
+   * @param _mask маска категорий событий при старте
+   */
+  TraceBuffer(uint8_t _mask) { mask = _mask; }
+
+  /**
+   * @brief запуск таймера отметок времени
+   *
+   */
+  void begin() { halTimerStart(); }
+
+  /**
+   * @brief установка маски категорий событий
+   *
+   * @param _mask маска, биты TraceCategory; 0 - трассировка отключена
+   */
+  void setMask(uint8_t _mask) { mask = _mask; }
+
+  /**
+   * @brief получение маски категорий событий
+   *
+   * @return uint8_t
+   */
+  uint8_t getMask() { return (mask); }
+
+  /**
+   * @brief запись события в буфер; может вызываться из прерываний
+   *
+   * @param event код события
+   * @param arg аргумент
+   */
+  void add(uint8_t event, uint8_t arg)
+  {
+    uint8_t state = halDisableInterrupts();
+    TraceRecord &rec = buf[head];
+    rec.time = halTimerRead();
+    rec.event = event;
+    rec.arg = arg;
+    head = (head + 1) & (TRACE_BUFFER_SIZE - 1);
+    if (count < TRACE_BUFFER_SIZE)
+    {
+      count++;
+    }
+    else if (lost < 0xFF)
+    {
+      lost++;
+    }
+    halRestoreInterrupts(state);
+  }
+
+  /**
+   * @brief обработка переполнения таймера; вызывается из прерывания таймера
+   *
+   */
+  void timerWrap()
+  {
+    if (mask)
+    {
+      add(TRACE_TIMER_WRAP, 0);
+    }
+  }
+
+  /**
+   * @brief вывод содержимого буфера в двоичном виде; на время вывода запись событий приостанавливается, после вывода буфер очищается
+   *
+   * @param out поток для вывода, например, Serial
+   */
+  void dump(Print &out)
+  {
+    uint8_t _mask = mask;
+    mask = 0;
+    out.write('T');
+    out.write('R');
+    out.write('C');
+    out.write(TRACE_FORMAT_VERSION);
+    out.write(count);
+    out.write(lost);
+    out.write(_mask);
+    uint32_t hz = HAL_TIMER_HZ;
+    writeWord(out, (uint16_t)hz);
+    writeWord(out, (uint16_t)(hz >> 16));
+    uint8_t i = (head - count) & (TRACE_BUFFER_SIZE - 1);
+    for (uint8_t n = 0; n < count; n++)
+    {
+      writeWord(out, buf[i].time);
+      out.write(buf[i].event);
+      out.write(buf[i].arg);
+      i = (i + 1) & (TRACE_BUFFER_SIZE - 1);
+    }
+    uint8_t state = halDisableInterrupts();
+    count = 0;
+    lost = 0;
+    mask = _mask;
+    halRestoreInterrupts(state);
+  }
+};
+
+#ifndef TRACE_DEFAULT_MASK
+#define TRACE_DEFAULT_MASK TRACE_CAT_ALL // категории событий, записываемые при старте
+#endif
+
+TraceBuffer trace(TRACE_DEFAULT_MASK);
+
+#define TRACE(category, event, arg)     \
+  do                                    \
+  {                                     \
+    if (trace.getMask() & (category))   \
+    {                                   \
+      trace.add(event, arg);            \
+    }                                   \
+  } while (0)
+#else
+#define TRACE(category, event, arg)
+#endif